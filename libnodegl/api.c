@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include <pthread.h>
 #include <stdio.h>
+#include <string.h>
 
 #if defined(TARGET_ANDROID)
 #include <jni.h>
@@ -31,11 +32,33 @@
 
 #include "backend.h"
 #include "darray.h"
+#include "dedup.h"
+#include "glstate.h"
 #include "log.h"
 #include "math_utils.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "patch.h"
+#include "profiler.h"
+#include "utils.h"
+
+#define FRAME_ARENA_BLOCK_SIZE (64 * 1024)
+
+static int attach_scene(struct ngl_ctx *s, struct ngl_node *scene)
+{
+    if (s->config.dedup_resources) {
+        int ret = ngli_dedup_scene(scene);
+        if (ret < 0)
+            return ret;
+    }
+
+    int ret = ngli_node_program_precompile(s, scene);
+    if (ret >= 0)
+        ret = ngli_node_attach_ctx(scene, s);
+    ngli_node_program_release_unused(s);
+    return ret;
+}
 
 static int cmd_reconfigure(struct ngl_ctx *s, void *arg)
 {
@@ -58,12 +81,19 @@ static int cmd_reconfigure(struct ngl_ctx *s, void *arg)
         current_config->handle    != config->handle    ||
         current_config->offscreen != config->offscreen ||
         current_config->samples   != config->samples) {
+        s->nb_frames_since_attach = 0;
         ngli_node_detach_ctx(s->scene);
+        if (s->profiler)
+            ngli_profiler_set_glcontext(s->profiler, NULL);
+        ngli_stats_reset(&s->stats);
         s->backend->destroy(s);
         int ret = s->backend->configure(s, config);
         if (ret < 0)
             return ret;
-        ret = ngli_node_attach_ctx(s->scene, s);
+        ngli_stats_init(&s->stats, s->glcontext);
+        if (s->profiler)
+            ngli_profiler_set_glcontext(s->profiler, s->glcontext);
+        ret = attach_scene(s, s->scene);
         if (ret < 0)
             return ret;
         return 0;
@@ -78,9 +108,22 @@ static int cmd_reconfigure(struct ngl_ctx *s, void *arg)
 static int cmd_configure(struct ngl_ctx *s, void *arg)
 {
     int ret = s->backend->configure(s, arg);
-    if (ret < 0)
+    if (ret < 0) {
         LOG(ERROR, "unable to configure %s", s->backend->name);
-    return ret;
+        return ret;
+    }
+
+    ngli_stats_init(&s->stats, s->glcontext);
+
+    const char *profile_filename = getenv("NGL_PROFILE");
+    if (profile_filename) {
+        s->profiler = ngli_profiler_create(profile_filename);
+        if (!s->profiler)
+            return -1;
+        ngli_profiler_set_glcontext(s->profiler, s->glcontext);
+    }
+
+    return 0;
 }
 
 static int cmd_set_scene(struct ngl_ctx *s, void *arg)
@@ -90,24 +133,72 @@ static int cmd_set_scene(struct ngl_ctx *s, void *arg)
         ngl_node_unrefp(&s->scene);
     }
 
+    s->nb_frames_since_attach = 0;
+
     struct ngl_node *scene = arg;
     if (!scene)
         return 0;
 
-    int ret = ngli_node_attach_ctx(scene, s);
-    if (ret < 0) {
-        ngli_node_detach_ctx(scene);
+    int ret = attach_scene(s, scene);
+    if (ret < 0)
         return ret;
-    }
 
     s->scene = ngl_node_ref(scene);
     return 0;
 }
 
+static int cmd_patch_scene(struct ngl_ctx *s, void *arg)
+{
+    struct ngl_node *new_scene = arg;
+    if (!s->scene || !new_scene)
+        return cmd_set_scene(s, new_scene);
+
+    struct patch *patch = ngli_patch_create(s->scene, new_scene);
+    if (!patch)
+        return -1;
+
+    const struct patch_stats *stats = ngli_patch_get_stats(patch);
+    LOG(DEBUG, "scene patched: %d nodes kept (%d updated), %d nodes created",
+        stats->nb_kept, stats->nb_updated, stats->nb_created);
+
+    /*
+     * The new graph is attached before the current one is detached so the
+     * nodes shared by both graphs are not released. The attach is all or
+     * nothing, so on failure the current scene is left untouched: the live
+     * changes of the kept nodes are only applied once the attach succeeded.
+     */
+    struct ngl_node *scene = ngli_patch_get_scene(patch);
+    int ret = 0;
+    if (scene != s->scene) {
+        ret = attach_scene(s, scene);
+        if (ret < 0)
+            goto end;
+    }
+
+    ret = ngli_patch_apply(patch);
+    if (ret < 0)
+        LOG(ERROR, "unable to apply the live changes of the patched scene");
+
+    if (scene != s->scene) {
+        ngli_node_detach_ctx(s->scene);
+        ngl_node_unrefp(&s->scene);
+        s->scene = ngl_node_ref(scene);
+    }
+
+end:
+    ngli_patch_freep(&patch);
+    return ret;
+}
+
 static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
 {
     const double t = *(double *)arg;
 
+    ngli_arena_reset(s->frame_arena);
+    s->activitycheck_nodes = NULL;
+    s->nb_activitycheck_nodes = 0;
+    s->activitycheck_nodes_capacity = 0;
+
     struct ngl_node *scene = s->scene;
     if (!scene) {
         return 0;
@@ -115,12 +206,11 @@ static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
 
     LOG(DEBUG, "prepare scene %s @ t=%f", scene->label, t);
 
-    s->activitycheck_nodes.count = 0;
     int ret = ngli_node_visit(scene, 1, t);
     if (ret < 0)
         return ret;
 
-    ret = ngli_node_honor_release_prefetch(&s->activitycheck_nodes);
+    ret = ngli_node_honor_release_prefetch(s->activitycheck_nodes, s->nb_activitycheck_nodes);
     if (ret < 0)
         return ret;
 
@@ -131,33 +221,85 @@ static int cmd_prepare_draw(struct ngl_ctx *s, void *arg)
     return 0;
 }
 
+#ifdef DEBUG_MEM
+/*
+ * Once the scene has been drawn a few times, a frame is expected not to
+ * allocate any heap memory: transient allocations must go through the frame
+ * arena. NGL_MEM_FRAME_ALLOCS=1 reports the frames breaking this rule,
+ * NGL_MEM_FRAME_ALLOCS=assert aborts on them.
+ */
+static void check_frame_heap_allocs(struct ngl_ctx *s, size_t nb_heap_allocs_start)
+{
+    const char *check = getenv("NGL_MEM_FRAME_ALLOCS");
+    if (!check || s->nb_frames_since_attach < 3)
+        return;
+
+    const size_t nb_heap_allocs = ngli_memory_get_nb_heap_allocs() - nb_heap_allocs_start;
+    if (!nb_heap_allocs)
+        return;
+
+    LOG(WARNING, "%zu heap allocation(s) during frame %d of the scene",
+        nb_heap_allocs, s->nb_frames_since_attach);
+    if (!strcmp(check, "assert"))
+        ngli_assert(0);
+}
+#else
+static void check_frame_heap_allocs(struct ngl_ctx *s, size_t nb_heap_allocs_start)
+{
+}
+#endif
+
 static int cmd_draw(struct ngl_ctx *s, void *arg)
 {
     const double t = *(double *)arg;
 
+    const size_t nb_heap_allocs_start = ngli_memory_get_nb_heap_allocs();
+    s->nb_frames_since_attach++;
+
     int ret = s->backend->pre_draw(s, t);
     if (ret < 0)
         goto end;
 
+    const int64_t update_start = ngli_gettime();
     ret = cmd_prepare_draw(s, arg);
     if (ret < 0)
         goto end;
 
+    const int64_t draw_start = ngli_gettime();
+    s->stats.cur.update_cpu_time = draw_start - update_start;
+
     if (s->scene) {
         LOG(DEBUG, "draw scene %s @ t=%f", s->scene->label, t);
+        ngli_stats_draw_start(&s->stats);
         ngli_node_draw(s->scene);
+        ngli_stats_draw_end(&s->stats);
     }
 
+    s->stats.cur.draw_cpu_time = ngli_gettime() - draw_start;
+
 end:;
     int end_ret = s->backend->post_draw(s, t);
+    ngli_stats_frame_end(&s->stats);
+    if (s->profiler)
+        ngli_profiler_frame_end(s->profiler);
+    check_frame_heap_allocs(s, nb_heap_allocs_start);
     if (end_ret < 0)
         return end_ret;
 
     return ret;
 }
 
+static int cmd_get_stats(struct ngl_ctx *s, void *arg)
+{
+    struct ngl_stats *stats = arg;
+    *stats = s->stats.last;
+    return 0;
+}
+
 static int cmd_stop(struct ngl_ctx *s, void *arg)
 {
+    ngli_profiler_freep(&s->profiler);
+    ngli_stats_reset(&s->stats);
     s->backend->destroy(s);
     return 0;
 }
@@ -185,6 +327,10 @@ static void *worker_thread(void *arg)
     for (;;) {
         while (!s->cmd_func)
             pthread_cond_wait(&s->cond_wkr, &s->lock);
+        /* A wrapped GL context is shared with the host application which may
+         * have changed any binding since the previous command */
+        if (s->glcontext && s->config.handle)
+            ngli_glstate_reset_bindings(s->glcontext);
         s->cmd_ret = s->cmd_func(s, s->cmd_arg);
         int need_stop = s->cmd_func == cmd_stop;
         s->cmd_func = s->cmd_arg = NULL;
@@ -242,6 +388,11 @@ static void stop_thread(struct ngl_ctx *s)
     pthread_mutex_destroy(&s->lock);
 }
 
+static void free_shared_resource(void *user_arg, void *data)
+{
+    ngli_free(data);
+}
+
 struct ngl_ctx *ngl_create(void)
 {
     struct ngl_ctx *s = ngli_calloc(1, sizeof(*s));
@@ -261,7 +412,14 @@ struct ngl_ctx *ngl_create(void)
 
     ngli_darray_init(&s->modelview_matrix_stack, 4 * 4 * sizeof(float), 1);
     ngli_darray_init(&s->projection_matrix_stack, 4 * 4 * sizeof(float), 1);
-    ngli_darray_init(&s->activitycheck_nodes, sizeof(struct ngl_node *), 0);
+
+    s->frame_arena = ngli_arena_create(FRAME_ARENA_BLOCK_SIZE);
+    s->slab = ngli_slab_create();
+    s->shared_resources = ngli_hmap_create();
+    s->shared_programs = ngli_hmap_create();
+    if (!s->frame_arena || !s->slab || !s->shared_resources || !s->shared_programs)
+        goto fail;
+    ngli_hmap_set_free(s->shared_resources, free_shared_resource, NULL);
 
     static const NGLI_ALIGNED_MAT(id_matrix) = NGLI_MAT4_IDENTITY;
     if (!ngli_darray_push(&s->modelview_matrix_stack, id_matrix) ||
@@ -374,6 +532,16 @@ int ngl_set_scene(struct ngl_ctx *s, struct ngl_node *scene)
     return dispatch_cmd(s, cmd_set_scene, scene);
 }
 
+int ngl_patch_scene(struct ngl_ctx *s, struct ngl_node *scene)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before setting a scene");
+        return -1;
+    }
+
+    return dispatch_cmd(s, cmd_patch_scene, scene);
+}
+
 int ngli_prepare_draw(struct ngl_ctx *s, double t)
 {
     if (!s->configured) {
@@ -394,6 +562,16 @@ int ngl_draw(struct ngl_ctx *s, double t)
     return dispatch_cmd(s, cmd_draw, &t);
 }
 
+int ngl_get_stats(struct ngl_ctx *s, struct ngl_stats *stats)
+{
+    if (!s->configured) {
+        LOG(ERROR, "context must be configured before getting stats");
+        return -1;
+    }
+
+    return dispatch_cmd(s, cmd_get_stats, stats);
+}
+
 void ngl_freep(struct ngl_ctx **ss)
 {
     struct ngl_ctx *s = *ss;
@@ -407,7 +585,10 @@ void ngl_freep(struct ngl_ctx **ss)
     stop_thread(s);
     ngli_darray_reset(&s->modelview_matrix_stack);
     ngli_darray_reset(&s->projection_matrix_stack);
-    ngli_darray_reset(&s->activitycheck_nodes);
+    ngli_arena_freep(&s->frame_arena);
+    ngli_hmap_freep(&s->shared_resources);
+    ngli_hmap_freep(&s->shared_programs);
+    ngli_slab_freep(&s->slab);
     ngli_free(*ss);
     *ss = NULL;
 }
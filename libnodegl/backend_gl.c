@@ -77,7 +77,8 @@ static int offscreen_fbo_init(struct ngl_ctx *s)
     if (ret < 0)
         return ret;
 
-    ngli_glViewport(gl, 0, 0, config->width, config->height);
+    const GLint viewport[] = {0, 0, config->width, config->height};
+    ngli_glstate_viewport(gl, viewport);
 
     return 0;
 }
@@ -195,10 +196,10 @@ static int capture_init(struct ngl_ctx *s)
             }
 
             GLuint id = CVOpenGLESTextureGetName(s->capture_cvtexture);
-            ngli_glBindTexture(gl, GL_TEXTURE_2D, id);
+            ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, id);
             ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
             ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-            ngli_glBindTexture(gl, GL_TEXTURE_2D, 0);
+            ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, 0);
 
             struct texture_params attachment_params = NGLI_TEXTURE_PARAM_DEFAULTS;
             attachment_params.format = NGLI_FORMAT_B8G8R8A8_UNORM;
@@ -339,7 +340,7 @@ static int gl_reconfigure(struct ngl_ctx *s, const struct ngl_config *config)
 
     const int *viewport = config->viewport;
     if (viewport[2] > 0 && viewport[3] > 0) {
-        ngli_glViewport(gl, viewport[0], viewport[1], viewport[2], viewport[3]);
+        ngli_glstate_viewport(gl, viewport);
         memcpy(current_config->viewport, config->viewport, sizeof(config->viewport));
     }
 
@@ -377,7 +378,7 @@ static int gl_configure(struct ngl_ctx *s, const struct ngl_config *config)
 
     const int *viewport = config->viewport;
     if (viewport[2] > 0 && viewport[3] > 0)
-        ngli_glViewport(s->glcontext, viewport[0], viewport[1], viewport[2], viewport[3]);
+        ngli_glstate_viewport(s->glcontext, viewport);
 
     const float *rgba = config->clear_color;
     ngli_glClearColor(s->glcontext, rgba[0], rgba[1], rgba[2], rgba[3]);
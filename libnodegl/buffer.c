@@ -31,16 +31,27 @@ int ngli_buffer_allocate(struct buffer *buffer, struct glcontext *gl, int size,
     buffer->size = size;
     buffer->usage = usage;
     ngli_glGenBuffers(gl, 1, &buffer->id);
-    ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, buffer->id);
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, buffer->id);
     ngli_glBufferData(gl, GL_ARRAY_BUFFER, size, NULL, usage);
+    gl->buffers_memory += size;
     return 0;
 }
 
 int ngli_buffer_upload(struct buffer *buffer, void *data, int size)
 {
     struct glcontext *gl = buffer->gl;
-    ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, buffer->id);
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, buffer->id);
     ngli_glBufferSubData(gl, GL_ARRAY_BUFFER, 0, size, data);
+    gl->uploaded_bytes += size;
+    return 0;
+}
+
+int ngli_buffer_upload_range(struct buffer *buffer, const void *data, int offset, int size)
+{
+    struct glcontext *gl = buffer->gl;
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, buffer->id);
+    ngli_glBufferSubData(gl, GL_ARRAY_BUFFER, offset, size, data);
+    gl->uploaded_bytes += size;
     return 0;
 }
 
@@ -48,6 +59,7 @@ void ngli_buffer_free(struct buffer *buffer)
 {
     if (!buffer->gl)
         return;
-    ngli_glDeleteBuffers(buffer->gl, 1, &buffer->id);
+    ngli_glstate_delete_buffer(buffer->gl, buffer->id);
+    buffer->gl->buffers_memory -= buffer->size;
     memset(buffer, 0, sizeof(*buffer));
 }
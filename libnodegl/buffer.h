@@ -33,6 +33,7 @@ struct buffer {
 
 int ngli_buffer_allocate(struct buffer *buffer, struct glcontext *gl, int size, int usage);
 int ngli_buffer_upload(struct buffer *buffer, void *data, int size);
+int ngli_buffer_upload_range(struct buffer *buffer, const void *data, int offset, int size);
 void ngli_buffer_free(struct buffer *buffer);
 
 #endif
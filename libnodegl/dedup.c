@@ -0,0 +1,406 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "darray.h"
+#include "dedup.h"
+#include "hmap.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "utils.h"
+
+struct scan {
+    struct hmap *visited;
+    struct hmap *excluded;
+    struct darray candidates;
+};
+
+static void get_node_key(char *key, size_t size, const struct ngl_node *node)
+{
+    (void)snprintf(key, size, "%p", node);
+}
+
+static int is_static_buffer(const struct ngl_node *node)
+{
+    const char *params_id = node->class->params_id;
+    return params_id && !strcmp(params_id, "Buffer");
+}
+
+static int is_texture(const struct ngl_node *node)
+{
+    return node->class->id == NGL_NODE_TEXTURE2D ||
+           node->class->id == NGL_NODE_TEXTURE3D;
+}
+
+static int exclude_node(struct scan *scan, const struct ngl_node *node)
+{
+    if (!node)
+        return 0;
+    char key[32];
+    get_node_key(key, sizeof(key), node);
+    return ngli_hmap_set(scan->excluded, key, (void *)node);
+}
+
+static int exclude_dict(struct scan *scan, struct hmap *hmap)
+{
+    if (!hmap)
+        return 0;
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(hmap, entry))) {
+        int ret = exclude_node(scan, entry->data);
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
+/* Exclude the resources which may be written by the GPU */
+static int exclude_written_resources(struct scan *scan, const struct ngl_node *node)
+{
+    switch (node->class->id) {
+    case NGL_NODE_RENDER: {
+        const struct render_priv *s = node->priv_data;
+        return exclude_dict(scan, s->pipeline.buffers);
+    }
+    case NGL_NODE_COMPUTE: {
+        const struct compute_priv *s = node->priv_data;
+        int ret = exclude_dict(scan, s->pipeline.buffers);
+        if (ret < 0)
+            return ret;
+        return exclude_dict(scan, s->pipeline.textures);
+    }
+    case NGL_NODE_RENDERTOTEXTURE: {
+        const struct rtt_priv *s = node->priv_data;
+        int ret = exclude_node(scan, s->color_texture);
+        if (ret < 0)
+            return ret;
+        return exclude_node(scan, s->depth_texture);
+    }
+    }
+    return 0;
+}
+
+static int scan_node(struct scan *scan, struct ngl_node *node);
+
+static int scan_children(struct scan *scan, struct ngl_node *node)
+{
+    uint8_t *base_ptr = node->priv_data;
+    const struct node_param *par = node->class->params;
+
+    while (par && par->key) {
+        int ret = 0;
+        switch (par->type) {
+            case PARAM_TYPE_NODE: {
+                struct ngl_node *child = *(struct ngl_node **)(base_ptr + par->offset);
+                if (child)
+                    ret = scan_node(scan, child);
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **elems = *(struct ngl_node ***)(base_ptr + par->offset);
+                const int nb_elems = *(int *)(base_ptr + par->offset + sizeof(struct ngl_node **));
+                for (int i = 0; i < nb_elems && ret >= 0; i++)
+                    ret = scan_node(scan, elems[i]);
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(base_ptr + par->offset);
+                if (!hmap)
+                    break;
+                const struct hmap_entry *entry = NULL;
+                while (ret >= 0 && (entry = ngli_hmap_next(hmap, entry)))
+                    ret = scan_node(scan, entry->data);
+                break;
+            }
+        }
+        if (ret < 0)
+            return ret;
+        par++;
+    }
+    return 0;
+}
+
+static int scan_node(struct scan *scan, struct ngl_node *node)
+{
+    char key[32];
+    get_node_key(key, sizeof(key), node);
+    if (ngli_hmap_get(scan->visited, key))
+        return 0;
+    int ret = ngli_hmap_set(scan->visited, key, node);
+    if (ret < 0)
+        return ret;
+
+    if ((is_static_buffer(node) || is_texture(node)) &&
+        !ngli_darray_push(&scan->candidates, &node))
+        return -1;
+
+    ret = exclude_written_resources(scan, node);
+    if (ret < 0)
+        return ret;
+
+    return scan_children(scan, node);
+}
+
+int ngli_dedup_scene(struct ngl_node *scene)
+{
+    int ret = -1;
+    struct scan scan = {
+        .visited  = ngli_hmap_create(),
+        .excluded = ngli_hmap_create(),
+    };
+    ngli_darray_init(&scan.candidates, sizeof(struct ngl_node *), 0);
+    if (!scan.visited || !scan.excluded)
+        goto end;
+
+    ret = scan_node(&scan, scene);
+    if (ret < 0)
+        goto end;
+
+    int nb_shareable = 0;
+    struct ngl_node **candidates = ngli_darray_data(&scan.candidates);
+    for (int i = 0; i < ngli_darray_count(&scan.candidates); i++) {
+        struct ngl_node *node = candidates[i];
+        char key[32];
+        get_node_key(key, sizeof(key), node);
+        const int shareable = !ngli_hmap_get(scan.excluded, key);
+        if (is_texture(node)) {
+            struct texture_priv *s = node->priv_data;
+            s->shareable = shareable;
+        } else {
+            struct buffer_priv *s = node->priv_data;
+            s->shareable = shareable;
+        }
+        nb_shareable += shareable;
+    }
+    LOG(DEBUG, "%d/%d buffers and textures can share their GL resources",
+        nb_shareable, ngli_darray_count(&scan.candidates));
+
+end:
+    ngli_hmap_freep(&scan.visited);
+    ngli_hmap_freep(&scan.excluded);
+    ngli_darray_reset(&scan.candidates);
+    return ret;
+}
+
+static struct shared_resource *get_resource(struct ngl_ctx *ctx, const char *key,
+                                            enum shared_resource_type type)
+{
+    if (!ctx->config.dedup_resources || !ctx->shared_resources)
+        return NULL;
+    struct shared_resource *res = ngli_hmap_get(ctx->shared_resources, key);
+    return res && res->type == type ? res : NULL;
+}
+
+static int use_resource(struct shared_resource *res, struct shared_resource **resp)
+{
+    res->refcount++;
+    *resp = res;
+    return 1;
+}
+
+static int register_resource(struct ngl_ctx *ctx, struct shared_resource **resp,
+                             const char *key, enum shared_resource_type type,
+                             struct ngl_node *owner, int64_t size)
+{
+    if (!ctx->config.dedup_resources || !ctx->shared_resources ||
+        ngli_hmap_get(ctx->shared_resources, key))
+        return 0;
+
+    struct shared_resource *res = ngli_calloc(1, sizeof(*res));
+    if (!res)
+        return -1;
+    snprintf(res->key, sizeof(res->key), "%s", key);
+    res->type = type;
+    res->refcount = 1;
+    res->owner = owner;
+    res->size = size;
+
+    int ret = ngli_hmap_set(ctx->shared_resources, res->key, res);
+    if (ret < 0) {
+        ngli_free(res);
+        return ret;
+    }
+    *resp = res;
+    return 0;
+}
+
+static void get_buffer_key(char *key, size_t size, const struct buffer_priv *s)
+{
+    const uint64_t hash = ngli_hash64(s->data, s->data_size);
+    snprintf(key, size, "buffer:%d:%d:%d:%016" PRIx64,
+             s->data_format, s->data_stride, s->data_size, hash);
+}
+
+/*
+ * The data of the buffers read from a file is not mapped once uploaded, so it
+ * needs to be referenced again for the comparison.
+ */
+static int buffer_content_equal(struct ngl_node *a_node, struct ngl_node *b_node)
+{
+    const struct buffer_priv *a = a_node->priv_data;
+    const struct buffer_priv *b = b_node->priv_data;
+
+    if (a->data_format != b->data_format ||
+        a->data_stride != b->data_stride ||
+        a->data_size   != b->data_size)
+        return 0;
+
+    if (a->filename && b->filename && !strcmp(a->filename, b->filename))
+        return 1;
+
+    int ret = ngli_node_buffer_ref_data(a_node);
+    if (ret < 0)
+        return ret;
+    ret = ngli_node_buffer_ref_data(b_node);
+    if (ret < 0) {
+        ngli_node_buffer_unref_data(a_node);
+        return ret;
+    }
+
+    const int equal = a->data == b->data || !memcmp(a->data, b->data, a->data_size);
+
+    ngli_node_buffer_unref_data(b_node);
+    ngli_node_buffer_unref_data(a_node);
+    return equal;
+}
+
+int ngli_dedup_buffer_ref(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+    if (!s->shareable || s->dynamic || !s->data)
+        return 0;
+
+    char key[DEDUP_KEY_LEN];
+    get_buffer_key(key, sizeof(key), s);
+    struct shared_resource *res = get_resource(node->ctx, key, SHARED_RESOURCE_BUFFER);
+    if (!res || !res->owner)
+        return 0;
+
+    int ret = buffer_content_equal(res->owner, node);
+    if (ret <= 0)
+        return ret;
+
+    s->buffer = res->gl.buffer;
+    return use_resource(res, &s->shared);
+}
+
+int ngli_dedup_buffer_register(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+    if (!s->shareable || s->dynamic || !s->data)
+        return 0;
+
+    char key[DEDUP_KEY_LEN];
+    get_buffer_key(key, sizeof(key), s);
+    int ret = register_resource(node->ctx, &s->shared, key, SHARED_RESOURCE_BUFFER,
+                                node, s->data_size);
+    if (ret < 0 || !s->shared)
+        return ret;
+    s->shared->gl.buffer = s->buffer;
+    return 0;
+}
+
+/*
+ * Only the textures initialized once from a static buffer can be shared. The
+ * buffer data must be referenced by the caller.
+ */
+static struct ngl_node *get_texture_buffer(const struct texture_priv *s)
+{
+    if (!s->data_src || !is_static_buffer(s->data_src))
+        return NULL;
+    const struct buffer_priv *buffer = s->data_src->priv_data;
+    return buffer->data ? s->data_src : NULL;
+}
+
+static void get_texture_key(char *key, size_t size, const struct texture_priv *s)
+{
+    const struct buffer_priv *buffer = get_texture_buffer(s)->priv_data;
+    const uint64_t params_hash = ngli_hash64(&s->params, sizeof(s->params));
+    const uint64_t data_hash = ngli_hash64(buffer->data, buffer->data_size);
+    snprintf(key, size, "texture:%016" PRIx64 ":%d:%016" PRIx64,
+             params_hash, buffer->data_size, data_hash);
+}
+
+static int texture_content_equal(const struct texture_priv *a, const struct texture_priv *b)
+{
+    if (memcmp(&a->params, &b->params, sizeof(a->params)))
+        return 0;
+    return buffer_content_equal(a->data_src, b->data_src);
+}
+
+int ngli_dedup_texture_ref(struct ngl_node *node)
+{
+    struct texture_priv *s = node->priv_data;
+    if (!s->shareable || !get_texture_buffer(s))
+        return 0;
+
+    char key[DEDUP_KEY_LEN];
+    get_texture_key(key, sizeof(key), s);
+    struct shared_resource *res = get_resource(node->ctx, key, SHARED_RESOURCE_TEXTURE);
+    if (!res || !res->owner)
+        return 0;
+
+    int ret = texture_content_equal(res->owner->priv_data, s);
+    if (ret <= 0)
+        return ret;
+
+    s->texture = res->gl.texture;
+    return use_resource(res, &s->shared);
+}
+
+int ngli_dedup_texture_register(struct ngl_node *node)
+{
+    struct texture_priv *s = node->priv_data;
+    if (!s->shareable || !get_texture_buffer(s))
+        return 0;
+
+    char key[DEDUP_KEY_LEN];
+    get_texture_key(key, sizeof(key), s);
+    const int64_t size = ngli_image_get_memory_size(&s->image);
+    int ret = register_resource(node->ctx, &s->shared, key, SHARED_RESOURCE_TEXTURE,
+                                node, size);
+    if (ret < 0 || !s->shared)
+        return ret;
+    s->shared->gl.texture = s->texture;
+    return 0;
+}
+
+int ngli_dedup_release(struct ngl_node *node, struct shared_resource **resp)
+{
+    struct shared_resource *res = *resp;
+    if (!res)
+        return 0;
+    *resp = NULL;
+
+    if (res->owner == node)
+        res->owner = NULL;
+
+    if (res->refcount-- > 1)
+        return 1;
+
+    ngli_hmap_set(node->ctx->shared_resources, res->key, NULL);
+    return 0;
+}
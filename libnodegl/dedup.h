@@ -0,0 +1,82 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef DEDUP_H
+#define DEDUP_H
+
+#include <stdint.h>
+
+#include "buffer.h"
+#include "texture.h"
+
+struct ngl_node;
+
+#define DEDUP_KEY_LEN 96
+
+enum shared_resource_type {
+    SHARED_RESOURCE_BUFFER,
+    SHARED_RESOURCE_TEXTURE,
+};
+
+/*
+ * GL resource shared by all the Buffer (or Texture) nodes of a context with
+ * identical content. The resource is created by the first node and destroyed
+ * by the last one released.
+ */
+struct shared_resource {
+    char key[DEDUP_KEY_LEN];
+    enum shared_resource_type type;
+    int refcount;               // number of nodes using the resource
+    struct ngl_node *owner;     // node holding the reference content, NULL once released
+    int64_t size;               // memory used by the resource, in bytes
+    union {
+        struct buffer buffer;   // SHARED_RESOURCE_BUFFER
+        struct texture texture; // SHARED_RESOURCE_TEXTURE
+    } gl;
+};
+
+/*
+ * Flag the static buffers and the textures initialized from them which can
+ * share their GL resources. Buffers used as program blocks and textures
+ * written by a RenderToTexture or a Compute node are excluded. Must be called
+ * before the scene is attached to the context.
+ */
+int ngli_dedup_scene(struct ngl_node *scene);
+
+/*
+ * Look for a GL buffer (resp. texture) with the same content as the node in
+ * the context registry. Return 1 if the node now shares it, 0 if the node
+ * must create its own resource, and then call ngli_dedup_*_register() so it
+ * can be shared with the next identical nodes.
+ */
+int ngli_dedup_buffer_ref(struct ngl_node *node);
+int ngli_dedup_buffer_register(struct ngl_node *node);
+int ngli_dedup_texture_ref(struct ngl_node *node);
+int ngli_dedup_texture_register(struct ngl_node *node);
+
+/*
+ * Drop the reference of a node on its shared resource. Return 1 if the
+ * resource is still used by other nodes, in which case the node must not
+ * destroy it.
+ */
+int ngli_dedup_release(struct ngl_node *node, struct shared_resource **resp);
+
+#endif
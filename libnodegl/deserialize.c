@@ -20,15 +20,19 @@
  */
 
 #include <inttypes.h>
-#include <stdio.h>
+#include <limits.h>
+#include <stddef.h>
 #include <string.h>
 
 #include "darray.h"
+#include "filemap.h"
 #include "log.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "params.h"
+#include "serialize_binary.h"
+#include "utils.h"
 
 #define CASE_LITERAL(param_type, type, parse_func)      \
 case param_type: {                                      \
@@ -42,25 +46,71 @@ case param_type: {                                      \
     break;                                              \
 }
 
+/* Value + 1 of each hexadecimal digit, 0 for any other character */
+static const uint8_t hex_digits[256] = {
+    ['0'] = 0x1, ['1'] = 0x2, ['2'] = 0x3, ['3'] = 0x4, ['4'] = 0x5,
+    ['5'] = 0x6, ['6'] = 0x7, ['7'] = 0x8, ['8'] = 0x9, ['9'] = 0xa,
+    ['a'] = 0xb, ['b'] = 0xc, ['c'] = 0xd, ['d'] = 0xe, ['e'] = 0xf, ['f'] = 0x10,
+    ['A'] = 0xb, ['B'] = 0xc, ['C'] = 0xd, ['D'] = 0xe, ['E'] = 0xf, ['F'] = 0x10,
+};
+
+static int parse_dec_u64(const char *s, uint64_t *valp)
+{
+    const char *p = s;
+    uint64_t v = 0;
+    while (*p >= '0' && *p <= '9')
+        v = v * 10 + (*p++ - '0');
+    *valp = v;
+    return (int)(p - s);
+}
+
+static int parse_hex_u64(const char *s, uint64_t *valp)
+{
+    const char *p = s;
+    uint64_t v = 0;
+    int d;
+    while ((d = hex_digits[(uint8_t)*p])) {
+        v = v << 4 | (d - 1);
+        p++;
+    }
+    *valp = v;
+    return (int)(p - s);
+}
+
+/* Like strtoll(), nothing is consumed if there is no digit */
+static int parse_dec_i64(const char *s, int64_t *valp)
+{
+    const int neg = *s == '-';
+    const int sign_len = neg || *s == '+';
+    uint64_t v;
+    const int len = parse_dec_u64(s + sign_len, &v);
+    if (!len) {
+        *valp = 0;
+        return 0;
+    }
+    *valp = neg ? -(int64_t)v : (int64_t)v;
+    return sign_len + len;
+}
+
 static int parse_int(const char *s, int *valp)
 {
-    char *endptr = NULL;
-    *valp = (int)strtol(s, &endptr, 10);
-    return (int)(endptr - s);
+    int64_t v;
+    const int len = parse_dec_i64(s, &v);
+    *valp = (int)v;
+    return len;
 }
 
 static int parse_hexint(const char *s, int *valp)
 {
-    char *endptr = NULL;
-    *valp = (int)strtol(s, &endptr, 16);
-    return (int)(endptr - s);
+    uint64_t v;
+    const int len = parse_hex_u64(s, &v);
+    *valp = (int)v;
+    return len;
 }
 
-static int64_t parse_i64(const char *s, int64_t *valp)
+static int parse_i64(const char *s, int64_t *valp)
 {
-    char *endptr = NULL;
-    *valp = strtoll(s, &endptr, 10);
-    return (int)(endptr - s);
+    return parse_dec_i64(s, valp);
 }
 
 static int parse_bool(const char *s, int *valp)
@@ -73,36 +123,61 @@ static int parse_bool(const char *s, int *valp)
     return ret;
 }
 
+/* Floats are serialized as [-]<hex exponent>z<hex mantissa> */
 #define DECLARE_FLT_PARSE_FUNC(type, nbit, shift_exp)                       \
 static int parse_##type(const char *s, type *valp)                          \
 {                                                                           \
-    int consumed = 0;                                                       \
+    const char *p = s;                                                      \
     union { uint##nbit##_t i; type f; } u = {.i = 0};                       \
                                                                             \
-    if (*s == '-') {                                                        \
+    if (*p == '-') {                                                        \
         u.i = 1ULL << (nbit - 1);                                           \
-        consumed++;                                                         \
+        p++;                                                                \
     }                                                                       \
                                                                             \
-    char *endptr = NULL;                                                    \
-    uint##nbit##_t exp = nbit == 64 ? strtoull(s + consumed, &endptr, 16)   \
-                                    : strtoul(s + consumed, &endptr, 16);   \
-    if (*endptr++ != 'z')                                                   \
+    uint64_t exp, mant;                                                     \
+    p += parse_hex_u64(p, &exp);                                            \
+    if (*p++ != 'z')                                                        \
         return -1;                                                          \
-    uint##nbit##_t mant = nbit == 64 ? strtoull(endptr, &endptr, 16)        \
-                                     : strtoul(endptr, &endptr, 16);        \
+    p += parse_hex_u64(p, &mant);                                           \
                                                                             \
-    u.i |= exp<<shift_exp | mant;                                           \
+    u.i |= (uint##nbit##_t)exp<<shift_exp | (uint##nbit##_t)mant;           \
                                                                             \
     *valp = u.f;                                                            \
-    return (int)(endptr - s);                                               \
+    return (int)(p - s);                                                    \
 }
 
 DECLARE_FLT_PARSE_FUNC(float,  32, 23)
 DECLARE_FLT_PARSE_FUNC(double, 64, 52)
 
+/* Parse exactly n comma separated floats */
+static int parse_float_vec(const char *s, float *v, int n)
+{
+    const char *p = s;
+    for (int i = 0; i < n; i++) {
+        if (i && *p++ != ',')
+            return -1;
+        const int len = parse_float(p, &v[i]);
+        if (len < 0)
+            return -1;
+        p += len;
+    }
+    if (*p == ',')
+        return -1;
+    return (int)(p - s);
+}
+
+static int token_len(const char *s)
+{
+    const char *p = s;
+    while (*p && *p != ' ' && *p != '\n')
+        p++;
+    return (int)(p - s);
+}
+
 #define DECLARE_PARSE_LIST_FUNC(type, parse_func)                           \
-static int parse_func##s(const char *s, type **valsp, int *nb_valsp)        \
+static int parse_func##s(struct arena *arena, const char *s,                \
+                         type **valsp, int *nb_valsp)                       \
 {                                                                           \
     type *vals = NULL;                                                      \
     int nb_vals = 0, consumed = 0, len;                                     \
@@ -114,8 +189,9 @@ static int parse_func##s(const char *s, type **valsp, int *nb_valsp)        \
             consumed = -1;                                                  \
             break;                                                          \
         }                                                                   \
-        type *new_vals = ngli_realloc(vals,                                 \
-                                      (nb_vals + 1) * sizeof(*new_vals));   \
+        const size_t size = nb_vals * sizeof(*vals);                        \
+        type *new_vals = ngli_arena_realloc(arena, vals, size,              \
+                                            size + sizeof(*vals));          \
         if (!new_vals) {                                                    \
             consumed = -1;                                                  \
             break;                                                          \
@@ -130,7 +206,6 @@ static int parse_func##s(const char *s, type **valsp, int *nb_valsp)        \
         consumed++;                                                         \
     }                                                                       \
     if (consumed < 0) {                                                     \
-        ngli_free(vals);                                                    \
         vals = NULL;                                                        \
         nb_vals = 0;                                                        \
     }                                                                       \
@@ -139,66 +214,60 @@ static int parse_func##s(const char *s, type **valsp, int *nb_valsp)        \
     return consumed;                                                        \
 }
 
-DECLARE_PARSE_LIST_FUNC(float,  parse_float)
 DECLARE_PARSE_LIST_FUNC(double, parse_double)
 DECLARE_PARSE_LIST_FUNC(int,    parse_hexint)
 
-#define FREE_KVS(count, keys, vals) do {                                    \
-    for (int k = 0; k < (count); k++)                                       \
-        ngli_free((keys)[k]);                                               \
-    ngli_free(keys);                                                        \
-    ngli_free(vals);                                                        \
-    keys = NULL;                                                            \
-    vals = NULL;                                                            \
-} while (0)
-
-static int parse_kvs(const char *s, int *nb_kvsp, char ***keysp, int **valsp)
+static int parse_kvs(struct arena *arena, const char *s,
+                     int *nb_kvsp, char ***keysp, int **valsp)
 {
     char **keys = NULL;
     int *vals = NULL;
-    int nb_vals = 0, consumed = 0, len;
+    int nb_vals = 0;
+    const char *p = s;
 
     for (;;) {
-        char key[63 + 1];
+        const char *key = p;
+        while (*p && *p != '=')
+            p++;
+        const size_t key_len = p - key;
+        if (*p++ != '=' || !key_len)
+            return -1;
+
         int val;
-        int n = sscanf(s, "%63[^=]=%x%n", key, &val, &len);
-        if (n != 2) {
-            consumed = -1;
-            break;
-        }
+        const int len = parse_hexint(p, &val);
+        if (!len)
+            return -1;
+        p += len;
 
-        char **new_keys = ngli_realloc(keys, (nb_vals + 1) * sizeof(*new_keys));
-        if (!new_keys) {
-            consumed = -1;
-            break;
-        }
+        char **new_keys = ngli_arena_realloc(arena, keys,
+                                             nb_vals * sizeof(*new_keys),
+                                             (nb_vals + 1) * sizeof(*new_keys));
+        if (!new_keys)
+            return -1;
         keys = new_keys;
 
-        int *new_vals = ngli_realloc(vals, (nb_vals + 1) * sizeof(*new_vals));
-        if (!new_vals) {
-            consumed = -1;
-            break;
-        }
+        int *new_vals = ngli_arena_realloc(arena, vals,
+                                           nb_vals * sizeof(*new_vals),
+                                           (nb_vals + 1) * sizeof(*new_vals));
+        if (!new_vals)
+            return -1;
         vals = new_vals;
 
-        s += len;
-        consumed += len;
-        keys[nb_vals] = ngli_strdup(key);
+        keys[nb_vals] = ngli_arena_alloc(arena, key_len + 1);
+        if (!keys[nb_vals])
+            return -1;
+        memcpy(keys[nb_vals], key, key_len);
+        keys[nb_vals][key_len] = 0;
         vals[nb_vals] = val;
         nb_vals++;
-        if (*s != ',')
+        if (*p != ',')
             break;
-        s++;
-        consumed++;
-    }
-    if (consumed < 0) {
-        FREE_KVS(nb_vals, keys, vals);
-        nb_vals = 0;
+        p++;
     }
     *keysp = keys;
     *valsp = vals;
     *nb_kvsp = nb_vals;
-    return consumed;
+    return (int)(p - s);
 }
 
 static inline int hexv(char c)
@@ -210,8 +279,8 @@ static inline int hexv(char c)
     return 0;
 }
 
-static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
-                       const struct node_param *par, const char *str)
+static int parse_param(struct arena *arena, struct darray *nodes_array, uint8_t *base_ptr,
+                       const struct node_param *par, const char *str, const char *end)
 {
     int len = -1;
 
@@ -223,10 +292,14 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
 
         case PARAM_TYPE_RATIONAL: {
             int r[2] = {0};
-            int ret = sscanf(str, "%d/%d%n", &r[0], &r[1], &len);
-            if (ret != 2)
+            const int num_len = parse_int(str, &r[0]);
+            if (!num_len || str[num_len] != '/')
                 return -1;
-            ret = ngli_params_vset(base_ptr, par, r[0], r[1]);
+            const int den_len = parse_int(str + num_len + 1, &r[1]);
+            if (!den_len)
+                return -1;
+            len = num_len + 1 + den_len;
+            int ret = ngli_params_vset(base_ptr, par, r[0], r[1]);
             if (ret < 0)
                 return ret;
             break;
@@ -234,22 +307,21 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
 
         case PARAM_TYPE_FLAGS:
         case PARAM_TYPE_SELECT: {
-            len = strcspn(str, " \n");
-            char *s = ngli_malloc(len + 1);
+            len = token_len(str);
+            char *s = ngli_arena_alloc(arena, len + 1);
             if (!s)
                 return -1;
             memcpy(s, str, len);
             s[len] = 0;
             int ret = ngli_params_vset(base_ptr, par, s);
-            ngli_free(s);
             if (ret < 0)
                 return ret;
             break;
         }
 
         case PARAM_TYPE_STR: {
-            len = strcspn(str, " \n");
-            char *s = ngli_malloc(len + 1);
+            len = token_len(str);
+            char *s = ngli_arena_alloc(arena, len + 1);
             if (!s)
                 return -1;
             char *sstart = s;
@@ -264,44 +336,36 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
             }
             *s = 0;
             int ret = ngli_params_vset(base_ptr, par, sstart);
-            ngli_free(sstart);
             if (ret < 0)
                 return ret;
             break;
         }
 
         case PARAM_TYPE_DATA: {
-            int size = 0;
-            int consumed = 0;
+            int size;
             const char *cur = str;
-            const char *end = str + strlen(str);
-            int ret = sscanf(str, "%d,%n", &size, &consumed);
-            if (ret != 1)
+            cur += parse_int(cur, &size);
+            if (cur == str || *cur++ != ',' || size < 0)
                 return -1;
             if (!size)
                 break;
-            if (cur >= end - consumed)
+            if (size > (end - cur) / 2)
                 return -1;
-            cur += consumed;
-            uint8_t *data = ngli_calloc(size, sizeof(*data));
+            uint8_t *data = ngli_arena_alloc(arena, size);
             if (!data)
                 return -1;
+            /* Check the digits once at the end instead of for every byte */
+            int invalid = 0;
             for (int i = 0; i < size; i++) {
-                if (cur > end - 2) {
-                    ngli_free(data);
-                    return -1;
-                }
-                static const uint8_t hexm[256] = {
-                    ['0'] = 0x0, ['1'] = 0x1, ['2'] = 0x2, ['3'] = 0x3,
-                    ['4'] = 0x4, ['5'] = 0x5, ['6'] = 0x6, ['7'] = 0x7,
-                    ['8'] = 0x8, ['9'] = 0x9, ['a'] = 0xa, ['b'] = 0xb,
-                    ['c'] = 0xc, ['d'] = 0xd, ['e'] = 0xe, ['f'] = 0xf,
-                };
-                data[i] = hexm[(uint8_t)cur[0]]<<4 | hexm[(uint8_t)cur[1]];
+                const int hi = hex_digits[(uint8_t)cur[0]];
+                const int lo = hex_digits[(uint8_t)cur[1]];
+                invalid |= !hi | !lo;
+                data[i] = (hi - 1) << 4 | (lo - 1);
                 cur += 2;
             }
-            ret = ngli_params_vset(base_ptr, par, size, data);
-            ngli_free(data);
+            if (invalid)
+                return -1;
+            int ret = ngli_params_vset(base_ptr, par, size, data);
             if (ret < 0)
                 return ret;
             len = cur - str;
@@ -312,30 +376,22 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
         case PARAM_TYPE_VEC3:
         case PARAM_TYPE_VEC4: {
             const int n = par->type - PARAM_TYPE_VEC2 + 2;
-            float *v = NULL;
-            int nb_flts;
-            len = parse_floats(str, &v, &nb_flts);
-            if (len < 0 || nb_flts != n) {
-                ngli_free(v);
+            float v[4];
+            len = parse_float_vec(str, v, n);
+            if (len < 0)
                 return -1;
-            }
             int ret = ngli_params_vset(base_ptr, par, v);
-            ngli_free(v);
             if (ret < 0)
                 return ret;
             break;
         }
 
         case PARAM_TYPE_MAT4: {
-            float *m = NULL;
-            int nb_flts;
-            len = parse_floats(str, &m, &nb_flts);
-            if (len < 0 || nb_flts != 16) {
-                ngli_free(m);
+            float m[16];
+            len = parse_float_vec(str, m, 16);
+            if (len < 0)
                 return -1;
-            }
             int ret = ngli_params_vset(base_ptr, par, m);
-            ngli_free(m);
             if (ret < 0)
                 return ret;
             break;
@@ -357,33 +413,27 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
 
         case PARAM_TYPE_NODELIST: {
             int *node_ids, nb_node_ids;
-            len = parse_hexints(str, &node_ids, &nb_node_ids);
+            len = parse_hexints(arena, str, &node_ids, &nb_node_ids);
             if (len < 0)
                 return -1;
             for (int i = 0; i < nb_node_ids; i++) {
                 struct ngl_node **nodep = ngli_darray_get(nodes_array, node_ids[i]);
-                if (!nodep) {
-                    ngli_free(node_ids);
+                if (!nodep)
                     return -1;
-                }
                 int ret = ngli_params_add(base_ptr, par, 1, nodep);
-                if (ret < 0) {
-                    ngli_free(node_ids);
+                if (ret < 0)
                     return ret;
-                }
             }
-            ngli_free(node_ids);
             break;
         }
 
         case PARAM_TYPE_DBLLIST: {
             double *dbls;
             int nb_dbls;
-            len = parse_doubles(str, &dbls, &nb_dbls);
+            len = parse_doubles(arena, str, &dbls, &nb_dbls);
             if (len < 0)
                 return -1;
             int ret = ngli_params_add(base_ptr, par, nb_dbls, dbls);
-            ngli_free(dbls);
             if (ret < 0)
                 return ret;
             break;
@@ -392,23 +442,18 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
         case PARAM_TYPE_NODEDICT: {
             char **node_keys;
             int *node_ids, nb_nodes;
-            len = parse_kvs(str, &nb_nodes, &node_keys, &node_ids);
+            len = parse_kvs(arena, str, &nb_nodes, &node_keys, &node_ids);
             if (len < 0)
                 return -1;
             for (int i = 0; i < nb_nodes; i++) {
                 const char *key = node_keys[i];
                 struct ngl_node **nodep = ngli_darray_get(nodes_array, node_ids[i]);
-                if (!nodep) {
-                    FREE_KVS(nb_nodes, node_keys, node_ids);
+                if (!nodep)
                     return -1;
-                }
                 int ret = ngli_params_vset(base_ptr, par, key, *nodep);
-                if (ret < 0) {
-                    FREE_KVS(nb_nodes, node_keys, node_ids);
+                if (ret < 0)
                     return ret;
-                }
             }
-            FREE_KVS(nb_nodes, node_keys, node_ids);
             break;
         }
 
@@ -419,7 +464,8 @@ static int parse_param(struct darray *nodes_array, uint8_t *base_ptr,
     return len;
 }
 
-static int set_node_params(struct darray *nodes_array, char *str,
+static int set_node_params(struct arena *arena, struct darray *nodes_array,
+                           char *str, const char *end,
                            const struct ngl_node *node)
 {
     uint8_t *base_ptr = node->priv_data;
@@ -434,7 +480,7 @@ static int set_node_params(struct darray *nodes_array, char *str,
         if (!(par->flags & PARAM_FLAG_CONSTRUCTOR))
             break;
 
-        int ret = parse_param(nodes_array, base_ptr, par, str);
+        int ret = parse_param(arena, nodes_array, base_ptr, par, str, end);
         if (ret < 0) {
             LOG(ERROR, "invalid value specified for parameter %s.%s",
                 node->class->name, par->key);
@@ -461,7 +507,7 @@ static int set_node_params(struct darray *nodes_array, char *str,
         }
 
         str = eok + 1;
-        int ret = parse_param(nodes_array, base_ptr, par, str);
+        int ret = parse_param(arena, nodes_array, base_ptr, par, str, end);
         if (ret < 0) {
             LOG(ERROR, "invalid value specified for parameter %s.%s",
                 node->class->name, par->key);
@@ -477,72 +523,503 @@ static int set_node_params(struct darray *nodes_array, char *str,
     return 0;
 }
 
-struct ngl_node *ngl_node_deserialize(const char *str)
+static int parse_version(const char *s, int *major, int *minor, int *micro)
 {
-    struct ngl_node *node = NULL;
-    struct darray nodes_array;
+    static const char header[] = "# Node.GL v";
+    if (strncmp(s, header, sizeof(header) - 1))
+        return -1;
+    s += sizeof(header) - 1;
 
-    ngli_darray_init(&nodes_array, sizeof(struct ngl_node *), 0);
+    int *v[] = {major, minor, micro};
+    for (int i = 0; i < NGLI_ARRAY_NB(v); i++) {
+        if (i && *s++ != '.')
+            return -1;
+        const int len = parse_int(s, v[i]);
+        if (!len)
+            return -1;
+        s += len;
+    }
+    return 0;
+}
+
+enum {
+    STATE_DETECT,   /* waiting for enough data to identify the format */
+    STATE_TEXT,
+    STATE_BINARY,
+    STATE_DONE,
+};
+
+struct ngl_deserializer {
+    int state;
+    int failed;
+    int header_parsed;
+    struct darray nodes_array;
+    struct arena *arena;    /* scratch memory for the node being parsed */
+    char *buf;              /* pending text line, or the whole binary scene */
+    size_t buf_size;
+    size_t buf_cap;
+};
 
-    char *s = ngli_strdup(str);
+struct ngl_deserializer *ngl_deserializer_create(void)
+{
+    struct ngl_deserializer *s = ngli_calloc(1, sizeof(*s));
     if (!s)
         return NULL;
+    ngli_darray_init(&s->nodes_array, sizeof(struct ngl_node *), 0);
+    s->arena = ngli_arena_create(4096);
+    if (!s->arena) {
+        ngli_free(s);
+        return NULL;
+    }
+    return s;
+}
+
+static int append_data(struct ngl_deserializer *s, const char *data, size_t size)
+{
+    /* One extra byte is always kept for the NUL terminator */
+    const size_t needed = s->buf_size + size + 1;
+    if (needed > s->buf_cap) {
+        size_t cap = s->buf_cap ? s->buf_cap : 4096;
+        while (cap < needed)
+            cap *= 2;
+        char *buf = ngli_realloc(s->buf, cap);
+        if (!buf)
+            return -1;
+        s->buf = buf;
+        s->buf_cap = cap;
+    }
+    if (size)
+        memcpy(s->buf + s->buf_size, data, size);
+    s->buf_size += size;
+    return 0;
+}
 
-    char *sstart = s;
-    char *send = s + strlen(s);
+/* The line is NUL terminated and modified in place */
+static int parse_line(struct ngl_deserializer *s, char *line, size_t len)
+{
+    if (!s->header_parsed) {
+        int major, minor, micro;
+        if (parse_version(line, &major, &minor, &micro) < 0) {
+            LOG(ERROR, "invalid serialized scene");
+            return -1;
+        }
+        if (NODEGL_VERSION_INT != NODEGL_GET_VERSION(major, minor, micro)) {
+            LOG(ERROR, "mismatching version: %d.%d.%d != %d.%d.%d",
+                major, minor, micro,
+                NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
+            return -1;
+        }
+        s->header_parsed = 1;
+        return 0;
+    }
 
-    int major, minor, micro;
-    int n = sscanf(s, "# Node.GL v%d.%d.%d", &major, &minor, &micro);
-    if (n != 3) {
+    if (!len)
+        return 0;
+    if (len < 4) {
         LOG(ERROR, "invalid serialized scene");
-        goto end;
+        return -1;
+    }
+
+    const int type = NGLI_FOURCC(line[0], line[1], line[2], line[3]);
+    char *str = line + 4;
+    if (*str == ' ')
+        str++;
+
+    struct ngl_node *node = ngli_node_create_noconstructor(type);
+    if (!node)
+        return -1;
+
+    if (!ngli_darray_push(&s->nodes_array, &node)) {
+        ngl_node_unrefp(&node);
+        return -1;
+    }
+
+    int ret = set_node_params(s->arena, &s->nodes_array, str, line + len, node);
+    ngli_arena_reset(s->arena);
+    return ret;
+}
+
+static int feed_text(struct ngl_deserializer *s, const char *data, size_t size)
+{
+    while (size) {
+        const char *nl = memchr(data, '\n', size);
+        const size_t len = nl ? nl - data : size;
+        int ret = append_data(s, data, len);
+        if (ret < 0)
+            return ret;
+        if (!nl)
+            break;
+
+        s->buf[s->buf_size] = 0;
+        ret = parse_line(s, s->buf, s->buf_size);
+        s->buf_size = 0;
+        if (ret < 0)
+            return ret;
+
+        data += len + 1;
+        size -= len + 1;
+    }
+    return 0;
+}
+
+static int is_binary(const char *s)
+{
+    return !strncmp(s, NGLB_MAGIC, strlen(NGLB_MAGIC));
+}
+
+int ngl_deserializer_feed(struct ngl_deserializer *s, const char *data, size_t size)
+{
+    if (s->failed || s->state == STATE_DONE)
+        return -1;
+
+    int ret = 0;
+    if (s->state == STATE_DETECT) {
+        const size_t magic_size = strlen(NGLB_MAGIC);
+        const size_t n = NGLI_MIN(size, magic_size - s->buf_size);
+        ret = append_data(s, data, n);
+        if (ret < 0)
+            goto end;
+        data += n;
+        size -= n;
+        if (s->buf_size < magic_size)
+            return 0;
+
+        /*
+         * The detection bytes stay in the buffer: in text mode they are the
+         * beginning of the header line, which never contains a line break.
+         */
+        s->buf[s->buf_size] = 0;
+        s->state = is_binary(s->buf) ? STATE_BINARY : STATE_TEXT;
     }
-    if (NODEGL_VERSION_INT != NODEGL_GET_VERSION(major, minor, micro)) {
+
+    if (s->state == STATE_BINARY)
+        ret = append_data(s, data, size);
+    else
+        ret = feed_text(s, data, size);
+
+end:
+    if (ret < 0)
+        s->failed = 1;
+    return ret;
+}
+struct binary_deserializer {
+    const struct nglb_header *header;
+    const char *strings;
+    const uint8_t *blobs;
+    struct filemap *filemap;
+    struct ngl_node **nodes;
+    uint32_t nb_nodes;
+};
+
+static const char *get_string(const struct binary_deserializer *s, uint64_t offset)
+{
+    const uint32_t size = s->header->strings_size;
+    if (offset >= size || !memchr(s->strings + offset, 0, size - offset))
+        return NULL;
+    return s->strings + offset;
+}
+
+static const void *get_blob(const struct binary_deserializer *s, uint64_t offset,
+                            uint64_t count, size_t elem_size)
+{
+    const uint64_t size = s->header->blobs_size;
+    if (offset % NGLI_ALIGN_VAL || offset > size || count > (size - offset) / elem_size)
+        return NULL;
+    return s->blobs + offset;
+}
+
+static struct ngl_node *get_node(const struct binary_deserializer *s, uint64_t index)
+{
+    /* Only the nodes already loaded can be referenced */
+    return index < s->nb_nodes ? s->nodes[index] : NULL;
+}
+
+static int set_binary_param(struct binary_deserializer *s, struct ngl_node *node,
+                            uint8_t *base_ptr, const struct node_param *par,
+                            const struct nglb_param *param)
+{
+    const uint64_t v = param->value;
+
+    switch (par->type) {
+        case PARAM_TYPE_BOOL:
+        case PARAM_TYPE_INT:
+            return ngli_params_vset(base_ptr, par, (int)v);
+        case PARAM_TYPE_I64:
+            return ngli_params_vset(base_ptr, par, (int64_t)v);
+        case PARAM_TYPE_DBL: {
+            double d;
+            memcpy(&d, &v, sizeof(d));
+            return ngli_params_vset(base_ptr, par, d);
+        }
+        case PARAM_TYPE_RATIONAL:
+            return ngli_params_vset(base_ptr, par, (int)(uint32_t)v, (int)(uint32_t)(v >> 32));
+        case PARAM_TYPE_STR:
+        case PARAM_TYPE_SELECT:
+        case PARAM_TYPE_FLAGS: {
+            const char *str = get_string(s, v);
+            if (!str)
+                return -1;
+            return ngli_params_vset(base_ptr, par, str);
+        }
+        case PARAM_TYPE_DATA: {
+            const uint8_t *data = get_blob(s, v, param->count, 1);
+            if (!data || param->count > INT_MAX)
+                return -1;
+            if (s->filemap && (!node->filemap || node->filemap == s->filemap))
+                return ngli_node_param_set_mapped_data(node, par, s->filemap,
+                                                       (uint8_t *)data, param->count);
+            return ngli_params_vset(base_ptr, par, (int)param->count, data);
+        }
+        case PARAM_TYPE_VEC2:
+        case PARAM_TYPE_VEC3:
+        case PARAM_TYPE_VEC4:
+        case PARAM_TYPE_MAT4: {
+            const uint32_t n = par->type == PARAM_TYPE_MAT4 ? 16 : par->type - PARAM_TYPE_VEC2 + 2;
+            const float *f = get_blob(s, v, n, sizeof(*f));
+            if (!f || param->count != n)
+                return -1;
+            return ngli_params_vset(base_ptr, par, f);
+        }
+        case PARAM_TYPE_NODE: {
+            struct ngl_node *child = get_node(s, v);
+            if (!child)
+                return -1;
+            return ngli_params_vset(base_ptr, par, child);
+        }
+        case PARAM_TYPE_NODELIST: {
+            const uint32_t *ids = get_blob(s, v, param->count, sizeof(*ids));
+            if (!ids)
+                return -1;
+            for (uint32_t i = 0; i < param->count; i++) {
+                struct ngl_node *child = get_node(s, ids[i]);
+                if (!child)
+                    return -1;
+                int ret = ngli_params_add(base_ptr, par, 1, &child);
+                if (ret < 0)
+                    return ret;
+            }
+            return 0;
+        }
+        case PARAM_TYPE_DBLLIST: {
+            const double *dbls = get_blob(s, v, param->count, sizeof(*dbls));
+            if (!dbls || param->count > INT_MAX)
+                return -1;
+            return ngli_params_add(base_ptr, par, param->count, (void *)dbls);
+        }
+        case PARAM_TYPE_NODEDICT: {
+            const uint32_t *pairs = get_blob(s, v, param->count, 2 * sizeof(*pairs));
+            if (!pairs)
+                return -1;
+            for (uint32_t i = 0; i < param->count; i++) {
+                const char *key = get_string(s, pairs[2 * i]);
+                struct ngl_node *child = get_node(s, pairs[2 * i + 1]);
+                if (!key || !child)
+                    return -1;
+                int ret = ngli_params_vset(base_ptr, par, key, child);
+                if (ret < 0)
+                    return ret;
+            }
+            return 0;
+        }
+        default:
+            LOG(ERROR, "cannot deserialize %s: "
+                "unsupported parameter type", par->key);
+            return -1;
+    }
+}
+
+static struct ngl_node *deserialize_binary(const uint8_t *data, size_t size,
+                                           struct filemap *filemap)
+{
+    const struct nglb_header *header = (const struct nglb_header *)data;
+    if (size < sizeof(*header) || memcmp(header->magic, NGLB_MAGIC, sizeof(header->magic))) {
+        LOG(ERROR, "invalid serialized scene");
+        return NULL;
+    }
+    if (header->byte_order != NGLB_BYTE_ORDER || header->version != NGLB_VERSION) {
+        LOG(ERROR, "unsupported binary scene version or byte order");
+        return NULL;
+    }
+    if (header->nodegl_version != NODEGL_VERSION_INT) {
         LOG(ERROR, "mismatching version: %d.%d.%d != %d.%d.%d",
-            major, minor, micro,
+            header->nodegl_version >> 16, header->nodegl_version >> 8 & 0xff,
+            header->nodegl_version & 0xff,
             NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
-        goto end;
+        return NULL;
     }
-    s += strcspn(s, "\n");
-    if (*s == '\n')
-        s++;
 
-    while (s < send - 4) {
-        const int type = NGLI_FOURCC(s[0], s[1], s[2], s[3]);
-        s += 4;
-        if (*s == ' ')
-            s++;
+    /*
+     * The sections offsets are increasing and computed from 32-bit counts so
+     * they can not overflow, but the blobs size is a 64-bit value which could
+     * wrap the total size: every section must fit in the input before the
+     * blobs one.
+     */
+    struct nglb_layout layout;
+    ngli_nglb_get_layout(header, &layout);
+    if (!header->nb_nodes || layout.blobs_offset > size ||
+        header->blobs_size > size - layout.blobs_offset ||
+        layout.size != header->size) {
+        LOG(ERROR, "truncated or corrupted binary scene");
+        return NULL;
+    }
 
-        node = ngli_node_create_noconstructor(type);
+    struct binary_deserializer s = {
+        .header   = header,
+        .strings  = (const char *)data + layout.strings_offset,
+        .blobs    = data + layout.blobs_offset,
+        .filemap  = filemap,
+        .nodes    = ngli_calloc(header->nb_nodes, sizeof(*s.nodes)),
+    };
+    if (!s.nodes)
+        return NULL;
+
+    struct ngl_node *root = NULL;
+    const struct nglb_node *nglb_nodes = (const struct nglb_node *)(data + layout.nodes_offset);
+    const struct nglb_param *params = (const struct nglb_param *)(data + layout.params_offset);
+    const struct nglb_param *params_end = params + header->nb_params;
+
+    for (uint32_t i = 0; i < header->nb_nodes; i++) {
+        const struct nglb_node *nglb_node = &nglb_nodes[i];
+        struct ngl_node *node = ngli_node_create_noconstructor(nglb_node->type);
         if (!node)
-            break;
+            goto end;
+        s.nodes[s.nb_nodes++] = node;
 
-        if (!ngli_darray_push(&nodes_array, &node)) {
-            ngl_node_unrefp(&node);
-            break;
+        if (nglb_node->nb_params > params_end - params) {
+            LOG(ERROR, "truncated or corrupted binary scene");
+            goto end;
         }
 
-        size_t eol = strcspn(s, "\n");
-        s[eol] = 0;
+        for (uint32_t j = 0; j < nglb_node->nb_params; j++) {
+            const struct nglb_param *param = params++;
+            const char *key = get_string(&s, param->key);
+            if (!key)
+                goto end;
 
-        int ret = set_node_params(&nodes_array, s, node);
-        if (ret < 0) {
-            node = NULL;
-            break;
+            uint8_t *base_ptr;
+            const struct node_param *par = ngli_node_param_find(node, key, &base_ptr);
+            if (!par)
+                goto end;
+
+            if (param->type != par->type ||
+                set_binary_param(&s, node, base_ptr, par, param) < 0) {
+                LOG(ERROR, "invalid value specified for parameter %s.%s",
+                    node->class->name, par->key);
+                goto end;
+            }
         }
+    }
+
+    root = ngl_node_ref(s.nodes[s.nb_nodes - 1]);
 
-        s += eol + 1;
+end:
+    for (uint32_t i = 0; i < s.nb_nodes; i++)
+        ngl_node_unrefp(&s.nodes[i]);
+    ngli_free(s.nodes);
+    return root;
+}
+
+static struct ngl_node *deserialize_binary_unaligned(const uint8_t *data, size_t size)
+{
+    if ((uintptr_t)data % NGLI_ALIGN_VAL == 0)
+        return deserialize_binary(data, size, NULL);
+
+    /* The records and blobs are accessed in place and need to be aligned */
+    uint8_t *aligned_data = ngli_malloc_aligned(size);
+    if (!aligned_data)
+        return NULL;
+    memcpy(aligned_data, data, size);
+    struct ngl_node *node = deserialize_binary(aligned_data, size, NULL);
+    ngli_free_aligned(aligned_data);
+    return node;
+}
+
+struct ngl_node *ngl_deserializer_end(struct ngl_deserializer *s)
+{
+    if (s->failed || s->state == STATE_DONE)
+        return NULL;
+
+    struct ngl_node *node = NULL;
+    if (s->state == STATE_BINARY) {
+        node = deserialize_binary_unaligned((const uint8_t *)s->buf, s->buf_size);
+    } else {
+        /* Flush the last line if it was not terminated by a line break */
+        if (s->buf_size || !s->header_parsed) {
+            if (append_data(s, NULL, 0) < 0)
+                goto end;
+            s->buf[s->buf_size] = 0;
+            int ret = parse_line(s, s->buf, s->buf_size);
+            s->buf_size = 0;
+            if (ret < 0)
+                goto end;
+        }
+        struct ngl_node **nodep = ngli_darray_tail(&s->nodes_array);
+        if (nodep)
+            node = ngl_node_ref(*nodep);
     }
 
-    if (node)
-        ngl_node_ref(node);
+end:
+    if (!node)
+        s->failed = 1;
+    s->state = STATE_DONE;
+    return node;
+}
 
-    struct ngl_node **nodes = ngli_darray_data(&nodes_array);
-    for (int i = 0; i < ngli_darray_count(&nodes_array); i++)
+void ngl_deserializer_freep(struct ngl_deserializer **sp)
+{
+    struct ngl_deserializer *s = *sp;
+    if (!s)
+        return;
+    struct ngl_node **nodes = ngli_darray_data(&s->nodes_array);
+    for (int i = 0; i < ngli_darray_count(&s->nodes_array); i++)
         ngl_node_unrefp(&nodes[i]);
+    ngli_darray_reset(&s->nodes_array);
+    ngli_arena_freep(&s->arena);
+    ngli_free(s->buf);
+    ngli_free(s);
+    *sp = NULL;
+}
 
-end:
-    ngli_darray_reset(&nodes_array);
-    ngli_free(sstart);
+static struct ngl_node *deserialize_text(const char *data, size_t size)
+{
+    struct ngl_deserializer *s = ngl_deserializer_create();
+    if (!s)
+        return NULL;
+    struct ngl_node *node = NULL;
+    if (ngl_deserializer_feed(s, data, size) >= 0)
+        node = ngl_deserializer_end(s);
+    ngl_deserializer_freep(&s);
+    return node;
+}
+
+struct ngl_node *ngl_node_deserialize_data(const void *data, size_t size)
+{
+    const size_t magic_size = strlen(NGLB_MAGIC);
+    if (size >= magic_size && !memcmp(data, NGLB_MAGIC, magic_size))
+        return deserialize_binary_unaligned(data, size);
+    return deserialize_text(data, size);
+}
+
+struct ngl_node *ngl_node_deserialize(const char *str)
+{
+    return ngl_node_deserialize_data(str, strlen(str));
+}
+
+struct ngl_node *ngl_node_deserialize_file(const char *filename)
+{
+    struct filemap *filemap = ngli_filemap_open(filename);
+    if (!filemap)
+        return NULL;
+
+    struct ngl_node *node = NULL;
+    const uint8_t *data = ngli_filemap_data(filemap);
+    const size_t size = ngli_filemap_size(filemap);
+
+    if (size >= strlen(NGLB_MAGIC) && !memcmp(data, NGLB_MAGIC, strlen(NGLB_MAGIC)))
+        node = deserialize_binary(data, size, filemap);
+    else
+        node = deserialize_text((const char *)data, size);
+
+    ngli_filemap_unrefp(&filemap);
     return node;
 }
@@ -58,11 +58,10 @@ int ngli_fbo_init(struct fbo *fbo, struct glcontext *gl, const struct fbo_params
 
     ngli_darray_init(&fbo->depth_indices, sizeof(GLenum), 0);
 
-    GLuint fbo_id = 0;
-    ngli_glGetIntegerv(gl, GL_FRAMEBUFFER_BINDING, (GLint *)&fbo_id);
+    const GLuint fbo_id = ngli_glstate_get_framebuffer(gl, GL_FRAMEBUFFER);
 
     ngli_glGenFramebuffers(gl, 1, &fbo->id);
-    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo->id);
+    ngli_glstate_bind_framebuffer(gl, GL_FRAMEBUFFER, fbo->id);
 
     int color_index = 0;
     for (int i = 0; i < params->nb_attachments; i++) {
@@ -74,7 +73,7 @@ int ngli_fbo_init(struct fbo *fbo, struct glcontext *gl, const struct fbo_params
             if (color_index >= gl->max_color_attachments) {
                 LOG(ERROR, "could not attach color buffer %d (maximum %d)",
                     color_index, gl->max_color_attachments);
-                ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+                ngli_glstate_bind_framebuffer(gl, GL_FRAMEBUFFER, fbo_id);
                 return -1;
             }
             attachment_index = attachment_index + color_index++;
@@ -109,11 +108,11 @@ int ngli_fbo_init(struct fbo *fbo, struct glcontext *gl, const struct fbo_params
 
     if (ngli_glCheckFramebufferStatus(gl, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
         LOG(ERROR, "framebuffer %u is not complete", fbo->id);
-        ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+        ngli_glstate_bind_framebuffer(gl, GL_FRAMEBUFFER, fbo_id);
         return -1;
     }
 
-    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo_id);
+    ngli_glstate_bind_framebuffer(gl, GL_FRAMEBUFFER, fbo_id);
 
     return 0;
 }
@@ -122,8 +121,8 @@ int ngli_fbo_bind(struct fbo *fbo)
 {
     struct glcontext *gl = fbo->gl;
 
-    ngli_glGetIntegerv(gl, GL_FRAMEBUFFER_BINDING, (GLint *)&fbo->prev_id);
-    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo->id);
+    fbo->prev_id = ngli_glstate_get_framebuffer(gl, GL_FRAMEBUFFER);
+    ngli_glstate_bind_framebuffer(gl, GL_FRAMEBUFFER, fbo->id);
 
     return 0;
 }
@@ -132,7 +131,7 @@ int ngli_fbo_unbind(struct fbo *fbo)
 {
     struct glcontext *gl = fbo->gl;
 
-    ngli_glBindFramebuffer(gl, GL_FRAMEBUFFER, fbo->prev_id);
+    ngli_glstate_bind_framebuffer(gl, GL_FRAMEBUFFER, fbo->prev_id);
     fbo->prev_id = 0;
 
     return 0;
@@ -159,7 +158,7 @@ void ngli_fbo_blit(struct fbo *fbo, struct fbo *dst, int vflip)
     if (!(gl->features & NGLI_FEATURE_FRAMEBUFFER_OBJECT))
         return;
 
-    ngli_glBindFramebuffer(gl, GL_DRAW_FRAMEBUFFER, dst->id);
+    ngli_glstate_bind_framebuffer(gl, GL_DRAW_FRAMEBUFFER, dst->id);
     if (vflip)
         ngli_glBlitFramebuffer(gl,
                                0, 0, fbo->width, fbo->height, 0, dst->height, dst->width, 0,
@@ -170,7 +169,7 @@ void ngli_fbo_blit(struct fbo *fbo, struct fbo *dst, int vflip)
                                0, 0, fbo->width, fbo->height, 0, 0, dst->width, dst->height,
                                GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT,
                                GL_NEAREST);
-    ngli_glBindFramebuffer(gl, GL_DRAW_FRAMEBUFFER, fbo->id);
+    ngli_glstate_bind_framebuffer(gl, GL_DRAW_FRAMEBUFFER, fbo->id);
 }
 
 void ngli_fbo_read_pixels(struct fbo *fbo, uint8_t *data)
@@ -185,7 +184,7 @@ void ngli_fbo_reset(struct fbo *fbo)
     if (!gl)
         return;
 
-    ngli_glDeleteFramebuffers(gl, 1, &fbo->id);
+    ngli_glstate_delete_framebuffer(gl, fbo->id);
 
     ngli_darray_reset(&fbo->depth_indices);
 
@@ -0,0 +1,165 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TARGET_MINGW_W64
+#define _DEFAULT_SOURCE // madvise()
+#endif
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#ifndef TARGET_MINGW_W64
+#include <sys/mman.h>
+#endif
+
+#include "filemap.h"
+#include "log.h"
+#include "memory.h"
+#include "utils.h"
+
+struct filemap {
+    int refcount;
+    uint8_t *data;
+    size_t size;
+    int mapped;
+};
+
+static int read_file(struct filemap *filemap, int fd)
+{
+    filemap->data = ngli_malloc(filemap->size);
+    if (!filemap->data)
+        return -1;
+
+    size_t pos = 0;
+    while (pos < filemap->size) {
+        const ssize_t n = read(fd, filemap->data + pos, filemap->size - pos);
+        if (n <= 0)
+            return -1;
+        pos += n;
+    }
+    return 0;
+}
+
+struct filemap *ngli_filemap_open(const char *filename)
+{
+    struct filemap *filemap = ngli_calloc(1, sizeof(*filemap));
+    if (!filemap)
+        return NULL;
+    filemap->refcount = 1;
+
+    int fd = open(filename, O_RDONLY);
+    if (fd == -1) {
+        LOG(ERROR, "unable to open %s", filename);
+        goto fail;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) == -1 || !st.st_size) {
+        LOG(ERROR, "unable to get the size of %s", filename);
+        goto fail;
+    }
+    filemap->size = st.st_size;
+
+#ifndef TARGET_MINGW_W64
+    void *data = mmap(NULL, filemap->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    if (data != MAP_FAILED) {
+        filemap->data = data;
+        filemap->mapped = 1;
+    }
+#endif
+    if (!filemap->mapped && read_file(filemap, fd) < 0) {
+        LOG(ERROR, "unable to read %s", filename);
+        goto fail;
+    }
+
+    close(fd);
+    return filemap;
+
+fail:
+    if (fd != -1)
+        close(fd);
+    ngli_filemap_unrefp(&filemap);
+    return NULL;
+}
+
+struct filemap *ngli_filemap_ref(struct filemap *filemap)
+{
+    filemap->refcount++;
+    return filemap;
+}
+
+uint8_t *ngli_filemap_data(const struct filemap *filemap)
+{
+    return filemap->data;
+}
+
+size_t ngli_filemap_size(const struct filemap *filemap)
+{
+    return filemap->size;
+}
+
+int ngli_filemap_contains(const struct filemap *filemap, const void *ptr)
+{
+    const uint8_t *p = ptr;
+    return p >= filemap->data && p < filemap->data + filemap->size;
+}
+
+void ngli_filemap_advise_sequential(struct filemap *filemap)
+{
+#ifndef TARGET_MINGW_W64
+    if (filemap->mapped)
+        madvise(filemap->data, filemap->size, MADV_SEQUENTIAL);
+#endif
+}
+
+void ngli_filemap_discard(struct filemap *filemap, size_t offset, size_t size)
+{
+#ifndef TARGET_MINGW_W64
+    if (!filemap->mapped)
+        return;
+
+    /* Only the pages fully contained in the range can be released */
+    const size_t page_size = sysconf(_SC_PAGESIZE);
+    const size_t start = NGLI_ALIGN(offset, page_size);
+    const size_t end = NGLI_MIN(offset + size, filemap->size) & ~(page_size - 1);
+    if (end > start)
+        madvise(filemap->data + start, end - start, MADV_DONTNEED);
+#endif
+}
+
+void ngli_filemap_unrefp(struct filemap **filemapp)
+{
+    struct filemap *filemap = *filemapp;
+    if (!filemap)
+        return;
+    if (filemap->refcount-- == 1) {
+#ifndef TARGET_MINGW_W64
+        if (filemap->mapped)
+            munmap(filemap->data, filemap->size);
+        else
+#endif
+        ngli_free(filemap->data);
+        ngli_free(filemap);
+    }
+    *filemapp = NULL;
+}
@@ -0,0 +1,57 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef FILEMAP_H
+#define FILEMAP_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Reference counted read-only view of a whole file. On POSIX systems the file
+ * is mapped privately in memory so its pages are only loaded when accessed;
+ * other platforms fall back on reading the file in a heap buffer. The data
+ * is writable but modifications are never written back to the file.
+ */
+struct filemap;
+
+struct filemap *ngli_filemap_open(const char *filename);
+struct filemap *ngli_filemap_ref(struct filemap *filemap);
+uint8_t *ngli_filemap_data(const struct filemap *filemap);
+size_t ngli_filemap_size(const struct filemap *filemap);
+int ngli_filemap_contains(const struct filemap *filemap, const void *ptr);
+
+/*
+ * Hint that the data is going to be read once, sequentially, so the pages can
+ * be read ahead aggressively.
+ */
+void ngli_filemap_advise_sequential(struct filemap *filemap);
+
+/*
+ * Release the memory backing the specified range. The pages are read back
+ * from the file if they are accessed again, so this must only be used on
+ * data which has not been modified.
+ */
+void ngli_filemap_discard(struct filemap *filemap, size_t offset, size_t size);
+
+void ngli_filemap_unrefp(struct filemap **filemapp);
+
+#endif
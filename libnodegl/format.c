@@ -21,6 +21,7 @@
 
 #include "format.h"
 #include "glcontext.h"
+#include "log.h"
 #include "nodes.h"
 
 static int get_gl_format_type(struct glcontext *gl, int data_format,
@@ -86,6 +87,8 @@ static int get_gl_format_type(struct glcontext *gl, int data_format,
         [NGLI_FORMAT_R32G32B32A32_UINT]    = {GL_RGBA_INTEGER,    GL_RGBA32UI,           GL_UNSIGNED_INT},
         [NGLI_FORMAT_R32G32B32A32_SINT]    = {GL_RGBA_INTEGER,    GL_RGBA32I,            GL_INT},
         [NGLI_FORMAT_R32G32B32A32_SFLOAT]  = {GL_RGBA,            GL_RGBA32F,            GL_FLOAT},
+        /* Vertex attribute only format, without any texture counterpart */
+        [NGLI_FORMAT_A2B10G10R10_SNORM_PACK32] = {GL_RGBA,        0,                     GL_INT_2_10_10_10_REV},
         [NGLI_FORMAT_D16_UNORM]            = {GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT16,  GL_UNSIGNED_SHORT},
         [NGLI_FORMAT_X8_D24_UNORM_PACK32]  = {GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT24,  GL_UNSIGNED_INT},
         [NGLI_FORMAT_D32_SFLOAT]           = {GL_DEPTH_COMPONENT, GL_DEPTH_COMPONENT32F, GL_FLOAT},
@@ -97,8 +100,12 @@ static int get_gl_format_type(struct glcontext *gl, int data_format,
     ngli_assert(data_format >= 0 && data_format < NGLI_ARRAY_NB(format_map));
     const struct entry *entry = &format_map[data_format];
 
-    ngli_assert(data_format == NGLI_FORMAT_UNDEFINED ||
-               (entry->format && entry->internal_format && entry->type));
+    ngli_assert(data_format == NGLI_FORMAT_UNDEFINED || (entry->format && entry->type));
+
+    if (internal_formatp && data_format != NGLI_FORMAT_UNDEFINED && !entry->internal_format) {
+        LOG(ERROR, "format 0x%x can not be used for textures", data_format);
+        return -1;
+    }
 
     if (formatp)
         *formatp = entry->format;
@@ -143,3 +150,36 @@ int ngli_format_get_gl_renderbuffer_format(struct glcontext *gl, int data_format
 {
     return get_gl_format_type(gl, data_format, NULL, formatp, NULL);
 }
+
+int ngli_format_get_gl_vertex_format(struct glcontext *gl, int data_format,
+                                     GLenum *typep, GLboolean *normalizedp)
+{
+    GLint format;
+    GLenum type;
+
+    int ret = get_gl_format_type(gl, data_format, &format, NULL, &type);
+    if (ret < 0)
+        return ret;
+
+    const int integer = format == GL_RED_INTEGER  ||
+                        format == GL_RG_INTEGER   ||
+                        format == GL_RGB_INTEGER  ||
+                        format == GL_RGBA_INTEGER ||
+                        format == GL_BGRA_INTEGER;
+
+    if (typep)
+        *typep = type;
+    if (normalizedp)
+        *normalizedp = !integer && type != GL_FLOAT && type != GL_HALF_FLOAT;
+
+    return 0;
+}
+
+#define FORMAT_SIZE_CASE(format, size, name, doc) case format: return size;
+int ngli_format_get_bytes_per_pixel(int data_format)
+{
+    switch (data_format) {
+        NGLI_FORMATS(FORMAT_SIZE_CASE);
+    }
+    return 0;
+}
@@ -42,5 +42,12 @@ int ngli_format_get_gl_renderbuffer_format(struct glcontext *gl,
                                            int data_format,
                                            GLint *formatp);
 
+int ngli_format_get_gl_vertex_format(struct glcontext *gl,
+                                     int data_format,
+                                     GLenum *typep,
+                                     GLboolean *normalizedp);
+
+int ngli_format_get_bytes_per_pixel(int data_format);
+
 
 #endif
@@ -78,6 +78,9 @@
     action(NGLI_FORMAT_R32G32B32A32_UINT,    16, "r32g32b32a32_uint",    "32-bit unsigned integer RGBA components")            \
     action(NGLI_FORMAT_R32G32B32A32_SINT,    16, "r32g32b32a32_sint",    "32-bit signed integer RGBA components")              \
     action(NGLI_FORMAT_R32G32B32A32_SFLOAT,  16, "r32g32b32a32_sfloat",  "32-bit signed float RGBA components")                \
+    action(NGLI_FORMAT_A2B10G10R10_SNORM_PACK32, 4, "a2b10g10r10_snorm", "32-bit packed format that has 10-bit signed "        \
+                                                                         "normalized RGB components + 2-bit signed "           \
+                                                                         "normalized alpha component")                         \
     action(NGLI_FORMAT_D16_UNORM,             2, "d16_unorm",            "16-bit unsigned normalized depth component")         \
     action(NGLI_FORMAT_X8_D24_UNORM_PACK32,   4, "d24_unorm",            "32-bit packed format that has 24-bit unsigned "      \
                                                                          "normalized depth component + 8-bit of unused data")  \
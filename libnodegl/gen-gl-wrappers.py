@@ -43,6 +43,7 @@ cmds_optional = [
     'glBindVertexArray',
     'glDeleteVertexArrays',
     'glGenVertexArrays',
+    'glVertexAttribIPointer',
 
     # Barrier
     'glMemoryBarrier',
@@ -61,6 +62,14 @@ cmds_optional = [
     'glGetProgramInterfaceiv',
     'glGetProgramResourceName',
 
+    # Program binary
+    'glGetProgramBinary',
+    'glProgramBinary',
+    'glProgramParameteri',
+
+    # Parallel shader compile
+    'glMaxShaderCompilerThreadsKHR',
+
     # Polygon
     'glPolygonMode',
 
@@ -73,6 +82,7 @@ cmds_optional = [
     'glGenQueries',
     'glDeleteQueries',
     'glGetQueryObjectui64v',
+    'glQueryCounter',
 
     # Query EXT
     'glBeginQueryEXT',
@@ -80,12 +90,21 @@ cmds_optional = [
     'glGenQueriesEXT',
     'glDeleteQueriesEXT',
     'glGetQueryObjectui64vEXT',
+    'glQueryCounterEXT',
 
     # Instancing
     'glDrawArraysInstanced',
     'glDrawElementsInstanced',
     'glVertexAttribDivisor',
 
+    # Draw indirect
+    'glDrawArraysIndirect',
+    'glDrawElementsIndirect',
+
+    # Multi draw indirect
+    'glMultiDrawArraysIndirect',
+    'glMultiDrawElementsIndirect',
+
     # Uniform Block Object
     'glGetUniformBlockIndex',
     'glUniformBlockBinding',
@@ -246,6 +265,31 @@ cmds = [
 
 ] + cmds_optional
 
+# Extra instrumentation code executed (in addition to the call counting) when
+# the GL calls statistics are enabled
+stats_hooks = {
+    'glActiveTexture':          'ngli_glstats_active_texture(gl->glstats, texture)',
+    'glBindBuffer':             'ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_BUFFER, target, buffer)',
+    'glBindBufferBase':         'ngli_glstats_set_binding(gl->glstats, NGLI_GLSTATS_BIND_BUFFER, target, buffer)',
+    'glBindFramebuffer':        'ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_FRAMEBUFFER, target, framebuffer)',
+    'glBindRenderbuffer':       'ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_RENDERBUFFER, target, renderbuffer)',
+    'glBindTexture':            'ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_TEXTURE, target, texture)',
+    'glBindVertexArray':        'ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_VERTEX_ARRAY, 0, array)',
+    'glUseProgram':             'ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_PROGRAM, 0, program)',
+    'glDeleteBuffers':          'ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_BUFFER, n, buffers)',
+    'glDeleteFramebuffers':     'ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_FRAMEBUFFER, n, framebuffers)',
+    'glDeleteRenderbuffers':    'ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_RENDERBUFFER, n, renderbuffers)',
+    'glDeleteTextures':         'ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_TEXTURE, n, textures)',
+    'glDeleteVertexArrays':     'ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_VERTEX_ARRAY, n, arrays)',
+    'glBufferData':             'ngli_glstats_transfer(gl->glstats, data ? size : 0)',
+    'glBufferSubData':          'ngli_glstats_transfer(gl->glstats, size)',
+    'glReadPixels':             'ngli_glstats_transfer(gl->glstats, ngli_glstats_get_image_size(format, type, width, height, 1))',
+    'glTexImage2D':             'ngli_glstats_transfer(gl->glstats, pixels ? ngli_glstats_get_image_size(format, type, width, height, 1) : 0)',
+    'glTexImage3D':             'ngli_glstats_transfer(gl->glstats, pixels ? ngli_glstats_get_image_size(format, type, width, height, depth) : 0)',
+    'glTexSubImage2D':          'ngli_glstats_transfer(gl->glstats, ngli_glstats_get_image_size(format, type, width, height, 1))',
+    'glTexSubImage3D':          'ngli_glstats_transfer(gl->glstats, ngli_glstats_get_image_size(format, type, width, height, depth))',
+}
+
 def get_proto_elems(xml_node):
     elems = []
     for text in xml_node.itertext():
@@ -282,6 +326,10 @@ def gen(gl_xml):
 #endif
 
 struct glfunctions {
+'''
+
+    glcalls = '''
+enum {
 '''
 
     gldefinitions = do_not_edit + '''
@@ -340,6 +388,7 @@ static const struct gldefinition {
         }
 
         glfunctions   += '    NGLI_GL_APIENTRY %(func_ret)s (*%(func_name_nogl)s)(%(func_args_specs)s);\n' % data
+        glcalls       += '    NGLI_GLCALL_%(func_name_nogl)s,\n' % data
         gldefinitions += '    {"%(func_name)s", offsetof(struct glfunctions, %(func_name_nogl)s), %(flags)s},\n' % data
         if funcname == 'glGetError':
             glwrappers += '''
@@ -349,12 +398,23 @@ static inline GLenum ngli_glGetError(const struct glcontext *gl)
 }
 '''
         else:
+            hook = stats_hooks.get(funcname)
+            if hook:
+                data['stats'] = '''    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_%s);
+        %s;
+    }
+''' % (data['func_name_nogl'], hook)
+            else:
+                data['stats'] = '''    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_%s);
+''' % data['func_name_nogl']
             glwrappers    += '''
 static inline %(func_ret)s ngli_%(func_name)s(%(wrapper_args_specs)s)
 {
     %(ret_assign)sgl->funcs.%(func_name_nogl)s(%(func_args)s);
     check_error_code(gl, "%(func_name)s");
-%(ret_call)s}
+%(stats)s%(ret_call)s}
 ''' % data
 
         cmds.pop(cmds.index(funcname))
@@ -364,7 +424,8 @@ static inline %(func_ret)s ngli_%(func_name)s(%(wrapper_args_specs)s)
     if cmds:
         print('WARNING: function(s) not found: ' + ', '.join(cmds))
 
-    glfunctions   += '};\n\n#endif\n'
+    glcalls       += '    NGLI_GLCALL_NB\n};\n'
+    glfunctions   += '};\n' + glcalls + '\n#endif\n'
     gldefinitions += '};\n'
 
     open('glfunctions.h', 'w').write(glfunctions)
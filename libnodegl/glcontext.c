@@ -289,6 +289,11 @@ static int glcontext_probe_settings(struct glcontext *glcontext)
         ngli_glGetIntegerv(glcontext, GL_MAX_UNIFORM_BLOCK_SIZE, &glcontext->max_uniform_block_size);
     }
 
+    /* Let the driver use as many threads as it sees fit to compile the
+     * shaders submitted ahead of their use */
+    if (glcontext->features & NGLI_FEATURE_PARALLEL_SHADER_COMPILE)
+        ngli_glMaxShaderCompilerThreadsKHR(glcontext, 0xFFFFFFFF);
+
     if (glcontext->features & NGLI_FEATURE_COMPUTE_SHADER) {
         for (int i = 0; i < NGLI_ARRAY_NB(glcontext->max_compute_work_group_counts); i++) {
             ngli_glGetIntegeri_v(glcontext, GL_MAX_COMPUTE_WORK_GROUP_COUNT,
@@ -353,6 +358,8 @@ struct glcontext *ngli_glcontext_new(const struct ngl_config *config)
     glcontext->height = config->height;
     glcontext->samples = config->samples;
 
+    ngli_glstate_reset_bindings(glcontext);
+
     if (glcontext->class->init) {
         int ret = glcontext->class->init(glcontext, config->display, config->window, config->handle);
         if (ret < 0)
@@ -367,6 +374,28 @@ struct glcontext *ngli_glcontext_new(const struct ngl_config *config)
     if (ret < 0)
         goto fail;
 
+    const char *glstats = getenv("NGL_GL_STATS");
+    if (glstats && strcmp(glstats, "0")) {
+        glcontext->glstats = ngli_glstats_create();
+        if (!glcontext->glstats)
+            goto fail;
+    }
+
+    const char *program_cache_dir = getenv("NGL_PROGRAM_CACHE_DIR");
+    if (program_cache_dir && *program_cache_dir) {
+        GLint nb_formats = 0;
+        if (glcontext->features & NGLI_FEATURE_GET_PROGRAM_BINARY)
+            ngli_glGetIntegerv(glcontext, GL_NUM_PROGRAM_BINARY_FORMATS, &nb_formats);
+        if (nb_formats > 0) {
+            glcontext->programcache = ngli_programcache_create(glcontext, program_cache_dir);
+            if (!glcontext->programcache)
+                goto fail;
+        } else {
+            LOG(WARNING, "program binaries are not supported by the context, "
+                "the program cache is disabled");
+        }
+    }
+
     if (!glcontext->offscreen) {
         if (glcontext->class->init_framebuffer) {
             int ret = glcontext->class->init_framebuffer(glcontext);
@@ -437,6 +466,8 @@ void ngli_glcontext_freep(struct glcontext **glcontextp)
     if (glcontext->class->uninit)
         glcontext->class->uninit(glcontext);
 
+    ngli_glstats_freep(&glcontext->glstats);
+    ngli_programcache_freep(&glcontext->programcache);
     ngli_free(glcontext->priv_data);
     ngli_free(glcontext);
 
@@ -24,6 +24,9 @@
 
 #include <stdlib.h>
 #include "glfunctions.h"
+#include "glstate.h"
+#include "glstats.h"
+#include "programcache.h"
 #include "nodegl.h"
 
 #define NGLI_FEATURE_VERTEX_ARRAY_OBJECT          (1 << 0)
@@ -50,6 +53,13 @@
 #define NGLI_FEATURE_EGL_EXT_IMAGE_DMA_BUF_IMPORT (1 << 21)
 #define NGLI_FEATURE_SYNC                         (1 << 22)
 #define NGLI_FEATURE_YUV_TARGET                   (1 << 23)
+#define NGLI_FEATURE_GET_PROGRAM_BINARY           (1 << 24)
+#define NGLI_FEATURE_PARALLEL_SHADER_COMPILE      (1 << 25)
+#define NGLI_FEATURE_MULTI_DRAW_INDIRECT          (1 << 26)
+#define NGLI_FEATURE_DRAW_INDIRECT                (1 << 27)
+#define NGLI_FEATURE_VERTEX_ATTRIB_INTEGER        (1 << 28)
+#define NGLI_FEATURE_HALF_FLOAT_VERTEX            (1 << 29)
+#define NGLI_FEATURE_VERTEX_TYPE_2_10_10_10_REV   (1 << 30)
 
 #define NGLI_FEATURE_COMPUTE_SHADER_ALL (NGLI_FEATURE_COMPUTE_SHADER           | \
                                          NGLI_FEATURE_PROGRAM_INTERFACE_QUERY  | \
@@ -82,6 +92,20 @@ struct glcontext {
     int max_samples;
     int max_color_attachments;
 
+    /* Resources accounting */
+    int64_t buffers_memory;
+    int64_t textures_memory;
+    int64_t uploaded_bytes;
+
+    /* Shadow copy of the GL bindings */
+    struct glbindings bindings;
+
+    /* GL calls statistics (NULL when disabled) */
+    struct glstats *glstats;
+
+    /* Program binaries cache (NULL when disabled) */
+    struct programcache *programcache;
+
     /* GL functions */
     struct glfunctions funcs;
 };
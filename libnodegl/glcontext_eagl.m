@@ -225,7 +225,8 @@ static int eagl_init_framebuffer(struct glcontext *ctx)
 
     ngli_fbo_bind(ctx->samples ? fbo_ms : fbo);
 
-    ngli_glViewport(ctx, 0, 0, ctx->width, ctx->height);
+    const GLint viewport[] = {0, 0, ctx->width, ctx->height};
+    ngli_glstate_viewport(ctx, viewport);
 
     return 0;
 }
@@ -59,8 +59,10 @@ static const struct gldefinition {
     {"glDisableVertexAttribArray", offsetof(struct glfunctions, DisableVertexAttribArray), M},
     {"glDispatchCompute", offsetof(struct glfunctions, DispatchCompute), 0},
     {"glDrawArrays", offsetof(struct glfunctions, DrawArrays), M},
+    {"glDrawArraysIndirect", offsetof(struct glfunctions, DrawArraysIndirect), 0},
     {"glDrawArraysInstanced", offsetof(struct glfunctions, DrawArraysInstanced), 0},
     {"glDrawElements", offsetof(struct glfunctions, DrawElements), M},
+    {"glDrawElementsIndirect", offsetof(struct glfunctions, DrawElementsIndirect), 0},
     {"glDrawElementsInstanced", offsetof(struct glfunctions, DrawElementsInstanced), 0},
     {"glEGLImageTargetTexture2DOES", offsetof(struct glfunctions, EGLImageTargetTexture2DOES), 0},
     {"glEnable", offsetof(struct glfunctions, Enable), M},
@@ -91,6 +93,7 @@ static const struct gldefinition {
     {"glGetIntegeri_v", offsetof(struct glfunctions, GetIntegeri_v), M},
     {"glGetIntegerv", offsetof(struct glfunctions, GetIntegerv), M},
     {"glGetInternalformativ", offsetof(struct glfunctions, GetInternalformativ), 0},
+    {"glGetProgramBinary", offsetof(struct glfunctions, GetProgramBinary), 0},
     {"glGetProgramInfoLog", offsetof(struct glfunctions, GetProgramInfoLog), M},
     {"glGetProgramInterfaceiv", offsetof(struct glfunctions, GetProgramInterfaceiv), 0},
     {"glGetProgramResourceIndex", offsetof(struct glfunctions, GetProgramResourceIndex), 0},
@@ -111,8 +114,15 @@ static const struct gldefinition {
     {"glGetUniformiv", offsetof(struct glfunctions, GetUniformiv), M},
     {"glInvalidateFramebuffer", offsetof(struct glfunctions, InvalidateFramebuffer), 0},
     {"glLinkProgram", offsetof(struct glfunctions, LinkProgram), M},
+    {"glMaxShaderCompilerThreadsKHR", offsetof(struct glfunctions, MaxShaderCompilerThreadsKHR), 0},
     {"glMemoryBarrier", offsetof(struct glfunctions, MemoryBarrier), 0},
+    {"glMultiDrawArraysIndirect", offsetof(struct glfunctions, MultiDrawArraysIndirect), 0},
+    {"glMultiDrawElementsIndirect", offsetof(struct glfunctions, MultiDrawElementsIndirect), 0},
     {"glPolygonMode", offsetof(struct glfunctions, PolygonMode), 0},
+    {"glProgramBinary", offsetof(struct glfunctions, ProgramBinary), 0},
+    {"glProgramParameteri", offsetof(struct glfunctions, ProgramParameteri), 0},
+    {"glQueryCounter", offsetof(struct glfunctions, QueryCounter), 0},
+    {"glQueryCounterEXT", offsetof(struct glfunctions, QueryCounterEXT), 0},
     {"glReadPixels", offsetof(struct glfunctions, ReadPixels), M},
     {"glReleaseShaderCompiler", offsetof(struct glfunctions, ReleaseShaderCompiler), M},
     {"glRenderbufferStorage", offsetof(struct glfunctions, RenderbufferStorage), M},
@@ -155,6 +165,7 @@ static const struct gldefinition {
     {"glUniformMatrix4fv", offsetof(struct glfunctions, UniformMatrix4fv), M},
     {"glUseProgram", offsetof(struct glfunctions, UseProgram), M},
     {"glVertexAttribDivisor", offsetof(struct glfunctions, VertexAttribDivisor), 0},
+    {"glVertexAttribIPointer", offsetof(struct glfunctions, VertexAttribIPointer), 0},
     {"glVertexAttribPointer", offsetof(struct glfunctions, VertexAttribPointer), M},
     {"glViewport", offsetof(struct glfunctions, Viewport), M},
     {"glWaitSync", offsetof(struct glfunctions, WaitSync), 0},
@@ -128,6 +128,8 @@ static const struct glfeature {
         .flag           = NGLI_FEATURE_TIMER_QUERY,
         .version        = 330,
         .extensions     = (const char*[]){"ARB_timer_query", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(QueryCounter),
+                                           -1}
     }, {
         .name           = "ext_disjoint_timer_query",
         .flag           = NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY,
@@ -137,6 +139,7 @@ static const struct glfeature {
                                            OFFSET(GenQueriesEXT),
                                            OFFSET(DeleteQueriesEXT),
                                            OFFSET(GetQueryObjectui64vEXT),
+                                           OFFSET(QueryCounterEXT),
                                            -1}
     }, {
         .name           = "draw_instanced",
@@ -210,6 +213,59 @@ static const struct glfeature {
                                            OFFSET(ClientWaitSync),
                                            OFFSET(WaitSync),
                                            -1}
+    }, {
+        .name           = "get_program_binary",
+        .flag           = NGLI_FEATURE_GET_PROGRAM_BINARY,
+        .version        = 410,
+        .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_get_program_binary", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(GetProgramBinary),
+                                           OFFSET(ProgramBinary),
+                                           OFFSET(ProgramParameteri),
+                                           -1}
+    }, {
+        .name           = "parallel_shader_compile",
+        .flag           = NGLI_FEATURE_PARALLEL_SHADER_COMPILE,
+        .extensions     = (const char*[]){"GL_KHR_parallel_shader_compile", NULL},
+        .es_extensions  = (const char*[]){"GL_KHR_parallel_shader_compile", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(MaxShaderCompilerThreadsKHR),
+                                           -1}
+    }, {
+        .name           = "draw_indirect",
+        .flag           = NGLI_FEATURE_DRAW_INDIRECT,
+        .version        = 400,
+        .es_version     = 310,
+        .extensions     = (const char*[]){"GL_ARB_draw_indirect", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(DrawArraysIndirect),
+                                           OFFSET(DrawElementsIndirect),
+                                           -1}
+    }, {
+        .name           = "multi_draw_indirect",
+        .flag           = NGLI_FEATURE_MULTI_DRAW_INDIRECT,
+        .version        = 430,
+        .extensions     = (const char*[]){"GL_ARB_multi_draw_indirect",
+                                          "GL_ARB_base_instance", NULL},
+        .funcs_offsets  = (const size_t[]){OFFSET(MultiDrawArraysIndirect),
+                                           OFFSET(MultiDrawElementsIndirect),
+                                           -1}
+    }, {
+        .name           = "vertex_attrib_integer",
+        .flag           = NGLI_FEATURE_VERTEX_ATTRIB_INTEGER,
+        .version        = 300,
+        .es_version     = 300,
+        .funcs_offsets  = (const size_t[]){OFFSET(VertexAttribIPointer),
+                                           -1}
+    }, {
+        .name           = "half_float_vertex",
+        .flag           = NGLI_FEATURE_HALF_FLOAT_VERTEX,
+        .version        = 300,
+        .es_version     = 300
+    }, {
+        .name           = "vertex_type_2_10_10_10_rev",
+        .flag           = NGLI_FEATURE_VERTEX_TYPE_2_10_10_10_REV,
+        .version        = 330,
+        .es_version     = 300,
+        .extensions     = (const char*[]){"GL_ARB_vertex_type_2_10_10_10_rev", NULL},
     }, {
         .name           = "yuv_target",
         .flag           = NGLI_FEATURE_YUV_TARGET,
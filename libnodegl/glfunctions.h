@@ -58,8 +58,10 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*DisableVertexAttribArray)(GLuint index);
     NGLI_GL_APIENTRY void (*DispatchCompute)(GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z);
     NGLI_GL_APIENTRY void (*DrawArrays)(GLenum mode, GLint first, GLsizei count);
+    NGLI_GL_APIENTRY void (*DrawArraysIndirect)(GLenum mode, const void * indirect);
     NGLI_GL_APIENTRY void (*DrawArraysInstanced)(GLenum mode, GLint first, GLsizei count, GLsizei instancecount);
     NGLI_GL_APIENTRY void (*DrawElements)(GLenum mode, GLsizei count, GLenum type, const void * indices);
+    NGLI_GL_APIENTRY void (*DrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect);
     NGLI_GL_APIENTRY void (*DrawElementsInstanced)(GLenum mode, GLsizei count, GLenum type, const void * indices, GLsizei instancecount);
     NGLI_GL_APIENTRY void (*EGLImageTargetTexture2DOES)(GLenum target, GLeglImageOES image);
     NGLI_GL_APIENTRY void (*Enable)(GLenum cap);
@@ -90,6 +92,7 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*GetIntegeri_v)(GLenum target, GLuint index, GLint * data);
     NGLI_GL_APIENTRY void (*GetIntegerv)(GLenum pname, GLint * data);
     NGLI_GL_APIENTRY void (*GetInternalformativ)(GLenum target, GLenum internalformat, GLenum pname, GLsizei bufSize, GLint * params);
+    NGLI_GL_APIENTRY void (*GetProgramBinary)(GLuint program, GLsizei bufSize, GLsizei * length, GLenum * binaryFormat, void * binary);
     NGLI_GL_APIENTRY void (*GetProgramInfoLog)(GLuint program, GLsizei bufSize, GLsizei * length, GLchar * infoLog);
     NGLI_GL_APIENTRY void (*GetProgramInterfaceiv)(GLuint program, GLenum programInterface, GLenum pname, GLint * params);
     NGLI_GL_APIENTRY GLuint (*GetProgramResourceIndex)(GLuint program, GLenum programInterface, const GLchar * name);
@@ -110,8 +113,15 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*GetUniformiv)(GLuint program, GLint location, GLint * params);
     NGLI_GL_APIENTRY void (*InvalidateFramebuffer)(GLenum target, GLsizei numAttachments, const GLenum * attachments);
     NGLI_GL_APIENTRY void (*LinkProgram)(GLuint program);
+    NGLI_GL_APIENTRY void (*MaxShaderCompilerThreadsKHR)(GLuint count);
     NGLI_GL_APIENTRY void (*MemoryBarrier)(GLbitfield barriers);
+    NGLI_GL_APIENTRY void (*MultiDrawArraysIndirect)(GLenum mode, const void * indirect, GLsizei drawcount, GLsizei stride);
+    NGLI_GL_APIENTRY void (*MultiDrawElementsIndirect)(GLenum mode, GLenum type, const void * indirect, GLsizei drawcount, GLsizei stride);
     NGLI_GL_APIENTRY void (*PolygonMode)(GLenum face, GLenum mode);
+    NGLI_GL_APIENTRY void (*ProgramBinary)(GLuint program, GLenum binaryFormat, const void * binary, GLsizei length);
+    NGLI_GL_APIENTRY void (*ProgramParameteri)(GLuint program, GLenum pname, GLint value);
+    NGLI_GL_APIENTRY void (*QueryCounter)(GLuint id, GLenum target);
+    NGLI_GL_APIENTRY void (*QueryCounterEXT)(GLuint id, GLenum target);
     NGLI_GL_APIENTRY void (*ReadPixels)(GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void * pixels);
     NGLI_GL_APIENTRY void (*ReleaseShaderCompiler)();
     NGLI_GL_APIENTRY void (*RenderbufferStorage)(GLenum target, GLenum internalformat, GLsizei width, GLsizei height);
@@ -154,9 +164,170 @@ struct glfunctions {
     NGLI_GL_APIENTRY void (*UniformMatrix4fv)(GLint location, GLsizei count, GLboolean transpose, const GLfloat * value);
     NGLI_GL_APIENTRY void (*UseProgram)(GLuint program);
     NGLI_GL_APIENTRY void (*VertexAttribDivisor)(GLuint index, GLuint divisor);
+    NGLI_GL_APIENTRY void (*VertexAttribIPointer)(GLuint index, GLint size, GLenum type, GLsizei stride, const void * pointer);
     NGLI_GL_APIENTRY void (*VertexAttribPointer)(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer);
     NGLI_GL_APIENTRY void (*Viewport)(GLint x, GLint y, GLsizei width, GLsizei height);
     NGLI_GL_APIENTRY void (*WaitSync)(GLsync sync, GLbitfield flags, GLuint64 timeout);
 };
 
+enum {
+    NGLI_GLCALL_ActiveTexture,
+    NGLI_GLCALL_AttachShader,
+    NGLI_GLCALL_BeginQuery,
+    NGLI_GLCALL_BeginQueryEXT,
+    NGLI_GLCALL_BindAttribLocation,
+    NGLI_GLCALL_BindBuffer,
+    NGLI_GLCALL_BindBufferBase,
+    NGLI_GLCALL_BindBufferRange,
+    NGLI_GLCALL_BindFramebuffer,
+    NGLI_GLCALL_BindImageTexture,
+    NGLI_GLCALL_BindRenderbuffer,
+    NGLI_GLCALL_BindTexture,
+    NGLI_GLCALL_BindVertexArray,
+    NGLI_GLCALL_BlendColor,
+    NGLI_GLCALL_BlendEquation,
+    NGLI_GLCALL_BlendEquationSeparate,
+    NGLI_GLCALL_BlendFunc,
+    NGLI_GLCALL_BlendFuncSeparate,
+    NGLI_GLCALL_BlitFramebuffer,
+    NGLI_GLCALL_BufferData,
+    NGLI_GLCALL_BufferSubData,
+    NGLI_GLCALL_CheckFramebufferStatus,
+    NGLI_GLCALL_Clear,
+    NGLI_GLCALL_ClearColor,
+    NGLI_GLCALL_ClientWaitSync,
+    NGLI_GLCALL_ColorMask,
+    NGLI_GLCALL_CompileShader,
+    NGLI_GLCALL_CreateProgram,
+    NGLI_GLCALL_CreateShader,
+    NGLI_GLCALL_CullFace,
+    NGLI_GLCALL_DeleteBuffers,
+    NGLI_GLCALL_DeleteFramebuffers,
+    NGLI_GLCALL_DeleteProgram,
+    NGLI_GLCALL_DeleteQueries,
+    NGLI_GLCALL_DeleteQueriesEXT,
+    NGLI_GLCALL_DeleteRenderbuffers,
+    NGLI_GLCALL_DeleteShader,
+    NGLI_GLCALL_DeleteTextures,
+    NGLI_GLCALL_DeleteVertexArrays,
+    NGLI_GLCALL_DepthFunc,
+    NGLI_GLCALL_DepthMask,
+    NGLI_GLCALL_DetachShader,
+    NGLI_GLCALL_Disable,
+    NGLI_GLCALL_DisableVertexAttribArray,
+    NGLI_GLCALL_DispatchCompute,
+    NGLI_GLCALL_DrawArrays,
+    NGLI_GLCALL_DrawArraysIndirect,
+    NGLI_GLCALL_DrawArraysInstanced,
+    NGLI_GLCALL_DrawElements,
+    NGLI_GLCALL_DrawElementsIndirect,
+    NGLI_GLCALL_DrawElementsInstanced,
+    NGLI_GLCALL_EGLImageTargetTexture2DOES,
+    NGLI_GLCALL_Enable,
+    NGLI_GLCALL_EnableVertexAttribArray,
+    NGLI_GLCALL_EndQuery,
+    NGLI_GLCALL_EndQueryEXT,
+    NGLI_GLCALL_FenceSync,
+    NGLI_GLCALL_Finish,
+    NGLI_GLCALL_Flush,
+    NGLI_GLCALL_FramebufferRenderbuffer,
+    NGLI_GLCALL_FramebufferTexture2D,
+    NGLI_GLCALL_GenBuffers,
+    NGLI_GLCALL_GenFramebuffers,
+    NGLI_GLCALL_GenQueries,
+    NGLI_GLCALL_GenQueriesEXT,
+    NGLI_GLCALL_GenRenderbuffers,
+    NGLI_GLCALL_GenTextures,
+    NGLI_GLCALL_GenVertexArrays,
+    NGLI_GLCALL_GenerateMipmap,
+    NGLI_GLCALL_GetActiveAttrib,
+    NGLI_GLCALL_GetActiveUniform,
+    NGLI_GLCALL_GetActiveUniformBlockName,
+    NGLI_GLCALL_GetActiveUniformBlockiv,
+    NGLI_GLCALL_GetAttachedShaders,
+    NGLI_GLCALL_GetAttribLocation,
+    NGLI_GLCALL_GetBooleanv,
+    NGLI_GLCALL_GetError,
+    NGLI_GLCALL_GetIntegeri_v,
+    NGLI_GLCALL_GetIntegerv,
+    NGLI_GLCALL_GetInternalformativ,
+    NGLI_GLCALL_GetProgramBinary,
+    NGLI_GLCALL_GetProgramInfoLog,
+    NGLI_GLCALL_GetProgramInterfaceiv,
+    NGLI_GLCALL_GetProgramResourceIndex,
+    NGLI_GLCALL_GetProgramResourceLocation,
+    NGLI_GLCALL_GetProgramResourceName,
+    NGLI_GLCALL_GetProgramResourceiv,
+    NGLI_GLCALL_GetProgramiv,
+    NGLI_GLCALL_GetQueryObjectui64v,
+    NGLI_GLCALL_GetQueryObjectui64vEXT,
+    NGLI_GLCALL_GetRenderbufferParameteriv,
+    NGLI_GLCALL_GetShaderInfoLog,
+    NGLI_GLCALL_GetShaderSource,
+    NGLI_GLCALL_GetShaderiv,
+    NGLI_GLCALL_GetString,
+    NGLI_GLCALL_GetStringi,
+    NGLI_GLCALL_GetUniformBlockIndex,
+    NGLI_GLCALL_GetUniformLocation,
+    NGLI_GLCALL_GetUniformiv,
+    NGLI_GLCALL_InvalidateFramebuffer,
+    NGLI_GLCALL_LinkProgram,
+    NGLI_GLCALL_MaxShaderCompilerThreadsKHR,
+    NGLI_GLCALL_MemoryBarrier,
+    NGLI_GLCALL_MultiDrawArraysIndirect,
+    NGLI_GLCALL_MultiDrawElementsIndirect,
+    NGLI_GLCALL_PolygonMode,
+    NGLI_GLCALL_ProgramBinary,
+    NGLI_GLCALL_ProgramParameteri,
+    NGLI_GLCALL_QueryCounter,
+    NGLI_GLCALL_QueryCounterEXT,
+    NGLI_GLCALL_ReadPixels,
+    NGLI_GLCALL_ReleaseShaderCompiler,
+    NGLI_GLCALL_RenderbufferStorage,
+    NGLI_GLCALL_RenderbufferStorageMultisample,
+    NGLI_GLCALL_ShaderBinary,
+    NGLI_GLCALL_ShaderSource,
+    NGLI_GLCALL_ShaderStorageBlockBinding,
+    NGLI_GLCALL_StencilFunc,
+    NGLI_GLCALL_StencilFuncSeparate,
+    NGLI_GLCALL_StencilMask,
+    NGLI_GLCALL_StencilMaskSeparate,
+    NGLI_GLCALL_StencilOp,
+    NGLI_GLCALL_StencilOpSeparate,
+    NGLI_GLCALL_TexImage2D,
+    NGLI_GLCALL_TexImage3D,
+    NGLI_GLCALL_TexParameteri,
+    NGLI_GLCALL_TexStorage2D,
+    NGLI_GLCALL_TexStorage3D,
+    NGLI_GLCALL_TexSubImage2D,
+    NGLI_GLCALL_TexSubImage3D,
+    NGLI_GLCALL_Uniform1f,
+    NGLI_GLCALL_Uniform1fv,
+    NGLI_GLCALL_Uniform1i,
+    NGLI_GLCALL_Uniform1iv,
+    NGLI_GLCALL_Uniform2f,
+    NGLI_GLCALL_Uniform2fv,
+    NGLI_GLCALL_Uniform2i,
+    NGLI_GLCALL_Uniform2iv,
+    NGLI_GLCALL_Uniform3f,
+    NGLI_GLCALL_Uniform3fv,
+    NGLI_GLCALL_Uniform3i,
+    NGLI_GLCALL_Uniform3iv,
+    NGLI_GLCALL_Uniform4f,
+    NGLI_GLCALL_Uniform4fv,
+    NGLI_GLCALL_Uniform4i,
+    NGLI_GLCALL_Uniform4iv,
+    NGLI_GLCALL_UniformBlockBinding,
+    NGLI_GLCALL_UniformMatrix2fv,
+    NGLI_GLCALL_UniformMatrix3fv,
+    NGLI_GLCALL_UniformMatrix4fv,
+    NGLI_GLCALL_UseProgram,
+    NGLI_GLCALL_VertexAttribDivisor,
+    NGLI_GLCALL_VertexAttribIPointer,
+    NGLI_GLCALL_VertexAttribPointer,
+    NGLI_GLCALL_Viewport,
+    NGLI_GLCALL_WaitSync,
+    NGLI_GLCALL_NB
+};
+
 #endif
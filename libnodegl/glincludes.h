@@ -63,6 +63,10 @@
 typedef void* GLeglImageOES;
 #endif
 
+#ifndef GL_DRAW_INDIRECT_BUFFER
+# define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
 #if NGL_OGL3_COMPAT_INCLUDES
 # define GL_LUMINANCE                          0x1909
 # define GL_LUMINANCE_ALPHA                    0x190A
@@ -89,6 +93,10 @@ typedef void* GLeglImageOES;
 # define GL_MINOR_VERSION                      0x821C
 # define GL_NUM_EXTENSIONS                     0x821D
 # define GL_HALF_FLOAT                         0x140B
+# define GL_INT_2_10_10_10_REV                 0x8D9F
+# define GL_UNSIGNED_INT_VEC2                  0x8DC6
+# define GL_UNSIGNED_INT_VEC3                  0x8DC7
+# define GL_UNSIGNED_INT_VEC4                  0x8DC8
 # define GL_RED                                0x1903
 # define GL_RED_INTEGER                        0x8D94
 # define GL_RG                                 0x8227
@@ -159,6 +167,7 @@ typedef void* GLeglImageOES;
 # define GL_WRITE_ONLY                         0x88B9
 # define GL_READ_WRITE                         0x88BA
 # define GL_TIME_ELAPSED                       0x88BF
+# define GL_TIMESTAMP                          0x8E28
 # define GL_STREAM_READ                        0x88E1
 # define GL_STREAM_COPY                        0x88E2
 # define GL_STATIC_READ                        0x88E5
@@ -182,6 +191,9 @@ typedef void* GLeglImageOES;
 # define GL_UNIFORM_BUFFER                     0x8A11
 # define GL_UNIFORM_BLOCK_BINDING              0x8A3F
 # define GL_MAX_UNIFORM_BLOCK_SIZE             0x8A30
+# define GL_PROGRAM_BINARY_RETRIEVABLE_HINT    0x8257
+# define GL_PROGRAM_BINARY_LENGTH              0x8741
+# define GL_NUM_PROGRAM_BINARY_FORMATS         0x87FE
 #endif
 
 #if NGL_CS_COMPAT_INCLUDES
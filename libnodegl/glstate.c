@@ -25,6 +25,232 @@
 #include "glincludes.h"
 #include "glstate.h"
 
+static int get_texture_index(GLenum target)
+{
+    switch (target) {
+    case GL_TEXTURE_2D:             return NGLI_GLSTATE_TEXTURE_2D;
+    case GL_TEXTURE_3D:             return NGLI_GLSTATE_TEXTURE_3D;
+    case GL_TEXTURE_CUBE_MAP:       return NGLI_GLSTATE_TEXTURE_CUBE_MAP;
+    case GL_TEXTURE_RECTANGLE:      return NGLI_GLSTATE_TEXTURE_RECTANGLE;
+    case GL_TEXTURE_EXTERNAL_OES:   return NGLI_GLSTATE_TEXTURE_EXTERNAL_OES;
+    default:                        return -1;
+    }
+}
+
+void ngli_glstate_reset_bindings(struct glcontext *gl)
+{
+    struct glbindings *b = &gl->bindings;
+
+    b->program              = NGLI_GLSTATE_UNKNOWN;
+    b->vertex_array         = NGLI_GLSTATE_UNKNOWN;
+    b->array_buffer         = NGLI_GLSTATE_UNKNOWN;
+    b->element_array_buffer = NGLI_GLSTATE_UNKNOWN;
+    b->draw_indirect_buffer = NGLI_GLSTATE_UNKNOWN;
+    b->active_texture       = NGLI_GLSTATE_UNKNOWN;
+    b->draw_framebuffer     = NGLI_GLSTATE_UNKNOWN;
+    b->read_framebuffer     = NGLI_GLSTATE_UNKNOWN;
+    b->has_viewport         = 0;
+    ngli_glstate_invalidate_textures(gl);
+}
+
+void ngli_glstate_invalidate_textures(struct glcontext *gl)
+{
+    struct glbindings *b = &gl->bindings;
+
+    for (int i = 0; i < NGLI_GLSTATE_MAX_TEXTURE_UNITS; i++)
+        for (int j = 0; j < NGLI_GLSTATE_TEXTURE_NB; j++)
+            b->textures[i][j] = NGLI_GLSTATE_UNKNOWN;
+}
+
+void ngli_glstate_use_program(struct glcontext *gl, GLuint program)
+{
+    struct glbindings *b = &gl->bindings;
+
+    if (b->program == program)
+        return;
+    ngli_glUseProgram(gl, program);
+    b->program = program;
+}
+
+void ngli_glstate_bind_vertex_array(struct glcontext *gl, GLuint vertex_array)
+{
+    struct glbindings *b = &gl->bindings;
+
+    if (b->vertex_array == vertex_array)
+        return;
+    ngli_glBindVertexArray(gl, vertex_array);
+    b->vertex_array = vertex_array;
+
+    /* The element array buffer binding is part of the vertex array state */
+    b->element_array_buffer = NGLI_GLSTATE_UNKNOWN;
+}
+
+void ngli_glstate_bind_buffer(struct glcontext *gl, GLenum target, GLuint buffer)
+{
+    struct glbindings *b = &gl->bindings;
+
+    GLuint *binding = NULL;
+    if (target == GL_ARRAY_BUFFER)
+        binding = &b->array_buffer;
+    else if (target == GL_ELEMENT_ARRAY_BUFFER)
+        binding = &b->element_array_buffer;
+    else if (target == GL_DRAW_INDIRECT_BUFFER)
+        binding = &b->draw_indirect_buffer;
+
+    if (binding && *binding == buffer)
+        return;
+    ngli_glBindBuffer(gl, target, buffer);
+    if (binding)
+        *binding = buffer;
+}
+
+void ngli_glstate_active_texture(struct glcontext *gl, GLenum texture)
+{
+    struct glbindings *b = &gl->bindings;
+
+    if (b->active_texture == texture)
+        return;
+    ngli_glActiveTexture(gl, texture);
+    b->active_texture = texture;
+}
+
+static GLuint *get_texture_binding(struct glbindings *b, GLenum target)
+{
+    const int index = get_texture_index(target);
+    const GLuint unit = b->active_texture - GL_TEXTURE0;
+    if (index < 0 || unit >= NGLI_GLSTATE_MAX_TEXTURE_UNITS)
+        return NULL;
+    return &b->textures[unit][index];
+}
+
+void ngli_glstate_bind_texture(struct glcontext *gl, GLenum target, GLuint texture)
+{
+    GLuint *binding = get_texture_binding(&gl->bindings, target);
+
+    if (binding && *binding == texture)
+        return;
+    ngli_glBindTexture(gl, target, texture);
+    if (binding)
+        *binding = texture;
+}
+
+void ngli_glstate_bind_framebuffer(struct glcontext *gl, GLenum target, GLuint framebuffer)
+{
+    struct glbindings *b = &gl->bindings;
+
+    if (target == GL_FRAMEBUFFER) {
+        if (b->draw_framebuffer == framebuffer && b->read_framebuffer == framebuffer)
+            return;
+        ngli_glBindFramebuffer(gl, target, framebuffer);
+        b->draw_framebuffer = framebuffer;
+        b->read_framebuffer = framebuffer;
+        return;
+    }
+
+    GLuint *binding = target == GL_READ_FRAMEBUFFER ? &b->read_framebuffer : &b->draw_framebuffer;
+    if (*binding == framebuffer)
+        return;
+    ngli_glBindFramebuffer(gl, target, framebuffer);
+    *binding = framebuffer;
+}
+
+GLuint ngli_glstate_get_framebuffer(struct glcontext *gl, GLenum target)
+{
+    struct glbindings *b = &gl->bindings;
+
+    if (target == GL_READ_FRAMEBUFFER) {
+        if (b->read_framebuffer == NGLI_GLSTATE_UNKNOWN)
+            ngli_glGetIntegerv(gl, GL_READ_FRAMEBUFFER_BINDING, (GLint *)&b->read_framebuffer);
+        return b->read_framebuffer;
+    }
+
+    if (b->draw_framebuffer == NGLI_GLSTATE_UNKNOWN)
+        ngli_glGetIntegerv(gl, GL_FRAMEBUFFER_BINDING, (GLint *)&b->draw_framebuffer);
+    return b->draw_framebuffer;
+}
+
+void ngli_glstate_viewport(struct glcontext *gl, const GLint *viewport)
+{
+    struct glbindings *b = &gl->bindings;
+
+    if (b->has_viewport && !memcmp(b->viewport, viewport, sizeof(b->viewport)))
+        return;
+    ngli_glViewport(gl, viewport[0], viewport[1], viewport[2], viewport[3]);
+    memcpy(b->viewport, viewport, sizeof(b->viewport));
+    b->has_viewport = 1;
+}
+
+void ngli_glstate_get_viewport(struct glcontext *gl, GLint *viewport)
+{
+    struct glbindings *b = &gl->bindings;
+
+    if (!b->has_viewport) {
+        ngli_glGetIntegerv(gl, GL_VIEWPORT, b->viewport);
+        b->has_viewport = 1;
+    }
+    memcpy(viewport, b->viewport, sizeof(b->viewport));
+}
+
+void ngli_glstate_delete_program(struct glcontext *gl, GLuint program)
+{
+    struct glbindings *b = &gl->bindings;
+
+    ngli_glDeleteProgram(gl, program);
+    if (b->program == program)
+        b->program = NGLI_GLSTATE_UNKNOWN;
+}
+
+void ngli_glstate_delete_vertex_array(struct glcontext *gl, GLuint vertex_array)
+{
+    struct glbindings *b = &gl->bindings;
+
+    ngli_glDeleteVertexArrays(gl, 1, &vertex_array);
+    if (b->vertex_array == vertex_array) {
+        b->vertex_array = 0;
+        b->element_array_buffer = NGLI_GLSTATE_UNKNOWN;
+    }
+}
+
+void ngli_glstate_delete_buffer(struct glcontext *gl, GLuint buffer)
+{
+    struct glbindings *b = &gl->bindings;
+
+    ngli_glDeleteBuffers(gl, 1, &buffer);
+    if (b->array_buffer == buffer)
+        b->array_buffer = 0;
+    if (b->element_array_buffer == buffer)
+        b->element_array_buffer = 0;
+    if (b->draw_indirect_buffer == buffer)
+        b->draw_indirect_buffer = 0;
+}
+
+void ngli_glstate_forget_texture(struct glcontext *gl, GLuint texture)
+{
+    struct glbindings *b = &gl->bindings;
+
+    for (int i = 0; i < NGLI_GLSTATE_MAX_TEXTURE_UNITS; i++)
+        for (int j = 0; j < NGLI_GLSTATE_TEXTURE_NB; j++)
+            if (b->textures[i][j] == texture)
+                b->textures[i][j] = NGLI_GLSTATE_UNKNOWN;
+}
+
+void ngli_glstate_delete_texture(struct glcontext *gl, GLuint texture)
+{
+    ngli_glDeleteTextures(gl, 1, &texture);
+    ngli_glstate_forget_texture(gl, texture);
+}
+
+void ngli_glstate_delete_framebuffer(struct glcontext *gl, GLuint framebuffer)
+{
+    struct glbindings *b = &gl->bindings;
+
+    ngli_glDeleteFramebuffers(gl, 1, &framebuffer);
+    if (b->draw_framebuffer == framebuffer)
+        b->draw_framebuffer = 0;
+    if (b->read_framebuffer == framebuffer)
+        b->read_framebuffer = 0;
+}
+
 void ngli_glstate_probe(const struct glcontext *gl, struct glstate *state)
 {
     /* Blend */
@@ -22,6 +22,73 @@
 #ifndef GLSTATE_H
 #define GLSTATE_H
 
+#include "glincludes.h"
+
+struct glcontext;
+
+#define NGLI_GLSTATE_MAX_TEXTURE_UNITS 32
+
+enum {
+    NGLI_GLSTATE_TEXTURE_2D,
+    NGLI_GLSTATE_TEXTURE_3D,
+    NGLI_GLSTATE_TEXTURE_CUBE_MAP,
+    NGLI_GLSTATE_TEXTURE_RECTANGLE,
+    NGLI_GLSTATE_TEXTURE_EXTERNAL_OES,
+    NGLI_GLSTATE_TEXTURE_NB
+};
+
+/*
+ * Shadow copy of the GL bindings, owned by the GL context. Every binding
+ * made by the library goes through the ngli_glstate_* functions below so
+ * redundant calls are elided and the current state can be read back without
+ * querying the driver. A binding set to NGLI_GLSTATE_UNKNOWN is always
+ * honored (and queried from GL when read).
+ */
+#define NGLI_GLSTATE_UNKNOWN ((GLuint)-1)
+
+struct glbindings {
+    GLuint program;
+    GLuint vertex_array;
+    GLuint array_buffer;
+    GLuint element_array_buffer;
+    GLuint draw_indirect_buffer;
+    GLenum active_texture;
+    GLuint textures[NGLI_GLSTATE_MAX_TEXTURE_UNITS][NGLI_GLSTATE_TEXTURE_NB];
+    GLuint draw_framebuffer;
+    GLuint read_framebuffer;
+    int has_viewport;
+    GLint viewport[4];
+};
+
+void ngli_glstate_reset_bindings(struct glcontext *gl);
+void ngli_glstate_invalidate_textures(struct glcontext *gl);
+
+void ngli_glstate_use_program(struct glcontext *gl, GLuint program);
+void ngli_glstate_bind_vertex_array(struct glcontext *gl, GLuint vertex_array);
+void ngli_glstate_bind_buffer(struct glcontext *gl, GLenum target, GLuint buffer);
+void ngli_glstate_active_texture(struct glcontext *gl, GLenum texture);
+void ngli_glstate_bind_texture(struct glcontext *gl, GLenum target, GLuint texture);
+void ngli_glstate_bind_framebuffer(struct glcontext *gl, GLenum target, GLuint framebuffer);
+GLuint ngli_glstate_get_framebuffer(struct glcontext *gl, GLenum target);
+void ngli_glstate_viewport(struct glcontext *gl, const GLint *viewport);
+void ngli_glstate_get_viewport(struct glcontext *gl, GLint *viewport);
+
+/*
+ * Delete a GL object and drop the bindings referring to it, since GL reverts
+ * them to 0 and may reuse the name for a new object.
+ */
+void ngli_glstate_delete_program(struct glcontext *gl, GLuint program);
+void ngli_glstate_delete_vertex_array(struct glcontext *gl, GLuint vertex_array);
+void ngli_glstate_delete_buffer(struct glcontext *gl, GLuint buffer);
+void ngli_glstate_delete_texture(struct glcontext *gl, GLuint texture);
+void ngli_glstate_delete_framebuffer(struct glcontext *gl, GLuint framebuffer);
+
+/*
+ * Drop the bindings referring to a texture whose lifetime is managed outside
+ * of the library (wrapped textures).
+ */
+void ngli_glstate_forget_texture(struct glcontext *gl, GLuint texture);
+
 struct glstate {
     GLenum blend;
     GLenum blend_dst_factor;
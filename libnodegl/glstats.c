@@ -0,0 +1,295 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "glcontext.h"
+#include "glstats.h"
+#include "log.h"
+#include "memory.h"
+#include "utils.h"
+
+#include "gldefinitions_data.h"
+
+NGLI_STATIC_ASSERT(glcalls_names, NGLI_ARRAY_NB(gldefinitions) == NGLI_GLCALL_NB);
+
+#define NB_REPORTED_CALLS 10
+
+static const char * const bind_names[NGLI_GLSTATS_BIND_NB] = {
+    [NGLI_GLSTATS_BIND_PROGRAM]      = "program",
+    [NGLI_GLSTATS_BIND_VERTEX_ARRAY] = "vertex array",
+    [NGLI_GLSTATS_BIND_BUFFER]       = "buffer",
+    [NGLI_GLSTATS_BIND_TEXTURE]      = "texture",
+    [NGLI_GLSTATS_BIND_FRAMEBUFFER]  = "framebuffer",
+    [NGLI_GLSTATS_BIND_RENDERBUFFER] = "renderbuffer",
+};
+
+struct glstats *ngli_glstats_create(void)
+{
+    struct glstats *s = ngli_calloc(1, sizeof(*s));
+    return s;
+}
+
+static int get_buffer_index(GLenum target)
+{
+    switch (target) {
+    case GL_ARRAY_BUFFER:           return NGLI_GLSTATS_BUFFER_ARRAY;
+    case GL_ELEMENT_ARRAY_BUFFER:   return NGLI_GLSTATS_BUFFER_ELEMENT_ARRAY;
+    case GL_UNIFORM_BUFFER:         return NGLI_GLSTATS_BUFFER_UNIFORM;
+    case GL_SHADER_STORAGE_BUFFER:  return NGLI_GLSTATS_BUFFER_SHADER_STORAGE;
+    case GL_DRAW_INDIRECT_BUFFER:   return NGLI_GLSTATS_BUFFER_DRAW_INDIRECT;
+    default:                        return -1;
+    }
+}
+
+static int get_texture_index(GLenum target)
+{
+    switch (target) {
+    case GL_TEXTURE_2D:             return NGLI_GLSTATS_TEXTURE_2D;
+    case GL_TEXTURE_3D:             return NGLI_GLSTATS_TEXTURE_3D;
+    case GL_TEXTURE_CUBE_MAP:       return NGLI_GLSTATS_TEXTURE_CUBE_MAP;
+    case GL_TEXTURE_RECTANGLE:      return NGLI_GLSTATS_TEXTURE_RECTANGLE;
+    case GL_TEXTURE_EXTERNAL_OES:   return NGLI_GLSTATS_TEXTURE_EXTERNAL_OES;
+    default:                        return -1;
+    }
+}
+
+static struct glstats_binding *get_binding(struct glstats *s, int type, GLenum target)
+{
+    switch (type) {
+    case NGLI_GLSTATS_BIND_PROGRAM:      return &s->program;
+    case NGLI_GLSTATS_BIND_VERTEX_ARRAY: return &s->vertex_array;
+    case NGLI_GLSTATS_BIND_RENDERBUFFER: return &s->renderbuffer;
+    case NGLI_GLSTATS_BIND_BUFFER: {
+        const int index = get_buffer_index(target);
+        return index >= 0 ? &s->buffers[index] : NULL;
+    }
+    case NGLI_GLSTATS_BIND_TEXTURE: {
+        const int index = get_texture_index(target);
+        if (index < 0 || s->active_texture < 0 || s->active_texture >= NGLI_GLSTATS_MAX_TEXTURE_UNITS)
+            return NULL;
+        return &s->textures[s->active_texture][index];
+    }
+    case NGLI_GLSTATS_BIND_FRAMEBUFFER:
+        if (target == GL_READ_FRAMEBUFFER)
+            return &s->read_framebuffer;
+        return &s->draw_framebuffer;
+    default:
+        return NULL;
+    }
+}
+
+void ngli_glstats_active_texture(struct glstats *s, GLenum texture)
+{
+    s->active_texture = (int)texture - GL_TEXTURE0;
+}
+
+void ngli_glstats_bind(struct glstats *s, int type, GLenum target, GLuint id)
+{
+    struct glstats_binding *binding = get_binding(s, type, target);
+    if (!binding)
+        return;
+
+    int redundant = binding->known && binding->id == id;
+
+    /* GL_FRAMEBUFFER binds both the draw and the read framebuffers */
+    if (type == NGLI_GLSTATS_BIND_FRAMEBUFFER && target == GL_FRAMEBUFFER) {
+        struct glstats_binding *read_binding = &s->read_framebuffer;
+        redundant = redundant && read_binding->known && read_binding->id == id;
+        read_binding->known = 1;
+        read_binding->id = id;
+    }
+
+    /* The element array buffer binding is part of the vertex array state */
+    if (type == NGLI_GLSTATS_BIND_VERTEX_ARRAY && !redundant)
+        s->buffers[NGLI_GLSTATS_BUFFER_ELEMENT_ARRAY].known = 0;
+
+    if (redundant)
+        s->nb_redundant_binds[type]++;
+    binding->known = 1;
+    binding->id = id;
+}
+
+void ngli_glstats_set_binding(struct glstats *s, int type, GLenum target, GLuint id)
+{
+    struct glstats_binding *binding = get_binding(s, type, target);
+    if (!binding)
+        return;
+    binding->known = 1;
+    binding->id = id;
+}
+
+static void reset_binding(struct glstats_binding *binding, GLuint id)
+{
+    if (binding->known && binding->id == id)
+        binding->id = 0;
+}
+
+void ngli_glstats_delete(struct glstats *s, int type, GLsizei n, const GLuint *ids)
+{
+    /* Deleting an object bound to the context reverts its binding to 0 */
+    for (int i = 0; i < n; i++) {
+        const GLuint id = ids[i];
+        if (!id)
+            continue;
+        switch (type) {
+        case NGLI_GLSTATS_BIND_VERTEX_ARRAY:
+            reset_binding(&s->vertex_array, id);
+            break;
+        case NGLI_GLSTATS_BIND_RENDERBUFFER:
+            reset_binding(&s->renderbuffer, id);
+            break;
+        case NGLI_GLSTATS_BIND_FRAMEBUFFER:
+            reset_binding(&s->draw_framebuffer, id);
+            reset_binding(&s->read_framebuffer, id);
+            break;
+        case NGLI_GLSTATS_BIND_BUFFER:
+            for (int j = 0; j < NGLI_GLSTATS_BUFFER_NB; j++)
+                reset_binding(&s->buffers[j], id);
+            break;
+        case NGLI_GLSTATS_BIND_TEXTURE:
+            for (int j = 0; j < NGLI_GLSTATS_MAX_TEXTURE_UNITS; j++)
+                for (int k = 0; k < NGLI_GLSTATS_TEXTURE_NB; k++)
+                    reset_binding(&s->textures[j][k], id);
+            break;
+        }
+    }
+}
+
+static int get_nb_components(GLenum format)
+{
+    switch (format) {
+    case GL_RED:
+    case GL_RED_INTEGER:
+    case GL_LUMINANCE:
+    case GL_DEPTH_COMPONENT:
+        return 1;
+    case GL_RG:
+    case GL_RG_INTEGER:
+    case GL_LUMINANCE_ALPHA:
+        return 2;
+    case GL_RGB:
+    case GL_RGB_INTEGER:
+        return 3;
+    case GL_RGBA:
+    case GL_RGBA_INTEGER:
+    case GL_BGRA:
+    case GL_BGRA_INTEGER:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+int64_t ngli_glstats_get_image_size(GLenum format, GLenum type, GLsizei width, GLsizei height, GLsizei depth)
+{
+    const int64_t nb_pixels = (int64_t)width * height * depth;
+
+    switch (type) {
+    case GL_UNSIGNED_SHORT_5_6_5:
+    case GL_UNSIGNED_SHORT_4_4_4_4:
+    case GL_UNSIGNED_SHORT_5_5_5_1:
+        return nb_pixels * 2;
+    case GL_UNSIGNED_INT_24_8:
+        return nb_pixels * 4;
+    case GL_FLOAT_32_UNSIGNED_INT_24_8_REV:
+        return nb_pixels * 8;
+    }
+
+    const int64_t nb_components = nb_pixels * get_nb_components(format);
+    switch (type) {
+    case GL_BYTE:
+    case GL_UNSIGNED_BYTE:
+        return nb_components;
+    case GL_SHORT:
+    case GL_UNSIGNED_SHORT:
+    case GL_HALF_FLOAT:
+        return nb_components * 2;
+    case GL_INT:
+    case GL_UNSIGNED_INT:
+    case GL_FLOAT:
+        return nb_components * 4;
+    default:
+        return 0;
+    }
+}
+
+int ngli_glstats_get_nb_redundant_binds(const struct glstats *s)
+{
+    int nb_redundant_binds = 0;
+    for (int i = 0; i < NGLI_GLSTATS_BIND_NB; i++)
+        nb_redundant_binds += s->nb_redundant_binds[i];
+    return nb_redundant_binds;
+}
+
+void ngli_glstats_frame_end(struct glstats *s)
+{
+    LOG(INFO, "GL stats frame #%d: %d calls, %d redundant binds, %" PRId64 " bytes transferred",
+        s->nb_frames, s->nb_total_calls, ngli_glstats_get_nb_redundant_binds(s), s->transferred_bytes);
+
+    for (int i = 0; i < NGLI_GLSTATS_BIND_NB; i++)
+        if (s->nb_redundant_binds[i])
+            LOG(INFO, "  redundant %s binds: %d", bind_names[i], s->nb_redundant_binds[i]);
+
+    /* Partial selection sort of the most called entry points */
+    int reported[NB_REPORTED_CALLS];
+    int nb_reported = 0;
+    while (nb_reported < NB_REPORTED_CALLS) {
+        int best = -1;
+        for (int i = 0; i < NGLI_GLCALL_NB; i++) {
+            if (!s->nb_calls[i])
+                continue;
+            int already_reported = 0;
+            for (int j = 0; j < nb_reported; j++)
+                already_reported |= reported[j] == i;
+            if (!already_reported && (best < 0 || s->nb_calls[i] > s->nb_calls[best]))
+                best = i;
+        }
+        if (best < 0)
+            break;
+        reported[nb_reported++] = best;
+        LOG(INFO, "  %-28s %d", gldefinitions[best].name, s->nb_calls[best]);
+    }
+
+    memset(s->nb_calls, 0, sizeof(s->nb_calls));
+    memset(s->nb_redundant_binds, 0, sizeof(s->nb_redundant_binds));
+    s->nb_total_calls = 0;
+    s->transferred_bytes = 0;
+    s->nb_frames++;
+
+    s->program.known = 0;
+    s->vertex_array.known = 0;
+    s->draw_framebuffer.known = 0;
+    s->read_framebuffer.known = 0;
+    s->renderbuffer.known = 0;
+    memset(s->buffers, 0, sizeof(s->buffers));
+    memset(s->textures, 0, sizeof(s->textures));
+}
+
+void ngli_glstats_freep(struct glstats **sp)
+{
+    if (!*sp)
+        return;
+    ngli_free(*sp);
+    *sp = NULL;
+}
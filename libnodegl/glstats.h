@@ -0,0 +1,120 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GLSTATS_H
+#define GLSTATS_H
+
+#include <stdint.h>
+
+#include "glfunctions.h"
+
+/*
+ * GL calls statistics: when enabled (NGL_GL_STATS environment variable), the
+ * GL wrappers count every call per entry point, sum the amount of data
+ * transferred between the CPU and the GPU, and detect the redundant bindings
+ * (an object bound again while it is already the current binding). A report
+ * is logged at the end of each frame.
+ */
+
+enum {
+    NGLI_GLSTATS_BIND_PROGRAM,
+    NGLI_GLSTATS_BIND_VERTEX_ARRAY,
+    NGLI_GLSTATS_BIND_BUFFER,
+    NGLI_GLSTATS_BIND_TEXTURE,
+    NGLI_GLSTATS_BIND_FRAMEBUFFER,
+    NGLI_GLSTATS_BIND_RENDERBUFFER,
+    NGLI_GLSTATS_BIND_NB
+};
+
+#define NGLI_GLSTATS_MAX_TEXTURE_UNITS 32
+
+enum {
+    NGLI_GLSTATS_BUFFER_ARRAY,
+    NGLI_GLSTATS_BUFFER_ELEMENT_ARRAY,
+    NGLI_GLSTATS_BUFFER_UNIFORM,
+    NGLI_GLSTATS_BUFFER_SHADER_STORAGE,
+    NGLI_GLSTATS_BUFFER_DRAW_INDIRECT,
+    NGLI_GLSTATS_BUFFER_NB
+};
+
+enum {
+    NGLI_GLSTATS_TEXTURE_2D,
+    NGLI_GLSTATS_TEXTURE_3D,
+    NGLI_GLSTATS_TEXTURE_CUBE_MAP,
+    NGLI_GLSTATS_TEXTURE_RECTANGLE,
+    NGLI_GLSTATS_TEXTURE_EXTERNAL_OES,
+    NGLI_GLSTATS_TEXTURE_NB
+};
+
+struct glstats_binding {
+    int known;
+    GLuint id;
+};
+
+struct glstats {
+    /* Per frame counters */
+    int nb_calls[NGLI_GLCALL_NB];
+    int nb_total_calls;
+    int nb_redundant_binds[NGLI_GLSTATS_BIND_NB];
+    int64_t transferred_bytes;
+    int nb_frames;
+
+    /* Last known bindings */
+    struct glstats_binding program;
+    struct glstats_binding vertex_array;
+    struct glstats_binding buffers[NGLI_GLSTATS_BUFFER_NB];
+    struct glstats_binding textures[NGLI_GLSTATS_MAX_TEXTURE_UNITS][NGLI_GLSTATS_TEXTURE_NB];
+    struct glstats_binding draw_framebuffer;
+    struct glstats_binding read_framebuffer;
+    struct glstats_binding renderbuffer;
+    int active_texture;
+};
+
+struct glstats *ngli_glstats_create(void);
+
+static inline void ngli_glstats_record_call(struct glstats *s, int call_id)
+{
+    s->nb_calls[call_id]++;
+    s->nb_total_calls++;
+}
+
+static inline void ngli_glstats_transfer(struct glstats *s, int64_t size)
+{
+    s->transferred_bytes += size;
+}
+
+void ngli_glstats_active_texture(struct glstats *s, GLenum texture);
+void ngli_glstats_bind(struct glstats *s, int type, GLenum target, GLuint id);
+void ngli_glstats_set_binding(struct glstats *s, int type, GLenum target, GLuint id);
+void ngli_glstats_delete(struct glstats *s, int type, GLsizei n, const GLuint *ids);
+int64_t ngli_glstats_get_image_size(GLenum format, GLenum type, GLsizei width, GLsizei height, GLsizei depth);
+int ngli_glstats_get_nb_redundant_binds(const struct glstats *s);
+
+/*
+ * Log the report of the current frame and reset the counters. The known
+ * bindings are also invalidated since the GL state may be altered outside
+ * of the library between two frames.
+ */
+void ngli_glstats_frame_end(struct glstats *s);
+
+void ngli_glstats_freep(struct glstats **sp);
+
+#endif
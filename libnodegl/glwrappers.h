@@ -12,132 +12,194 @@ static inline void ngli_glActiveTexture(const struct glcontext *gl, GLenum textu
 {
     gl->funcs.ActiveTexture(texture);
     check_error_code(gl, "glActiveTexture");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ActiveTexture);
+        ngli_glstats_active_texture(gl->glstats, texture);
+    }
 }
 
 static inline void ngli_glAttachShader(const struct glcontext *gl, GLuint program, GLuint shader)
 {
     gl->funcs.AttachShader(program, shader);
     check_error_code(gl, "glAttachShader");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_AttachShader);
 }
 
 static inline void ngli_glBeginQuery(const struct glcontext *gl, GLenum target, GLuint id)
 {
     gl->funcs.BeginQuery(target, id);
     check_error_code(gl, "glBeginQuery");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BeginQuery);
 }
 
 static inline void ngli_glBeginQueryEXT(const struct glcontext *gl, GLenum target, GLuint id)
 {
     gl->funcs.BeginQueryEXT(target, id);
     check_error_code(gl, "glBeginQueryEXT");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BeginQueryEXT);
 }
 
 static inline void ngli_glBindAttribLocation(const struct glcontext *gl, GLuint program, GLuint index, const GLchar * name)
 {
     gl->funcs.BindAttribLocation(program, index, name);
     check_error_code(gl, "glBindAttribLocation");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindAttribLocation);
 }
 
 static inline void ngli_glBindBuffer(const struct glcontext *gl, GLenum target, GLuint buffer)
 {
     gl->funcs.BindBuffer(target, buffer);
     check_error_code(gl, "glBindBuffer");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindBuffer);
+        ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_BUFFER, target, buffer);
+    }
 }
 
 static inline void ngli_glBindBufferBase(const struct glcontext *gl, GLenum target, GLuint index, GLuint buffer)
 {
     gl->funcs.BindBufferBase(target, index, buffer);
     check_error_code(gl, "glBindBufferBase");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindBufferBase);
+        ngli_glstats_set_binding(gl->glstats, NGLI_GLSTATS_BIND_BUFFER, target, buffer);
+    }
 }
 
 static inline void ngli_glBindBufferRange(const struct glcontext *gl, GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
 {
     gl->funcs.BindBufferRange(target, index, buffer, offset, size);
     check_error_code(gl, "glBindBufferRange");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindBufferRange);
 }
 
 static inline void ngli_glBindFramebuffer(const struct glcontext *gl, GLenum target, GLuint framebuffer)
 {
     gl->funcs.BindFramebuffer(target, framebuffer);
     check_error_code(gl, "glBindFramebuffer");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindFramebuffer);
+        ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_FRAMEBUFFER, target, framebuffer);
+    }
 }
 
 static inline void ngli_glBindImageTexture(const struct glcontext *gl, GLuint unit, GLuint texture, GLint level, GLboolean layered, GLint layer, GLenum access, GLenum format)
 {
     gl->funcs.BindImageTexture(unit, texture, level, layered, layer, access, format);
     check_error_code(gl, "glBindImageTexture");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindImageTexture);
 }
 
 static inline void ngli_glBindRenderbuffer(const struct glcontext *gl, GLenum target, GLuint renderbuffer)
 {
     gl->funcs.BindRenderbuffer(target, renderbuffer);
     check_error_code(gl, "glBindRenderbuffer");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindRenderbuffer);
+        ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_RENDERBUFFER, target, renderbuffer);
+    }
 }
 
 static inline void ngli_glBindTexture(const struct glcontext *gl, GLenum target, GLuint texture)
 {
     gl->funcs.BindTexture(target, texture);
     check_error_code(gl, "glBindTexture");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindTexture);
+        ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_TEXTURE, target, texture);
+    }
 }
 
 static inline void ngli_glBindVertexArray(const struct glcontext *gl, GLuint array)
 {
     gl->funcs.BindVertexArray(array);
     check_error_code(gl, "glBindVertexArray");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BindVertexArray);
+        ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_VERTEX_ARRAY, 0, array);
+    }
 }
 
 static inline void ngli_glBlendColor(const struct glcontext *gl, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
 {
     gl->funcs.BlendColor(red, green, blue, alpha);
     check_error_code(gl, "glBlendColor");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BlendColor);
 }
 
 static inline void ngli_glBlendEquation(const struct glcontext *gl, GLenum mode)
 {
     gl->funcs.BlendEquation(mode);
     check_error_code(gl, "glBlendEquation");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BlendEquation);
 }
 
 static inline void ngli_glBlendEquationSeparate(const struct glcontext *gl, GLenum modeRGB, GLenum modeAlpha)
 {
     gl->funcs.BlendEquationSeparate(modeRGB, modeAlpha);
     check_error_code(gl, "glBlendEquationSeparate");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BlendEquationSeparate);
 }
 
 static inline void ngli_glBlendFunc(const struct glcontext *gl, GLenum sfactor, GLenum dfactor)
 {
     gl->funcs.BlendFunc(sfactor, dfactor);
     check_error_code(gl, "glBlendFunc");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BlendFunc);
 }
 
 static inline void ngli_glBlendFuncSeparate(const struct glcontext *gl, GLenum sfactorRGB, GLenum dfactorRGB, GLenum sfactorAlpha, GLenum dfactorAlpha)
 {
     gl->funcs.BlendFuncSeparate(sfactorRGB, dfactorRGB, sfactorAlpha, dfactorAlpha);
     check_error_code(gl, "glBlendFuncSeparate");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BlendFuncSeparate);
 }
 
 static inline void ngli_glBlitFramebuffer(const struct glcontext *gl, GLint srcX0, GLint srcY0, GLint srcX1, GLint srcY1, GLint dstX0, GLint dstY0, GLint dstX1, GLint dstY1, GLbitfield mask, GLenum filter)
 {
     gl->funcs.BlitFramebuffer(srcX0, srcY0, srcX1, srcY1, dstX0, dstY0, dstX1, dstY1, mask, filter);
     check_error_code(gl, "glBlitFramebuffer");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BlitFramebuffer);
 }
 
 static inline void ngli_glBufferData(const struct glcontext *gl, GLenum target, GLsizeiptr size, const void * data, GLenum usage)
 {
     gl->funcs.BufferData(target, size, data, usage);
     check_error_code(gl, "glBufferData");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BufferData);
+        ngli_glstats_transfer(gl->glstats, data ? size : 0);
+    }
 }
 
 static inline void ngli_glBufferSubData(const struct glcontext *gl, GLenum target, GLintptr offset, GLsizeiptr size, const void * data)
 {
     gl->funcs.BufferSubData(target, offset, size, data);
     check_error_code(gl, "glBufferSubData");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_BufferSubData);
+        ngli_glstats_transfer(gl->glstats, size);
+    }
 }
 
 static inline GLenum ngli_glCheckFramebufferStatus(const struct glcontext *gl, GLenum target)
 {
     GLenum ret = gl->funcs.CheckFramebufferStatus(target);
     check_error_code(gl, "glCheckFramebufferStatus");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_CheckFramebufferStatus);
     return ret;
 }
 
@@ -145,18 +207,24 @@ static inline void ngli_glClear(const struct glcontext *gl, GLbitfield mask)
 {
     gl->funcs.Clear(mask);
     check_error_code(gl, "glClear");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Clear);
 }
 
 static inline void ngli_glClearColor(const struct glcontext *gl, GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha)
 {
     gl->funcs.ClearColor(red, green, blue, alpha);
     check_error_code(gl, "glClearColor");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ClearColor);
 }
 
 static inline GLenum ngli_glClientWaitSync(const struct glcontext *gl, GLsync sync, GLbitfield flags, GLuint64 timeout)
 {
     GLenum ret = gl->funcs.ClientWaitSync(sync, flags, timeout);
     check_error_code(gl, "glClientWaitSync");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ClientWaitSync);
     return ret;
 }
 
@@ -164,18 +232,24 @@ static inline void ngli_glColorMask(const struct glcontext *gl, GLboolean red, G
 {
     gl->funcs.ColorMask(red, green, blue, alpha);
     check_error_code(gl, "glColorMask");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ColorMask);
 }
 
 static inline void ngli_glCompileShader(const struct glcontext *gl, GLuint shader)
 {
     gl->funcs.CompileShader(shader);
     check_error_code(gl, "glCompileShader");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_CompileShader);
 }
 
 static inline GLuint ngli_glCreateProgram(const struct glcontext *gl)
 {
     GLuint ret = gl->funcs.CreateProgram();
     check_error_code(gl, "glCreateProgram");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_CreateProgram);
     return ret;
 }
 
@@ -183,6 +257,8 @@ static inline GLuint ngli_glCreateShader(const struct glcontext *gl, GLenum type
 {
     GLuint ret = gl->funcs.CreateShader(type);
     check_error_code(gl, "glCreateShader");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_CreateShader);
     return ret;
 }
 
@@ -190,156 +266,234 @@ static inline void ngli_glCullFace(const struct glcontext *gl, GLenum mode)
 {
     gl->funcs.CullFace(mode);
     check_error_code(gl, "glCullFace");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_CullFace);
 }
 
 static inline void ngli_glDeleteBuffers(const struct glcontext *gl, GLsizei n, const GLuint * buffers)
 {
     gl->funcs.DeleteBuffers(n, buffers);
     check_error_code(gl, "glDeleteBuffers");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteBuffers);
+        ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_BUFFER, n, buffers);
+    }
 }
 
 static inline void ngli_glDeleteFramebuffers(const struct glcontext *gl, GLsizei n, const GLuint * framebuffers)
 {
     gl->funcs.DeleteFramebuffers(n, framebuffers);
     check_error_code(gl, "glDeleteFramebuffers");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteFramebuffers);
+        ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_FRAMEBUFFER, n, framebuffers);
+    }
 }
 
 static inline void ngli_glDeleteProgram(const struct glcontext *gl, GLuint program)
 {
     gl->funcs.DeleteProgram(program);
     check_error_code(gl, "glDeleteProgram");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteProgram);
 }
 
 static inline void ngli_glDeleteQueries(const struct glcontext *gl, GLsizei n, const GLuint * ids)
 {
     gl->funcs.DeleteQueries(n, ids);
     check_error_code(gl, "glDeleteQueries");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteQueries);
 }
 
 static inline void ngli_glDeleteQueriesEXT(const struct glcontext *gl, GLsizei n, const GLuint * ids)
 {
     gl->funcs.DeleteQueriesEXT(n, ids);
     check_error_code(gl, "glDeleteQueriesEXT");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteQueriesEXT);
 }
 
 static inline void ngli_glDeleteRenderbuffers(const struct glcontext *gl, GLsizei n, const GLuint * renderbuffers)
 {
     gl->funcs.DeleteRenderbuffers(n, renderbuffers);
     check_error_code(gl, "glDeleteRenderbuffers");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteRenderbuffers);
+        ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_RENDERBUFFER, n, renderbuffers);
+    }
 }
 
 static inline void ngli_glDeleteShader(const struct glcontext *gl, GLuint shader)
 {
     gl->funcs.DeleteShader(shader);
     check_error_code(gl, "glDeleteShader");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteShader);
 }
 
 static inline void ngli_glDeleteTextures(const struct glcontext *gl, GLsizei n, const GLuint * textures)
 {
     gl->funcs.DeleteTextures(n, textures);
     check_error_code(gl, "glDeleteTextures");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteTextures);
+        ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_TEXTURE, n, textures);
+    }
 }
 
 static inline void ngli_glDeleteVertexArrays(const struct glcontext *gl, GLsizei n, const GLuint * arrays)
 {
     gl->funcs.DeleteVertexArrays(n, arrays);
     check_error_code(gl, "glDeleteVertexArrays");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DeleteVertexArrays);
+        ngli_glstats_delete(gl->glstats, NGLI_GLSTATS_BIND_VERTEX_ARRAY, n, arrays);
+    }
 }
 
 static inline void ngli_glDepthFunc(const struct glcontext *gl, GLenum func)
 {
     gl->funcs.DepthFunc(func);
     check_error_code(gl, "glDepthFunc");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DepthFunc);
 }
 
 static inline void ngli_glDepthMask(const struct glcontext *gl, GLboolean flag)
 {
     gl->funcs.DepthMask(flag);
     check_error_code(gl, "glDepthMask");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DepthMask);
 }
 
 static inline void ngli_glDetachShader(const struct glcontext *gl, GLuint program, GLuint shader)
 {
     gl->funcs.DetachShader(program, shader);
     check_error_code(gl, "glDetachShader");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DetachShader);
 }
 
 static inline void ngli_glDisable(const struct glcontext *gl, GLenum cap)
 {
     gl->funcs.Disable(cap);
     check_error_code(gl, "glDisable");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Disable);
 }
 
 static inline void ngli_glDisableVertexAttribArray(const struct glcontext *gl, GLuint index)
 {
     gl->funcs.DisableVertexAttribArray(index);
     check_error_code(gl, "glDisableVertexAttribArray");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DisableVertexAttribArray);
 }
 
 static inline void ngli_glDispatchCompute(const struct glcontext *gl, GLuint num_groups_x, GLuint num_groups_y, GLuint num_groups_z)
 {
     gl->funcs.DispatchCompute(num_groups_x, num_groups_y, num_groups_z);
     check_error_code(gl, "glDispatchCompute");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DispatchCompute);
 }
 
 static inline void ngli_glDrawArrays(const struct glcontext *gl, GLenum mode, GLint first, GLsizei count)
 {
     gl->funcs.DrawArrays(mode, first, count);
     check_error_code(gl, "glDrawArrays");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DrawArrays);
+}
+
+static inline void ngli_glDrawArraysIndirect(const struct glcontext *gl, GLenum mode, const void * indirect)
+{
+    gl->funcs.DrawArraysIndirect(mode, indirect);
+    check_error_code(gl, "glDrawArraysIndirect");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DrawArraysIndirect);
 }
 
 static inline void ngli_glDrawArraysInstanced(const struct glcontext *gl, GLenum mode, GLint first, GLsizei count, GLsizei instancecount)
 {
     gl->funcs.DrawArraysInstanced(mode, first, count, instancecount);
     check_error_code(gl, "glDrawArraysInstanced");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DrawArraysInstanced);
 }
 
 static inline void ngli_glDrawElements(const struct glcontext *gl, GLenum mode, GLsizei count, GLenum type, const void * indices)
 {
     gl->funcs.DrawElements(mode, count, type, indices);
     check_error_code(gl, "glDrawElements");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DrawElements);
+}
+
+static inline void ngli_glDrawElementsIndirect(const struct glcontext *gl, GLenum mode, GLenum type, const void * indirect)
+{
+    gl->funcs.DrawElementsIndirect(mode, type, indirect);
+    check_error_code(gl, "glDrawElementsIndirect");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DrawElementsIndirect);
 }
 
 static inline void ngli_glDrawElementsInstanced(const struct glcontext *gl, GLenum mode, GLsizei count, GLenum type, const void * indices, GLsizei instancecount)
 {
     gl->funcs.DrawElementsInstanced(mode, count, type, indices, instancecount);
     check_error_code(gl, "glDrawElementsInstanced");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_DrawElementsInstanced);
 }
 
 static inline void ngli_glEGLImageTargetTexture2DOES(const struct glcontext *gl, GLenum target, GLeglImageOES image)
 {
     gl->funcs.EGLImageTargetTexture2DOES(target, image);
     check_error_code(gl, "glEGLImageTargetTexture2DOES");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_EGLImageTargetTexture2DOES);
 }
 
 static inline void ngli_glEnable(const struct glcontext *gl, GLenum cap)
 {
     gl->funcs.Enable(cap);
     check_error_code(gl, "glEnable");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Enable);
 }
 
 static inline void ngli_glEnableVertexAttribArray(const struct glcontext *gl, GLuint index)
 {
     gl->funcs.EnableVertexAttribArray(index);
     check_error_code(gl, "glEnableVertexAttribArray");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_EnableVertexAttribArray);
 }
 
 static inline void ngli_glEndQuery(const struct glcontext *gl, GLenum target)
 {
     gl->funcs.EndQuery(target);
     check_error_code(gl, "glEndQuery");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_EndQuery);
 }
 
 static inline void ngli_glEndQueryEXT(const struct glcontext *gl, GLenum target)
 {
     gl->funcs.EndQueryEXT(target);
     check_error_code(gl, "glEndQueryEXT");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_EndQueryEXT);
 }
 
 static inline GLsync ngli_glFenceSync(const struct glcontext *gl, GLenum condition, GLbitfield flags)
 {
     GLsync ret = gl->funcs.FenceSync(condition, flags);
     check_error_code(gl, "glFenceSync");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_FenceSync);
     return ret;
 }
 
@@ -347,108 +501,144 @@ static inline void ngli_glFinish(const struct glcontext *gl)
 {
     gl->funcs.Finish();
     check_error_code(gl, "glFinish");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Finish);
 }
 
 static inline void ngli_glFlush(const struct glcontext *gl)
 {
     gl->funcs.Flush();
     check_error_code(gl, "glFlush");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Flush);
 }
 
 static inline void ngli_glFramebufferRenderbuffer(const struct glcontext *gl, GLenum target, GLenum attachment, GLenum renderbuffertarget, GLuint renderbuffer)
 {
     gl->funcs.FramebufferRenderbuffer(target, attachment, renderbuffertarget, renderbuffer);
     check_error_code(gl, "glFramebufferRenderbuffer");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_FramebufferRenderbuffer);
 }
 
 static inline void ngli_glFramebufferTexture2D(const struct glcontext *gl, GLenum target, GLenum attachment, GLenum textarget, GLuint texture, GLint level)
 {
     gl->funcs.FramebufferTexture2D(target, attachment, textarget, texture, level);
     check_error_code(gl, "glFramebufferTexture2D");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_FramebufferTexture2D);
 }
 
 static inline void ngli_glGenBuffers(const struct glcontext *gl, GLsizei n, GLuint * buffers)
 {
     gl->funcs.GenBuffers(n, buffers);
     check_error_code(gl, "glGenBuffers");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenBuffers);
 }
 
 static inline void ngli_glGenFramebuffers(const struct glcontext *gl, GLsizei n, GLuint * framebuffers)
 {
     gl->funcs.GenFramebuffers(n, framebuffers);
     check_error_code(gl, "glGenFramebuffers");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenFramebuffers);
 }
 
 static inline void ngli_glGenQueries(const struct glcontext *gl, GLsizei n, GLuint * ids)
 {
     gl->funcs.GenQueries(n, ids);
     check_error_code(gl, "glGenQueries");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenQueries);
 }
 
 static inline void ngli_glGenQueriesEXT(const struct glcontext *gl, GLsizei n, GLuint * ids)
 {
     gl->funcs.GenQueriesEXT(n, ids);
     check_error_code(gl, "glGenQueriesEXT");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenQueriesEXT);
 }
 
 static inline void ngli_glGenRenderbuffers(const struct glcontext *gl, GLsizei n, GLuint * renderbuffers)
 {
     gl->funcs.GenRenderbuffers(n, renderbuffers);
     check_error_code(gl, "glGenRenderbuffers");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenRenderbuffers);
 }
 
 static inline void ngli_glGenTextures(const struct glcontext *gl, GLsizei n, GLuint * textures)
 {
     gl->funcs.GenTextures(n, textures);
     check_error_code(gl, "glGenTextures");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenTextures);
 }
 
 static inline void ngli_glGenVertexArrays(const struct glcontext *gl, GLsizei n, GLuint * arrays)
 {
     gl->funcs.GenVertexArrays(n, arrays);
     check_error_code(gl, "glGenVertexArrays");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenVertexArrays);
 }
 
 static inline void ngli_glGenerateMipmap(const struct glcontext *gl, GLenum target)
 {
     gl->funcs.GenerateMipmap(target);
     check_error_code(gl, "glGenerateMipmap");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GenerateMipmap);
 }
 
 static inline void ngli_glGetActiveAttrib(const struct glcontext *gl, GLuint program, GLuint index, GLsizei bufSize, GLsizei * length, GLint * size, GLenum * type, GLchar * name)
 {
     gl->funcs.GetActiveAttrib(program, index, bufSize, length, size, type, name);
     check_error_code(gl, "glGetActiveAttrib");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetActiveAttrib);
 }
 
 static inline void ngli_glGetActiveUniform(const struct glcontext *gl, GLuint program, GLuint index, GLsizei bufSize, GLsizei * length, GLint * size, GLenum * type, GLchar * name)
 {
     gl->funcs.GetActiveUniform(program, index, bufSize, length, size, type, name);
     check_error_code(gl, "glGetActiveUniform");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetActiveUniform);
 }
 
 static inline void ngli_glGetActiveUniformBlockName(const struct glcontext *gl, GLuint program, GLuint uniformBlockIndex, GLsizei bufSize, GLsizei * length, GLchar * uniformBlockName)
 {
     gl->funcs.GetActiveUniformBlockName(program, uniformBlockIndex, bufSize, length, uniformBlockName);
     check_error_code(gl, "glGetActiveUniformBlockName");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetActiveUniformBlockName);
 }
 
 static inline void ngli_glGetActiveUniformBlockiv(const struct glcontext *gl, GLuint program, GLuint uniformBlockIndex, GLenum pname, GLint * params)
 {
     gl->funcs.GetActiveUniformBlockiv(program, uniformBlockIndex, pname, params);
     check_error_code(gl, "glGetActiveUniformBlockiv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetActiveUniformBlockiv);
 }
 
 static inline void ngli_glGetAttachedShaders(const struct glcontext *gl, GLuint program, GLsizei maxCount, GLsizei * count, GLuint * shaders)
 {
     gl->funcs.GetAttachedShaders(program, maxCount, count, shaders);
     check_error_code(gl, "glGetAttachedShaders");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetAttachedShaders);
 }
 
 static inline GLint ngli_glGetAttribLocation(const struct glcontext *gl, GLuint program, const GLchar * name)
 {
     GLint ret = gl->funcs.GetAttribLocation(program, name);
     check_error_code(gl, "glGetAttribLocation");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetAttribLocation);
     return ret;
 }
 
@@ -456,6 +646,8 @@ static inline void ngli_glGetBooleanv(const struct glcontext *gl, GLenum pname,
 {
     gl->funcs.GetBooleanv(pname, data);
     check_error_code(gl, "glGetBooleanv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetBooleanv);
 }
 
 static inline GLenum ngli_glGetError(const struct glcontext *gl)
@@ -467,36 +659,56 @@ static inline void ngli_glGetIntegeri_v(const struct glcontext *gl, GLenum targe
 {
     gl->funcs.GetIntegeri_v(target, index, data);
     check_error_code(gl, "glGetIntegeri_v");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetIntegeri_v);
 }
 
 static inline void ngli_glGetIntegerv(const struct glcontext *gl, GLenum pname, GLint * data)
 {
     gl->funcs.GetIntegerv(pname, data);
     check_error_code(gl, "glGetIntegerv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetIntegerv);
 }
 
 static inline void ngli_glGetInternalformativ(const struct glcontext *gl, GLenum target, GLenum internalformat, GLenum pname, GLsizei bufSize, GLint * params)
 {
     gl->funcs.GetInternalformativ(target, internalformat, pname, bufSize, params);
     check_error_code(gl, "glGetInternalformativ");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetInternalformativ);
+}
+
+static inline void ngli_glGetProgramBinary(const struct glcontext *gl, GLuint program, GLsizei bufSize, GLsizei * length, GLenum * binaryFormat, void * binary)
+{
+    gl->funcs.GetProgramBinary(program, bufSize, length, binaryFormat, binary);
+    check_error_code(gl, "glGetProgramBinary");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramBinary);
 }
 
 static inline void ngli_glGetProgramInfoLog(const struct glcontext *gl, GLuint program, GLsizei bufSize, GLsizei * length, GLchar * infoLog)
 {
     gl->funcs.GetProgramInfoLog(program, bufSize, length, infoLog);
     check_error_code(gl, "glGetProgramInfoLog");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramInfoLog);
 }
 
 static inline void ngli_glGetProgramInterfaceiv(const struct glcontext *gl, GLuint program, GLenum programInterface, GLenum pname, GLint * params)
 {
     gl->funcs.GetProgramInterfaceiv(program, programInterface, pname, params);
     check_error_code(gl, "glGetProgramInterfaceiv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramInterfaceiv);
 }
 
 static inline GLuint ngli_glGetProgramResourceIndex(const struct glcontext *gl, GLuint program, GLenum programInterface, const GLchar * name)
 {
     GLuint ret = gl->funcs.GetProgramResourceIndex(program, programInterface, name);
     check_error_code(gl, "glGetProgramResourceIndex");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramResourceIndex);
     return ret;
 }
 
@@ -504,6 +716,8 @@ static inline GLint ngli_glGetProgramResourceLocation(const struct glcontext *gl
 {
     GLint ret = gl->funcs.GetProgramResourceLocation(program, programInterface, name);
     check_error_code(gl, "glGetProgramResourceLocation");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramResourceLocation);
     return ret;
 }
 
@@ -511,60 +725,80 @@ static inline void ngli_glGetProgramResourceName(const struct glcontext *gl, GLu
 {
     gl->funcs.GetProgramResourceName(program, programInterface, index, bufSize, length, name);
     check_error_code(gl, "glGetProgramResourceName");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramResourceName);
 }
 
 static inline void ngli_glGetProgramResourceiv(const struct glcontext *gl, GLuint program, GLenum programInterface, GLuint index, GLsizei propCount, const GLenum * props, GLsizei bufSize, GLsizei * length, GLint * params)
 {
     gl->funcs.GetProgramResourceiv(program, programInterface, index, propCount, props, bufSize, length, params);
     check_error_code(gl, "glGetProgramResourceiv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramResourceiv);
 }
 
 static inline void ngli_glGetProgramiv(const struct glcontext *gl, GLuint program, GLenum pname, GLint * params)
 {
     gl->funcs.GetProgramiv(program, pname, params);
     check_error_code(gl, "glGetProgramiv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetProgramiv);
 }
 
 static inline void ngli_glGetQueryObjectui64v(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 * params)
 {
     gl->funcs.GetQueryObjectui64v(id, pname, params);
     check_error_code(gl, "glGetQueryObjectui64v");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetQueryObjectui64v);
 }
 
 static inline void ngli_glGetQueryObjectui64vEXT(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 * params)
 {
     gl->funcs.GetQueryObjectui64vEXT(id, pname, params);
     check_error_code(gl, "glGetQueryObjectui64vEXT");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetQueryObjectui64vEXT);
 }
 
 static inline void ngli_glGetRenderbufferParameteriv(const struct glcontext *gl, GLenum target, GLenum pname, GLint * params)
 {
     gl->funcs.GetRenderbufferParameteriv(target, pname, params);
     check_error_code(gl, "glGetRenderbufferParameteriv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetRenderbufferParameteriv);
 }
 
 static inline void ngli_glGetShaderInfoLog(const struct glcontext *gl, GLuint shader, GLsizei bufSize, GLsizei * length, GLchar * infoLog)
 {
     gl->funcs.GetShaderInfoLog(shader, bufSize, length, infoLog);
     check_error_code(gl, "glGetShaderInfoLog");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetShaderInfoLog);
 }
 
 static inline void ngli_glGetShaderSource(const struct glcontext *gl, GLuint shader, GLsizei bufSize, GLsizei * length, GLchar * source)
 {
     gl->funcs.GetShaderSource(shader, bufSize, length, source);
     check_error_code(gl, "glGetShaderSource");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetShaderSource);
 }
 
 static inline void ngli_glGetShaderiv(const struct glcontext *gl, GLuint shader, GLenum pname, GLint * params)
 {
     gl->funcs.GetShaderiv(shader, pname, params);
     check_error_code(gl, "glGetShaderiv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetShaderiv);
 }
 
 static inline const GLubyte * ngli_glGetString(const struct glcontext *gl, GLenum name)
 {
     const GLubyte * ret = gl->funcs.GetString(name);
     check_error_code(gl, "glGetString");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetString);
     return ret;
 }
 
@@ -572,6 +806,8 @@ static inline const GLubyte * ngli_glGetStringi(const struct glcontext *gl, GLen
 {
     const GLubyte * ret = gl->funcs.GetStringi(name, index);
     check_error_code(gl, "glGetStringi");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetStringi);
     return ret;
 }
 
@@ -579,6 +815,8 @@ static inline GLuint ngli_glGetUniformBlockIndex(const struct glcontext *gl, GLu
 {
     GLuint ret = gl->funcs.GetUniformBlockIndex(program, uniformBlockName);
     check_error_code(gl, "glGetUniformBlockIndex");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetUniformBlockIndex);
     return ret;
 }
 
@@ -586,6 +824,8 @@ static inline GLint ngli_glGetUniformLocation(const struct glcontext *gl, GLuint
 {
     GLint ret = gl->funcs.GetUniformLocation(program, name);
     check_error_code(gl, "glGetUniformLocation");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetUniformLocation);
     return ret;
 }
 
@@ -593,298 +833,474 @@ static inline void ngli_glGetUniformiv(const struct glcontext *gl, GLuint progra
 {
     gl->funcs.GetUniformiv(program, location, params);
     check_error_code(gl, "glGetUniformiv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_GetUniformiv);
 }
 
 static inline void ngli_glInvalidateFramebuffer(const struct glcontext *gl, GLenum target, GLsizei numAttachments, const GLenum * attachments)
 {
     gl->funcs.InvalidateFramebuffer(target, numAttachments, attachments);
     check_error_code(gl, "glInvalidateFramebuffer");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_InvalidateFramebuffer);
 }
 
 static inline void ngli_glLinkProgram(const struct glcontext *gl, GLuint program)
 {
     gl->funcs.LinkProgram(program);
     check_error_code(gl, "glLinkProgram");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_LinkProgram);
+}
+
+static inline void ngli_glMaxShaderCompilerThreadsKHR(const struct glcontext *gl, GLuint count)
+{
+    gl->funcs.MaxShaderCompilerThreadsKHR(count);
+    check_error_code(gl, "glMaxShaderCompilerThreadsKHR");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_MaxShaderCompilerThreadsKHR);
 }
 
 static inline void ngli_glMemoryBarrier(const struct glcontext *gl, GLbitfield barriers)
 {
     gl->funcs.MemoryBarrier(barriers);
     check_error_code(gl, "glMemoryBarrier");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_MemoryBarrier);
+}
+
+static inline void ngli_glMultiDrawArraysIndirect(const struct glcontext *gl, GLenum mode, const void * indirect, GLsizei drawcount, GLsizei stride)
+{
+    gl->funcs.MultiDrawArraysIndirect(mode, indirect, drawcount, stride);
+    check_error_code(gl, "glMultiDrawArraysIndirect");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_MultiDrawArraysIndirect);
+}
+
+static inline void ngli_glMultiDrawElementsIndirect(const struct glcontext *gl, GLenum mode, GLenum type, const void * indirect, GLsizei drawcount, GLsizei stride)
+{
+    gl->funcs.MultiDrawElementsIndirect(mode, type, indirect, drawcount, stride);
+    check_error_code(gl, "glMultiDrawElementsIndirect");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_MultiDrawElementsIndirect);
 }
 
 static inline void ngli_glPolygonMode(const struct glcontext *gl, GLenum face, GLenum mode)
 {
     gl->funcs.PolygonMode(face, mode);
     check_error_code(gl, "glPolygonMode");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_PolygonMode);
+}
+
+static inline void ngli_glProgramBinary(const struct glcontext *gl, GLuint program, GLenum binaryFormat, const void * binary, GLsizei length)
+{
+    gl->funcs.ProgramBinary(program, binaryFormat, binary, length);
+    check_error_code(gl, "glProgramBinary");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ProgramBinary);
+}
+
+static inline void ngli_glProgramParameteri(const struct glcontext *gl, GLuint program, GLenum pname, GLint value)
+{
+    gl->funcs.ProgramParameteri(program, pname, value);
+    check_error_code(gl, "glProgramParameteri");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ProgramParameteri);
+}
+
+static inline void ngli_glQueryCounter(const struct glcontext *gl, GLuint id, GLenum target)
+{
+    gl->funcs.QueryCounter(id, target);
+    check_error_code(gl, "glQueryCounter");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_QueryCounter);
+}
+
+static inline void ngli_glQueryCounterEXT(const struct glcontext *gl, GLuint id, GLenum target)
+{
+    gl->funcs.QueryCounterEXT(id, target);
+    check_error_code(gl, "glQueryCounterEXT");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_QueryCounterEXT);
 }
 
 static inline void ngli_glReadPixels(const struct glcontext *gl, GLint x, GLint y, GLsizei width, GLsizei height, GLenum format, GLenum type, void * pixels)
 {
     gl->funcs.ReadPixels(x, y, width, height, format, type, pixels);
     check_error_code(gl, "glReadPixels");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ReadPixels);
+        ngli_glstats_transfer(gl->glstats, ngli_glstats_get_image_size(format, type, width, height, 1));
+    }
 }
 
 static inline void ngli_glReleaseShaderCompiler(const struct glcontext *gl)
 {
     gl->funcs.ReleaseShaderCompiler();
     check_error_code(gl, "glReleaseShaderCompiler");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ReleaseShaderCompiler);
 }
 
 static inline void ngli_glRenderbufferStorage(const struct glcontext *gl, GLenum target, GLenum internalformat, GLsizei width, GLsizei height)
 {
     gl->funcs.RenderbufferStorage(target, internalformat, width, height);
     check_error_code(gl, "glRenderbufferStorage");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_RenderbufferStorage);
 }
 
 static inline void ngli_glRenderbufferStorageMultisample(const struct glcontext *gl, GLenum target, GLsizei samples, GLenum internalformat, GLsizei width, GLsizei height)
 {
     gl->funcs.RenderbufferStorageMultisample(target, samples, internalformat, width, height);
     check_error_code(gl, "glRenderbufferStorageMultisample");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_RenderbufferStorageMultisample);
 }
 
 static inline void ngli_glShaderBinary(const struct glcontext *gl, GLsizei count, const GLuint * shaders, GLenum binaryformat, const void * binary, GLsizei length)
 {
     gl->funcs.ShaderBinary(count, shaders, binaryformat, binary, length);
     check_error_code(gl, "glShaderBinary");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ShaderBinary);
 }
 
 static inline void ngli_glShaderSource(const struct glcontext *gl, GLuint shader, GLsizei count, const GLchar *const* string, const GLint * length)
 {
     gl->funcs.ShaderSource(shader, count, string, length);
     check_error_code(gl, "glShaderSource");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ShaderSource);
 }
 
 static inline void ngli_glShaderStorageBlockBinding(const struct glcontext *gl, GLuint program, GLuint storageBlockIndex, GLuint storageBlockBinding)
 {
     gl->funcs.ShaderStorageBlockBinding(program, storageBlockIndex, storageBlockBinding);
     check_error_code(gl, "glShaderStorageBlockBinding");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_ShaderStorageBlockBinding);
 }
 
 static inline void ngli_glStencilFunc(const struct glcontext *gl, GLenum func, GLint ref, GLuint mask)
 {
     gl->funcs.StencilFunc(func, ref, mask);
     check_error_code(gl, "glStencilFunc");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_StencilFunc);
 }
 
 static inline void ngli_glStencilFuncSeparate(const struct glcontext *gl, GLenum face, GLenum func, GLint ref, GLuint mask)
 {
     gl->funcs.StencilFuncSeparate(face, func, ref, mask);
     check_error_code(gl, "glStencilFuncSeparate");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_StencilFuncSeparate);
 }
 
 static inline void ngli_glStencilMask(const struct glcontext *gl, GLuint mask)
 {
     gl->funcs.StencilMask(mask);
     check_error_code(gl, "glStencilMask");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_StencilMask);
 }
 
 static inline void ngli_glStencilMaskSeparate(const struct glcontext *gl, GLenum face, GLuint mask)
 {
     gl->funcs.StencilMaskSeparate(face, mask);
     check_error_code(gl, "glStencilMaskSeparate");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_StencilMaskSeparate);
 }
 
 static inline void ngli_glStencilOp(const struct glcontext *gl, GLenum fail, GLenum zfail, GLenum zpass)
 {
     gl->funcs.StencilOp(fail, zfail, zpass);
     check_error_code(gl, "glStencilOp");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_StencilOp);
 }
 
 static inline void ngli_glStencilOpSeparate(const struct glcontext *gl, GLenum face, GLenum sfail, GLenum dpfail, GLenum dppass)
 {
     gl->funcs.StencilOpSeparate(face, sfail, dpfail, dppass);
     check_error_code(gl, "glStencilOpSeparate");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_StencilOpSeparate);
 }
 
 static inline void ngli_glTexImage2D(const struct glcontext *gl, GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLint border, GLenum format, GLenum type, const void * pixels)
 {
     gl->funcs.TexImage2D(target, level, internalformat, width, height, border, format, type, pixels);
     check_error_code(gl, "glTexImage2D");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_TexImage2D);
+        ngli_glstats_transfer(gl->glstats, pixels ? ngli_glstats_get_image_size(format, type, width, height, 1) : 0);
+    }
 }
 
 static inline void ngli_glTexImage3D(const struct glcontext *gl, GLenum target, GLint level, GLint internalformat, GLsizei width, GLsizei height, GLsizei depth, GLint border, GLenum format, GLenum type, const void * pixels)
 {
     gl->funcs.TexImage3D(target, level, internalformat, width, height, depth, border, format, type, pixels);
     check_error_code(gl, "glTexImage3D");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_TexImage3D);
+        ngli_glstats_transfer(gl->glstats, pixels ? ngli_glstats_get_image_size(format, type, width, height, depth) : 0);
+    }
 }
 
 static inline void ngli_glTexParameteri(const struct glcontext *gl, GLenum target, GLenum pname, GLint param)
 {
     gl->funcs.TexParameteri(target, pname, param);
     check_error_code(gl, "glTexParameteri");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_TexParameteri);
 }
 
 static inline void ngli_glTexStorage2D(const struct glcontext *gl, GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height)
 {
     gl->funcs.TexStorage2D(target, levels, internalformat, width, height);
     check_error_code(gl, "glTexStorage2D");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_TexStorage2D);
 }
 
 static inline void ngli_glTexStorage3D(const struct glcontext *gl, GLenum target, GLsizei levels, GLenum internalformat, GLsizei width, GLsizei height, GLsizei depth)
 {
     gl->funcs.TexStorage3D(target, levels, internalformat, width, height, depth);
     check_error_code(gl, "glTexStorage3D");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_TexStorage3D);
 }
 
 static inline void ngli_glTexSubImage2D(const struct glcontext *gl, GLenum target, GLint level, GLint xoffset, GLint yoffset, GLsizei width, GLsizei height, GLenum format, GLenum type, const void * pixels)
 {
     gl->funcs.TexSubImage2D(target, level, xoffset, yoffset, width, height, format, type, pixels);
     check_error_code(gl, "glTexSubImage2D");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_TexSubImage2D);
+        ngli_glstats_transfer(gl->glstats, ngli_glstats_get_image_size(format, type, width, height, 1));
+    }
 }
 
 static inline void ngli_glTexSubImage3D(const struct glcontext *gl, GLenum target, GLint level, GLint xoffset, GLint yoffset, GLint zoffset, GLsizei width, GLsizei height, GLsizei depth, GLenum format, GLenum type, const void * pixels)
 {
     gl->funcs.TexSubImage3D(target, level, xoffset, yoffset, zoffset, width, height, depth, format, type, pixels);
     check_error_code(gl, "glTexSubImage3D");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_TexSubImage3D);
+        ngli_glstats_transfer(gl->glstats, ngli_glstats_get_image_size(format, type, width, height, depth));
+    }
 }
 
 static inline void ngli_glUniform1f(const struct glcontext *gl, GLint location, GLfloat v0)
 {
     gl->funcs.Uniform1f(location, v0);
     check_error_code(gl, "glUniform1f");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform1f);
 }
 
 static inline void ngli_glUniform1fv(const struct glcontext *gl, GLint location, GLsizei count, const GLfloat * value)
 {
     gl->funcs.Uniform1fv(location, count, value);
     check_error_code(gl, "glUniform1fv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform1fv);
 }
 
 static inline void ngli_glUniform1i(const struct glcontext *gl, GLint location, GLint v0)
 {
     gl->funcs.Uniform1i(location, v0);
     check_error_code(gl, "glUniform1i");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform1i);
 }
 
 static inline void ngli_glUniform1iv(const struct glcontext *gl, GLint location, GLsizei count, const GLint * value)
 {
     gl->funcs.Uniform1iv(location, count, value);
     check_error_code(gl, "glUniform1iv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform1iv);
 }
 
 static inline void ngli_glUniform2f(const struct glcontext *gl, GLint location, GLfloat v0, GLfloat v1)
 {
     gl->funcs.Uniform2f(location, v0, v1);
     check_error_code(gl, "glUniform2f");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform2f);
 }
 
 static inline void ngli_glUniform2fv(const struct glcontext *gl, GLint location, GLsizei count, const GLfloat * value)
 {
     gl->funcs.Uniform2fv(location, count, value);
     check_error_code(gl, "glUniform2fv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform2fv);
 }
 
 static inline void ngli_glUniform2i(const struct glcontext *gl, GLint location, GLint v0, GLint v1)
 {
     gl->funcs.Uniform2i(location, v0, v1);
     check_error_code(gl, "glUniform2i");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform2i);
 }
 
 static inline void ngli_glUniform2iv(const struct glcontext *gl, GLint location, GLsizei count, const GLint * value)
 {
     gl->funcs.Uniform2iv(location, count, value);
     check_error_code(gl, "glUniform2iv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform2iv);
 }
 
 static inline void ngli_glUniform3f(const struct glcontext *gl, GLint location, GLfloat v0, GLfloat v1, GLfloat v2)
 {
     gl->funcs.Uniform3f(location, v0, v1, v2);
     check_error_code(gl, "glUniform3f");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform3f);
 }
 
 static inline void ngli_glUniform3fv(const struct glcontext *gl, GLint location, GLsizei count, const GLfloat * value)
 {
     gl->funcs.Uniform3fv(location, count, value);
     check_error_code(gl, "glUniform3fv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform3fv);
 }
 
 static inline void ngli_glUniform3i(const struct glcontext *gl, GLint location, GLint v0, GLint v1, GLint v2)
 {
     gl->funcs.Uniform3i(location, v0, v1, v2);
     check_error_code(gl, "glUniform3i");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform3i);
 }
 
 static inline void ngli_glUniform3iv(const struct glcontext *gl, GLint location, GLsizei count, const GLint * value)
 {
     gl->funcs.Uniform3iv(location, count, value);
     check_error_code(gl, "glUniform3iv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform3iv);
 }
 
 static inline void ngli_glUniform4f(const struct glcontext *gl, GLint location, GLfloat v0, GLfloat v1, GLfloat v2, GLfloat v3)
 {
     gl->funcs.Uniform4f(location, v0, v1, v2, v3);
     check_error_code(gl, "glUniform4f");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform4f);
 }
 
 static inline void ngli_glUniform4fv(const struct glcontext *gl, GLint location, GLsizei count, const GLfloat * value)
 {
     gl->funcs.Uniform4fv(location, count, value);
     check_error_code(gl, "glUniform4fv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform4fv);
 }
 
 static inline void ngli_glUniform4i(const struct glcontext *gl, GLint location, GLint v0, GLint v1, GLint v2, GLint v3)
 {
     gl->funcs.Uniform4i(location, v0, v1, v2, v3);
     check_error_code(gl, "glUniform4i");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform4i);
 }
 
 static inline void ngli_glUniform4iv(const struct glcontext *gl, GLint location, GLsizei count, const GLint * value)
 {
     gl->funcs.Uniform4iv(location, count, value);
     check_error_code(gl, "glUniform4iv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Uniform4iv);
 }
 
 static inline void ngli_glUniformBlockBinding(const struct glcontext *gl, GLuint program, GLuint uniformBlockIndex, GLuint uniformBlockBinding)
 {
     gl->funcs.UniformBlockBinding(program, uniformBlockIndex, uniformBlockBinding);
     check_error_code(gl, "glUniformBlockBinding");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_UniformBlockBinding);
 }
 
 static inline void ngli_glUniformMatrix2fv(const struct glcontext *gl, GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
 {
     gl->funcs.UniformMatrix2fv(location, count, transpose, value);
     check_error_code(gl, "glUniformMatrix2fv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_UniformMatrix2fv);
 }
 
 static inline void ngli_glUniformMatrix3fv(const struct glcontext *gl, GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
 {
     gl->funcs.UniformMatrix3fv(location, count, transpose, value);
     check_error_code(gl, "glUniformMatrix3fv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_UniformMatrix3fv);
 }
 
 static inline void ngli_glUniformMatrix4fv(const struct glcontext *gl, GLint location, GLsizei count, GLboolean transpose, const GLfloat * value)
 {
     gl->funcs.UniformMatrix4fv(location, count, transpose, value);
     check_error_code(gl, "glUniformMatrix4fv");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_UniformMatrix4fv);
 }
 
 static inline void ngli_glUseProgram(const struct glcontext *gl, GLuint program)
 {
     gl->funcs.UseProgram(program);
     check_error_code(gl, "glUseProgram");
+    if (gl->glstats) {
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_UseProgram);
+        ngli_glstats_bind(gl->glstats, NGLI_GLSTATS_BIND_PROGRAM, 0, program);
+    }
 }
 
 static inline void ngli_glVertexAttribDivisor(const struct glcontext *gl, GLuint index, GLuint divisor)
 {
     gl->funcs.VertexAttribDivisor(index, divisor);
     check_error_code(gl, "glVertexAttribDivisor");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_VertexAttribDivisor);
+}
+
+static inline void ngli_glVertexAttribIPointer(const struct glcontext *gl, GLuint index, GLint size, GLenum type, GLsizei stride, const void * pointer)
+{
+    gl->funcs.VertexAttribIPointer(index, size, type, stride, pointer);
+    check_error_code(gl, "glVertexAttribIPointer");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_VertexAttribIPointer);
 }
 
 static inline void ngli_glVertexAttribPointer(const struct glcontext *gl, GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void * pointer)
 {
     gl->funcs.VertexAttribPointer(index, size, type, normalized, stride, pointer);
     check_error_code(gl, "glVertexAttribPointer");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_VertexAttribPointer);
 }
 
 static inline void ngli_glViewport(const struct glcontext *gl, GLint x, GLint y, GLsizei width, GLsizei height)
 {
     gl->funcs.Viewport(x, y, width, height);
     check_error_code(gl, "glViewport");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_Viewport);
 }
 
 static inline void ngli_glWaitSync(const struct glcontext *gl, GLsync sync, GLbitfield flags, GLuint64 timeout)
 {
     gl->funcs.WaitSync(sync, flags, timeout);
     check_error_code(gl, "glWaitSync");
+    if (gl->glstats)
+        ngli_glstats_record_call(gl->glstats, NGLI_GLCALL_WaitSync);
 }
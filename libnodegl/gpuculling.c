@@ -0,0 +1,309 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "darray.h"
+#include "format.h"
+#include "gpuculling.h"
+#include "log.h"
+#include "math_utils.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "utils.h"
+
+/* GL only guarantees 8 shader storage blocks in compute shaders: one is used
+ * by the draw command, and each attribute needs an input and an output */
+#define MAX_ATTRIBUTES 3
+#define LOCAL_SIZE 64
+
+struct culled_attribute {
+    struct ngl_node *input;                 // instance attribute of the Render node
+    struct ngl_node *output;                // compacted instance attribute
+};
+
+struct gpuculling {
+    struct ngl_ctx *ctx;
+    const struct render_priv *render;
+    struct culled_attribute attributes[MAX_ATTRIBUTES];
+    int nb_attributes;
+    struct ngl_node *command;               // indirect draw command
+    struct ngl_node *mvp_matrix;
+    struct ngl_node *bounds;                // center and radius of the geometry bounding sphere
+    struct ngl_node *compute;
+};
+
+static char *build_compute_shader(const struct gpuculling *s, int offset_index, int nb_instances)
+{
+    struct glcontext *gl = s->ctx->glcontext;
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+
+    if (gl->backend == NGL_BACKEND_OPENGLES)
+        ngli_bstr_print(b, "#version 310 es\n"
+                           "precision highp float;\n");
+    else
+        ngli_bstr_print(b, "#version 430\n");
+
+    ngli_bstr_print(b, "layout(local_size_x = %d) in;\n"
+                       "uniform mat4 mvp_matrix;\n"
+                       "uniform vec4 bounds;\n"
+                       "layout(std430) buffer draw_command { uint count; uint nb_instances; };\n",
+                    LOCAL_SIZE);
+
+    for (int i = 0; i < s->nb_attributes; i++)
+        ngli_bstr_print(b, "layout(std430) readonly buffer input_%d { float input_%d_data[]; };\n"
+                           "layout(std430) writeonly buffer output_%d { float output_%d_data[]; };\n",
+                        i, i, i, i);
+
+    /* The inputs are read with their own stride, the outputs are packed */
+    const struct buffer_priv *offsets = s->attributes[offset_index].input->priv_data;
+    const int comp = offsets->data_comp;
+    const int stride = offsets->data_stride / sizeof(float);
+    ngli_bstr_print(b, "void main()\n"
+                       "{\n"
+                       "    uint id = gl_GlobalInvocationID.x;\n"
+                       "    if (id >= %du)\n"
+                       "        return;\n"
+                       "    vec3 offset = vec3(0.0);\n",
+                    nb_instances);
+    for (int c = 0; c < NGLI_MIN(comp, 3); c++)
+        ngli_bstr_print(b, "    offset[%d] = input_%d_data[id * %du + %du];\n", c, offset_index, stride, c);
+
+    /* Frustum planes extracted from the rows of the MVP matrix */
+    ngli_bstr_print(b, "    vec3 center = bounds.xyz + offset;\n"
+                       "    mat4 rows = transpose(mvp_matrix);\n"
+                       "    for (int i = 0; i < 6; i++) {\n"
+                       "        vec4 plane = rows[3] + (i %% 2 == 0 ? rows[i / 2] : -rows[i / 2]);\n"
+                       "        if (dot(plane.xyz, center) + plane.w < -bounds.w * length(plane.xyz))\n"
+                       "            return;\n"
+                       "    }\n"
+                       "    uint index = atomicAdd(nb_instances, 1u);\n");
+
+    for (int i = 0; i < s->nb_attributes; i++) {
+        const struct buffer_priv *input = s->attributes[i].input->priv_data;
+        ngli_bstr_print(b, "    for (uint c = 0u; c < %du; c++)\n"
+                           "        output_%d_data[index * %du + c] = input_%d_data[id * %du + c];\n",
+                        input->data_comp, i, input->data_comp, i,
+                        (int)(input->data_stride / sizeof(float)));
+    }
+    ngli_bstr_print(b, "}\n");
+
+    char *shader = ngli_bstr_strdup(b);
+    ngli_bstr_freep(&b);
+    return shader;
+}
+
+static int init_compute(struct gpuculling *s, int offset_index, int nb_instances)
+{
+    char *shader = build_compute_shader(s, offset_index, nb_instances);
+    if (!shader)
+        return -1;
+
+    int ret = -1;
+    const int nb_groups = (nb_instances + LOCAL_SIZE - 1) / LOCAL_SIZE;
+    struct ngl_node *program = ngl_node_create(NGL_NODE_COMPUTEPROGRAM, shader);
+    if (!program)
+        goto end;
+    s->compute = ngl_node_create(NGL_NODE_COMPUTE, nb_groups, 1, 1, program);
+    if (!s->compute)
+        goto end;
+
+    if ((ret = ngl_node_param_set(s->compute, "uniforms", "mvp_matrix", s->mvp_matrix)) < 0 ||
+        (ret = ngl_node_param_set(s->compute, "uniforms", "bounds", s->bounds)) < 0 ||
+        (ret = ngl_node_param_set(s->compute, "buffers", "draw_command", s->command)) < 0)
+        goto end;
+
+    for (int i = 0; i < s->nb_attributes; i++) {
+        char name[MAX_ID_LEN];
+        snprintf(name, sizeof(name), "input_%d", i);
+        if ((ret = ngl_node_param_set(s->compute, "buffers", name, s->attributes[i].input)) < 0)
+            goto end;
+        snprintf(name, sizeof(name), "output_%d", i);
+        if ((ret = ngl_node_param_set(s->compute, "buffers", name, s->attributes[i].output)) < 0)
+            goto end;
+    }
+
+    ret = ngli_node_attach_ctx(s->compute, s->ctx);
+
+end:
+    /* Only an attached compute node is detached at free time */
+    if (ret < 0)
+        ngl_node_unrefp(&s->compute);
+    ngl_node_unrefp(&program);
+    ngli_free(shader);
+    return ret;
+}
+
+struct gpuculling *ngli_gpuculling_create(struct ngl_node *render, const char *offset_attribute)
+{
+    struct gpuculling *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->ctx = render->ctx;
+    s->render = render->priv_data;
+
+    const struct darray *pairs_array = &s->render->instance_attribute_pairs;
+    const struct nodeprograminfopair *pairs = ngli_darray_data(pairs_array);
+    const int nb_pairs = ngli_darray_count(pairs_array);
+    if (nb_pairs > MAX_ATTRIBUTES) {
+        LOG(ERROR, "instance culling supports at most %d instance attributes (got %d)",
+            MAX_ATTRIBUTES, nb_pairs);
+        goto fail;
+    }
+
+    int offset_index = -1;
+    const int nb_instances = s->render->nb_instances;
+    for (int i = 0; i < nb_pairs; i++) {
+        const struct nodeprograminfopair *pair = &pairs[i];
+        const struct buffer_priv *buffer = pair->node->priv_data;
+        GLenum type;
+        ngli_format_get_gl_vertex_format(s->ctx->glcontext, buffer->data_format, &type, NULL);
+        if (type != GL_FLOAT) {
+            LOG(ERROR, "instance culling only supports float instance attributes (%s)", pair->name);
+            goto fail;
+        }
+        if (buffer->data_stride % sizeof(float) ||
+            buffer->data_stride < buffer->data_comp * sizeof(float)) {
+            LOG(ERROR, "instance culling does not support the stride (%d) of %s",
+                buffer->data_stride, pair->name);
+            goto fail;
+        }
+
+        struct culled_attribute *attribute = &s->attributes[s->nb_attributes++];
+        attribute->input = ngl_node_ref(pair->node);
+        if (!strcmp(pair->name, offset_attribute))
+            offset_index = i;
+
+        attribute->output = ngl_node_create(pair->node->class->id);
+        if (!attribute->output ||
+            ngl_node_param_set(attribute->output, "count", nb_instances) < 0 ||
+            ngl_node_param_set(attribute->output, "usage", "dynamic_copy") < 0)
+            goto fail;
+    }
+
+    if (offset_index < 0) {
+        LOG(ERROR, "instance culling attribute %s is not an active instance attribute",
+            offset_attribute);
+        goto fail;
+    }
+
+    const struct buffer_priv *offsets = s->attributes[offset_index].input->priv_data;
+    if (offsets->data_comp < 2) {
+        LOG(ERROR, "instance culling attribute %s must have at least 2 components",
+            offset_attribute);
+        goto fail;
+    }
+
+    const struct geometry_priv *geometry = s->render->geometry->priv_data;
+    const struct ngl_node *elements = geometry->indices_buffer ? geometry->indices_buffer
+                                                               : geometry->vertices_buffer;
+    const struct buffer_priv *elements_priv = elements->priv_data;
+    const uint32_t command[5] = {elements_priv->count};
+
+    s->command    = ngl_node_create(NGL_NODE_BUFFERUINT);
+    s->mvp_matrix = ngl_node_create(NGL_NODE_UNIFORMMAT4);
+    s->bounds     = ngl_node_create(NGL_NODE_UNIFORMVEC4);
+    if (!s->command || !s->mvp_matrix || !s->bounds ||
+        ngl_node_param_set(s->command, "data", (int)sizeof(command), command) < 0 ||
+        ngl_node_param_set(s->command, "usage", "dynamic_draw") < 0)
+        goto fail;
+
+    if (init_compute(s, offset_index, nb_instances) < 0)
+        goto fail;
+
+    return s;
+
+fail:
+    ngli_gpuculling_freep(&s);
+    return NULL;
+}
+
+int ngli_gpuculling_update(struct gpuculling *s, double t)
+{
+    return ngli_node_update(s->compute, t);
+}
+
+struct ngl_node *ngli_gpuculling_get_output(struct gpuculling *s, const struct ngl_node *input)
+{
+    for (int i = 0; i < s->nb_attributes; i++)
+        if (s->attributes[i].input == input)
+            return s->attributes[i].output;
+    return NULL;
+}
+
+GLuint ngli_gpuculling_run(struct gpuculling *s)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    const float *modelview_matrix = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+
+    NGLI_ALIGNED_MAT(mvp_matrix);
+    ngli_mat4_mul(mvp_matrix, projection_matrix, modelview_matrix);
+    struct uniform_priv *mvp = s->mvp_matrix->priv_data;
+    memcpy(mvp->matrix, mvp_matrix, sizeof(mvp->matrix));
+
+    /* The geometry bounds may change with animated vertices */
+    const struct geometry_priv *geometry = s->render->geometry->priv_data;
+    struct uniform_priv *bounds = s->bounds->priv_data;
+    float size[3];
+    ngli_vec3_sub(size, geometry->aabb_max, geometry->aabb_min);
+    for (int i = 0; i < 3; i++)
+        bounds->vector[i] = (geometry->aabb_min[i] + geometry->aabb_max[i]) / 2.f;
+    bounds->vector[3] = ngli_vec3_length(size) / 2.f;
+
+    /* Reset the number of instances, incremented by each visible instance */
+    struct buffer_priv *command = s->command->priv_data;
+    uint32_t *command_data = (uint32_t *)command->data;
+    command_data[1] = 0;
+    int ret = ngli_buffer_upload(&command->buffer, command->data, command->data_size);
+    if (ret < 0)
+        LOG(ERROR, "unable to reset the indirect draw command");
+
+    ngli_node_draw(s->compute);
+    return command->buffer.id;
+}
+
+void ngli_gpuculling_freep(struct gpuculling **sp)
+{
+    struct gpuculling *s = *sp;
+    if (!s)
+        return;
+    if (s->compute) {
+        ngli_node_detach_ctx(s->compute);
+        ngl_node_unrefp(&s->compute);
+    }
+    for (int i = 0; i < s->nb_attributes; i++) {
+        ngl_node_unrefp(&s->attributes[i].input);
+        ngl_node_unrefp(&s->attributes[i].output);
+    }
+    ngl_node_unrefp(&s->command);
+    ngl_node_unrefp(&s->mvp_matrix);
+    ngl_node_unrefp(&s->bounds);
+    ngli_free(s);
+    *sp = NULL;
+}
@@ -0,0 +1,56 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef GPUCULLING_H
+#define GPUCULLING_H
+
+#include "glincludes.h"
+#include "nodegl.h"
+
+/*
+ * Compute pass culling the instances of a Render node against the view
+ * frustum. Each instance is bounded by the sphere enclosing the geometry,
+ * offset by the value of a per instance attribute. The visible instances
+ * have their attributes compacted into internal buffers (which replace the
+ * original ones in the draw), and their count written into an indirect draw
+ * command. The relative order of the instances is not preserved.
+ */
+struct gpuculling;
+
+struct gpuculling *ngli_gpuculling_create(struct ngl_node *render, const char *offset_attribute);
+int ngli_gpuculling_update(struct gpuculling *s, double t);
+
+/*
+ * Return the internal buffer receiving the compacted values of the given
+ * instance attribute buffer, or NULL if it is not handled by the pass.
+ */
+struct ngl_node *ngli_gpuculling_get_output(struct gpuculling *s, const struct ngl_node *input);
+
+/*
+ * Run the culling pass with the current modelview and projection matrices.
+ * Return the buffer holding the indirect draw command to be used by the
+ * Render node.
+ */
+GLuint ngli_gpuculling_run(struct gpuculling *s);
+
+void ngli_gpuculling_freep(struct gpuculling **sp);
+
+#endif
@@ -27,26 +27,66 @@
 #include "memory.h"
 #include "utils.h"
 
-struct bucket {
-    struct hmap_entry *entries;
-    int nb_entries;
+/*
+ * Open addressing hash map: the entries are stored densely in insertion order
+ * (deleted entries are left as holes until the next compaction), and indexed
+ * by a power of two table of slots using linear probing. Each slot caches the
+ * hash of its entry so probing rarely needs to touch the keys.
+ */
+
+#define EMPTY_SLOT -1
+
+struct slot {
+    uint32_t hash;
+    int32_t index; // index in the entries array, or EMPTY_SLOT
 };
 
 struct hmap {
-    struct bucket *buckets;
-    int size;
+    struct slot *slots;
+    int size;       // number of slots
     uint32_t mask;
-    int count; // total number of entries
+    struct hmap_entry *entries;
+    int nb_entries; // number of entries including the deleted ones
+    int entries_capacity;
+    int count;      // number of live entries
+    int interned_keys;
     user_free_func_type user_free_func;
     void *user_arg;
 };
 
+/* FNV-1a */
+static uint32_t hash_key(const char *key)
+{
+    uint32_t hash = 0x811c9dc5;
+    for (int i = 0; key[i]; i++) {
+        hash ^= (uint8_t)key[i];
+        hash *= 0x01000193;
+    }
+    return hash;
+}
+
 void ngli_hmap_set_free(struct hmap *hm, user_free_func_type user_free_func, void *user_arg)
 {
     hm->user_free_func = user_free_func;
     hm->user_arg = user_arg;
 }
 
+void ngli_hmap_set_interned_keys(struct hmap *hm, int interned_keys)
+{
+    ngli_assert(!hm->nb_entries);
+    hm->interned_keys = interned_keys;
+}
+
+static struct slot *alloc_slots(int size)
+{
+    struct slot *slots = ngli_malloc(size * sizeof(*slots));
+    if (!slots)
+        return NULL;
+    for (int i = 0; i < size; i++)
+        slots[i].index = EMPTY_SLOT;
+    return slots;
+}
+
 struct hmap *ngli_hmap_create(void)
 {
     struct hmap *hm = ngli_calloc(1, sizeof(*hm));
@@ -54,8 +94,8 @@ struct hmap *ngli_hmap_create(void)
         return NULL;
     hm->size = 1 << HMAP_SIZE_NBIT;
     hm->mask = hm->size - 1;
-    hm->buckets = ngli_calloc(hm->size, sizeof(*hm->buckets));
-    if (!hm->buckets) {
+    hm->slots = alloc_slots(hm->size);
+    if (!hm->slots) {
         ngli_free(hm);
         return NULL;
     }
@@ -67,173 +107,192 @@ int ngli_hmap_count(struct hmap *hm)
     return hm->count;
 }
 
+static int find_slot(const struct hmap *hm, const char *key, uint32_t hash)
+{
+    uint32_t i = hash & hm->mask;
+    for (;;) {
+        const struct slot *slot = &hm->slots[i];
+        if (slot->index == EMPTY_SLOT)
+            return -1;
+        if (slot->hash == hash) {
+            const char *entry_key = hm->entries[slot->index].key;
+            if (entry_key == key || !strcmp(entry_key, key))
+                return i;
+        }
+        i = (i + 1) & hm->mask;
+    }
+}
+
+static void insert_slot(struct hmap *hm, uint32_t hash, int index)
+{
+    uint32_t i = hash & hm->mask;
+    while (hm->slots[i].index != EMPTY_SLOT)
+        i = (i + 1) & hm->mask;
+    hm->slots[i].hash = hash;
+    hm->slots[i].index = index;
+}
+
+static void remove_slot(struct hmap *hm, uint32_t i)
+{
+    /* Backward shift deletion: move back the following entries of the probe
+     * sequence which are not at their ideal position anymore */
+    uint32_t j = i;
+    hm->slots[i].index = EMPTY_SLOT;
+    for (;;) {
+        j = (j + 1) & hm->mask;
+        if (hm->slots[j].index == EMPTY_SLOT)
+            return;
+        const uint32_t k = hm->slots[j].hash & hm->mask;
+        if (i <= j ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+        hm->slots[i] = hm->slots[j];
+        hm->slots[j].index = EMPTY_SLOT;
+        i = j;
+    }
+}
+
+static void reindex(struct hmap *hm)
+{
+    for (int i = 0; i < hm->size; i++)
+        hm->slots[i].index = EMPTY_SLOT;
+    for (int i = 0; i < hm->nb_entries; i++) {
+        const struct hmap_entry *e = &hm->entries[i];
+        if (e->key)
+            insert_slot(hm, e->hash, i);
+    }
+}
+
+static void compact_entries(struct hmap *hm)
+{
+    int n = 0;
+    for (int i = 0; i < hm->nb_entries; i++)
+        if (hm->entries[i].key)
+            hm->entries[n++] = hm->entries[i];
+    hm->nb_entries = n;
+    reindex(hm);
+}
+
+static int grow_slots(struct hmap *hm)
+{
+    if (hm->size >= 1 << (sizeof(hm->size)*8 - 2))
+        return -1;
+
+    struct slot *slots = alloc_slots(hm->size << 1);
+    if (!slots)
+        return -1;
+    ngli_free(hm->slots);
+    hm->slots = slots;
+    hm->size <<= 1;
+    hm->mask = hm->size - 1;
+    reindex(hm);
+    return 0;
+}
+
+static int reserve_entry(struct hmap *hm)
+{
+    if (hm->nb_entries < hm->entries_capacity)
+        return 0;
+
+    /* Reuse the holes left by the deleted entries if they represent a
+     * significant part of the array, grow it otherwise */
+    if (hm->nb_entries - hm->count >= hm->nb_entries / 2 && hm->nb_entries) {
+        compact_entries(hm);
+        return 0;
+    }
+
+    const int capacity = hm->entries_capacity ? hm->entries_capacity * 2 : hm->size;
+    struct hmap_entry *entries = ngli_realloc(hm->entries, capacity * sizeof(*entries));
+    if (!entries)
+        return -1;
+    hm->entries = entries;
+    hm->entries_capacity = capacity;
+    return 0;
+}
+
+static void free_entry(struct hmap *hm, struct hmap_entry *e)
+{
+    if (!hm->interned_keys)
+        ngli_free(e->key);
+    if (hm->user_free_func)
+        hm->user_free_func(hm->user_arg, e->data);
+}
+
 int ngli_hmap_set(struct hmap *hm, const char *key, void *data)
 {
     if (!key)
         return -1;
 
-    const uint32_t hash = ngli_crc32(key);
-    int id = hash & hm->mask;
-    struct bucket *b = &hm->buckets[id];
+    const uint32_t hash = hash_key(key);
+    const int slot_id = find_slot(hm, key, hash);
 
     /* Delete */
     if (!data) {
-        for (int i = 0; i < b->nb_entries; i++) {
-            struct hmap_entry *e = &b->entries[i];
-            if (!strcmp(e->key, key)) {
-                ngli_free(e->key);
-                if (hm->user_free_func)
-                    hm->user_free_func(hm->user_arg, e->data);
-                hm->count--;
-                b->nb_entries--;
-                if (!b->nb_entries) {
-                    ngli_free(b->entries);
-                } else {
-                    memmove(e, e + 1, (b->nb_entries - i) * sizeof(*b->entries));
-                    struct hmap_entry *entries =
-                        ngli_realloc(b->entries, b->nb_entries * sizeof(*b->entries));
-                    if (!entries)
-                        return 0; // unable to realloc but entry got dropped, so this is OK
-                    b->entries = entries;
-                }
-                return 1;
-            }
-        }
-        return 0;
+        if (slot_id < 0)
+            return 0;
+        struct hmap_entry *e = &hm->entries[hm->slots[slot_id].index];
+        free_entry(hm, e);
+        e->key = NULL;
+        e->data = NULL;
+        remove_slot(hm, slot_id);
+        hm->count--;
+        if (!hm->count)
+            hm->nb_entries = 0;
+        return 1;
     }
 
     /* Replace */
-    for (int i = 0; i < b->nb_entries; i++) {
-        struct hmap_entry *e = &b->entries[i];
-        if (!strcmp(e->key, key)) {
-            if (hm->user_free_func)
-                hm->user_free_func(hm->user_arg, e->data);
-            e->data = data;
-            return 0;
-        }
+    if (slot_id >= 0) {
+        struct hmap_entry *e = &hm->entries[hm->slots[slot_id].index];
+        if (hm->user_free_func)
+            hm->user_free_func(hm->user_arg, e->data);
+        e->data = data;
+        return 0;
     }
 
-    /* Resize check before addition  */
-    if (hm->count * 3 / 4 >= hm->size) {
-        struct hmap old_hm = *hm;
-
-        if (hm->size >= 1 << (sizeof(hm->size)*8 - 2))
-            return -1;
-
-        struct bucket *new_buckets = ngli_calloc(hm->size << 1, sizeof(*new_buckets));
-        if (new_buckets) {
-            hm->buckets = new_buckets;
-            hm->count = 0;
-            hm->size <<= 1;
-            hm->mask = hm->size - 1;
-
-            if (old_hm.count) {
-                /* Transfer all entries to the new map */
-                const struct hmap_entry *e = NULL;
-                while ((e = ngli_hmap_next(&old_hm, e))) {
-                    const int new_id = ngli_crc32(e->key) & hm->mask;
-                    struct bucket *b = &hm->buckets[new_id];
-                    struct hmap_entry *entries =
-                        ngli_realloc(b->entries, (b->nb_entries + 1) * sizeof(*b->entries));
-                    if (!entries) {
-                        /* Unable to allocate more, ngli_free the incomplete buckets
-                         * and restore the previous hashmap state */
-                        for (int j = 0; j < hm->size; j++)
-                            ngli_free(hm->buckets[j].entries);
-                        ngli_free(hm->buckets);
-                        *hm = old_hm;
-                        return -1;
-                    }
-                    b->entries = entries;
-                    struct hmap_entry *new_e = &entries[b->nb_entries++];
-                    new_e->key = e->key;
-                    new_e->data = e->data;
-                    new_e->bucket_id = new_id;
-                    hm->count++;
-                }
-
-                /* Destroy previous indexes in the old buckets */
-                for (int j = 0; j < old_hm.size; j++) {
-                    struct bucket *b = &old_hm.buckets[j];
-                    ngli_free(b->entries);
-                    old_hm.count -= b->nb_entries;
-                    if (old_hm.count == 0)
-                        break;
-                }
-            }
-
-            ngli_free(old_hm.buckets);
-
-            /* Fix the bucket position for the entry to add */
-            id = hash & hm->mask;
-            b = &hm->buckets[id];
-        }
+    /* Resize check before addition */
+    if ((hm->count + 1) * 4 > hm->size * 3) {
+        int ret = grow_slots(hm);
+        if (ret < 0)
+            return ret;
     }
 
+    int ret = reserve_entry(hm);
+    if (ret < 0)
+        return ret;
+
     /* Add */
-    char *new_key = ngli_strdup(key);
+    char *new_key = hm->interned_keys ? (char *)key : ngli_strdup(key);
     if (!new_key)
         return -1;
-    struct hmap_entry *entries =
-        ngli_realloc(b->entries, (b->nb_entries + 1) * sizeof(*b->entries));
-    if (!entries) {
-        ngli_free(new_key);
-        return -1;
-    }
-    b->entries = entries;
-    struct hmap_entry *e = &entries[b->nb_entries++];
+    const int index = hm->nb_entries++;
+    struct hmap_entry *e = &hm->entries[index];
     e->key = new_key;
     e->data = data;
-    e->bucket_id = id;
+    e->hash = hash;
+    insert_slot(hm, hash, index);
     hm->count++;
 
     return 0;
 }
 
-static const struct hmap_entry *get_first_entry(const struct hmap *hm,
-                                                int bucket_start)
-{
-    for (int i = bucket_start; i < hm->size; i++) {
-        const struct bucket *b = &hm->buckets[i];
-        if (b->nb_entries)
-            return &b->entries[0];
-    }
-    return NULL;
-}
-
 const struct hmap_entry *ngli_hmap_next(const struct hmap *hm,
                                         const struct hmap_entry *prev)
 {
-    if (!hm->count)
-        return NULL;
-
-    if (!prev)
-        return get_first_entry(hm, 0);
-
-    const int id = prev->bucket_id;
-    const struct bucket *b = &hm->buckets[id];
-    const int entry_id = prev - b->entries;
-
-    if (entry_id < b->nb_entries - 1)
-        return &b->entries[entry_id + 1];
-
-    if (id < hm->size - 1)
-        return get_first_entry(hm, id + 1);
-
+    int i = prev ? prev - hm->entries + 1 : 0;
+    for (; i < hm->nb_entries; i++) {
+        const struct hmap_entry *e = &hm->entries[i];
+        if (e->key)
+            return e;
+    }
     return NULL;
 }
 
 void *ngli_hmap_get(const struct hmap *hm, const char *key)
 {
-    const int id = ngli_crc32(key) & hm->mask;
-    const struct bucket *b = &hm->buckets[id];
-
-    for (int i = 0; i < b->nb_entries; i++) {
-        struct hmap_entry *e = &b->entries[i];
-        if (!strcmp(e->key, key))
-            return e->data;
-    }
-    return NULL;
+    const int slot_id = find_slot(hm, key, hash_key(key));
+    if (slot_id < 0)
+        return NULL;
+    return hm->entries[hm->slots[slot_id].index].data;
 }
 
 void ngli_hmap_freep(struct hmap **hmp)
@@ -243,23 +302,14 @@ void ngli_hmap_freep(struct hmap **hmp)
     if (!hm)
         return;
 
-    if (hm->count) {
-        for (int j = 0; j < hm->size; j++) {
-            struct bucket *b = &hm->buckets[j];
-            for (int i = 0; i < b->nb_entries; i++) {
-                struct hmap_entry *e = &b->entries[i];
-                ngli_free(e->key);
-                if (hm->user_free_func)
-                    hm->user_free_func(hm->user_arg, e->data);
-            }
-            ngli_free(b->entries);
-            hm->count -= b->nb_entries;
-            if (hm->count == 0)
-                break;
-        }
+    for (int i = 0; i < hm->nb_entries; i++) {
+        struct hmap_entry *e = &hm->entries[i];
+        if (e->key)
+            free_entry(hm, e);
     }
 
-    ngli_free(hm->buckets);
+    ngli_free(hm->entries);
+    ngli_free(hm->slots);
     ngli_free(hm);
     *hmp = NULL;
 }
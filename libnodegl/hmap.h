@@ -22,6 +22,8 @@
 #ifndef HMAP_H
 #define HMAP_H
 
+#include <stdint.h>
+
 #ifndef HMAP_SIZE_NBIT
 #define HMAP_SIZE_NBIT 3
 #endif
@@ -31,13 +33,21 @@ struct hmap;
 struct hmap_entry {
     char *key;
     void *data;
-    int bucket_id;
+    uint32_t hash;
 };
 
 typedef void (*user_free_func_type)(void *user_arg, void *data);
 
 struct hmap *ngli_hmap_create(void);
 void ngli_hmap_set_free(struct hmap *hm, user_free_func_type user_free_func, void *user_arg);
+
+/*
+ * In interned keys mode, the keys are referenced instead of being copied: the
+ * caller must guarantee they outlive the map. Must be set before any
+ * insertion.
+ */
+void ngli_hmap_set_interned_keys(struct hmap *hm, int interned_keys);
+
 int ngli_hmap_count(struct hmap *hm);
 int ngli_hmap_set(struct hmap *hm, const char *key, void *data);
 void *ngli_hmap_get(const struct hmap *hm, const char *key);
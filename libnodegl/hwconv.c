@@ -169,7 +169,7 @@ int ngli_hwconv_init(struct hwconv *hwconv, struct glcontext *gl,
     ngli_free(fragment_data);
     if (!hwconv->program_id)
         return -1;
-    ngli_glUseProgram(gl, hwconv->program_id);
+    ngli_glstate_use_program(gl, hwconv->program_id);
 
     hwconv->position_location = ngli_glGetAttribLocation(gl, hwconv->program_id, "position");
     if (hwconv->position_location < 0)
@@ -197,15 +197,15 @@ int ngli_hwconv_init(struct hwconv *hwconv, struct glcontext *gl,
         -1.0f,  1.0f, 0.0f, 1.0f,
     };
     ngli_glGenBuffers(gl, 1, &hwconv->vertices_id);
-    ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, hwconv->vertices_id);
+    ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, hwconv->vertices_id);
     ngli_glBufferData(gl, GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
 
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT) {
         ngli_glGenVertexArrays(gl, 1, &hwconv->vao_id);
-        ngli_glBindVertexArray(gl, hwconv->vao_id);
+        ngli_glstate_bind_vertex_array(gl, hwconv->vao_id);
 
         ngli_glEnableVertexAttribArray(gl, hwconv->position_location);
-        ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, hwconv->vertices_id);
+        ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, hwconv->vertices_id);
         ngli_glVertexAttribPointer(gl, hwconv->position_location, 4, GL_FLOAT, GL_FALSE, 4 * 4, NULL);
     }
 
@@ -219,22 +219,23 @@ int ngli_hwconv_convert(struct hwconv *hwconv, const struct texture *planes, con
 
     ngli_fbo_bind(fbo);
     GLint viewport[4];
-    ngli_glGetIntegerv(gl, GL_VIEWPORT, viewport);
-    ngli_glViewport(gl, 0, 0, fbo->width, fbo->height);
+    ngli_glstate_get_viewport(gl, viewport);
+    const GLint fbo_viewport[] = {0, 0, fbo->width, fbo->height};
+    ngli_glstate_viewport(gl, fbo_viewport);
     ngli_glClear(gl, GL_COLOR_BUFFER_BIT);
 
-    ngli_glUseProgram(gl, hwconv->program_id);
+    ngli_glstate_use_program(gl, hwconv->program_id);
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT) {
-        ngli_glBindVertexArray(gl, hwconv->vao_id);
+        ngli_glstate_bind_vertex_array(gl, hwconv->vao_id);
     } else {
         ngli_glEnableVertexAttribArray(gl, hwconv->position_location);
-        ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, hwconv->vertices_id);
+        ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, hwconv->vertices_id);
         ngli_glVertexAttribPointer(gl, hwconv->position_location, 4, GL_FLOAT, GL_FALSE, 4 * 4, NULL);
     }
     const struct hwconv_desc *desc = &hwconv_descs[hwconv->src_layout];
     for (int i = 0; i < desc->nb_planes; i++) {
-        ngli_glActiveTexture(gl, GL_TEXTURE0 + i);
-        ngli_glBindTexture(gl, planes[i].target, planes[i].id);
+        ngli_glstate_active_texture(gl, GL_TEXTURE0 + i);
+        ngli_glstate_bind_texture(gl, planes[i].target, planes[i].id);
     }
     if (matrix) {
         ngli_glUniformMatrix4fv(gl, hwconv->texture_matrix_location, 1, GL_FALSE, matrix);
@@ -257,7 +258,7 @@ int ngli_hwconv_convert(struct hwconv *hwconv, const struct texture *planes, con
         ngli_glDisableVertexAttribArray(gl, hwconv->position_location);
     }
 
-    ngli_glViewport(gl, viewport[0], viewport[1], viewport[2], viewport[3]);
+    ngli_glstate_viewport(gl, viewport);
     ngli_fbo_unbind(fbo);
 
     return 0;
@@ -272,9 +273,9 @@ void ngli_hwconv_reset(struct hwconv *hwconv)
     ngli_fbo_reset(&hwconv->fbo);
 
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT)
-        ngli_glDeleteVertexArrays(gl, 1, &hwconv->vao_id);
-    ngli_glDeleteProgram(gl, hwconv->program_id);
-    ngli_glDeleteBuffers(gl, 1, &hwconv->vertices_id);
+        ngli_glstate_delete_vertex_array(gl, hwconv->vao_id);
+    ngli_glstate_delete_program(gl, hwconv->program_id);
+    ngli_glstate_delete_buffer(gl, hwconv->vertices_id);
 
     memset(hwconv, 0, sizeof(*hwconv));
 }
@@ -25,6 +25,7 @@
 #include <sxplayer.h>
 
 #include "glincludes.h"
+#include "glstate.h"
 #include "hwupload.h"
 #include "log.h"
 #include "math_utils.h"
@@ -93,6 +94,8 @@ int ngli_hwupload_upload_frame(struct ngl_node *node)
         }
 
         int ret = hwmap_class->init(node, frame);
+        if (hwmap_class->flags & HWMAP_FLAG_EXTERNAL_GL)
+            ngli_glstate_reset_bindings(node->ctx->glcontext);
         if (ret < 0) {
             sxplayer_release_frame(frame);
             return ret;
@@ -103,6 +106,8 @@ int ngli_hwupload_upload_frame(struct ngl_node *node)
     }
 
     int ret = hwmap_class->map_frame(node, frame);
+    if (hwmap_class->flags & HWMAP_FLAG_EXTERNAL_GL)
+        ngli_glstate_reset_bindings(node->ctx->glcontext);
     if (!(hwmap_class->flags &  HWMAP_FLAG_FRAME_OWNER))
         sxplayer_release_frame(frame);
     return ret;
@@ -28,6 +28,7 @@
 #include "nodegl.h"
 
 #define HWMAP_FLAG_FRAME_OWNER (1 << 0)
+#define HWMAP_FLAG_EXTERNAL_GL (1 << 1) // platform APIs change the GL bindings behind the library
 
 struct hwmap_class {
     const char *name;
@@ -88,6 +88,8 @@ static int mc_common_render_frame(struct ngl_node *node, struct sxplayer_frame *
         0.0f, 1.0f, 0.0f, 1.0f,
     };
 
+    /* SurfaceTexture.updateTexImage() binds the texture behind our back, the
+     * bindings are reset once the frame is mapped (HWMAP_FLAG_EXTERNAL_GL) */
     ngli_android_surface_render_buffer(media->android_surface, buffer, matrix);
     ngli_mat4_mul(matrix, flip_matrix, matrix);
 
@@ -135,10 +137,10 @@ static int mc_dr_init(struct ngl_node *node, struct sxplayer_frame *frame)
     GLint id = media->android_texture.id;
     GLenum target = media->android_texture.target;
 
-    ngli_glBindTexture(gl, target, id);
+    ngli_glstate_bind_texture(gl, target, id);
     ngli_glTexParameteri(gl, target, GL_TEXTURE_MIN_FILTER, params->min_filter);
     ngli_glTexParameteri(gl, target, GL_TEXTURE_MAG_FILTER, params->mag_filter);
-    ngli_glBindTexture(gl, target, 0);
+    ngli_glstate_bind_texture(gl, target, 0);
 
     ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_MEDIACODEC, &media->android_texture);
 
@@ -159,6 +161,7 @@ static int mc_dr_map_frame(struct ngl_node *node, struct sxplayer_frame *frame)
 
 static const struct hwmap_class hwmap_mc_class = {
     .name      = "mediacodec (oes → 2d)",
+    .flags     = HWMAP_FLAG_EXTERNAL_GL,
     .priv_size = sizeof(struct hwupload_mc),
     .init      = mc_init,
     .map_frame = mc_map_frame,
@@ -167,6 +170,7 @@ static const struct hwmap_class hwmap_mc_class = {
 
 static const struct hwmap_class hwmap_mc_dr_class = {
     .name      = "mediacodec (oes zero-copy)",
+    .flags     = HWMAP_FLAG_EXTERNAL_GL,
     .init      = mc_dr_init,
     .map_frame = mc_dr_map_frame,
 };
@@ -192,7 +192,7 @@ static int vaapi_common_map_frame(struct ngl_node *node, struct sxplayer_frame *
         struct texture *plane = &vaapi->planes[i];
         ngli_texture_set_dimensions(plane, width, height, 0);
 
-        ngli_glBindTexture(gl, plane->target, plane->id);
+        ngli_glstate_bind_texture(gl, plane->target, plane->id);
         ngli_glEGLImageTargetTexture2DOES(gl, plane->target, vaapi->egl_images[i]);
     }
 
@@ -284,7 +284,7 @@ static int vaapi_dr_init(struct ngl_node *node, struct sxplayer_frame *frame)
 
 static const struct hwmap_class hwmap_vaapi_class = {
     .name      = "vaapi (dma buf → egl image)",
-    .flags     = HWMAP_FLAG_FRAME_OWNER,
+    .flags     = HWMAP_FLAG_FRAME_OWNER | HWMAP_FLAG_EXTERNAL_GL,
     .priv_size = sizeof(struct hwupload_vaapi),
     .init      = vaapi_init,
     .map_frame = vaapi_map_frame,
@@ -293,7 +293,7 @@ static const struct hwmap_class hwmap_vaapi_class = {
 
 static const struct hwmap_class hwmap_vaapi_dr_class = {
     .name      = "vaapi (dma buf → egl image → rgba)",
-    .flags     = HWMAP_FLAG_FRAME_OWNER,
+    .flags     = HWMAP_FLAG_FRAME_OWNER | HWMAP_FLAG_EXTERNAL_GL,
     .priv_size = sizeof(struct hwupload_vaapi),
     .init      = vaapi_dr_init,
     .map_frame = vaapi_common_map_frame,
@@ -122,7 +122,7 @@ static int vt_darwin_map_frame(struct ngl_node *node, struct sxplayer_frame *fra
     for (int i = 0; i < 2; i++) {
         struct texture *plane = &vt->planes[i];
 
-        ngli_glBindTexture(gl, plane->target, plane->id);
+        ngli_glstate_bind_texture(gl, plane->target, plane->id);
 
         int width = IOSurfaceGetWidthOfPlane(surface, i);
         int height = IOSurfaceGetHeightOfPlane(surface, i);
@@ -136,7 +136,7 @@ static int vt_darwin_map_frame(struct ngl_node *node, struct sxplayer_frame *fra
             return -1;
         }
 
-        ngli_glBindTexture(gl, GL_TEXTURE_RECTANGLE, 0);
+        ngli_glstate_bind_texture(gl, GL_TEXTURE_RECTANGLE, 0);
     }
 
     if (!ngli_texture_match_dimensions(&s->texture, frame->width, frame->height, 0)) {
@@ -182,7 +182,7 @@ static void vt_darwin_uninit(struct ngl_node *node)
 
 static const struct hwmap_class hwmap_vt_darwin_class = {
     .name      = "videotoolbox (copy)",
-    .flags     = HWMAP_FLAG_FRAME_OWNER,
+    .flags     = HWMAP_FLAG_FRAME_OWNER | HWMAP_FLAG_EXTERNAL_GL,
     .priv_size = sizeof(struct hwupload_vt_darwin),
     .init      = vt_darwin_init,
     .map_frame = vt_darwin_map_frame,
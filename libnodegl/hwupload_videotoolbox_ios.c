@@ -120,12 +120,12 @@ static int vt_ios_common_map_plane(struct ngl_node *node, CVPixelBufferRef cvpix
     }
 
     GLint id = CVOpenGLESTextureGetName(vt->ios_textures[index]);
-    ngli_glBindTexture(gl, GL_TEXTURE_2D, id);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, id);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, plane_params->min_filter);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, plane_params->mag_filter);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, plane_params->wrap_s);
     ngli_glTexParameteri(gl, GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, plane_params->wrap_t);
-    ngli_glBindTexture(gl, GL_TEXTURE_2D, 0);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, 0);
 
     ngli_texture_set_id(plane, id);
     ngli_texture_set_dimensions(plane, width, height, 0);
@@ -312,6 +312,7 @@ static int vt_ios_dr_init(struct ngl_node *node, struct sxplayer_frame *frame)
 
 static const struct hwmap_class hwmap_vt_ios_class = {
     .name      = "videotoolbox (nv12 → rgba)",
+    .flags     = HWMAP_FLAG_EXTERNAL_GL,
     .priv_size = sizeof(struct hwupload_vt_ios),
     .init      = vt_ios_init,
     .map_frame = vt_ios_map_frame,
@@ -320,6 +321,7 @@ static const struct hwmap_class hwmap_vt_ios_class = {
 
 static const struct hwmap_class hwmap_vt_ios_dr_class = {
     .name      = "videotoolbox (zero-copy)",
+    .flags     = HWMAP_FLAG_EXTERNAL_GL,
     .priv_size = sizeof(struct hwupload_vt_ios),
     .init      = vt_ios_dr_init,
     .map_frame = vt_ios_common_map_frame,
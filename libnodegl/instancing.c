@@ -0,0 +1,749 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bstr.h"
+#include "darray.h"
+#include "hmap.h"
+#include "instancing.h"
+#include "log.h"
+#include "math_utils.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "utils.h"
+
+enum {
+    MATRIX_MODELVIEW,
+    MATRIX_NORMAL,
+    NB_MATRICES
+};
+
+static const struct {
+    const char *name;
+    const char *decl;           // uniform declaration replaced by instance attributes
+    const char *type;
+    const char *column_type;
+    int nb_columns;
+    int buffer_type;
+} instanced_matrices[NB_MATRICES] = {
+    [MATRIX_MODELVIEW] = {"ngl_modelview_matrix", "uniform mat4 ngl_modelview_matrix;",
+                          "mat4", "vec4", 4, NGL_NODE_BUFFERVEC4},
+    [MATRIX_NORMAL]    = {"ngl_normal_matrix",    "uniform mat3 ngl_normal_matrix;",
+                          "mat3", "vec3", 3, NGL_NODE_BUFFERVEC3},
+};
+
+struct batch_member {
+    int index;                              // index of the child in the group
+    struct ngl_node *node;
+    const struct ngl_node *geometry;
+};
+
+struct batch {
+    struct darray members;                  // batch_member
+    int first_index;                        // index of the first member in the group
+    const struct render_priv *render_ref;   // Render node of the first member
+    struct ngl_node *render;                // instanced Render node
+    int render_attached;                    // the instanced Render node is attached to the context
+    struct ngl_node *geometry;              // merged geometries, if the members do not share theirs
+    struct ngl_node *columns[NB_MATRICES][4];  // per instance matrix columns, NULL if unused
+    int has_normal_matrix;
+};
+
+struct instancing {
+    struct ngl_ctx *ctx;
+    int multi_draw;                         // different geometries can be merged in one draw
+    struct darray batches;                  // batch *
+    struct batch **child_batches;           // batch of each child of the group, if any
+};
+
+static const struct ngl_node *get_render(const struct ngl_node *node)
+{
+    while (node) {
+        switch (node->class->id) {
+        case NGL_NODE_RENDER:
+            return node;
+        case NGL_NODE_ROTATE:
+        case NGL_NODE_TRANSFORM:
+        case NGL_NODE_TRANSLATE:
+        case NGL_NODE_SCALE: {
+            const struct transform_priv *s = node->priv_data;
+            node = s->child;
+            break;
+        }
+        default:
+            return NULL;
+        }
+    }
+    return NULL;
+}
+
+/*
+ * The matrices can only be moved to instance attributes if they are declared
+ * in the canonical way in the vertex shader, and not used by the fragment
+ * shader.
+ */
+static int is_instanceable(const struct render_priv *s)
+{
+    if (s->nb_instances || s->instance_attributes)
+        return 0;
+
+    const struct program_priv *program = s->pipeline.program->priv_data;
+    const char *vertex = program->vertex;
+    const char *fragment = program->fragment;
+    if (!vertex || !fragment || strstr(vertex, "gl_InstanceID"))
+        return 0;
+
+    if (!strstr(vertex, instanced_matrices[MATRIX_MODELVIEW].decl))
+        return 0;
+
+    for (int i = 0; i < NB_MATRICES; i++) {
+        if (strstr(fragment, instanced_matrices[i].name))
+            return 0;
+        if (strstr(vertex, instanced_matrices[i].name) && !strstr(vertex, instanced_matrices[i].decl))
+            return 0;
+    }
+
+    return 1;
+}
+
+static int hmap_equal(struct hmap *a, struct hmap *b)
+{
+    const int count_a = a ? ngli_hmap_count(a) : 0;
+    const int count_b = b ? ngli_hmap_count(b) : 0;
+    if (count_a != count_b)
+        return 0;
+    if (!count_a)
+        return 1;
+
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(a, entry)))
+        if (ngli_hmap_get(b, entry->key) != entry->data)
+            return 0;
+    return 1;
+}
+
+static int buffer_mergeable(const struct ngl_node *a, const struct ngl_node *b)
+{
+    if (!a || !b)
+        return a == b;
+    const struct buffer_priv *buffer_a = a->priv_data;
+    const struct buffer_priv *buffer_b = b->priv_data;
+    return a->class->id == b->class->id && !buffer_a->dynamic && !buffer_b->dynamic;
+}
+
+/*
+ * Different geometries can be concatenated into the same buffers (and drawn
+ * with a multi-draw indirect) if they share their topology and the layout of
+ * their static buffers.
+ */
+static int geometry_mergeable(const struct ngl_node *a, const struct ngl_node *b)
+{
+    const struct geometry_priv *geometry_a = a->priv_data;
+    const struct geometry_priv *geometry_b = b->priv_data;
+    return geometry_a->topology == geometry_b->topology &&
+           buffer_mergeable(geometry_a->vertices_buffer, geometry_b->vertices_buffer) &&
+           buffer_mergeable(geometry_a->uvcoords_buffer, geometry_b->uvcoords_buffer) &&
+           buffer_mergeable(geometry_a->normals_buffer,  geometry_b->normals_buffer)  &&
+           buffer_mergeable(geometry_a->indices_buffer,  geometry_b->indices_buffer);
+}
+
+static int render_equal(const struct instancing *s,
+                        const struct render_priv *a, const struct render_priv *b)
+{
+    const struct program_priv *program_a = a->pipeline.program->priv_data;
+    const struct program_priv *program_b = b->pipeline.program->priv_data;
+
+    /* The user vertex attributes are sized after the geometry, so they
+     * prevent any geometry merge */
+    const int geometry_equal = a->geometry == b->geometry ||
+                               (s->multi_draw && !a->attributes && !b->attributes &&
+                                geometry_mergeable(a->geometry, b->geometry));
+
+    return geometry_equal &&
+           (a->pipeline.program == b->pipeline.program ||
+            (program_a->shared && program_a->shared == program_b->shared)) &&
+           hmap_equal(a->pipeline.textures, b->pipeline.textures) &&
+           hmap_equal(a->pipeline.uniforms, b->pipeline.uniforms) &&
+           hmap_equal(a->pipeline.buffers,  b->pipeline.buffers)  &&
+           hmap_equal(a->attributes,        b->attributes);
+}
+
+static const char *get_attribute_qualifier(const char *vertex)
+{
+    int version = 0;
+    char profile[8] = {0};
+    const char *p = strstr(vertex, "#version");
+    if (p)
+        sscanf(p, "#version %d %7s", &version, profile);
+    const int es = !strcmp(profile, "es");
+    return (es && version >= 300) || (!es && version >= 130) ? "in" : "attribute";
+}
+
+static char *rewrite_vertex_shader(const char *vertex, int *has_matrix)
+{
+    const char *qualifier = get_attribute_qualifier(vertex);
+
+    char *shader = ngli_strdup(vertex);
+    if (!shader)
+        return NULL;
+
+    for (int i = 0; i < NB_MATRICES; i++) {
+        const char *name = instanced_matrices[i].name;
+        const char *decl = instanced_matrices[i].decl;
+        const char *p = strstr(shader, decl);
+        has_matrix[i] = !!p;
+        if (!p)
+            continue;
+
+        struct bstr *b = ngli_bstr_create();
+        if (!b) {
+            ngli_free(shader);
+            return NULL;
+        }
+
+        ngli_bstr_print(b, "%.*s", (int)(p - shader), shader);
+        for (int c = 0; c < instanced_matrices[i].nb_columns; c++)
+            ngli_bstr_print(b, "%s %s %s_%d;\n", qualifier, instanced_matrices[i].column_type, name, c);
+        ngli_bstr_print(b, "#define %s %s(", name, instanced_matrices[i].type);
+        for (int c = 0; c < instanced_matrices[i].nb_columns; c++)
+            ngli_bstr_print(b, "%s%s_%d", c ? ", " : "", name, c);
+        ngli_bstr_print(b, ")\n%s", p + strlen(decl));
+
+        ngli_free(shader);
+        shader = ngli_bstr_strdup(b);
+        ngli_bstr_freep(&b);
+        if (!shader)
+            return NULL;
+    }
+
+    return shader;
+}
+
+static int set_dict(struct ngl_node *node, const char *key, struct hmap *hmap)
+{
+    if (!hmap)
+        return 0;
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(hmap, entry))) {
+        int ret = ngl_node_param_set(node, key, entry->key, entry->data);
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
+struct geometry_range {
+    const struct ngl_node *geometry;
+    int first_vertex;
+    int first_index;
+};
+
+#define GEOMETRY_OFFSET(x) offsetof(struct geometry_priv, x)
+static const struct {
+    const char *param;
+    int offset;
+} geometry_buffers[] = {
+    {"vertices", GEOMETRY_OFFSET(vertices_buffer)},
+    {"uvcoords", GEOMETRY_OFFSET(uvcoords_buffer)},
+    {"normals",  GEOMETRY_OFFSET(normals_buffer)},
+    {"indices",  GEOMETRY_OFFSET(indices_buffer)},
+};
+
+static struct ngl_node *get_geometry_buffer(const struct ngl_node *geometry, int offset)
+{
+    const uint8_t *buffer_node_p = (const uint8_t *)geometry->priv_data + offset;
+    return *(struct ngl_node **)buffer_node_p;
+}
+
+static struct ngl_node *merge_buffers(const struct geometry_range *ranges, int nb_ranges, int offset)
+{
+    const struct ngl_node *ref = get_geometry_buffer(ranges[0].geometry, offset);
+
+    int count = 0;
+    int size = 0;
+    for (int i = 0; i < nb_ranges; i++) {
+        const struct buffer_priv *buffer = get_geometry_buffer(ranges[i].geometry, offset)->priv_data;
+        count += buffer->count;
+        size += buffer->data_size;
+    }
+
+    uint8_t *data = ngli_malloc(size);
+    if (!data)
+        return NULL;
+
+    uint8_t *dst = data;
+    for (int i = 0; i < nb_ranges; i++) {
+        struct ngl_node *bnode = get_geometry_buffer(ranges[i].geometry, offset);
+        const struct buffer_priv *buffer = bnode->priv_data;
+        if (ngli_node_buffer_ref_data(bnode) < 0) {
+            ngli_free(data);
+            return NULL;
+        }
+        memcpy(dst, buffer->data, buffer->data_size);
+        dst += buffer->data_size;
+        ngli_node_buffer_unref_data(bnode);
+    }
+
+    struct ngl_node *node = ngl_node_create(ref->class->id, count);
+    if (node && ngl_node_param_set(node, "data", size, data) < 0)
+        ngl_node_unrefp(&node);
+    ngli_free(data);
+    return node;
+}
+
+/*
+ * Concatenate the geometries of the batch members into batch->geometry and
+ * build the indirect draws, one per run of members sharing their geometry.
+ * The members are expected to be grouped by geometry as much as the draw
+ * order allows.
+ */
+static int merge_geometries(struct batch *batch, struct darray *draws)
+{
+    const struct batch_member *members = ngli_darray_data(&batch->members);
+    const int nb_members = ngli_darray_count(&batch->members);
+
+    int ret = -1;
+    int nb_ranges = 0;
+    struct geometry_range *ranges = ngli_calloc(nb_members, sizeof(*ranges));
+    struct hmap *range_map = ngli_hmap_create();
+    if (!ranges || !range_map)
+        goto end;
+
+    struct render_indirect_draw *draw = NULL;
+    for (int i = 0; i < nb_members; i++) {
+        const struct ngl_node *geometry = members[i].geometry;
+        if (draw && members[i - 1].geometry == geometry) {
+            draw->nb_instances++;
+            continue;
+        }
+
+        char key[32];
+        snprintf(key, sizeof(key), "%p", geometry);
+        struct geometry_range *range = ngli_hmap_get(range_map, key);
+        if (!range) {
+            range = &ranges[nb_ranges];
+            range->geometry = geometry;
+            if (nb_ranges) {
+                const struct geometry_range *prev = &ranges[nb_ranges - 1];
+                const struct geometry_priv *prev_geometry = prev->geometry->priv_data;
+                const struct buffer_priv *vertices = prev_geometry->vertices_buffer->priv_data;
+                range->first_vertex = prev->first_vertex + vertices->count;
+                if (prev_geometry->indices_buffer) {
+                    const struct buffer_priv *indices = prev_geometry->indices_buffer->priv_data;
+                    range->first_index = prev->first_index + indices->count;
+                }
+            }
+            nb_ranges++;
+            if ((ret = ngli_hmap_set(range_map, key, range)) < 0)
+                goto end;
+        }
+
+        const struct geometry_priv *geometry_priv = geometry->priv_data;
+        const int indexed = !!geometry_priv->indices_buffer;
+        const struct buffer_priv *elements = indexed ? geometry_priv->indices_buffer->priv_data
+                                                     : geometry_priv->vertices_buffer->priv_data;
+        const struct render_indirect_draw new_draw = {
+            .count         = elements->count,
+            .nb_instances  = 1,
+            .first         = indexed ? range->first_index : range->first_vertex,
+            .base_vertex   = indexed ? range->first_vertex : 0,
+            .base_instance = i,
+        };
+        draw = ngli_darray_push(draws, &new_draw);
+        if (!draw) {
+            ret = -1;
+            goto end;
+        }
+    }
+
+    const struct ngl_node *ref = ranges[0].geometry;
+    struct ngl_node *buffers[NGLI_ARRAY_NB(geometry_buffers)] = {NULL};
+    for (int i = 0; i < NGLI_ARRAY_NB(geometry_buffers); i++) {
+        if (!get_geometry_buffer(ref, geometry_buffers[i].offset))
+            continue;
+        buffers[i] = merge_buffers(ranges, nb_ranges, geometry_buffers[i].offset);
+        if (!buffers[i]) {
+            ret = -1;
+            goto unref_buffers;
+        }
+    }
+
+    ret = -1;
+    batch->geometry = ngl_node_create(NGL_NODE_GEOMETRY, buffers[0]);
+    if (!batch->geometry)
+        goto unref_buffers;
+    for (int i = 1; i < NGLI_ARRAY_NB(geometry_buffers); i++) {
+        if (buffers[i] && (ret = ngl_node_param_set(batch->geometry, geometry_buffers[i].param, buffers[i])) < 0)
+            goto unref_buffers;
+    }
+
+    /* The topology is copied as is since it is only exposed as a string
+     * parameter */
+    const struct geometry_priv *ref_geometry = ref->priv_data;
+    struct geometry_priv *merged_geometry = batch->geometry->priv_data;
+    merged_geometry->topology = ref_geometry->topology;
+    ret = 0;
+
+unref_buffers:
+    for (int i = 0; i < NGLI_ARRAY_NB(buffers); i++)
+        ngl_node_unrefp(&buffers[i]);
+end:
+    ngli_hmap_freep(&range_map);
+    ngli_free(ranges);
+    return ret;
+}
+
+static int init_batch(struct instancing *s, struct batch *batch)
+{
+    const struct render_priv *ref = batch->render_ref;
+    const struct program_priv *program = ref->pipeline.program->priv_data;
+    const int nb_instances = ngli_darray_count(&batch->members);
+
+    struct darray draws;
+    ngli_darray_init(&draws, sizeof(struct render_indirect_draw), 0);
+
+    int has_matrix[NB_MATRICES];
+    char *vertex = rewrite_vertex_shader(program->vertex, has_matrix);
+    if (!vertex)
+        return -1;
+
+    int ret = -1;
+    int program_attached = 0;
+    struct ngl_node *pnode = ngl_node_create(NGL_NODE_PROGRAM);
+    if (!pnode)
+        goto end;
+
+    const struct batch_member *members = ngli_darray_data(&batch->members);
+    for (int i = 0; i < nb_instances; i++) {
+        if (members[i].geometry != ref->geometry) {
+            if ((ret = merge_geometries(batch, &draws)) < 0)
+                goto end;
+            break;
+        }
+    }
+
+    ret = -1;
+    batch->render = ngl_node_create(NGL_NODE_RENDER, batch->geometry ? batch->geometry : ref->geometry);
+    if (!batch->render)
+        goto end;
+
+    if ((ret = ngl_node_param_set(pnode, "vertex", vertex)) < 0 ||
+        (ret = ngl_node_param_set(pnode, "fragment", program->fragment)) < 0 ||
+        (ret = ngl_node_param_set(batch->render, "program", pnode)) < 0 ||
+        (ret = ngl_node_param_set(batch->render, "nb_instances", nb_instances)) < 0 ||
+        (ret = set_dict(batch->render, "textures", ref->pipeline.textures)) < 0 ||
+        (ret = set_dict(batch->render, "uniforms", ref->pipeline.uniforms)) < 0 ||
+        (ret = set_dict(batch->render, "buffers", ref->pipeline.buffers)) < 0 ||
+        (ret = set_dict(batch->render, "attributes", ref->attributes)) < 0)
+        goto end;
+
+    /* The program is initialized first to only feed the matrix columns which
+     * have not been optimized out */
+    ret = ngli_node_attach_ctx(pnode, s->ctx);
+    if (ret < 0)
+        goto end;
+    program_attached = 1;
+    const struct program_priv *instanced_program = pnode->priv_data;
+
+    for (int i = 0; i < NB_MATRICES; i++) {
+        if (!has_matrix[i])
+            continue;
+        for (int c = 0; c < instanced_matrices[i].nb_columns; c++) {
+            char name[MAX_ID_LEN];
+            snprintf(name, sizeof(name), "%s_%d", instanced_matrices[i].name, c);
+            if (!ngli_hmap_get(instanced_program->active_attributes, name))
+                continue;
+
+            struct ngl_node *column = ngl_node_create(instanced_matrices[i].buffer_type);
+            if (!column) {
+                ret = -1;
+                goto end;
+            }
+            batch->columns[i][c] = column;
+            if (i == MATRIX_NORMAL)
+                batch->has_normal_matrix = 1;
+
+            if ((ret = ngl_node_param_set(column, "count", nb_instances)) < 0 ||
+                (ret = ngl_node_param_set(column, "usage", "dynamic_draw")) < 0 ||
+                (ret = ngl_node_param_set(batch->render, "instance_attributes", name, column)) < 0)
+                goto end;
+        }
+    }
+
+    ret = ngli_node_attach_ctx(batch->render, s->ctx);
+    if (ret < 0)
+        goto end;
+    batch->render_attached = 1;
+
+    if (ngli_darray_count(&draws))
+        ret = ngli_node_render_set_indirect_draws(batch->render, ngli_darray_data(&draws),
+                                                  ngli_darray_count(&draws));
+
+end:
+    if (program_attached)
+        ngli_node_detach_ctx(pnode);
+    ngl_node_unrefp(&pnode);
+    ngli_darray_reset(&draws);
+    ngli_free(vertex);
+    return ret;
+}
+
+static void free_batch(struct batch **batchp)
+{
+    struct batch *batch = *batchp;
+    if (!batch)
+        return;
+    if (batch->render_attached)
+        ngli_node_detach_ctx(batch->render);
+    ngl_node_unrefp(&batch->render);
+    ngl_node_unrefp(&batch->geometry);
+    for (int i = 0; i < NB_MATRICES; i++)
+        for (int c = 0; c < NGLI_ARRAY_NB(batch->columns[i]); c++)
+            ngl_node_unrefp(&batch->columns[i][c]);
+    ngli_darray_reset(&batch->members);
+    ngli_free(batch);
+    *batchp = NULL;
+}
+
+static struct batch *find_batch(const struct instancing *s, struct darray *candidates,
+                                const struct render_priv *render, int order_independent)
+{
+    struct batch **batches = ngli_darray_data(candidates);
+    const int nb_batches = ngli_darray_count(candidates);
+
+    /* Without reordering, only the last batch can be extended */
+    for (int i = order_independent ? 0 : NGLI_MAX(nb_batches - 1, 0); i < nb_batches; i++)
+        if (render_equal(s, batches[i]->render_ref, render))
+            return batches[i];
+    return NULL;
+}
+
+static int find_batches(const struct instancing *s, struct darray *candidates,
+                        struct ngl_node **children, int nb_children, int order_independent)
+{
+    struct batch *last_batch = NULL;
+    for (int i = 0; i < nb_children; i++) {
+        struct ngl_node *child = children[i];
+        const struct ngl_node *render_node = get_render(child);
+        const struct render_priv *render = render_node ? render_node->priv_data : NULL;
+        if (!render || !is_instanceable(render)) {
+            last_batch = NULL;
+            continue;
+        }
+
+        struct batch *batch = find_batch(s, candidates, render, order_independent);
+        if (!batch || (!order_independent && batch != last_batch)) {
+            batch = ngli_calloc(1, sizeof(*batch));
+            if (!batch)
+                return -1;
+            ngli_darray_init(&batch->members, sizeof(struct batch_member), 0);
+            batch->first_index = i;
+            batch->render_ref = render;
+            if (!ngli_darray_push(candidates, &batch)) {
+                free_batch(&batch);
+                return -1;
+            }
+        }
+        const struct batch_member member = {.index = i, .node = child, .geometry = render->geometry};
+        if (!ngli_darray_push(&batch->members, &member))
+            return -1;
+        last_batch = batch;
+    }
+    return 0;
+}
+
+static int cmp_member(const void *a, const void *b)
+{
+    const struct batch_member *member_a = a;
+    const struct batch_member *member_b = b;
+    if (member_a->geometry != member_b->geometry)
+        return (uintptr_t)member_a->geometry < (uintptr_t)member_b->geometry ? -1 : 1;
+    return member_a->index - member_b->index;
+}
+
+struct instancing *ngli_instancing_create(struct ngl_node *group, struct ngl_node **children,
+                                          int nb_children, int order_independent)
+{
+    struct instancing *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    s->ctx = group->ctx;
+    ngli_darray_init(&s->batches, sizeof(struct batch *), 0);
+
+    struct glcontext *gl = s->ctx->glcontext;
+    if (!(gl->features & NGLI_FEATURE_DRAW_INSTANCED) ||
+        !(gl->features & NGLI_FEATURE_INSTANCED_ARRAY))
+        return s;
+    s->multi_draw = !!(gl->features & NGLI_FEATURE_MULTI_DRAW_INDIRECT);
+
+    s->child_batches = ngli_calloc(nb_children, sizeof(*s->child_batches));
+    if (!s->child_batches) {
+        ngli_instancing_freep(&s);
+        return NULL;
+    }
+
+    struct darray candidates;
+    ngli_darray_init(&candidates, sizeof(struct batch *), 0);
+    int ret = find_batches(s, &candidates, children, nb_children, order_independent);
+
+    /* Only the batches actually merging several children are kept */
+    struct batch **batches = ngli_darray_data(&candidates);
+    for (int i = 0; i < ngli_darray_count(&candidates); i++) {
+        struct batch *batch = batches[i];
+        if (ret < 0 || ngli_darray_count(&batch->members) < 2) {
+            free_batch(&batch);
+            continue;
+        }
+        if (!ngli_darray_push(&s->batches, &batch)) {
+            free_batch(&batch);
+            ret = -1;
+            continue;
+        }
+        /* Grouping the members by geometry reduces the number of indirect
+         * draws, which is only allowed if the order does not matter */
+        if (order_independent && s->multi_draw)
+            qsort(ngli_darray_data(&batch->members), ngli_darray_count(&batch->members),
+                  sizeof(struct batch_member), cmp_member);
+        /* A batch which can not be initialized is dropped and its members
+         * are drawn individually instead of failing the whole scene */
+        if (init_batch(s, batch) < 0) {
+            LOG(WARNING, "unable to initialize the instanced draw of %s, "
+                "falling back on individual draws", children[batch->first_index]->label);
+            ngli_darray_pop(&s->batches);
+            free_batch(&batch);
+            continue;
+        }
+        const struct batch_member *members = ngli_darray_data(&batch->members);
+        for (int j = 0; j < ngli_darray_count(&batch->members); j++)
+            s->child_batches[members[j].index] = batch;
+    }
+    ngli_darray_reset(&candidates);
+
+    if (ret < 0)
+        ngli_instancing_freep(&s);
+    return s;
+}
+
+int ngli_instancing_update(struct instancing *s, double t)
+{
+    struct batch **batches = ngli_darray_data(&s->batches);
+    for (int i = 0; i < ngli_darray_count(&s->batches); i++) {
+        int ret = ngli_node_update(batches[i]->render, t);
+        if (ret < 0)
+            return ret;
+    }
+    return 0;
+}
+
+static void update_columns(struct ngl_node **columns, const float *matrix, int index, int nb_comp,
+                           int *changed)
+{
+    for (int c = 0; c < nb_comp; c++) {
+        if (!columns[c])
+            continue;
+        struct buffer_priv *s = columns[c]->priv_data;
+        float *dst = (float *)s->data + index * nb_comp;
+        const float *src = matrix + c * nb_comp;
+        if (memcmp(dst, src, nb_comp * sizeof(*dst))) {
+            memcpy(dst, src, nb_comp * sizeof(*dst));
+            changed[c] = 1;
+        }
+    }
+}
+
+static void draw_batch(struct instancing *s, struct batch *batch)
+{
+    struct ngl_ctx *ctx = s->ctx;
+    const float *parent_matrix = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    int changed[NB_MATRICES][4] = {{0}};
+
+    const struct batch_member *members = ngli_darray_data(&batch->members);
+    for (int i = 0; i < ngli_darray_count(&batch->members); i++) {
+        NGLI_ALIGNED_MAT(modelview_matrix);
+        NGLI_ALIGNED_MAT(tmp_matrix);
+        memcpy(modelview_matrix, parent_matrix, sizeof(modelview_matrix));
+
+        const struct ngl_node *node = members[i].node;
+        while (node->class->id != NGL_NODE_RENDER) {
+            const struct transform_priv *trf = node->priv_data;
+            ngli_mat4_mul(tmp_matrix, modelview_matrix, trf->matrix);
+            memcpy(modelview_matrix, tmp_matrix, sizeof(modelview_matrix));
+            node = trf->child;
+        }
+
+        update_columns(batch->columns[MATRIX_MODELVIEW], modelview_matrix, i, 4,
+                       changed[MATRIX_MODELVIEW]);
+
+        if (batch->has_normal_matrix) {
+            float normal_matrix[3*3];
+            ngli_mat3_from_mat4(normal_matrix, modelview_matrix);
+            ngli_mat3_inverse(normal_matrix, normal_matrix);
+            ngli_mat3_transpose(normal_matrix, normal_matrix);
+            update_columns(batch->columns[MATRIX_NORMAL], normal_matrix, i, 3,
+                           changed[MATRIX_NORMAL]);
+        }
+    }
+
+    for (int i = 0; i < NB_MATRICES; i++) {
+        for (int c = 0; c < NGLI_ARRAY_NB(batch->columns[i]); c++) {
+            if (!changed[i][c])
+                continue;
+            struct buffer_priv *column = batch->columns[i][c]->priv_data;
+            int ret = ngli_buffer_upload(&column->buffer, column->data, column->data_size);
+            if (ret < 0)
+                LOG(ERROR, "unable to upload the instance matrices");
+        }
+    }
+
+    ngli_node_draw(batch->render);
+}
+
+int ngli_instancing_draw_child(struct instancing *s, int index)
+{
+    if (!s->child_batches)
+        return 0;
+    struct batch *batch = s->child_batches[index];
+    if (!batch)
+        return 0;
+    if (batch->first_index == index)
+        draw_batch(s, batch);
+    return 1;
+}
+
+void ngli_instancing_freep(struct instancing **sp)
+{
+    struct instancing *s = *sp;
+    if (!s)
+        return;
+    struct batch **batches = ngli_darray_data(&s->batches);
+    for (int i = 0; i < ngli_darray_count(&s->batches); i++)
+        free_batch(&batches[i]);
+    ngli_darray_reset(&s->batches);
+    ngli_free(s->child_batches);
+    ngli_free(s);
+    *sp = NULL;
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef INSTANCING_H
+#define INSTANCING_H
+
+#include "nodegl.h"
+
+/*
+ * Automatic instancing of the children of a Group: the Render nodes (possibly
+ * under a chain of transforms) sharing their geometry, program, textures,
+ * uniforms, buffers and attributes are merged into a single instanced draw.
+ * The per-instance modelview and normal matrices are fed through instance
+ * attributes replacing the ngl_modelview_matrix and ngl_normal_matrix
+ * uniforms of the vertex shader, and are refreshed at every draw.
+ *
+ * If multi-draw indirect is supported, Render nodes with different but
+ * compatible static geometries are merged as well: the geometries are
+ * concatenated and drawn with one indirect command per geometry, the base
+ * instance of each command pointing at its matrices.
+ *
+ * Unless the children are declared order independent, only consecutive
+ * children are merged so the draw order is preserved.
+ */
+struct instancing;
+
+struct instancing *ngli_instancing_create(struct ngl_node *group, struct ngl_node **children,
+                                          int nb_children, int order_independent);
+int ngli_instancing_update(struct instancing *s, double t);
+
+/*
+ * Draw the instanced batch the child at the given index belongs to, if it
+ * is the first child of the batch. Return 1 if the child is part of a batch
+ * (and must not be drawn by itself), 0 otherwise.
+ */
+int ngli_instancing_draw_child(struct instancing *s, int index);
+
+void ngli_instancing_freep(struct instancing **sp);
+
+#endif
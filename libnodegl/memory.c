@@ -23,6 +23,8 @@
 #define _POSIX_C_SOURCE 200809L // posix_memalign()
 #endif
 
+#include <stdint.h>
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -30,6 +32,22 @@
 #include "utils.h"
 
 #ifdef DEBUG_MEM
+/*
+ * Every rendering context runs in its own thread, so a per-thread counter
+ * isolates the allocations of a context from the other ones.
+ */
+static __thread size_t nb_heap_allocs;
+
+static void count_heap_alloc(void)
+{
+    nb_heap_allocs++;
+}
+
+size_t ngli_memory_get_nb_heap_allocs(void)
+{
+    return nb_heap_allocs;
+}
+
 static int failure_requested(void)
 {
     static int alloc_counter;
@@ -56,17 +74,54 @@ static int failure_requested(void)
     alloc_counter++;
     return should_fail;
 }
+
+static void report_stats(const char *name, const struct memory_stats *stats)
+{
+    if (!getenv("NGL_MEM_STATS"))
+        return;
+    fprintf(stderr, "MEMSTATS: %s: %zu allocs, %zu bytes allocated, "
+            "%zu bytes reserved (peak: %zu)\n", name, stats->nb_allocs,
+            stats->allocated_size, stats->reserved_size, stats->peak_reserved_size);
+}
 #else
+static inline void count_heap_alloc(void)
+{
+}
+
+size_t ngli_memory_get_nb_heap_allocs(void)
+{
+    return 0;
+}
+
 static inline int failure_requested(void)
 {
     return 0;
 }
+
+static inline void report_stats(const char *name, const struct memory_stats *stats)
+{
+}
+#endif
+
+static void *malloc_aligned(size_t size)
+{
+    count_heap_alloc();
+
+    void *ptr;
+#ifdef TARGET_MINGW_W64
+    ptr = _aligned_malloc(size, NGLI_ALIGN_VAL);
+#else
+    if (posix_memalign(&ptr, NGLI_ALIGN_VAL, size))
+        ptr = NULL;
 #endif
+    return ptr;
+}
 
 void *ngli_malloc(size_t size)
 {
     if (failure_requested())
         return NULL;
+    count_heap_alloc();
     return malloc(size);
 }
 
@@ -74,6 +129,7 @@ void *ngli_calloc(size_t n, size_t size)
 {
     if (failure_requested())
         return NULL;
+    count_heap_alloc();
     return calloc(n, size);
 }
 
@@ -81,21 +137,14 @@ void *ngli_malloc_aligned(size_t size)
 {
     if (failure_requested())
         return NULL;
-
-    void *ptr;
-#ifdef TARGET_MINGW_W64
-    ptr = _aligned_malloc(size, NGLI_ALIGN_VAL);
-#else
-    if (posix_memalign(&ptr, NGLI_ALIGN_VAL, size))
-        ptr = NULL;
-#endif
-    return ptr;
+    return malloc_aligned(size);
 }
 
 void *ngli_realloc(void *ptr, size_t size)
 {
     if (failure_requested())
         return NULL;
+    count_heap_alloc();
     return realloc(ptr, size);
 }
 
@@ -112,3 +161,276 @@ void ngli_free_aligned(void *ptr)
     free(ptr);
 #endif
 }
+
+static void add_reserved(struct memory_stats *stats, size_t size)
+{
+    stats->reserved_size += size;
+    stats->peak_reserved_size = NGLI_MAX(stats->peak_reserved_size, stats->reserved_size);
+}
+
+#define SLAB_SIZE_STEP       NGLI_ALIGN_VAL
+#define SLAB_MAX_OBJECT_SIZE 1024
+#define SLAB_CHUNK_SIZE      (32 * 1024)
+#define SLAB_HEADER_SIZE     NGLI_ALIGN(sizeof(struct slab_chunk), NGLI_ALIGN_VAL)
+
+struct slab_chunk {
+    struct slab_chunk *next;
+};
+
+struct slab_class {
+    struct slab_chunk *chunks;
+    void *free_list;    // released objects, linked through their first bytes
+    uint8_t *cur;       // unused space of the most recent chunk
+    uint8_t *end;
+    size_t nb_objects;
+};
+
+struct slab {
+    struct slab_class classes[SLAB_MAX_OBJECT_SIZE / SLAB_SIZE_STEP];
+    struct memory_stats stats;
+};
+
+/*
+ * The slab hides the individual objects from the memory debugging tools, so
+ * it is bypassed in favor of the system allocator when they are in use.
+ */
+#if defined(DEBUG_MEM) || defined(__SANITIZE_ADDRESS__)
+# define SLAB_BYPASS 1
+#elif defined(__has_feature)
+# if __has_feature(address_sanitizer)
+#  define SLAB_BYPASS 1
+# endif
+#endif
+#ifndef SLAB_BYPASS
+# define SLAB_BYPASS 0
+#endif
+
+struct slab *ngli_slab_create(void)
+{
+    return ngli_calloc(1, sizeof(struct slab));
+}
+
+static void slab_release_chunks(struct slab *slab, struct slab_class *class)
+{
+    struct slab_chunk *chunk = class->chunks;
+    while (chunk) {
+        struct slab_chunk *next = chunk->next;
+        ngli_free_aligned(chunk);
+        slab->stats.reserved_size -= SLAB_CHUNK_SIZE;
+        chunk = next;
+    }
+    memset(class, 0, sizeof(*class));
+}
+
+void *ngli_slab_alloc(struct slab *slab, size_t size)
+{
+    if (failure_requested())
+        return NULL;
+
+    void *ptr;
+    if (SLAB_BYPASS || !size || size > SLAB_MAX_OBJECT_SIZE) {
+        ptr = malloc_aligned(size);
+        if (!ptr)
+            return NULL;
+        memset(ptr, 0, size);
+        return ptr;
+    }
+
+    const size_t index = (size - 1) / SLAB_SIZE_STEP;
+    const size_t object_size = (index + 1) * SLAB_SIZE_STEP;
+
+    struct slab_class *class = &slab->classes[index];
+    if (class->free_list) {
+        ptr = class->free_list;
+        class->free_list = *(void **)ptr;
+    } else {
+        if (class->cur + object_size > class->end) {
+            struct slab_chunk *chunk = malloc_aligned(SLAB_CHUNK_SIZE);
+            if (!chunk)
+                return NULL;
+            chunk->next = class->chunks;
+            class->chunks = chunk;
+            class->cur = (uint8_t *)chunk + SLAB_HEADER_SIZE;
+            class->end = (uint8_t *)chunk + SLAB_CHUNK_SIZE;
+            add_reserved(&slab->stats, SLAB_CHUNK_SIZE);
+        }
+        ptr = class->cur;
+        class->cur += object_size;
+    }
+    class->nb_objects++;
+    slab->stats.nb_allocs++;
+    slab->stats.allocated_size += object_size;
+
+    memset(ptr, 0, size);
+    return ptr;
+}
+
+void ngli_slab_free(struct slab *slab, void *ptr, size_t size)
+{
+    if (!ptr)
+        return;
+
+    if (SLAB_BYPASS || !size || size > SLAB_MAX_OBJECT_SIZE) {
+        ngli_free_aligned(ptr);
+        return;
+    }
+
+    const size_t index = (size - 1) / SLAB_SIZE_STEP;
+    const size_t object_size = (index + 1) * SLAB_SIZE_STEP;
+
+    struct slab_class *class = &slab->classes[index];
+    slab->stats.nb_allocs--;
+    slab->stats.allocated_size -= object_size;
+    if (--class->nb_objects == 0) {
+        slab_release_chunks(slab, class);
+    } else {
+        *(void **)ptr = class->free_list;
+        class->free_list = ptr;
+    }
+}
+
+void ngli_slab_get_stats(const struct slab *slab, struct memory_stats *stats)
+{
+    *stats = slab->stats;
+}
+
+void ngli_slab_freep(struct slab **slabp)
+{
+    struct slab *slab = *slabp;
+    if (!slab)
+        return;
+    report_stats("slab", &slab->stats);
+    for (int i = 0; i < NGLI_ARRAY_NB(slab->classes); i++)
+        slab_release_chunks(slab, &slab->classes[i]);
+    ngli_free(slab);
+    *slabp = NULL;
+}
+
+#define ARENA_ALIGN        NGLI_ALIGN_VAL
+#define ARENA_HEADER_SIZE  NGLI_ALIGN(sizeof(struct arena_block), ARENA_ALIGN)
+
+struct arena_block {
+    struct arena_block *next;
+    size_t size;
+};
+
+struct arena {
+    size_t block_size;
+    struct arena_block *blocks; // most recent block first
+    uint8_t *cur;
+    uint8_t *end;
+    void *last_alloc;
+    struct memory_stats stats;
+};
+
+struct arena *ngli_arena_create(size_t block_size)
+{
+    struct arena *arena = ngli_calloc(1, sizeof(*arena));
+    if (!arena)
+        return NULL;
+    arena->block_size = NGLI_MAX(block_size, 2 * ARENA_HEADER_SIZE);
+    return arena;
+}
+
+static int arena_grow(struct arena *arena, size_t size)
+{
+    /*
+     * The block size grows geometrically so that an allocation repeatedly
+     * extended with ngli_arena_realloc() only gets copied a logarithmic
+     * number of times.
+     */
+    while (arena->block_size < ARENA_HEADER_SIZE + size)
+        arena->block_size *= 2;
+    const size_t block_size = arena->block_size;
+    struct arena_block *block = malloc_aligned(block_size);
+    if (!block)
+        return -1;
+    block->next = arena->blocks;
+    block->size = block_size;
+    arena->blocks = block;
+    arena->cur = (uint8_t *)block + ARENA_HEADER_SIZE;
+    arena->end = (uint8_t *)block + block_size;
+    add_reserved(&arena->stats, block_size);
+    return 0;
+}
+
+void *ngli_arena_alloc(struct arena *arena, size_t size)
+{
+    if (failure_requested())
+        return NULL;
+
+    size = NGLI_ALIGN(size, ARENA_ALIGN);
+    if ((size_t)(arena->end - arena->cur) < size && arena_grow(arena, size) < 0)
+        return NULL;
+
+    void *ptr = arena->cur;
+    arena->cur += size;
+    arena->last_alloc = ptr;
+    arena->stats.nb_allocs++;
+    arena->stats.allocated_size += size;
+    return ptr;
+}
+
+void *ngli_arena_realloc(struct arena *arena, void *ptr, size_t old_size, size_t new_size)
+{
+    if (!ptr)
+        return ngli_arena_alloc(arena, new_size);
+
+    old_size = NGLI_ALIGN(old_size, ARENA_ALIGN);
+    new_size = NGLI_ALIGN(new_size, ARENA_ALIGN);
+
+    if (ptr == arena->last_alloc && (size_t)(arena->end - (uint8_t *)ptr) >= new_size) {
+        if (failure_requested())
+            return NULL;
+        arena->cur = (uint8_t *)ptr + new_size;
+        arena->stats.allocated_size += new_size - old_size;
+        return ptr;
+    }
+
+    void *new_ptr = ngli_arena_alloc(arena, new_size);
+    if (!new_ptr)
+        return NULL;
+    memcpy(new_ptr, ptr, NGLI_MIN(old_size, new_size));
+    return new_ptr;
+}
+
+void ngli_arena_reset(struct arena *arena)
+{
+    /* Only keep the most recent block, the others are released */
+    struct arena_block *block = arena->blocks;
+    if (!block)
+        return;
+    struct arena_block *next = block->next;
+    while (next) {
+        struct arena_block *tmp = next->next;
+        arena->stats.reserved_size -= next->size;
+        ngli_free_aligned(next);
+        next = tmp;
+    }
+    block->next = NULL;
+    arena->cur = (uint8_t *)block + ARENA_HEADER_SIZE;
+    arena->last_alloc = NULL;
+    arena->stats.nb_allocs = 0;
+    arena->stats.allocated_size = 0;
+}
+
+void ngli_arena_get_stats(const struct arena *arena, struct memory_stats *stats)
+{
+    *stats = arena->stats;
+}
+
+void ngli_arena_freep(struct arena **arenap)
+{
+    struct arena *arena = *arenap;
+    if (!arena)
+        return;
+    report_stats("arena", &arena->stats);
+    struct arena_block *block = arena->blocks;
+    while (block) {
+        struct arena_block *next = block->next;
+        ngli_free_aligned(block);
+        block = next;
+    }
+    ngli_free(arena);
+    *arenap = NULL;
+}
@@ -33,4 +33,55 @@ void *ngli_realloc(void *ptr, size_t size);
 void ngli_free(void *ptr);
 void ngli_free_aligned(void *ptr);
 
+/*
+ * Number of system heap allocations made by the library from the calling
+ * thread so far. It is only tracked in DEBUG_MEM builds and always 0
+ * otherwise.
+ */
+size_t ngli_memory_get_nb_heap_allocs(void);
+
+struct memory_stats {
+    size_t nb_allocs;           // number of live allocations
+    size_t allocated_size;      // bytes handed out to the live allocations
+    size_t reserved_size;       // bytes reserved from the system
+    size_t peak_reserved_size;
+};
+
+/*
+ * Size-class slab allocator: objects of similar sizes are carved from the
+ * same large chunks, which keeps them close in memory and avoids one system
+ * allocation per object. The returned memory is zeroed and aligned on
+ * NGLI_ALIGN_VAL. The size must be passed again when freeing the object. The
+ * chunks of a size class are all released at once when its last object is
+ * freed. A slab is not thread-safe: it belongs to a rendering context and is
+ * only used from its thread. It falls back on the system allocator in
+ * DEBUG_MEM and sanitizer builds.
+ */
+struct slab;
+
+struct slab *ngli_slab_create(void);
+void *ngli_slab_alloc(struct slab *slab, size_t size);
+void ngli_slab_free(struct slab *slab, void *ptr, size_t size);
+void ngli_slab_get_stats(const struct slab *slab, struct memory_stats *stats);
+void ngli_slab_freep(struct slab **slabp);
+
+/*
+ * Bump allocator for short-lived allocations: there is no individual free,
+ * all the allocations are released at once by ngli_arena_reset() or
+ * ngli_arena_freep().
+ */
+struct arena;
+
+struct arena *ngli_arena_create(size_t block_size);
+void *ngli_arena_alloc(struct arena *arena, size_t size);
+
+/*
+ * Grow (or shrink) an allocation; it is extended in place if it is the last
+ * one made in the arena and the current block has enough room left.
+ */
+void *ngli_arena_realloc(struct arena *arena, void *ptr, size_t old_size, size_t new_size);
+void ngli_arena_reset(struct arena *arena);
+void ngli_arena_get_stats(const struct arena *arena, struct memory_stats *stats);
+void ngli_arena_freep(struct arena **arenap);
+
 #endif
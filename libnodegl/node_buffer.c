@@ -19,18 +19,21 @@
  * under the License.
  */
 
-#include <fcntl.h>
+#include <limits.h>
 #include <stddef.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sys/types.h>
 #include <sys/stat.h>
-#include <unistd.h>
 
 #include "buffer.h"
+#include "dedup.h"
+#include "filemap.h"
 #include "log.h"
 #include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "utils.h"
 
 static const struct param_choices usage_choices = {
     .name = "buffer_usage",
@@ -73,22 +76,110 @@ static const struct node_param buffer_params[] = {
     {NULL}
 };
 
-int ngli_node_buffer_ref(struct ngl_node *node)
+int ngli_node_buffer_ref_data(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+
+    if (!s->filename || s->data_refcount++ > 0)
+        return 0;
+
+    s->filemap = ngli_filemap_open(s->filename);
+    if (!s->filemap) {
+        s->data_refcount = 0;
+        return -1;
+    }
+
+    if (ngli_filemap_size(s->filemap) != s->data_size) {
+        LOG(ERROR, "size of '%s' changed from %d to %zu bytes",
+            s->filename, s->data_size, ngli_filemap_size(s->filemap));
+        ngli_filemap_unrefp(&s->filemap);
+        s->data_refcount = 0;
+        return -1;
+    }
+
+    ngli_filemap_advise_sequential(s->filemap);
+    s->data = ngli_filemap_data(s->filemap);
+    return 0;
+}
+
+void ngli_node_buffer_unref_data(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
+
+    if (!s->filename)
+        return;
+
+    ngli_assert(s->data_refcount);
+    if (s->data_refcount-- == 1) {
+        s->data = NULL;
+        ngli_filemap_unrefp(&s->filemap);
+    }
+}
+
+/*
+ * The data read from a file is uploaded by chunks and the pages already
+ * uploaded are dropped, so that large files never need to be entirely resident
+ * in memory.
+ */
+#define FILE_UPLOAD_CHUNK_SIZE (4 << 20)
+
+static int upload_data(struct buffer_priv *s)
+{
+    if (!s->filemap)
+        return ngli_buffer_upload(&s->buffer, s->data, s->data_size);
+
+    for (int offset = 0; offset < s->data_size; offset += FILE_UPLOAD_CHUNK_SIZE) {
+        const int size = NGLI_MIN(s->data_size - offset, FILE_UPLOAD_CHUNK_SIZE);
+        int ret = ngli_buffer_upload_range(&s->buffer, s->data + offset, offset, size);
+        if (ret < 0)
+            return ret;
+        ngli_filemap_discard(s->filemap, offset, size);
+    }
+
+    return 0;
+}
+
+static int buffer_ref(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct glcontext *gl = ctx->glcontext;
     struct buffer_priv *s = node->priv_data;
 
-    if (s->buffer_refcount++ == 0) {
-        int ret = ngli_buffer_allocate(&s->buffer, gl, s->data_size, s->usage);
+    int ret = ngli_dedup_buffer_ref(node);
+    if (ret < 0)
+        return ret;
+
+    if (!ret) {
+        ret = ngli_buffer_allocate(&s->buffer, gl, s->data_size, s->usage);
+        if (ret < 0)
+            return ret;
+
+        ret = upload_data(s);
+        if (ret < 0)
+            return ret;
+
+        ret = ngli_dedup_buffer_register(node);
         if (ret < 0)
             return ret;
+    }
+
+    s->buffer_last_upload_time = -1.;
+    return 0;
+}
+
+int ngli_node_buffer_ref(struct ngl_node *node)
+{
+    struct buffer_priv *s = node->priv_data;
 
-        ret = ngli_buffer_upload(&s->buffer, s->data, s->data_size);
+    if (s->buffer_refcount++ == 0) {
+        int ret = ngli_node_buffer_ref_data(node);
         if (ret < 0)
             return ret;
 
-        s->buffer_last_upload_time = -1.;
+        ret = buffer_ref(node);
+        ngli_node_buffer_unref_data(node);
+        if (ret < 0)
+            return ret;
     }
 
     return 0;
@@ -99,8 +190,12 @@ void ngli_node_buffer_unref(struct ngl_node *node)
     struct buffer_priv *s = node->priv_data;
 
     ngli_assert(s->buffer_refcount);
-    if (s->buffer_refcount-- == 1)
-        ngli_buffer_free(&s->buffer);
+    if (s->buffer_refcount-- == 1) {
+        if (ngli_dedup_release(node, &s->shared))
+            memset(&s->buffer, 0, sizeof(s->buffer));
+        else
+            ngli_buffer_free(&s->buffer);
+    }
 }
 
 int ngli_node_buffer_upload(struct ngl_node *node)
@@ -138,19 +233,17 @@ static int buffer_init_from_filename(struct ngl_node *node)
 {
     struct buffer_priv *s = node->priv_data;
 
-    s->fd = open(s->filename, O_RDONLY);
-    if (s->fd < 0) {
-        LOG(ERROR, "could not open '%s'", s->filename);
+    /* The file is only mapped when the data is needed, see ngli_node_buffer_ref_data() */
+    struct stat st;
+    if (stat(s->filename, &st) < 0) {
+        LOG(ERROR, "could not stat '%s'", s->filename);
         return -1;
     }
-
-    off_t filesize = lseek(s->fd, 0, SEEK_END);
-    off_t ret      = lseek(s->fd, 0, SEEK_SET);
-    if (filesize < 0 || ret < 0) {
-        LOG(ERROR, "could not seek in '%s'", s->filename);
+    if (st.st_size > INT_MAX) {
+        LOG(ERROR, "'%s' is too large", s->filename);
         return -1;
     }
-    s->data_size = filesize;
+    s->data_size = st.st_size;
     s->count = s->count ? s->count : s->data_size / s->data_stride;
 
     if (s->data_size != s->count * s->data_stride) {
@@ -162,21 +255,6 @@ static int buffer_init_from_filename(struct ngl_node *node)
         return -1;
     }
 
-    s->data = ngli_calloc(s->count, s->data_stride);
-    if (!s->data)
-        return -1;
-
-    ssize_t n = read(s->fd, s->data, s->data_size);
-    if (n < 0) {
-        LOG(ERROR, "could not read '%s': %zd", s->filename, n);
-        return -1;
-    }
-
-    if (n != s->data_size) {
-        LOG(ERROR, "read %zd bytes does not match expected size of %d bytes", n, s->data_size);
-        return -1;
-    }
-
     return 0;
 }
 
@@ -204,39 +282,43 @@ static int buffer_init(struct ngl_node *node)
     }
 
     int ret;
-    int data_comp_size;
     int nb_comp;
     int format;
 
     switch (node->class->id) {
-    case NGL_NODE_BUFFERBYTE:   data_comp_size = 1; nb_comp = 1; format = NGLI_FORMAT_R8_SNORM;               break;
-    case NGL_NODE_BUFFERBVEC2:  data_comp_size = 1; nb_comp = 2; format = NGLI_FORMAT_R8G8_SNORM;             break;
-    case NGL_NODE_BUFFERBVEC3:  data_comp_size = 1; nb_comp = 3; format = NGLI_FORMAT_R8G8B8_SNORM;           break;
-    case NGL_NODE_BUFFERBVEC4:  data_comp_size = 1; nb_comp = 4; format = NGLI_FORMAT_R8G8B8A8_SNORM;         break;
-    case NGL_NODE_BUFFERINT:    data_comp_size = 4; nb_comp = 1; format = NGLI_FORMAT_R32_SINT;               break;
-    case NGL_NODE_BUFFERIVEC2:  data_comp_size = 4; nb_comp = 2; format = NGLI_FORMAT_R32G32_SINT;            break;
-    case NGL_NODE_BUFFERIVEC3:  data_comp_size = 4; nb_comp = 3; format = NGLI_FORMAT_R32G32B32_SINT;         break;
-    case NGL_NODE_BUFFERIVEC4:  data_comp_size = 4; nb_comp = 4; format = NGLI_FORMAT_R32G32B32A32_SINT;      break;
-    case NGL_NODE_BUFFERSHORT:  data_comp_size = 2; nb_comp = 1; format = NGLI_FORMAT_R16_SNORM;              break;
-    case NGL_NODE_BUFFERSVEC2:  data_comp_size = 2; nb_comp = 2; format = NGLI_FORMAT_R16G16_SNORM;           break;
-    case NGL_NODE_BUFFERSVEC3:  data_comp_size = 2; nb_comp = 3; format = NGLI_FORMAT_R16G16B16_SNORM;        break;
-    case NGL_NODE_BUFFERSVEC4:  data_comp_size = 2; nb_comp = 4; format = NGLI_FORMAT_R16G16B16A16_SNORM;     break;
-    case NGL_NODE_BUFFERUBYTE:  data_comp_size = 1; nb_comp = 1; format = NGLI_FORMAT_R8_UNORM;               break;
-    case NGL_NODE_BUFFERUBVEC2: data_comp_size = 1; nb_comp = 2; format = NGLI_FORMAT_R8G8_UNORM;             break;
-    case NGL_NODE_BUFFERUBVEC3: data_comp_size = 1; nb_comp = 3; format = NGLI_FORMAT_R8G8B8_UNORM;           break;
-    case NGL_NODE_BUFFERUBVEC4: data_comp_size = 1; nb_comp = 4; format = NGLI_FORMAT_R8G8B8A8_UNORM;         break;
-    case NGL_NODE_BUFFERUINT:   data_comp_size = 4; nb_comp = 1; format = NGLI_FORMAT_R32_UINT;               break;
-    case NGL_NODE_BUFFERUIVEC2: data_comp_size = 4; nb_comp = 2; format = NGLI_FORMAT_R32G32_UINT;            break;
-    case NGL_NODE_BUFFERUIVEC3: data_comp_size = 4; nb_comp = 3; format = NGLI_FORMAT_R32G32B32_UINT;         break;
-    case NGL_NODE_BUFFERUIVEC4: data_comp_size = 4; nb_comp = 4; format = NGLI_FORMAT_R32G32B32A32_UINT;      break;
-    case NGL_NODE_BUFFERUSHORT: data_comp_size = 2; nb_comp = 1; format = NGLI_FORMAT_R16_UNORM;              break;
-    case NGL_NODE_BUFFERUSVEC2: data_comp_size = 2; nb_comp = 2; format = NGLI_FORMAT_R16G16_UNORM;           break;
-    case NGL_NODE_BUFFERUSVEC3: data_comp_size = 2; nb_comp = 3; format = NGLI_FORMAT_R16G16B16_UNORM;        break;
-    case NGL_NODE_BUFFERUSVEC4: data_comp_size = 2; nb_comp = 4; format = NGLI_FORMAT_R16G16B16A16_UNORM;     break;
-    case NGL_NODE_BUFFERFLOAT:  data_comp_size = 4; nb_comp = 1; format = NGLI_FORMAT_R32_SFLOAT;             break;
-    case NGL_NODE_BUFFERVEC2:   data_comp_size = 4; nb_comp = 2; format = NGLI_FORMAT_R32G32_SFLOAT;          break;
-    case NGL_NODE_BUFFERVEC3:   data_comp_size = 4; nb_comp = 3; format = NGLI_FORMAT_R32G32B32_SFLOAT;       break;
-    case NGL_NODE_BUFFERVEC4:   data_comp_size = 4; nb_comp = 4; format = NGLI_FORMAT_R32G32B32A32_SFLOAT;    break;
+    case NGL_NODE_BUFFERBYTE:   nb_comp = 1; format = NGLI_FORMAT_R8_SNORM;               break;
+    case NGL_NODE_BUFFERBVEC2:  nb_comp = 2; format = NGLI_FORMAT_R8G8_SNORM;             break;
+    case NGL_NODE_BUFFERBVEC3:  nb_comp = 3; format = NGLI_FORMAT_R8G8B8_SNORM;           break;
+    case NGL_NODE_BUFFERBVEC4:  nb_comp = 4; format = NGLI_FORMAT_R8G8B8A8_SNORM;         break;
+    case NGL_NODE_BUFFERINT:    nb_comp = 1; format = NGLI_FORMAT_R32_SINT;               break;
+    case NGL_NODE_BUFFERIVEC2:  nb_comp = 2; format = NGLI_FORMAT_R32G32_SINT;            break;
+    case NGL_NODE_BUFFERIVEC3:  nb_comp = 3; format = NGLI_FORMAT_R32G32B32_SINT;         break;
+    case NGL_NODE_BUFFERIVEC4:  nb_comp = 4; format = NGLI_FORMAT_R32G32B32A32_SINT;      break;
+    case NGL_NODE_BUFFERINT2101010REV: nb_comp = 4; format = NGLI_FORMAT_A2B10G10R10_SNORM_PACK32; break;
+    case NGL_NODE_BUFFERSHORT:  nb_comp = 1; format = NGLI_FORMAT_R16_SNORM;              break;
+    case NGL_NODE_BUFFERSVEC2:  nb_comp = 2; format = NGLI_FORMAT_R16G16_SNORM;           break;
+    case NGL_NODE_BUFFERSVEC3:  nb_comp = 3; format = NGLI_FORMAT_R16G16B16_SNORM;        break;
+    case NGL_NODE_BUFFERSVEC4:  nb_comp = 4; format = NGLI_FORMAT_R16G16B16A16_SNORM;     break;
+    case NGL_NODE_BUFFERUBYTE:  nb_comp = 1; format = NGLI_FORMAT_R8_UNORM;               break;
+    case NGL_NODE_BUFFERUBVEC2: nb_comp = 2; format = NGLI_FORMAT_R8G8_UNORM;             break;
+    case NGL_NODE_BUFFERUBVEC3: nb_comp = 3; format = NGLI_FORMAT_R8G8B8_UNORM;           break;
+    case NGL_NODE_BUFFERUBVEC4: nb_comp = 4; format = NGLI_FORMAT_R8G8B8A8_UNORM;         break;
+    case NGL_NODE_BUFFERUINT:   nb_comp = 1; format = NGLI_FORMAT_R32_UINT;               break;
+    case NGL_NODE_BUFFERUIVEC2: nb_comp = 2; format = NGLI_FORMAT_R32G32_UINT;            break;
+    case NGL_NODE_BUFFERUIVEC3: nb_comp = 3; format = NGLI_FORMAT_R32G32B32_UINT;         break;
+    case NGL_NODE_BUFFERUIVEC4: nb_comp = 4; format = NGLI_FORMAT_R32G32B32A32_UINT;      break;
+    case NGL_NODE_BUFFERUSHORT: nb_comp = 1; format = NGLI_FORMAT_R16_UNORM;              break;
+    case NGL_NODE_BUFFERUSVEC2: nb_comp = 2; format = NGLI_FORMAT_R16G16_UNORM;           break;
+    case NGL_NODE_BUFFERUSVEC3: nb_comp = 3; format = NGLI_FORMAT_R16G16B16_UNORM;        break;
+    case NGL_NODE_BUFFERUSVEC4: nb_comp = 4; format = NGLI_FORMAT_R16G16B16A16_UNORM;     break;
+    case NGL_NODE_BUFFERHALF:   nb_comp = 1; format = NGLI_FORMAT_R16_SFLOAT;             break;
+    case NGL_NODE_BUFFERHVEC2:  nb_comp = 2; format = NGLI_FORMAT_R16G16_SFLOAT;          break;
+    case NGL_NODE_BUFFERHVEC3:  nb_comp = 3; format = NGLI_FORMAT_R16G16B16_SFLOAT;       break;
+    case NGL_NODE_BUFFERHVEC4:  nb_comp = 4; format = NGLI_FORMAT_R16G16B16A16_SFLOAT;    break;
+    case NGL_NODE_BUFFERFLOAT:  nb_comp = 1; format = NGLI_FORMAT_R32_SFLOAT;             break;
+    case NGL_NODE_BUFFERVEC2:   nb_comp = 2; format = NGLI_FORMAT_R32G32_SFLOAT;          break;
+    case NGL_NODE_BUFFERVEC3:   nb_comp = 3; format = NGLI_FORMAT_R32G32B32_SFLOAT;       break;
+    case NGL_NODE_BUFFERVEC4:   nb_comp = 4; format = NGLI_FORMAT_R32G32B32A32_SFLOAT;    break;
     default:
         ngli_assert(0);
     }
@@ -245,7 +327,7 @@ static int buffer_init(struct ngl_node *node)
     s->data_format = format;
 
     if (!s->data_stride)
-        s->data_stride = s->data_comp * data_comp_size;
+        s->data_stride = ngli_format_get_bytes_per_pixel(s->data_format);
 
     if (s->data)
         ret = buffer_init_from_data(node);
@@ -264,16 +346,8 @@ static void buffer_uninit(struct ngl_node *node)
     struct buffer_priv *s = node->priv_data;
 
     if (s->filename) {
-        ngli_free(s->data);
-        s->data = NULL;
+        ngli_assert(!s->data_refcount);
         s->data_size = 0;
-
-        if (s->fd) {
-            int ret = close(s->fd);
-            if (ret < 0) {
-                LOG(ERROR, "could not properly close '%s'", s->filename);
-            }
-        }
     }
 }
 
@@ -297,6 +371,7 @@ DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERINT,     "BufferInt",     int)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERIVEC2,   "BufferIVec2",   ivec2)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERIVEC3,   "BufferIVec3",   ivec3)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERIVEC4,   "BufferIVec4",   ivec4)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERINT2101010REV, "BufferInt2101010Rev", int2101010rev)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERSHORT,   "BufferShort",   short)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERSVEC2,   "BufferSVec2",   svec2)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERSVEC3,   "BufferSVec3",   svec3)
@@ -313,6 +388,10 @@ DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERUSHORT,  "BufferUShort",  ushort)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERUSVEC2,  "BufferUSVec2",  usvec2)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERUSVEC3,  "BufferUSVec3",  usvec3)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERUSVEC4,  "BufferUSVec4",  usvec4)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHALF,    "BufferHalf",    half)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHVEC2,   "BufferHVec2",   hvec2)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHVEC3,   "BufferHVec3",   hvec3)
+DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERHVEC4,   "BufferHVec4",   hvec4)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERFLOAT,   "BufferFloat",   float)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERVEC2,    "BufferVec2",    vec2)
 DEFINE_BUFFER_CLASS(NGL_NODE_BUFFERVEC3,    "BufferVec3",    vec3)
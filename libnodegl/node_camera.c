@@ -240,18 +240,18 @@ static void camera_draw(struct ngl_node *node)
     ngli_darray_pop(&ctx->projection_matrix_stack);
 
     if (s->pipe_fd) {
-        GLuint framebuffer_read_id;
-        GLuint framebuffer_draw_id;
+        GLuint framebuffer_read_id = 0;
+        GLuint framebuffer_draw_id = 0;
 
         if (s->samples > 0) {
-            ngli_glGetIntegerv(gl, GL_READ_FRAMEBUFFER_BINDING, (GLint *)&framebuffer_read_id);
-            ngli_glGetIntegerv(gl, GL_DRAW_FRAMEBUFFER_BINDING, (GLint *)&framebuffer_draw_id);
+            framebuffer_read_id = ngli_glstate_get_framebuffer(gl, GL_READ_FRAMEBUFFER);
+            framebuffer_draw_id = ngli_glstate_get_framebuffer(gl, GL_DRAW_FRAMEBUFFER);
 
-            ngli_glBindFramebuffer(gl, GL_READ_FRAMEBUFFER, framebuffer_draw_id);
-            ngli_glBindFramebuffer(gl, GL_DRAW_FRAMEBUFFER, s->fbo.id);
+            ngli_glstate_bind_framebuffer(gl, GL_READ_FRAMEBUFFER, framebuffer_draw_id);
+            ngli_glstate_bind_framebuffer(gl, GL_DRAW_FRAMEBUFFER, s->fbo.id);
             ngli_glBlitFramebuffer(gl, 0, 0, s->pipe_width, s->pipe_height, 0, 0, s->pipe_width, s->pipe_height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
 
-            ngli_glBindFramebuffer(gl, GL_READ_FRAMEBUFFER, s->fbo.id);
+            ngli_glstate_bind_framebuffer(gl, GL_READ_FRAMEBUFFER, s->fbo.id);
         }
 
         TRACE("write %dx%d buffer to FD=%d", s->pipe_width, s->pipe_height, s->pipe_fd);
@@ -265,8 +265,8 @@ static void camera_draw(struct ngl_node *node)
         }
 
         if (s->samples > 0) {
-            ngli_glBindFramebuffer(gl, GL_READ_FRAMEBUFFER, framebuffer_read_id);
-            ngli_glBindFramebuffer(gl, GL_DRAW_FRAMEBUFFER, framebuffer_draw_id);
+            ngli_glstate_bind_framebuffer(gl, GL_READ_FRAMEBUFFER, framebuffer_read_id);
+            ngli_glstate_bind_framebuffer(gl, GL_DRAW_FRAMEBUFFER, framebuffer_draw_id);
         }
     }
 }
@@ -104,7 +104,7 @@ static int circle_init(struct ngl_node *node)
 
     s->topology = GL_TRIANGLE_FAN;
 
-    ret = 0;
+    ret = ngli_node_geometry_update_aabb(node);
 
 end:
     ngli_free(vertices);
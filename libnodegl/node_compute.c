@@ -125,7 +125,7 @@ static void compute_draw(struct ngl_node *node)
     struct compute_priv *s = node->priv_data;
 
     const struct program_priv *program = s->pipeline.program->priv_data;
-    ngli_glUseProgram(gl, program->program_id);
+    ngli_glstate_use_program(gl, program->program_id);
 
     int ret = ngli_pipeline_upload_data(node);
     if (ret < 0) {
@@ -135,6 +135,7 @@ static void compute_draw(struct ngl_node *node)
     ngli_glMemoryBarrier(gl, GL_ALL_BARRIER_BITS);
     ngli_glDispatchCompute(gl, s->nb_group_x, s->nb_group_y, s->nb_group_z);
     ngli_glMemoryBarrier(gl, GL_ALL_BARRIER_BITS);
+    ctx->stats.cur.nb_dispatches++;
 }
 
 const struct node_class ngli_compute_class = {
@@ -36,69 +36,22 @@ static const struct node_param computeprogram_params[] = {
     {NULL}
 };
 
-static GLuint load_shader(struct ngl_node *node, const char *compute_shader_data)
-{
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
-
-    GLuint program = ngli_glCreateProgram(gl);
-    GLuint compute_shader = ngli_glCreateShader(gl, GL_COMPUTE_SHADER);
-
-    ngli_glShaderSource(gl, compute_shader, 1, &compute_shader_data, NULL);
-    ngli_glCompileShader(gl, compute_shader);
-    if (ngli_program_check_status(gl, compute_shader, GL_COMPILE_STATUS) < 0)
-        goto fail;
-
-    ngli_glAttachShader(gl, program, compute_shader);
-    ngli_glLinkProgram(gl, program);
-    if (ngli_program_check_status(gl, program, GL_LINK_STATUS) < 0)
-        goto fail;
-
-    ngli_glDeleteShader(gl, compute_shader);
-
-    return program;
-
-fail:
-    if (compute_shader)
-        ngli_glDeleteShader(gl, compute_shader);
-    if (program)
-        ngli_glDeleteProgram(gl, program);
-
-    return 0;
-}
-
 static int computeprogram_init(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct glcontext *gl = ctx->glcontext;
-    struct program_priv *s = node->priv_data;
 
     if (!(gl->features & NGLI_FEATURE_COMPUTE_SHADER_ALL)) {
         LOG(ERROR, "context does not support compute shaders");
         return -1;
     }
 
-    s->program_id = load_shader(node, s->compute);
-    if (!s->program_id)
-        return -1;
-
-    s->active_uniforms = ngli_program_probe_uniforms(node->label, gl, s->program_id);
-    s->active_buffer_blocks = ngli_program_probe_buffer_blocks(node->label, gl, s->program_id);
-    if (!s->active_uniforms || !s->active_buffer_blocks)
-        return -1;
-
-    return 0;
+    return ngli_node_program_ref(node);
 }
 
 static void computeprogram_uninit(struct ngl_node *node)
 {
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
-    struct program_priv *s = node->priv_data;
-
-    ngli_hmap_freep(&s->active_uniforms);
-    ngli_hmap_freep(&s->active_buffer_blocks);
-    ngli_glDeleteProgram(gl, s->program_id);
+    ngli_node_program_unref(node);
 }
 
 const struct node_class ngli_computeprogram_class = {
@@ -19,13 +19,19 @@
  * under the License.
  */
 
+#include <float.h>
 #include <stddef.h>
 #include <stdlib.h>
 #include <string.h>
 
 #include "log.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "utils.h"
+#include "vertexcache.h"
+
+#define VERTEX_CACHE_SIZE 16
 
 struct ngl_node *ngli_node_geometry_generate_buffer(struct ngl_ctx *ctx, int type, int count, int size, void *data)
 {
@@ -47,6 +53,32 @@ fail:
     return NULL;
 }
 
+int ngli_node_geometry_update_aabb(struct ngl_node *node)
+{
+    struct geometry_priv *s = node->priv_data;
+
+    int ret = ngli_node_buffer_ref_data(s->vertices_buffer);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < 3; i++) {
+        s->aabb_min[i] =  FLT_MAX;
+        s->aabb_max[i] = -FLT_MAX;
+    }
+
+    const struct buffer_priv *vertices = s->vertices_buffer->priv_data;
+    for (int i = 0; i < vertices->count; i++) {
+        const float *vertex = (const float *)(vertices->data + i * vertices->data_stride);
+        for (int j = 0; j < 3; j++) {
+            s->aabb_min[j] = NGLI_MIN(s->aabb_min[j], vertex[j]);
+            s->aabb_max[j] = NGLI_MAX(s->aabb_max[j], vertex[j]);
+        }
+    }
+
+    ngli_node_buffer_unref_data(s->vertices_buffer);
+    return 0;
+}
+
 static const struct param_choices topology_choices = {
     .name = "topology",
     .consts = {
@@ -64,39 +96,261 @@ static const struct param_choices topology_choices = {
 #define TEXCOORDS_TYPES_LIST (const int[]){NGL_NODE_BUFFERFLOAT,            \
                                            NGL_NODE_BUFFERVEC2,             \
                                            NGL_NODE_BUFFERVEC3,             \
+                                           NGL_NODE_BUFFERHALF,             \
+                                           NGL_NODE_BUFFERHVEC2,            \
+                                           NGL_NODE_BUFFERHVEC3,            \
+                                           NGL_NODE_BUFFERBYTE,             \
+                                           NGL_NODE_BUFFERBVEC2,            \
+                                           NGL_NODE_BUFFERBVEC3,            \
+                                           NGL_NODE_BUFFERSHORT,            \
+                                           NGL_NODE_BUFFERSVEC2,            \
+                                           NGL_NODE_BUFFERSVEC3,            \
+                                           NGL_NODE_BUFFERUBYTE,            \
+                                           NGL_NODE_BUFFERUBVEC2,           \
+                                           NGL_NODE_BUFFERUBVEC3,           \
+                                           NGL_NODE_BUFFERUSHORT,           \
+                                           NGL_NODE_BUFFERUSVEC2,           \
+                                           NGL_NODE_BUFFERUSVEC3,           \
                                            NGL_NODE_ANIMATEDBUFFERFLOAT,    \
                                            NGL_NODE_ANIMATEDBUFFERVEC2,     \
                                            NGL_NODE_ANIMATEDBUFFERVEC3,     \
                                            -1}
 
+#define NORMALS_TYPES_LIST (const int[]){NGL_NODE_BUFFERVEC3,               \
+                                         NGL_NODE_BUFFERHVEC3,              \
+                                         NGL_NODE_BUFFERBVEC3,              \
+                                         NGL_NODE_BUFFERSVEC3,              \
+                                         NGL_NODE_BUFFERINT2101010REV,      \
+                                         NGL_NODE_ANIMATEDBUFFERVEC3,       \
+                                         -1}
+
 #define OFFSET(x) offsetof(struct geometry_priv, x)
 static const struct node_param geometry_params[] = {
-    {"vertices",  PARAM_TYPE_NODE, OFFSET(vertices_buffer),
+    {"vertices",  PARAM_TYPE_NODE, OFFSET(geometry_vertices),
                   .node_types=(const int[]){NGL_NODE_BUFFERVEC3, NGL_NODE_ANIMATEDBUFFERVEC3, -1},
                   .flags=PARAM_FLAG_CONSTRUCTOR | PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
                   .desc=NGLI_DOCSTRING("vertice coordinates defining the geometry")},
-    {"uvcoords",  PARAM_TYPE_NODE, OFFSET(uvcoords_buffer),
+    {"uvcoords",  PARAM_TYPE_NODE, OFFSET(geometry_uvcoords),
                   .node_types=TEXCOORDS_TYPES_LIST,
                   .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
                   .desc=NGLI_DOCSTRING("coordinates used for UV mapping of each `vertices`")},
-    {"normals",   PARAM_TYPE_NODE, OFFSET(normals_buffer),
-                  .node_types=(const int[]){NGL_NODE_BUFFERVEC3, NGL_NODE_ANIMATEDBUFFERVEC3, -1},
+    {"normals",   PARAM_TYPE_NODE, OFFSET(geometry_normals),
+                  .node_types=NORMALS_TYPES_LIST,
                   .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
                   .desc=NGLI_DOCSTRING("normal vectors of each `vertices`")},
-    {"indices",   PARAM_TYPE_NODE, OFFSET(indices_buffer),
+    {"indices",   PARAM_TYPE_NODE, OFFSET(geometry_indices),
                   .node_types=(const int[]){NGL_NODE_BUFFERUBYTE, NGL_NODE_BUFFERUINT, NGL_NODE_BUFFERUSHORT, -1},
                   .flags=PARAM_FLAG_DOT_DISPLAY_FIELDNAME,
                   .desc=NGLI_DOCSTRING("indices defining the drawing order of the `vertices`, auto-generated if not set")},
     {"topology",  PARAM_TYPE_SELECT, OFFSET(topology), {.i64=GL_TRIANGLES},
                   .choices=&topology_choices,
                   .desc=NGLI_DOCSTRING("primitive topology")},
+    {"optimize",  PARAM_TYPE_BOOL, OFFSET(optimize), {.i64=0},
+                  .desc=NGLI_DOCSTRING("reorder the triangles and the `vertices` (along with the `uvcoords` and `normals`) "
+                                       "of an indexed triangle list for the vertex caches of the GPU; "
+                                       "the extra vertex attributes of the Render nodes must follow the same order "
+                                       "and are thus not allowed")},
     {NULL}
 };
 
+/* Buffers rewritten by the optimization, indices last */
+static const struct {
+    int param_offset;
+    int buffer_offset;
+} geometry_buffers[] = {
+    {OFFSET(geometry_vertices), OFFSET(vertices_buffer)},
+    {OFFSET(geometry_uvcoords), OFFSET(uvcoords_buffer)},
+    {OFFSET(geometry_normals),  OFFSET(normals_buffer)},
+    {OFFSET(geometry_indices),  OFFSET(indices_buffer)},
+};
+
+#define PARAM_NODE_P(s, i)  ((struct ngl_node **)((uint8_t *)(s) + geometry_buffers[i].param_offset))
+#define BUFFER_NODE_P(s, i) ((struct ngl_node **)((uint8_t *)(s) + geometry_buffers[i].buffer_offset))
+
+static uint32_t *read_indices(const struct buffer_priv *indices)
+{
+    uint32_t *data = ngli_calloc(indices->count, sizeof(*data));
+    if (!data)
+        return NULL;
+    for (int i = 0; i < indices->count; i++) {
+        switch (indices->data_stride) {
+        case 1: data[i] = indices->data[i];                      break;
+        case 2: data[i] = ((const uint16_t *)indices->data)[i];  break;
+        case 4: data[i] = ((const uint32_t *)indices->data)[i];  break;
+        }
+    }
+    return data;
+}
+
+static struct ngl_node *generate_indices(struct ngl_ctx *ctx, const uint32_t *data, int count,
+                                         int nb_vertices, int stride)
+{
+    /* The indices are shrunk to 16-bit whenever possible */
+    if (stride > 2 && nb_vertices <= UINT16_MAX + 1)
+        stride = 2;
+
+    void *indices = ngli_calloc(count, stride);
+    if (!indices)
+        return NULL;
+    for (int i = 0; i < count; i++) {
+        switch (stride) {
+        case 1: ((uint8_t  *)indices)[i] = data[i]; break;
+        case 2: ((uint16_t *)indices)[i] = data[i]; break;
+        case 4: ((uint32_t *)indices)[i] = data[i]; break;
+        }
+    }
+
+    const int type = stride == 1 ? NGL_NODE_BUFFERUBYTE :
+                     stride == 2 ? NGL_NODE_BUFFERUSHORT : NGL_NODE_BUFFERUINT;
+    struct ngl_node *node = ngli_node_geometry_generate_buffer(ctx, type, count, count * stride, indices);
+    ngli_free(indices);
+    return node;
+}
+
+static struct ngl_node *generate_remapped_buffer(struct ngl_ctx *ctx, const struct ngl_node *bnode,
+                                                 const uint32_t *remap)
+{
+    const struct buffer_priv *buffer = bnode->priv_data;
+    uint8_t *data = ngli_malloc(buffer->data_size);
+    if (!data)
+        return NULL;
+    for (int i = 0; i < buffer->count; i++)
+        memcpy(data + remap[i] * buffer->data_stride, buffer->data + i * buffer->data_stride, buffer->data_stride);
+
+    struct ngl_node *node = ngli_node_geometry_generate_buffer(ctx, bnode->class->id, buffer->count,
+                                                               buffer->data_size, data);
+    ngli_free(data);
+    return node;
+}
+
+static int optimize_buffers(struct ngl_node *node, struct ngl_node **optimized)
+{
+    struct geometry_priv *s = node->priv_data;
+    const struct buffer_priv *vertices = s->vertices_buffer->priv_data;
+    const struct buffer_priv *indices = s->indices_buffer->priv_data;
+    const int nb_vertices = vertices->count;
+    const int nb_indices = indices->count;
+
+    int ret = -1;
+    uint32_t *remap = ngli_calloc(nb_vertices, sizeof(*remap));
+    uint32_t *optimized_indices = ngli_calloc(nb_indices, sizeof(*optimized_indices));
+    uint32_t *user_indices = read_indices(indices);
+    if (!remap || !optimized_indices || !user_indices)
+        goto end;
+
+    for (int i = 0; i < nb_indices; i++) {
+        if (user_indices[i] >= nb_vertices) {
+            LOG(ERROR, "index %u exceeds the number of vertices (%d)", user_indices[i], nb_vertices);
+            goto end;
+        }
+    }
+
+    if ((ret = ngli_vertexcache_optimize(optimized_indices, user_indices, nb_indices,
+                                         nb_vertices, VERTEX_CACHE_SIZE)) < 0)
+        goto end;
+    ngli_vertexcache_remap(remap, optimized_indices, nb_indices, nb_vertices);
+
+    ret = -1;
+    for (int i = 0; i < NGLI_ARRAY_NB(geometry_buffers) - 1; i++) {
+        const struct ngl_node *bnode = *BUFFER_NODE_P(s, i);
+        if (!bnode)
+            continue;
+        optimized[i] = generate_remapped_buffer(node->ctx, bnode, remap);
+        if (!optimized[i])
+            goto end;
+    }
+
+    optimized[NGLI_ARRAY_NB(geometry_buffers) - 1] =
+        generate_indices(node->ctx, optimized_indices, nb_indices, nb_vertices, indices->data_stride);
+    if (!optimized[NGLI_ARRAY_NB(geometry_buffers) - 1])
+        goto end;
+
+    ret = 0;
+
+end:
+    ngli_free(remap);
+    ngli_free(optimized_indices);
+    ngli_free(user_indices);
+    return ret;
+}
+
+static int can_optimize(const struct geometry_priv *s)
+{
+    if (s->topology != GL_TRIANGLES || !s->indices_buffer) {
+        LOG(WARNING, "only indexed triangle lists can be optimized");
+        return 0;
+    }
+
+    for (int i = 0; i < NGLI_ARRAY_NB(geometry_buffers); i++) {
+        const struct ngl_node *bnode = *BUFFER_NODE_P(s, i);
+        const struct buffer_priv *buffer = bnode ? bnode->priv_data : NULL;
+        if (buffer && buffer->dynamic) {
+            LOG(WARNING, "geometries with animated buffers can not be optimized");
+            return 0;
+        }
+    }
+
+    const struct buffer_priv *indices = s->indices_buffer->priv_data;
+    if (indices->count % 3) {
+        LOG(ERROR, "number of indices (%d) is not a multiple of 3", indices->count);
+        return -1;
+    }
+
+    return 1;
+}
+
+static int optimize_geometry(struct ngl_node *node)
+{
+    struct geometry_priv *s = node->priv_data;
+
+    int ret = can_optimize(s);
+    if (ret <= 0)
+        return ret;
+
+    int nb_refs = 0;
+    for (; nb_refs < NGLI_ARRAY_NB(geometry_buffers); nb_refs++) {
+        struct ngl_node *bnode = *BUFFER_NODE_P(s, nb_refs);
+        if (bnode && (ret = ngli_node_buffer_ref_data(bnode)) < 0)
+            break;
+    }
+
+    struct ngl_node *optimized[NGLI_ARRAY_NB(geometry_buffers)] = {NULL};
+    if (ret >= 0)
+        ret = optimize_buffers(node, optimized);
+
+    for (int i = 0; i < nb_refs; i++) {
+        struct ngl_node *bnode = *BUFFER_NODE_P(s, i);
+        if (bnode)
+            ngli_node_buffer_unref_data(bnode);
+    }
+
+    /* The optimized buffers are drawn instead of the user ones, which are
+     * left untouched in the parameters */
+    for (int i = 0; i < NGLI_ARRAY_NB(geometry_buffers); i++) {
+        if (!optimized[i])
+            continue;
+        if (ret < 0) {
+            ngli_node_detach_ctx(optimized[i]);
+            ngl_node_unrefp(&optimized[i]);
+            continue;
+        }
+        struct ngl_node **bnodep = BUFFER_NODE_P(s, i);
+        ngl_node_unrefp(bnodep);
+        *bnodep = optimized[i];
+    }
+
+    return ret;
+}
+
 static int geometry_init(struct ngl_node *node)
 {
     struct geometry_priv *s = node->priv_data;
 
+    for (int i = 0; i < NGLI_ARRAY_NB(geometry_buffers); i++) {
+        struct ngl_node *bnode = *PARAM_NODE_P(s, i);
+        *BUFFER_NODE_P(s, i) = bnode ? ngl_node_ref(bnode) : NULL;
+    }
+
     struct buffer_priv *vertices = s->vertices_buffer->priv_data;
 
     if (s->uvcoords_buffer) {
@@ -121,7 +375,13 @@ static int geometry_init(struct ngl_node *node)
         }
     }
 
-    return 0;
+    if (s->optimize) {
+        int ret = optimize_geometry(node);
+        if (ret < 0)
+            return ret;
+    }
+
+    return ngli_node_geometry_update_aabb(node);
 }
 
 static int geometry_update(struct ngl_node *node, double t)
@@ -132,6 +392,13 @@ static int geometry_update(struct ngl_node *node, double t)
     if (ret < 0)
         return ret;
 
+    const struct buffer_priv *vertices = s->vertices_buffer->priv_data;
+    if (vertices->dynamic) {
+        ret = ngli_node_geometry_update_aabb(node);
+        if (ret < 0)
+            return ret;
+    }
+
     if (s->uvcoords_buffer) {
         ret = ngli_node_update(s->uvcoords_buffer, t);
         if (ret < 0)
@@ -147,10 +414,23 @@ static int geometry_update(struct ngl_node *node, double t)
     return 0;
 }
 
+static void geometry_uninit(struct ngl_node *node)
+{
+    struct geometry_priv *s = node->priv_data;
+
+    for (int i = 0; i < NGLI_ARRAY_NB(geometry_buffers); i++) {
+        struct ngl_node **bnodep = BUFFER_NODE_P(s, i);
+        if (*bnodep && *bnodep != *PARAM_NODE_P(s, i))
+            ngli_node_detach_ctx(*bnodep);
+        ngl_node_unrefp(bnodep);
+    }
+}
+
 const struct node_class ngli_geometry_class = {
     .id        = NGL_NODE_GEOMETRY,
     .name      = "Geometry",
     .init      = geometry_init,
+    .uninit    = geometry_uninit,
     .update    = geometry_update,
     .priv_size = sizeof(struct geometry_priv),
     .params    = geometry_params,
@@ -21,22 +21,46 @@
 
 #include <stddef.h>
 #include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
+#include "instancing.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "utils.h"
 
 struct group_priv {
     struct ngl_node **children;
     int nb_children;
+    int order_independent;
+
+    struct instancing *instancing;
 };
 
 #define OFFSET(x) offsetof(struct group_priv, x)
 static const struct node_param group_params[] = {
     {"children", PARAM_TYPE_NODELIST, OFFSET(children),
                  .desc=NGLI_DOCSTRING("a set of scenes")},
+    {"order_independent", PARAM_TYPE_BOOL, OFFSET(order_independent),
+                 .desc=NGLI_DOCSTRING("the rendering of the children does not depend on their order, "
+                                      "allowing them to be drawn in the order minimizing the GL state changes")},
     {NULL}
 };
 
+static int group_init(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct group_priv *s = node->priv_data;
+
+    if (ctx->config.auto_instancing) {
+        s->instancing = ngli_instancing_create(node, s->children, s->nb_children, s->order_independent);
+        if (!s->instancing)
+            return -1;
+    }
+
+    return 0;
+}
+
 static int group_update(struct ngl_node *node, double t)
 {
     struct group_priv *s = node->priv_data;
@@ -48,21 +72,145 @@ static int group_update(struct ngl_node *node, double t)
             return ret;
     }
 
+    if (s->instancing)
+        return ngli_instancing_update(s->instancing, t);
+
     return 0;
 }
 
+struct draw_key {
+    uint64_t program;
+    uint64_t textures;
+    uint64_t state;
+    uint64_t buffers;
+    int index;
+};
+
+static uint64_t hash_u64(uint64_t hash, uint64_t value)
+{
+    return hash * 0x9e3779b97f4a7c15 ^ value;
+}
+
+static void get_pipeline_keys(const struct pipeline *s, struct draw_key *key)
+{
+    const struct program_priv *program = s->program->priv_data;
+    key->program = program->program_id;
+
+    const struct pipeline_texture *textures = ngli_darray_data(&s->texture_bindings);
+    for (int i = 0; i < ngli_darray_count(&s->texture_bindings); i++) {
+        const struct image *image = textures[i].image;
+        for (int j = 0; image && j < image->nb_planes; j++)
+            key->textures = hash_u64(key->textures, image->planes[j]->id);
+    }
+
+    const struct pipeline_buffer *buffers = ngli_darray_data(&s->buffer_bindings);
+    for (int i = 0; i < ngli_darray_count(&s->buffer_bindings); i++)
+        key->buffers = hash_u64(key->buffers, buffers[i].buffer->id);
+}
+
+/*
+ * Build the sort key of a child from the Render node it leads to, through
+ * the transforms and graphic configurations. The children which are not
+ * a Render node keep a null key and are drawn first, in their list order.
+ */
+static void get_draw_key(const struct ngl_node *node, struct draw_key *key)
+{
+    for (;;) {
+        switch (node->class->id) {
+        case NGL_NODE_RENDER: {
+            const struct render_priv *s = node->priv_data;
+            get_pipeline_keys(&s->pipeline, key);
+            return;
+        }
+        case NGL_NODE_GRAPHICCONFIG: {
+            const struct graphicconfig_priv *s = node->priv_data;
+            const size_t start = offsetof(struct graphicconfig_priv, blend);
+            const size_t end = offsetof(struct graphicconfig_priv, states);
+            key->state = hash_u64(key->state, ngli_hash64((const uint8_t *)s + start, end - start));
+            node = s->child;
+            break;
+        }
+        case NGL_NODE_ROTATE:
+        case NGL_NODE_TRANSFORM:
+        case NGL_NODE_TRANSLATE:
+        case NGL_NODE_SCALE: {
+            const struct transform_priv *s = node->priv_data;
+            node = s->child;
+            break;
+        }
+        default:
+            return;
+        }
+        if (!node)
+            return;
+    }
+}
+
+#define CMP_FIELD(field) do {                   \
+    if (a->field != b->field)                   \
+        return a->field < b->field ? -1 : 1;    \
+} while (0)
+
+static int cmp_draw_key(const void *p1, const void *p2)
+{
+    const struct draw_key *a = p1;
+    const struct draw_key *b = p2;
+    CMP_FIELD(program);
+    CMP_FIELD(textures);
+    CMP_FIELD(state);
+    CMP_FIELD(buffers);
+    return a->index - b->index;
+}
+
+static void draw_child(struct group_priv *s, int index)
+{
+    if (s->instancing && ngli_instancing_draw_child(s->instancing, index))
+        return;
+    ngli_node_draw(s->children[index]);
+}
+
 static void group_draw(struct ngl_node *node)
 {
+    struct ngl_ctx *ctx = node->ctx;
     struct group_priv *s = node->priv_data;
+
+    struct draw_key *keys = NULL;
+    if (s->order_independent && s->nb_children > 1)
+        keys = ngli_arena_alloc(ctx->frame_arena, s->nb_children * sizeof(*keys));
+
+    if (!keys) {
+        for (int i = 0; i < s->nb_children; i++)
+            draw_child(s, i);
+        return;
+    }
+
+    /*
+     * The children are sorted by program first since switching program is
+     * the most expensive change, then by texture set, graphic configuration
+     * and buffer bindings. The list index makes the order deterministic.
+     */
     for (int i = 0; i < s->nb_children; i++) {
-        struct ngl_node *child = s->children[i];
-        ngli_node_draw(child);
+        memset(&keys[i], 0, sizeof(keys[i]));
+        keys[i].index = i;
+        get_draw_key(s->children[i], &keys[i]);
     }
+    qsort(keys, s->nb_children, sizeof(*keys), cmp_draw_key);
+
+    for (int i = 0; i < s->nb_children; i++)
+        draw_child(s, keys[i].index);
+}
+
+static void group_uninit(struct ngl_node *node)
+{
+    struct group_priv *s = node->priv_data;
+    ngli_instancing_freep(&s->instancing);
 }
 
 const struct node_class ngli_group_class = {
     .id        = NGL_NODE_GROUP,
     .name      = "Group",
+    .init      = group_init,
+    .uninit    = group_uninit,
     .update    = group_update,
     .draw      = group_draw,
     .priv_size = sizeof(struct group_priv),
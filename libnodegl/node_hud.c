@@ -29,6 +29,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include "dedup.h"
 #include "hmap.h"
 #include "memory.h"
 #include "nodegl.h"
@@ -208,6 +209,7 @@ enum {
     MEMORY_BUFFERS_CPU,
     MEMORY_BUFFERS_GPU,
     MEMORY_TEXTURES,
+    MEMORY_DEDUPLICATED,
     NB_MEMORY
 };
 
@@ -293,6 +295,11 @@ static const struct {
         .node_types=(const int[]){NGL_NODE_TEXTURE2D, NGL_NODE_TEXTURE3D, -1},
         .color=0xFF7F7FFF,
     },
+    [MEMORY_DEDUPLICATED] = {
+        .label="Deduplicated",
+        .node_types=(const int[]){BUFFER_NODES, NGL_NODE_TEXTURE2D, NGL_NODE_TEXTURE3D, -1},
+        .color=0xFFFF7FFF,
+    },
 };
 
 static const struct activity_spec {
@@ -365,14 +372,40 @@ struct latency_measure {
     int64_t total_times;
 };
 
+enum {
+    TIMESTAMP_UPDATE_START,
+    TIMESTAMP_UPDATE_END,
+    TIMESTAMP_DRAW_START,
+    TIMESTAMP_DRAW_END,
+    NB_TIMESTAMP
+};
+
+/*
+ * GPU timings are based on timestamp queries which are read back
+ * asynchronously: every frame records its timestamps in its own set of
+ * queries, and the results are only fetched once the GPU reports them as
+ * available, up to NB_QUERY_FRAMES frames later. Contrary to GL_TIME_ELAPSED
+ * queries, timestamps can be nested, so multiple HUD can live in the same
+ * graph.
+ */
+#define NB_QUERY_FRAMES 4
+
+struct query_frame {
+    GLuint queries[NB_TIMESTAMP];
+    int has_update;
+};
+
 struct widget_latency {
     struct latency_measure measures[NB_LATENCY];
 
-    GLuint query;
+    struct query_frame query_frames[NB_QUERY_FRAMES];
+    int query_read_pos;
+    int query_write_pos;
+    int nb_pending_queries;
+    int query_recording;
     void (*glGenQueries)(const struct glcontext *gl, GLsizei n, GLuint * ids);
     void (*glDeleteQueries)(const struct glcontext *gl, GLsizei n, const GLuint * ids);
-    void (*glBeginQuery)(const struct glcontext *gl, GLenum target, GLuint id);
-    void (*glEndQuery)(const struct glcontext *gl, GLenum target);
+    void (*glQueryCounter)(const struct glcontext *gl, GLuint id, GLenum target);
     void (*glGetQueryObjectui64v)(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 *params);
 };
 
@@ -434,24 +467,22 @@ static int widget_latency_init(struct ngl_node *node, struct widget *widget)
     if (gl->features & NGLI_FEATURE_TIMER_QUERY) {
         priv->glGenQueries          = ngli_glGenQueries;
         priv->glDeleteQueries       = ngli_glDeleteQueries;
-        priv->glBeginQuery          = ngli_glBeginQuery;
-        priv->glEndQuery            = ngli_glEndQuery;
+        priv->glQueryCounter        = ngli_glQueryCounter;
         priv->glGetQueryObjectui64v = ngli_glGetQueryObjectui64v;
     } else if (gl->features & NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY) {
         priv->glGenQueries          = ngli_glGenQueriesEXT;
         priv->glDeleteQueries       = ngli_glDeleteQueriesEXT;
-        priv->glBeginQuery          = ngli_glBeginQueryEXT;
-        priv->glEndQuery            = ngli_glEndQueryEXT;
+        priv->glQueryCounter        = ngli_glQueryCounterEXT;
         priv->glGetQueryObjectui64v = ngli_glGetQueryObjectui64vEXT;
     } else {
         priv->glGenQueries          = (void *)noop;
         priv->glDeleteQueries       = (void *)noop;
-        priv->glBeginQuery          = (void *)noop;
-        priv->glEndQuery            = (void *)noop;
+        priv->glQueryCounter        = (void *)noop;
         priv->glGetQueryObjectui64v = (void *)noop;
     }
 
-    priv->glGenQueries(gl, 1, &priv->query);
+    for (int i = 0; i < NB_QUERY_FRAMES; i++)
+        priv->glGenQueries(gl, NB_TIMESTAMP, priv->query_frames[i].queries);
 
     ngli_assert(NB_LATENCY == NGLI_ARRAY_NB(priv->measures));
 
@@ -559,6 +590,64 @@ static void register_time(struct hud_priv *s, struct latency_measure *m, int64_t
     m->count = NGLI_MIN(m->count + 1, s->measure_window);
 }
 
+static int64_t get_last_time(const struct hud_priv *s, const struct latency_measure *m)
+{
+    const int last_pos = (m->pos ? m->pos : s->measure_window) - 1;
+    return m->times[last_pos];
+}
+
+static void collect_gpu_times(struct ngl_node *node, struct widget_latency *priv)
+{
+    struct hud_priv *s = node->priv_data;
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+
+    while (priv->nb_pending_queries) {
+        const struct query_frame *frame = &priv->query_frames[priv->query_read_pos];
+
+        /* Commands are executed in order, so if the last timestamp of the
+         * frame is available, all the previous ones are as well */
+        GLuint64 available = 0;
+        priv->glGetQueryObjectui64v(gl, frame->queries[TIMESTAMP_DRAW_END], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 timestamps[NB_TIMESTAMP] = {0};
+        for (int i = frame->has_update ? 0 : TIMESTAMP_DRAW_START; i < NB_TIMESTAMP; i++)
+            priv->glGetQueryObjectui64v(gl, frame->queries[i], GL_QUERY_RESULT, &timestamps[i]);
+
+        if (frame->has_update)
+            register_time(s, &priv->measures[LATENCY_UPDATE_GPU],
+                          timestamps[TIMESTAMP_UPDATE_END] - timestamps[TIMESTAMP_UPDATE_START]);
+
+        const int64_t gpu_tdraw = timestamps[TIMESTAMP_DRAW_END] - timestamps[TIMESTAMP_DRAW_START];
+        const int64_t gpu_tupdate = get_last_time(s, &priv->measures[LATENCY_UPDATE_GPU]);
+        register_time(s, &priv->measures[LATENCY_DRAW_GPU], gpu_tdraw);
+        register_time(s, &priv->measures[LATENCY_TOTAL_GPU], gpu_tdraw + gpu_tupdate);
+
+        priv->query_read_pos = (priv->query_read_pos + 1) % NB_QUERY_FRAMES;
+        priv->nb_pending_queries--;
+    }
+}
+
+static struct query_frame *get_recording_frame(struct widget_latency *priv)
+{
+    struct query_frame *frame = &priv->query_frames[priv->query_write_pos];
+    if (priv->query_recording)
+        return frame;
+
+    /* The GPU is too far behind: drop the oldest measure instead of waiting
+     * for it */
+    if (priv->nb_pending_queries == NB_QUERY_FRAMES) {
+        priv->query_read_pos = (priv->query_read_pos + 1) % NB_QUERY_FRAMES;
+        priv->nb_pending_queries--;
+    }
+
+    frame->has_update = 0;
+    priv->query_recording = 1;
+    return frame;
+}
+
 static int widget_latency_update(struct ngl_node *node, struct widget *widget, double t)
 {
     int ret;
@@ -569,28 +658,17 @@ static int widget_latency_update(struct ngl_node *node, struct widget *widget, d
     struct glcontext *gl = ctx->glcontext;
     struct widget_latency *priv = widget->priv_data;
 
-    int timer_active = ctx->timer_active;
-    if (timer_active) {
-        LOG(WARNING, "GPU timings will not be available when using multiple HUD "
-                     "in the same graph due to GL limitations");
-    } else {
-        ctx->timer_active = 1;
-        priv->glBeginQuery(gl, GL_TIME_ELAPSED, priv->query);
-    }
+    collect_gpu_times(node, priv);
+    struct query_frame *frame = get_recording_frame(priv);
 
+    priv->glQueryCounter(gl, frame->queries[TIMESTAMP_UPDATE_START], GL_TIMESTAMP);
     int64_t update_start = ngli_gettime();
     ret = ngli_node_update(child, t);
     int64_t update_end = ngli_gettime();
-
-    GLuint64 gpu_tupdate = 0;
-    if (!timer_active) {
-        priv->glEndQuery(gl, GL_TIME_ELAPSED);
-        priv->glGetQueryObjectui64v(gl, priv->query, GL_QUERY_RESULT, &gpu_tupdate);
-        ctx->timer_active = 0;
-    }
+    priv->glQueryCounter(gl, frame->queries[TIMESTAMP_UPDATE_END], GL_TIMESTAMP);
+    frame->has_update = 1;
 
     register_time(s, &priv->measures[LATENCY_UPDATE_CPU], update_end - update_start);
-    register_time(s, &priv->measures[LATENCY_UPDATE_GPU], gpu_tupdate);
 
     return ret;
 }
@@ -604,35 +682,32 @@ static void widget_latency_make_stats(struct ngl_node *node, struct widget *widg
     struct glcontext *gl = ctx->glcontext;
     struct widget_latency *priv = widget->priv_data;
 
-    int timer_active = ctx->timer_active;
-    if (!timer_active) {
-        ctx->timer_active = 1;
-        priv->glBeginQuery(gl, GL_TIME_ELAPSED, priv->query);
-    }
+    collect_gpu_times(node, priv);
+    struct query_frame *frame = get_recording_frame(priv);
 
+    priv->glQueryCounter(gl, frame->queries[TIMESTAMP_DRAW_START], GL_TIMESTAMP);
     const int64_t draw_start = ngli_gettime();
     ngli_node_draw(s->child);
     const int64_t draw_end = ngli_gettime();
+    priv->glQueryCounter(gl, frame->queries[TIMESTAMP_DRAW_END], GL_TIMESTAMP);
 
-    GLuint64 gpu_tdraw = 0;
-    if (!timer_active) {
-        priv->glEndQuery(gl, GL_TIME_ELAPSED);
-        priv->glGetQueryObjectui64v(gl, priv->query, GL_QUERY_RESULT, &gpu_tdraw);
-        ctx->timer_active = 0;
-    }
+    priv->query_write_pos = (priv->query_write_pos + 1) % NB_QUERY_FRAMES;
+    priv->nb_pending_queries++;
+    priv->query_recording = 0;
 
     int64_t cpu_tdraw = draw_end - draw_start;
+    const int64_t cpu_tupdate = get_last_time(s, &priv->measures[LATENCY_UPDATE_CPU]);
     register_time(s, &priv->measures[LATENCY_DRAW_CPU], cpu_tdraw);
-    register_time(s, &priv->measures[LATENCY_DRAW_GPU], gpu_tdraw);
-
-    const struct latency_measure *cpu_up = &priv->measures[LATENCY_UPDATE_CPU];
-    const struct latency_measure *gpu_up = &priv->measures[LATENCY_UPDATE_GPU];
-    const int last_cpu_up_pos = (cpu_up->pos ? cpu_up->pos : s->measure_window) - 1;
-    const int last_gpu_up_pos = (gpu_up->pos ? gpu_up->pos : s->measure_window) - 1;
-    const int64_t cpu_tupdate = cpu_up->times[last_cpu_up_pos];
-    const int64_t gpu_tupdate = gpu_up->times[last_gpu_up_pos];
     register_time(s, &priv->measures[LATENCY_TOTAL_CPU], cpu_tdraw + cpu_tupdate);
-    register_time(s, &priv->measures[LATENCY_TOTAL_GPU], gpu_tdraw + gpu_tupdate);
+}
+
+/*
+ * Share of the memory of a GL resource accounted to one of the nodes using it,
+ * so that the resource is only accounted once in total
+ */
+static uint64_t get_shared_size(const struct shared_resource *shared, uint64_t size)
+{
+    return shared ? size / shared->refcount : size;
 }
 
 static void widget_memory_make_stats(struct ngl_node *node, struct widget *widget)
@@ -645,7 +720,7 @@ static void widget_memory_make_stats(struct ngl_node *node, struct widget *widge
     for (int i = 0; i < ngli_darray_count(nodes_buf_array_cpu); i++) {
         const struct ngl_node *buf_node = nodes_buf_cpu[i];
         const struct buffer_priv *buffer = buf_node->priv_data;
-        priv->sizes[MEMORY_BUFFERS_CPU] += buffer->data_size;
+        priv->sizes[MEMORY_BUFFERS_CPU] += buffer->data ? buffer->data_size : 0;
     }
 
     struct darray *nodes_buf_array_gpu = &priv->nodes[MEMORY_BUFFERS_GPU];
@@ -654,7 +729,8 @@ static void widget_memory_make_stats(struct ngl_node *node, struct widget *widge
     for (int i = 0; i < ngli_darray_count(nodes_buf_array_gpu); i++) {
         const struct ngl_node *buf_node = nodes_buf_gpu[i];
         const struct buffer_priv *buffer = buf_node->priv_data;
-        priv->sizes[MEMORY_BUFFERS_GPU] += buffer->data_size * (buffer->buffer_refcount > 0);
+        priv->sizes[MEMORY_BUFFERS_GPU] += get_shared_size(buffer->shared, buffer->data_size)
+                                         * (buffer->buffer_refcount > 0);
     }
 
     struct darray *nodes_tex_array = &priv->nodes[MEMORY_TEXTURES];
@@ -663,8 +739,29 @@ static void widget_memory_make_stats(struct ngl_node *node, struct widget *widge
     for (int i = 0; i < ngli_darray_count(nodes_tex_array); i++) {
         const struct ngl_node *tex_node = nodes_tex[i];
         const struct texture_priv *texture = tex_node->priv_data;
-        priv->sizes[MEMORY_TEXTURES] += ngli_image_get_memory_size(&texture->image)
-                                      * tex_node->is_active;
+        const uint64_t size = ngli_image_get_memory_size(&texture->image);
+        priv->sizes[MEMORY_TEXTURES] += get_shared_size(texture->shared, size) * tex_node->is_active;
+    }
+
+    /*
+     * Memory which would have been allocated (and uploaded) if the nodes did
+     * not share their GL resources
+     */
+    struct darray *nodes_dedup_array = &priv->nodes[MEMORY_DEDUPLICATED];
+    struct ngl_node **nodes_dedup = ngli_darray_data(nodes_dedup_array);
+    priv->sizes[MEMORY_DEDUPLICATED] = 0;
+    for (int i = 0; i < ngli_darray_count(nodes_dedup_array); i++) {
+        const struct ngl_node *dedup_node = nodes_dedup[i];
+        const struct shared_resource *shared;
+        if (dedup_node->class->id == NGL_NODE_TEXTURE2D || dedup_node->class->id == NGL_NODE_TEXTURE3D) {
+            const struct texture_priv *texture = dedup_node->priv_data;
+            shared = texture->shared;
+        } else {
+            const struct buffer_priv *buffer = dedup_node->priv_data;
+            shared = buffer->shared;
+        }
+        if (shared)
+            priv->sizes[MEMORY_DEDUPLICATED] += shared->size - shared->size / shared->refcount;
     }
 }
 
@@ -830,6 +927,8 @@ static void register_graph_value(struct data_graph *d, int64_t v)
 static int64_t get_latency_avg(const struct widget_latency *priv, int id)
 {
     const struct latency_measure *m = &priv->measures[id];
+    if (!m->count)
+        return 0;
     return m->total_times / m->count / (latency_specs[id].unit == 'u' ? 1 : 1000);
 }
 
@@ -1002,7 +1101,8 @@ static void widget_latency_uninit(struct ngl_node *node, struct widget *widget)
 
     for (int i = 0; i < NB_LATENCY; i++)
         ngli_free(priv->measures[i].times);
-    priv->glDeleteQueries(gl, 1, &priv->query);
+    for (int i = 0; i < NB_QUERY_FRAMES; i++)
+        priv->glDeleteQueries(gl, NB_TIMESTAMP, priv->query_frames[i].queries);
 }
 
 static void widget_memory_uninit(struct ngl_node *node, struct widget *widget)
@@ -19,15 +19,19 @@
  * under the License.
  */
 
+#include <inttypes.h>
 #include <stddef.h>
 #include <stdio.h>
 #include <string.h>
 #include "bstr.h"
+#include "darray.h"
 #include "glincludes.h"
 #include "log.h"
+#include "memory.h"
 #include "nodegl.h"
 #include "nodes.h"
 #include "program.h"
+#include "utils.h"
 
 #if defined(TARGET_ANDROID)
 static const char default_fragment_shader[] =
@@ -96,35 +100,277 @@ static const struct node_param program_params[] = {
     {NULL}
 };
 
-static int program_init(struct ngl_node *node)
+static int str_equal(const char *a, const char *b)
+{
+    return a == b || (a && b && !strcmp(a, b));
+}
+
+static uint64_t hash_str(uint64_t hash, const char *str)
+{
+    return hash * 0x9e3779b97f4a7c15 ^ (str ? ngli_hash64(str, strlen(str)) : 0);
+}
+
+static void get_program_key(char *key, size_t size, const struct program_priv *s)
+{
+    uint64_t hash = 0;
+    hash = hash_str(hash, s->vertex);
+    hash = hash_str(hash, s->fragment);
+    hash = hash_str(hash, s->compute);
+    snprintf(key, size, "%016" PRIx64, hash);
+}
+
+static int program_equal(const struct shared_program *p, const struct program_priv *s)
+{
+    return str_equal(p->vertex,   s->vertex)   &&
+           str_equal(p->fragment, s->fragment) &&
+           str_equal(p->compute,  s->compute);
+}
+
+static void free_shared_program(struct glcontext *gl, struct shared_program *p)
+{
+    ngli_program_build_reset(gl, &p->build);
+    ngli_hmap_freep(&p->active_uniforms);
+    ngli_hmap_freep(&p->active_attributes);
+    ngli_hmap_freep(&p->active_buffer_blocks);
+    ngli_glstate_delete_program(gl, p->program_id);
+    ngli_free(p->vertex);
+    ngli_free(p->fragment);
+    ngli_free(p->compute);
+    ngli_free(p);
+}
+
+static struct shared_program *submit_shared_program(struct glcontext *gl, const struct program_priv *s)
+{
+    struct shared_program *p = ngli_calloc(1, sizeof(*p));
+    if (!p)
+        return NULL;
+
+    if ((s->vertex   && !(p->vertex   = ngli_strdup(s->vertex)))   ||
+        (s->fragment && !(p->fragment = ngli_strdup(s->fragment))) ||
+        (s->compute  && !(p->compute  = ngli_strdup(s->compute)))) {
+        free_shared_program(gl, p);
+        return NULL;
+    }
+
+    ngli_program_build_submit(gl, &p->build, p->vertex, p->fragment, p->compute);
+    p->pending = 1;
+    return p;
+}
+
+static int finish_shared_program(struct glcontext *gl, struct shared_program *p, const char *label)
+{
+    p->pending = 0;
+    p->program_id = ngli_program_build_finish(gl, &p->build);
+    if (!p->program_id)
+        return -1;
+
+    p->active_uniforms = ngli_program_probe_uniforms(label, gl, p->program_id);
+    p->active_buffer_blocks = ngli_program_probe_buffer_blocks(label, gl, p->program_id);
+    if (!p->active_uniforms || !p->active_buffer_blocks)
+        return -1;
+
+    if (!p->compute) {
+        p->active_attributes = ngli_program_probe_attributes(label, gl, p->program_id);
+        if (!p->active_attributes)
+            return -1;
+    }
+
+    return 0;
+}
+
+static int register_shared_program(struct ngl_ctx *ctx, struct shared_program *p, const char *key)
+{
+    /* In the unlikely event of a hash collision, the program is simply not
+     * shared */
+    if (ngli_hmap_get(ctx->shared_programs, key))
+        return 0;
+    snprintf(p->key, sizeof(p->key), "%s", key);
+    return ngli_hmap_set(ctx->shared_programs, p->key, p);
+}
+
+static void unregister_shared_program(struct ngl_ctx *ctx, struct shared_program *p)
+{
+    if (*p->key)
+        ngli_hmap_set(ctx->shared_programs, p->key, NULL);
+    free_shared_program(ctx->glcontext, p);
+}
+
+/*
+ * Programs with identical sources share the same GL program: they are
+ * compiled, linked and probed only once per context.
+ */
+int ngli_node_program_ref(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
     struct glcontext *gl = ctx->glcontext;
     struct program_priv *s = node->priv_data;
 
-    s->program_id = ngli_program_load(gl, s->vertex, s->fragment);
-    if (!s->program_id)
-        return -1;
+    char key[32];
+    get_program_key(key, sizeof(key), s);
 
-    s->active_uniforms = ngli_program_probe_uniforms(node->label, gl, s->program_id);
-    s->active_attributes = ngli_program_probe_attributes(node->label, gl, s->program_id);
-    s->active_buffer_blocks = ngli_program_probe_buffer_blocks(node->label, gl, s->program_id);
-    if (!s->active_uniforms || !s->active_attributes || !s->active_buffer_blocks)
+    struct shared_program *p = ngli_hmap_get(ctx->shared_programs, key);
+    if (!p || !program_equal(p, s)) {
+        p = submit_shared_program(gl, s);
+        if (!p)
+            return -1;
+        int ret = register_shared_program(ctx, p, key);
+        if (ret < 0) {
+            free_shared_program(gl, p);
+            return ret;
+        }
+    }
+
+    if (p->pending && finish_shared_program(gl, p, node->label) < 0) {
+        unregister_shared_program(ctx, p);
         return -1;
+    }
+    p->refcount++;
 
+    s->shared = p;
+    s->program_id = p->program_id;
+    s->active_uniforms = p->active_uniforms;
+    s->active_attributes = p->active_attributes;
+    s->active_buffer_blocks = p->active_buffer_blocks;
     return 0;
 }
 
-static void program_uninit(struct ngl_node *node)
+void ngli_node_program_unref(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
     struct program_priv *s = node->priv_data;
+    struct shared_program *p = s->shared;
+
+    if (!p)
+        return;
+
+    if (--p->refcount == 0)
+        unregister_shared_program(ctx, p);
+
+    s->shared = NULL;
+    s->program_id = 0;
+    s->active_uniforms = NULL;
+    s->active_attributes = NULL;
+    s->active_buffer_blocks = NULL;
+}
+
+static int precompile_node(struct ngl_ctx *ctx, struct hmap *visited, struct ngl_node *node);
+
+static int precompile_children(struct ngl_ctx *ctx, struct hmap *visited, struct ngl_node *node)
+{
+    uint8_t *base_ptr = node->priv_data;
+    const struct node_param *par = node->class->params;
+
+    while (par && par->key) {
+        int ret = 0;
+        switch (par->type) {
+            case PARAM_TYPE_NODE: {
+                struct ngl_node *child = *(struct ngl_node **)(base_ptr + par->offset);
+                if (child)
+                    ret = precompile_node(ctx, visited, child);
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **elems = *(struct ngl_node ***)(base_ptr + par->offset);
+                const int nb_elems = *(int *)(base_ptr + par->offset + sizeof(struct ngl_node **));
+                for (int i = 0; i < nb_elems && ret >= 0; i++)
+                    ret = precompile_node(ctx, visited, elems[i]);
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(base_ptr + par->offset);
+                if (!hmap)
+                    break;
+                const struct hmap_entry *entry = NULL;
+                while (ret >= 0 && (entry = ngli_hmap_next(hmap, entry)))
+                    ret = precompile_node(ctx, visited, entry->data);
+                break;
+            }
+        }
+        if (ret < 0)
+            return ret;
+        par++;
+    }
+    return 0;
+}
+
+static int precompile_node(struct ngl_ctx *ctx, struct hmap *visited, struct ngl_node *node)
+{
+    char key[32];
+    snprintf(key, sizeof(key), "%p", node);
+    if (ngli_hmap_get(visited, key))
+        return 0;
+    int ret = ngli_hmap_set(visited, key, node);
+    if (ret < 0)
+        return ret;
+
+    struct glcontext *gl = ctx->glcontext;
+    const int is_program = node->class->id == NGL_NODE_PROGRAM ||
+                           (node->class->id == NGL_NODE_COMPUTEPROGRAM &&
+                            (gl->features & NGLI_FEATURE_COMPUTE_SHADER_ALL));
+    if (is_program) {
+        const struct program_priv *s = node->priv_data;
+        get_program_key(key, sizeof(key), s);
+        if (!ngli_hmap_get(ctx->shared_programs, key)) {
+            struct shared_program *p = submit_shared_program(gl, s);
+            if (!p)
+                return -1;
+            ret = register_shared_program(ctx, p, key);
+            if (ret < 0) {
+                free_shared_program(gl, p);
+                return ret;
+            }
+        }
+    }
+
+    return precompile_children(ctx, visited, node);
+}
 
-    ngli_hmap_freep(&s->active_uniforms);
-    ngli_hmap_freep(&s->active_attributes);
-    ngli_hmap_freep(&s->active_buffer_blocks);
-    ngli_glDeleteProgram(gl, s->program_id);
+/*
+ * Submit the builds of all the programs of the scene before the nodes are
+ * initialized: the driver can then compile them concurrently (typically with
+ * GL_KHR_parallel_shader_compile) while the Render and Compute nodes only
+ * wait for the program they need in their initialization.
+ */
+int ngli_node_program_precompile(struct ngl_ctx *ctx, struct ngl_node *scene)
+{
+    struct hmap *visited = ngli_hmap_create();
+    if (!visited)
+        return -1;
+    int ret = precompile_node(ctx, visited, scene);
+    ngli_hmap_freep(&visited);
+    return ret;
+}
+
+/*
+ * Release the submitted builds which have not been referenced by any node,
+ * typically because the scene initialization failed.
+ */
+void ngli_node_program_release_unused(struct ngl_ctx *ctx)
+{
+    struct darray unused;
+    ngli_darray_init(&unused, sizeof(struct shared_program *), 0);
+
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(ctx->shared_programs, entry))) {
+        struct shared_program *p = entry->data;
+        if (!p->refcount && !ngli_darray_push(&unused, &p))
+            break;
+    }
+
+    struct shared_program **ps = ngli_darray_data(&unused);
+    for (int i = 0; i < ngli_darray_count(&unused); i++)
+        unregister_shared_program(ctx, ps[i]);
+    ngli_darray_reset(&unused);
+}
+
+static int program_init(struct ngl_node *node)
+{
+    return ngli_node_program_ref(node);
+}
+
+static void program_uninit(struct ngl_node *node)
+{
+    ngli_node_program_unref(node);
 }
 
 const struct node_class ngli_program_class = {
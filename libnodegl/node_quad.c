@@ -105,7 +105,7 @@ static int quad_init(struct ngl_node *node)
 
     s->topology = GL_TRIANGLE_FAN;
 
-    return 0;
+    return ngli_node_geometry_update_aabb(node);
 }
 
 #define NODE_UNREFP(node) do {                    \
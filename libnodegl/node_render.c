@@ -27,6 +27,7 @@
 #include "buffer.h"
 #include "format.h"
 #include "glincludes.h"
+#include "gpuculling.h"
 #include "hmap.h"
 #include "log.h"
 #include "math_utils.h"
@@ -55,10 +56,39 @@
                                           NGL_NODE_UNIFORMMAT4,     \
                                           -1}
 
-#define ATTRIBUTES_TYPES_LIST (const int[]){NGL_NODE_BUFFERFLOAT,   \
-                                            NGL_NODE_BUFFERVEC2,    \
-                                            NGL_NODE_BUFFERVEC3,    \
-                                            NGL_NODE_BUFFERVEC4,    \
+#define ATTRIBUTES_TYPES_LIST (const int[]){NGL_NODE_BUFFERFLOAT,           \
+                                            NGL_NODE_BUFFERVEC2,            \
+                                            NGL_NODE_BUFFERVEC3,            \
+                                            NGL_NODE_BUFFERVEC4,            \
+                                            NGL_NODE_BUFFERHALF,            \
+                                            NGL_NODE_BUFFERHVEC2,           \
+                                            NGL_NODE_BUFFERHVEC3,           \
+                                            NGL_NODE_BUFFERHVEC4,           \
+                                            NGL_NODE_BUFFERBYTE,            \
+                                            NGL_NODE_BUFFERBVEC2,           \
+                                            NGL_NODE_BUFFERBVEC3,           \
+                                            NGL_NODE_BUFFERBVEC4,           \
+                                            NGL_NODE_BUFFERSHORT,           \
+                                            NGL_NODE_BUFFERSVEC2,           \
+                                            NGL_NODE_BUFFERSVEC3,           \
+                                            NGL_NODE_BUFFERSVEC4,           \
+                                            NGL_NODE_BUFFERUBYTE,           \
+                                            NGL_NODE_BUFFERUBVEC2,          \
+                                            NGL_NODE_BUFFERUBVEC3,          \
+                                            NGL_NODE_BUFFERUBVEC4,          \
+                                            NGL_NODE_BUFFERUSHORT,          \
+                                            NGL_NODE_BUFFERUSVEC2,          \
+                                            NGL_NODE_BUFFERUSVEC3,          \
+                                            NGL_NODE_BUFFERUSVEC4,          \
+                                            NGL_NODE_BUFFERINT,             \
+                                            NGL_NODE_BUFFERIVEC2,           \
+                                            NGL_NODE_BUFFERIVEC3,           \
+                                            NGL_NODE_BUFFERIVEC4,           \
+                                            NGL_NODE_BUFFERUINT,            \
+                                            NGL_NODE_BUFFERUIVEC2,          \
+                                            NGL_NODE_BUFFERUIVEC3,          \
+                                            NGL_NODE_BUFFERUIVEC4,          \
+                                            NGL_NODE_BUFFERINT2101010REV,   \
                                             -1}
 
 #define GEOMETRY_TYPES_LIST (const int[]){NGL_NODE_CIRCLE,          \
@@ -106,6 +136,13 @@ static const struct node_param render_params[] = {
                  .desc=NGLI_DOCSTRING("per instance extra vertex attributes made accessible to the `program`")},
     {"nb_instances", PARAM_TYPE_INT, OFFSET(nb_instances),
                  .desc=NGLI_DOCSTRING("number of instances to draw")},
+    {"instance_culling_attribute", PARAM_TYPE_STR, OFFSET(instance_culling_attribute),
+                 .desc=NGLI_DOCSTRING("per instance attribute holding the offset applied to the `geometry` of each instance; "
+                                      "if set, the instances outside the view frustum are discarded by a compute pass "
+                                      "before the draw (which does not preserve the order of the instances)")},
+    {"frustum_culling", PARAM_TYPE_BOOL, OFFSET(frustum_culling), {.i64=1},
+                 .desc=NGLI_DOCSTRING("skip the draw when the bounding box of the `geometry` is outside the view frustum; "
+                                      "must be disabled if the vertex shader moves the vertices beyond the bounds of the `geometry`")},
     {NULL}
 };
 
@@ -137,6 +174,60 @@ static int update_geometry_uniforms(struct ngl_node *node)
     return 0;
 }
 
+/*
+ * The bounding box of the geometry is culled if all its corners, once
+ * projected in clip space, are on the outer side of the same frustum plane.
+ */
+static int is_culled(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct render_priv *s = node->priv_data;
+    const struct geometry_priv *geometry = s->geometry->priv_data;
+
+    const float *modelview_matrix = ngli_darray_tail(&ctx->modelview_matrix_stack);
+    const float *projection_matrix = ngli_darray_tail(&ctx->projection_matrix_stack);
+
+    NGLI_ALIGNED_MAT(mvp_matrix);
+    ngli_mat4_mul(mvp_matrix, projection_matrix, modelview_matrix);
+
+    int outside = 0x3f;
+    for (int i = 0; i < 8 && outside; i++) {
+        NGLI_ALIGNED_VEC(corner) = {
+            i & 1 ? geometry->aabb_max[0] : geometry->aabb_min[0],
+            i & 2 ? geometry->aabb_max[1] : geometry->aabb_min[1],
+            i & 4 ? geometry->aabb_max[2] : geometry->aabb_min[2],
+            1.0f,
+        };
+        NGLI_ALIGNED_VEC(clip);
+        ngli_mat4_mul_vec4(clip, mvp_matrix, corner);
+
+        int corner_outside = 0;
+        for (int j = 0; j < 3; j++) {
+            corner_outside |= (clip[j] < -clip[3]) << (j * 2);
+            corner_outside |= (clip[j] >  clip[3]) << (j * 2 + 1);
+        }
+        outside &= corner_outside;
+    }
+
+    return !!outside;
+}
+
+static int is_integer_attribute(GLenum type)
+{
+    switch (type) {
+    case GL_INT:
+    case GL_INT_VEC2:
+    case GL_INT_VEC3:
+    case GL_INT_VEC4:
+    case GL_UNSIGNED_INT:
+    case GL_UNSIGNED_INT_VEC2:
+    case GL_UNSIGNED_INT_VEC3:
+    case GL_UNSIGNED_INT_VEC4:
+        return 1;
+    }
+    return 0;
+}
+
 static void update_vertex_attribs_from_pairs(struct glcontext *gl,
                                              const struct darray *attribute_pairs,
                                              int is_instance_attrib)
@@ -148,9 +239,16 @@ static void update_vertex_attribs_from_pairs(struct glcontext *gl,
         const GLint aid = info->location;
         struct buffer_priv *buffer = pair->node->priv_data;
 
+        GLenum type;
+        GLboolean normalized;
+        ngli_format_get_gl_vertex_format(gl, buffer->data_format, &type, &normalized);
+
         ngli_glEnableVertexAttribArray(gl, aid);
-        ngli_glBindBuffer(gl, GL_ARRAY_BUFFER, buffer->buffer.id);
-        ngli_glVertexAttribPointer(gl, aid, buffer->data_comp, GL_FLOAT, GL_FALSE, buffer->data_stride, NULL);
+        ngli_glstate_bind_buffer(gl, GL_ARRAY_BUFFER, buffer->buffer.id);
+        if (is_integer_attribute(info->type))
+            ngli_glVertexAttribIPointer(gl, aid, buffer->data_comp, type, buffer->data_stride, NULL);
+        else
+            ngli_glVertexAttribPointer(gl, aid, buffer->data_comp, type, normalized, buffer->data_stride, NULL);
 
         if (is_instance_attrib)
             ngli_glVertexAttribDivisor(gl, aid, 1);
@@ -196,11 +294,48 @@ static int get_uniform_location(struct hmap *uniforms, const char *name)
     return info ? info->location : -1;
 }
 
-static int pair_node_to_attribinfo(struct render_priv *s,
+static int check_attribute_format(struct glcontext *gl, const char *name,
+                                  const struct attributeprograminfo *info,
+                                  const struct buffer_priv *buffer)
+{
+    GLenum type;
+    int ret = ngli_format_get_gl_vertex_format(gl, buffer->data_format, &type, NULL);
+    if (ret < 0)
+        return ret;
+
+    /* The integer attributes get the raw values of any integer buffer,
+     * normalized or not */
+    if (is_integer_attribute(info->type)) {
+        if (type == GL_FLOAT || type == GL_HALF_FLOAT || type == GL_INT_2_10_10_10_REV) {
+            LOG(ERROR, "integer attribute %s requires an integer buffer", name);
+            return -1;
+        }
+        if (!(gl->features & NGLI_FEATURE_VERTEX_ATTRIB_INTEGER)) {
+            LOG(ERROR, "context does not support integer vertex attributes");
+            return -1;
+        }
+    }
+
+    if (type == GL_HALF_FLOAT && !(gl->features & NGLI_FEATURE_HALF_FLOAT_VERTEX)) {
+        LOG(ERROR, "context does not support half-float vertex attributes");
+        return -1;
+    }
+
+    if (type == GL_INT_2_10_10_10_REV && !(gl->features & NGLI_FEATURE_VERTEX_TYPE_2_10_10_10_REV)) {
+        LOG(ERROR, "context does not support packed 2_10_10_10 vertex attributes");
+        return -1;
+    }
+
+    return 0;
+}
+
+static int pair_node_to_attribinfo(struct ngl_node *node,
                                    struct darray *attribute_pairs,
                                    const char *name,
                                    struct ngl_node *anode)
 {
+    struct glcontext *gl = node->ctx->glcontext;
+    struct render_priv *s = node->priv_data;
     const struct ngl_node *pnode = s->pipeline.program;
     const struct program_priv *program = pnode->priv_data;
     const struct attributeprograminfo *active_attribute =
@@ -211,7 +346,11 @@ static int pair_node_to_attribinfo(struct render_priv *s,
     if (active_attribute->location < 0)
         return 0;
 
-    int ret = ngli_node_buffer_ref(anode);
+    int ret = check_attribute_format(gl, name, active_attribute, anode->priv_data);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_node_buffer_ref(anode);
     if (ret < 0)
         return ret;
 
@@ -266,7 +405,7 @@ static int pair_nodes_to_attribinfo(struct ngl_node *node,
             }
         }
 
-        int ret = pair_node_to_attribinfo(s, attribute_pairs, entry->key, anode);
+        int ret = pair_node_to_attribinfo(node, attribute_pairs, entry->key, anode);
         if (ret < 0)
             return ret;
 
@@ -283,7 +422,7 @@ static void draw_elements(struct glcontext *gl, struct render_priv *render)
 {
     struct geometry_priv *geometry = render->geometry->priv_data;
     const struct buffer_priv *indices = geometry->indices_buffer->priv_data;
-    ngli_glBindBuffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->buffer.id);
+    ngli_glstate_bind_buffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->buffer.id);
     ngli_glDrawElements(gl, geometry->topology, indices->count, render->indices_type, 0);
 }
 
@@ -291,7 +430,7 @@ static void draw_elements_instanced(struct glcontext *gl, struct render_priv *re
 {
     struct geometry_priv *geometry = render->geometry->priv_data;
     struct buffer_priv *indices = geometry->indices_buffer->priv_data;
-    ngli_glBindBuffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->buffer.id);
+    ngli_glstate_bind_buffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->buffer.id);
     ngli_glDrawElementsInstanced(gl, geometry->topology, indices->count, render->indices_type, 0, render->nb_instances);
 }
 
@@ -309,6 +448,85 @@ static void draw_arrays_instanced(struct glcontext *gl, struct render_priv *rend
     ngli_glDrawArraysInstanced(gl, geometry->topology, 0, vertices->count, render->nb_instances);
 }
 
+static void draw_elements_culled(struct glcontext *gl, struct render_priv *render)
+{
+    struct geometry_priv *geometry = render->geometry->priv_data;
+    struct buffer_priv *indices = geometry->indices_buffer->priv_data;
+    ngli_glstate_bind_buffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->buffer.id);
+    ngli_glstate_bind_buffer(gl, GL_DRAW_INDIRECT_BUFFER, render->culled_command_id);
+    ngli_glDrawElementsIndirect(gl, geometry->topology, render->indices_type, NULL);
+}
+
+static void draw_arrays_culled(struct glcontext *gl, struct render_priv *render)
+{
+    struct geometry_priv *geometry = render->geometry->priv_data;
+    ngli_glstate_bind_buffer(gl, GL_DRAW_INDIRECT_BUFFER, render->culled_command_id);
+    ngli_glDrawArraysIndirect(gl, geometry->topology, NULL);
+}
+
+static void multi_draw_elements_indirect(struct glcontext *gl, struct render_priv *render)
+{
+    struct geometry_priv *geometry = render->geometry->priv_data;
+    struct buffer_priv *indices = geometry->indices_buffer->priv_data;
+    ngli_glstate_bind_buffer(gl, GL_ELEMENT_ARRAY_BUFFER, indices->buffer.id);
+    ngli_glstate_bind_buffer(gl, GL_DRAW_INDIRECT_BUFFER, render->indirect_buffer.id);
+    ngli_glMultiDrawElementsIndirect(gl, geometry->topology, render->indices_type, NULL, render->nb_indirect_draws, 0);
+}
+
+static void multi_draw_arrays_indirect(struct glcontext *gl, struct render_priv *render)
+{
+    struct geometry_priv *geometry = render->geometry->priv_data;
+    ngli_glstate_bind_buffer(gl, GL_DRAW_INDIRECT_BUFFER, render->indirect_buffer.id);
+    ngli_glMultiDrawArraysIndirect(gl, geometry->topology, NULL, render->nb_indirect_draws, 0);
+}
+
+int ngli_node_render_set_indirect_draws(struct ngl_node *node,
+                                        const struct render_indirect_draw *draws, int nb_draws)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct render_priv *s = node->priv_data;
+
+    if (!(gl->features & NGLI_FEATURE_MULTI_DRAW_INDIRECT)) {
+        LOG(ERROR, "context does not support multi-draw indirect");
+        return -1;
+    }
+
+    struct geometry_priv *geometry = s->geometry->priv_data;
+    const int indexed = !!geometry->indices_buffer;
+
+    /* Layout of the DrawElementsIndirectCommand and DrawArraysIndirectCommand
+     * structures, which only differ by the baseVertex field */
+    const int nb_fields = indexed ? 5 : 4;
+    GLuint *commands = ngli_calloc(nb_draws, nb_fields * sizeof(*commands));
+    if (!commands)
+        return -1;
+
+    for (int i = 0; i < nb_draws; i++) {
+        const struct render_indirect_draw *draw = &draws[i];
+        GLuint *command = commands + i * nb_fields;
+        *command++ = draw->count;
+        *command++ = draw->nb_instances;
+        *command++ = draw->first;
+        if (indexed)
+            *command++ = draw->base_vertex;
+        *command++ = draw->base_instance;
+    }
+
+    ngli_buffer_free(&s->indirect_buffer);
+    const int size = nb_draws * nb_fields * sizeof(*commands);
+    int ret = ngli_buffer_allocate(&s->indirect_buffer, gl, size, GL_STATIC_DRAW);
+    if (ret >= 0)
+        ret = ngli_buffer_upload(&s->indirect_buffer, commands, size);
+    ngli_free(commands);
+    if (ret < 0)
+        return ret;
+
+    s->nb_indirect_draws = nb_draws;
+    s->draw = indexed ? multi_draw_elements_indirect : multi_draw_arrays_indirect;
+    return 0;
+}
+
 #define GEOMETRY_OFFSET(x) offsetof(struct geometry_priv, x)
 static const struct {
     const char *const_name;
@@ -341,6 +559,31 @@ static int init_builtin_attributes(struct render_priv *s)
     return 0;
 }
 
+/*
+ * The instance attributes are replaced with their compacted version written
+ * by the culling pass.
+ */
+static int init_gpuculling(struct ngl_node *node)
+{
+    struct render_priv *s = node->priv_data;
+
+    s->gpuculling = ngli_gpuculling_create(node, s->instance_culling_attribute);
+    if (!s->gpuculling)
+        return -1;
+
+    struct nodeprograminfopair *pairs = ngli_darray_data(&s->instance_attribute_pairs);
+    for (int i = 0; i < ngli_darray_count(&s->instance_attribute_pairs); i++) {
+        struct nodeprograminfopair *pair = &pairs[i];
+        struct ngl_node *output = ngli_gpuculling_get_output(s->gpuculling, pair->node);
+        int ret = ngli_node_buffer_ref(output);
+        if (ret < 0)
+            return ret;
+        ngli_node_buffer_unref(pair->node);
+        pair->node = output;
+    }
+    return 0;
+}
+
 static int render_init(struct ngl_node *node)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -380,6 +623,11 @@ static int render_init(struct ngl_node *node)
     s->projection_matrix_location = get_uniform_location(uniforms, "ngl_projection_matrix");
     s->normal_matrix_location     = get_uniform_location(uniforms, "ngl_normal_matrix");
 
+    /* The position of the vertices is only known if they go through the
+     * builtin matrices, and only once per instance */
+    s->culling = s->frustum_culling && !ctx->config.disable_culling && !s->nb_instances &&
+                 s->modelview_matrix_location >= 0 && s->projection_matrix_location >= 0;
+
     /* User and builtin attribute pairs */
     ngli_darray_init(&s->builtin_attribute_pairs, sizeof(struct nodeprograminfopair), 0);
     ngli_darray_init(&s->attribute_pairs, sizeof(struct nodeprograminfopair), 0);
@@ -395,6 +643,15 @@ static int render_init(struct ngl_node *node)
         return ret;
 
     /* User vertex attributes */
+    struct geometry_priv *geometry = s->geometry->priv_data;
+    const int optimized = geometry->geometry_vertices &&
+                          geometry->vertices_buffer != geometry->geometry_vertices;
+    if (s->attributes && optimized) {
+        LOG(ERROR, "extra vertex attributes can not be used with the reordered vertices "
+            "of an optimized geometry");
+        return -1;
+    }
+
     ret = pair_nodes_to_attribinfo(node, &s->attribute_pairs, s->attributes, 0, 1);
     if (ret < 0)
         return ret;
@@ -404,7 +661,18 @@ static int render_init(struct ngl_node *node)
     if (ret < 0)
         return ret;
 
-    struct geometry_priv *geometry = s->geometry->priv_data;
+    /* Instances culling pass */
+    if (s->instance_culling_attribute && !ctx->config.disable_culling) {
+        const int features = NGLI_FEATURE_COMPUTE_SHADER_ALL | NGLI_FEATURE_DRAW_INDIRECT;
+        if ((gl->features & features) == features) {
+            ret = init_gpuculling(node);
+            if (ret < 0)
+                return ret;
+        } else {
+            LOG(WARNING, "context does not support the culling of the instances of %s", node->label);
+        }
+    }
+
     if (geometry->indices_buffer) {
         ret = ngli_node_buffer_ref(geometry->indices_buffer);
         if (ret < 0)
@@ -417,11 +685,13 @@ static int render_init(struct ngl_node *node)
 
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT) {
         ngli_glGenVertexArrays(gl, 1, &s->vao_id);
-        ngli_glBindVertexArray(gl, s->vao_id);
+        ngli_glstate_bind_vertex_array(gl, s->vao_id);
         update_vertex_attribs(node);
     }
 
-    if (geometry->indices_buffer)
+    if (s->gpuculling)
+        s->draw = geometry->indices_buffer ? draw_elements_culled : draw_arrays_culled;
+    else if (geometry->indices_buffer)
         s->draw = s->nb_instances > 0 ? draw_elements_instanced : draw_elements;
     else
         s->draw = s->nb_instances > 0 ? draw_arrays_instanced : draw_arrays;
@@ -449,11 +719,13 @@ static void render_uninit(struct ngl_node *node)
     ngli_hmap_freep(&s->builtin_attributes);
 
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT) {
-        ngli_glDeleteVertexArrays(gl, 1, &s->vao_id);
+        ngli_glstate_delete_vertex_array(gl, s->vao_id);
     }
 
     ngli_pipeline_uninit(node);
 
+    ngli_buffer_free(&s->indirect_buffer);
+
     if (s->has_indices_buffer_ref) {
         struct geometry_priv *geometry = s->geometry->priv_data;
         ngli_node_buffer_unref(geometry->indices_buffer);
@@ -462,6 +734,8 @@ static void render_uninit(struct ngl_node *node)
     uninit_attributes(&s->builtin_attribute_pairs);
     uninit_attributes(&s->attribute_pairs);
     uninit_attributes(&s->instance_attribute_pairs);
+
+    ngli_gpuculling_freep(&s->gpuculling);
 }
 
 static int update_attributes(struct darray *attribute_pairs, double t)
@@ -488,6 +762,12 @@ static int render_update(struct ngl_node *node, double t)
     if (ret < 0)
         return ret;
 
+    if (s->gpuculling) {
+        ret = ngli_gpuculling_update(s->gpuculling, t);
+        if (ret < 0)
+            return ret;
+    }
+
     ret = update_attributes(&s->builtin_attribute_pairs, t);
     if (ret < 0)
         return ret;
@@ -509,11 +789,19 @@ static void render_draw(struct ngl_node *node)
     struct glcontext *gl = ctx->glcontext;
     struct render_priv *s = node->priv_data;
 
+    if (s->culling && is_culled(node)) {
+        ctx->stats.cur.nb_culled_draws++;
+        return;
+    }
+
+    if (s->gpuculling)
+        s->culled_command_id = ngli_gpuculling_run(s->gpuculling);
+
     const struct program_priv *program = s->pipeline.program->priv_data;
-    ngli_glUseProgram(gl, program->program_id);
+    ngli_glstate_use_program(gl, program->program_id);
 
     if (gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT) {
-        ngli_glBindVertexArray(gl, s->vao_id);
+        ngli_glstate_bind_vertex_array(gl, s->vao_id);
     } else {
         update_vertex_attribs(node);
     }
@@ -526,6 +814,7 @@ static void render_draw(struct ngl_node *node)
     }
 
     s->draw(gl, s);
+    ctx->stats.cur.nb_draw_calls++;
 
     if (!(gl->features & NGLI_FEATURE_VERTEX_ARRAY_OBJECT)) {
         disable_vertex_attribs(node);
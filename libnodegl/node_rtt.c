@@ -233,8 +233,9 @@ static void rtt_draw(struct ngl_node *node)
         return;
 
     GLint viewport[4];
-    ngli_glGetIntegerv(gl, GL_VIEWPORT, viewport);
-    ngli_glViewport(gl, 0, 0, s->width, s->height);
+    ngli_glstate_get_viewport(gl, viewport);
+    const GLint rtt_viewport[] = {0, 0, s->width, s->height};
+    ngli_glstate_viewport(gl, rtt_viewport);
 
     if (s->use_clear_color) {
         float *rgba = s->clear_color;
@@ -257,7 +258,7 @@ static void rtt_draw(struct ngl_node *node)
     ngli_fbo_invalidate_depth_buffers(fbo);
     ngli_fbo_unbind(fbo);
 
-    ngli_glViewport(gl, viewport[0], viewport[1], viewport[2], viewport[3]);
+    ngli_glstate_viewport(gl, viewport);
 
     struct ngl_node *texture_node = s->color_texture;
     struct texture_priv *texture = texture_node->priv_data;
@@ -24,6 +24,7 @@
 #include <string.h>
 #include <sxplayer.h>
 
+#include "dedup.h"
 #include "format.h"
 #include "glincludes.h"
 #include "hwupload.h"
@@ -181,6 +182,33 @@ static const struct node_param texture3d_params[] = {
     {NULL}
 };
 
+static int texture_init_from_data(struct ngl_node *node, const uint8_t *data)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct texture_priv *s = node->priv_data;
+
+    int ret = ngli_dedup_texture_ref(node);
+    if (ret < 0)
+        return ret;
+    if (ret) {
+        ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+        return 0;
+    }
+
+    ret = ngli_texture_init(&s->texture, gl, &s->params);
+    if (ret < 0)
+        return ret;
+
+    ret = ngli_texture_upload(&s->texture, data);
+    if (ret < 0)
+        return ret;
+
+    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
+
+    return ngli_dedup_texture_register(node);
+}
+
 static int texture_prefetch(struct ngl_node *node, int dimensions)
 {
     struct ngl_ctx *ctx = node->ctx;
@@ -193,8 +221,6 @@ static int texture_prefetch(struct ngl_node *node, int dimensions)
     if (gl->features & NGLI_FEATURE_TEXTURE_STORAGE)
         params->immutable = 1;
 
-    const uint8_t *data = NULL;
-
     if (s->data_src) {
         switch (s->data_src->class->id) {
         case NGL_NODE_HUD: {
@@ -259,26 +285,21 @@ static int texture_prefetch(struct ngl_node *node, int dimensions)
                     params->height = params->depth = 1;
                 }
             }
-            data = buffer->data;
+
+            int ret = ngli_node_buffer_ref_data(s->data_src);
+            if (ret < 0)
+                return ret;
             params->format = buffer->data_format;
-            break;
+            ret = texture_init_from_data(node, buffer->data);
+            ngli_node_buffer_unref_data(s->data_src);
+            return ret;
         }
         default:
             ngli_assert(0);
         }
     }
 
-    int ret = ngli_texture_init(&s->texture, gl, params);
-    if (ret < 0)
-        return ret;
-
-    ret = ngli_texture_upload(&s->texture, data);
-    if (ret < 0)
-        return ret;
-
-    ngli_image_init(&s->image, NGLI_IMAGE_LAYOUT_DEFAULT, &s->texture);
-
-    return 0;
+    return texture_init_from_data(node, NULL);
 }
 
 #define TEXTURE_PREFETCH(dim)                               \
@@ -357,7 +378,10 @@ static void texture_release(struct ngl_node *node)
     struct texture_priv *s = node->priv_data;
 
     ngli_hwupload_uninit(node);
-    ngli_texture_reset(&s->texture);
+    if (ngli_dedup_release(node, &s->shared))
+        memset(&s->texture, 0, sizeof(s->texture));
+    else
+        ngli_texture_reset(&s->texture);
     ngli_image_reset(&s->image);
 }
 
@@ -87,7 +87,7 @@ static int triangle_init(struct ngl_node *node)
 
     s->topology = GL_TRIANGLES;
 
-    return 0;
+    return ngli_node_geometry_update_aabb(node);
 }
 
 #define NODE_UNREFP(node) do {                    \
@@ -33,6 +33,7 @@
                                               NODEGL_VERSION_MICRO)
 
 #include <stdarg.h>
+#include <stddef.h>
 #include <stdint.h>
 
 /**
@@ -112,6 +113,7 @@ struct ngl_node;
 #define NGL_NODE_BUFFERIVEC2            NGLI_FOURCC('B','s','i','2')
 #define NGL_NODE_BUFFERIVEC3            NGLI_FOURCC('B','s','i','3')
 #define NGL_NODE_BUFFERIVEC4            NGLI_FOURCC('B','s','i','4')
+#define NGL_NODE_BUFFERINT2101010REV    NGLI_FOURCC('B','s','p','4')
 #define NGL_NODE_BUFFERSHORT            NGLI_FOURCC('B','s','s','1')
 #define NGL_NODE_BUFFERSVEC2            NGLI_FOURCC('B','s','s','2')
 #define NGL_NODE_BUFFERSVEC3            NGLI_FOURCC('B','s','s','3')
@@ -128,6 +130,10 @@ struct ngl_node;
 #define NGL_NODE_BUFFERUSVEC2           NGLI_FOURCC('B','u','s','2')
 #define NGL_NODE_BUFFERUSVEC3           NGLI_FOURCC('B','u','s','3')
 #define NGL_NODE_BUFFERUSVEC4           NGLI_FOURCC('B','u','s','4')
+#define NGL_NODE_BUFFERHALF             NGLI_FOURCC('B','f','h','1')
+#define NGL_NODE_BUFFERHVEC2            NGLI_FOURCC('B','f','h','2')
+#define NGL_NODE_BUFFERHVEC3            NGLI_FOURCC('B','f','h','3')
+#define NGL_NODE_BUFFERHVEC4            NGLI_FOURCC('B','f','h','4')
 #define NGL_NODE_BUFFERFLOAT            NGLI_FOURCC('B','f','v','1')
 #define NGL_NODE_BUFFERVEC2             NGLI_FOURCC('B','f','v','2')
 #define NGL_NODE_BUFFERVEC3             NGLI_FOURCC('B','f','v','3')
@@ -256,10 +262,28 @@ char *ngl_node_dot(const struct ngl_node *node);
  */
 char *ngl_node_serialize(const struct ngl_node *node);
 
+/**
+ * Serialize in node.gl binary format (.nglb).
+ *
+ * The binary format is faster to load than the text one, and its data (such
+ * as the buffers content) can be used in place when the scene is loaded with
+ * ngl_node_deserialize_file(). It is specific to the host endianness and to
+ * the node.gl version.
+ *
+ * Must be destroyed using free().
+ *
+ * @param size  pointer to the size in bytes of the returned data
+ *
+ * @return an allocated buffer in node.gl binary format or NULL on error
+ */
+void *ngl_node_serialize_binary(const struct ngl_node *node, size_t *size);
+
 /**
  * De-serialize a scene.
  *
- * @param s  string in node.gl serialized format.
+ * @param s  NUL terminated string in node.gl serialized format; a scene in
+ *           node.gl binary format must be loaded with
+ *           ngl_node_deserialize_data() instead
  *
  * Must be destroyed using ngl_node_unrefp().
  *
@@ -267,6 +291,73 @@ char *ngl_node_serialize(const struct ngl_node *node);
  */
 struct ngl_node *ngl_node_deserialize(const char *s);
 
+/**
+ * De-serialize a scene from memory.
+ *
+ * @param data  data in node.gl text or binary format (detected automatically)
+ * @param size  the data size in bytes; nothing is read past it
+ *
+ * Must be destroyed using ngl_node_unrefp().
+ *
+ * @return a pointer to the de-serialized node graph or NULL on error
+ */
+struct ngl_node *ngl_node_deserialize_data(const void *data, size_t size);
+
+/**
+ * De-serialize a scene from a file in node.gl text or binary format.
+ *
+ * A binary scene is mapped in memory and its data is referenced in place
+ * instead of being copied.
+ *
+ * Must be destroyed using ngl_node_unrefp().
+ *
+ * @return a pointer to the de-serialized node graph or NULL on error
+ */
+struct ngl_node *ngl_node_deserialize_file(const char *filename);
+
+/**
+ * Incremental scene de-serializer
+ *
+ * The scene data can be fed in chunks of any size (typically while it is
+ * being read from a file or a pipe). In text format, the nodes are created as
+ * soon as their definition line is complete, and only the current line is
+ * kept in memory. A binary scene is accumulated and loaded at the end.
+ */
+struct ngl_deserializer;
+
+/**
+ * Allocate a new de-serializer.
+ *
+ * Must be destroyed using ngl_deserializer_freep().
+ *
+ * @return a pointer to the de-serializer or NULL on error
+ */
+struct ngl_deserializer *ngl_deserializer_create(void);
+
+/**
+ * Feed the next chunk of serialized scene data.
+ *
+ * @param data  the chunk data, which does not need to be NUL terminated
+ * @param size  the chunk size in bytes
+ *
+ * @return 0 on success, < 0 on error (every subsequent call will fail)
+ */
+int ngl_deserializer_feed(struct ngl_deserializer *d, const char *data, size_t size);
+
+/**
+ * Signal the end of the data and get the de-serialized scene.
+ *
+ * The returned scene must be destroyed using ngl_node_unrefp().
+ *
+ * @return a pointer to the de-serialized node graph or NULL on error
+ */
+struct ngl_node *ngl_deserializer_end(struct ngl_deserializer *d);
+
+/**
+ * Destroy the de-serializer and the nodes it still references.
+ */
+void ngl_deserializer_freep(struct ngl_deserializer **dp);
+
 /**
  * Platform-specific identifiers
  */
@@ -326,6 +417,27 @@ struct ngl_config {
     uint8_t *capture_buffer; /* RGBA offscreen capture buffer. If allocated,
                                 its size must be at least width * height * 4
                                 bytes. */
+
+    int dedup_resources; /* Whether the static buffers (and the textures
+                            initialized from them) with identical content
+                            should share their GL resources. Only honored
+                            when a scene is attached to the context. */
+
+    int auto_instancing; /* Whether the sibling Render nodes of a Group (under
+                            transforms only) sharing their geometry, program,
+                            textures, uniforms, buffers and attributes should
+                            be merged into a single instanced draw. Only
+                            honored when a scene is attached to the
+                            context. */
+
+    int disable_culling; /* Whether the Render nodes should always be drawn,
+                            even if the bounding box of their geometry is
+                            outside the view frustum. Must be set when the
+                            vertex shaders move the vertices beyond the
+                            bounds of the geometries (or, per node, the
+                            frustum_culling parameter of the Render nodes
+                            concerned must be disabled). Only honored when
+                            a scene is attached to the context. */
 };
 
 /**
@@ -383,6 +495,30 @@ int ngl_configure(struct ngl_ctx *s, struct ngl_config *config);
  */
 int ngl_set_scene(struct ngl_ctx *s, struct ngl_node *scene);
 
+/**
+ * Replace the scene associated with a node.gl context while preserving the
+ * resources of the nodes which did not change.
+ *
+ * Every node of the new scene is matched with a node of the current scene,
+ * either at the same position in the graph or through an identical
+ * non-default label. A matched node is kept (along with its GL resources) if
+ * its parameters only differ by parameters which can be live changed (they
+ * are then updated in place) and if all its children are kept as well. The
+ * other nodes are taken from the new scene; the ones referencing kept nodes
+ * are copied so that the new scene itself is never modified.
+ *
+ * If no scene is currently associated with the context, this function is
+ * equivalent to ngl_set_scene().
+ *
+ * @param s      pointer to the configured node.gl context
+ * @param scene  pointer to the new scene
+ *
+ * @note node.gl context must to be configured before calling this function.
+ *
+ * @return 0 on success, < 0 on error
+ */
+int ngl_patch_scene(struct ngl_ctx *s, struct ngl_node *scene);
+
 /**
  * Draw at the specified time.
  *
@@ -395,6 +531,73 @@ int ngl_set_scene(struct ngl_ctx *s, struct ngl_node *scene);
  */
 int ngl_draw(struct ngl_ctx *s, double t);
 
+/**
+ * Statistics of a drawn frame
+ */
+struct ngl_stats {
+    int64_t update_cpu_time; /* CPU time spent visiting, prefetching and
+                                updating the scene, in microseconds */
+
+    int64_t draw_cpu_time;   /* CPU time spent drawing the scene, in
+                                microseconds */
+
+    int64_t draw_gpu_time;   /* GPU time spent drawing the scene, in
+                                microseconds. GPU timings are read back
+                                asynchronously, so this value refers to a frame
+                                drawn a few frames earlier (-1 if not
+                                available) */
+
+    int nb_draw_calls;       /* Number of Render nodes drawn */
+
+    int nb_culled_draws;     /* Number of Render nodes skipped because their
+                                geometry was outside the view frustum */
+
+    int nb_dispatches;       /* Number of Compute nodes dispatched */
+
+    int nb_active_nodes;     /* Number of distinct nodes active in the scene */
+
+    int nb_prefetches;       /* Number of nodes which got their resources
+                                prefetched */
+
+    int nb_releases;         /* Number of nodes which got their resources
+                                released */
+
+    int64_t uploaded_bytes;  /* Number of bytes uploaded to the GPU buffers and
+                                textures */
+
+    int64_t buffers_memory;  /* GPU memory allocated for buffers, in bytes */
+
+    int64_t textures_memory; /* GPU memory allocated for textures, in bytes */
+
+    int nb_gl_calls;         /* Number of GL calls (only available when the
+                                NGL_GL_STATS environment variable is set,
+                                0 otherwise) */
+
+    int nb_redundant_binds;  /* Number of GL bindings of an object already
+                                bound (only available when the NGL_GL_STATS
+                                environment variable is set, 0 otherwise) */
+
+    int nb_program_cache_hits;   /* Number of programs loaded from the program
+                                    binary cache since the context creation
+                                    (only available when the
+                                    NGL_PROGRAM_CACHE_DIR environment variable
+                                    is set, 0 otherwise) */
+
+    int nb_program_cache_misses; /* Number of programs missing from (or
+                                    rejected by the driver in) the program
+                                    binary cache since the context creation */
+};
+
+/**
+ * Get the statistics of the last drawn frame.
+ *
+ * @param s      pointer to the configured node.gl context
+ * @param stats  pointer to the statistics structure to fill
+ *
+ * @return 0 on success, < 0 on error
+ */
+int ngl_get_stats(struct ngl_ctx *s, struct ngl_stats *stats);
+
 /**
  * Serialize the current scene in Graphviz format (.dot) a node graph at the
  * specified time. Non active nodes will be grayed.
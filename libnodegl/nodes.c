@@ -26,10 +26,12 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "filemap.h"
 #include "hmap.h"
 #include "log.h"
 #include "nodegl.h"
 #include "nodes.h"
+#include "profiler.h"
 #include "memory.h"
 #include "params.h"
 #include "utils.h"
@@ -176,6 +178,19 @@ struct ngl_node *ngl_node_create(int type, ...)
     return node;
 }
 
+static int profiler_begin(const struct ngl_node *node, enum profiler_event_type type)
+{
+    struct profiler *profiler = node->ctx->profiler;
+    return profiler ? ngli_profiler_begin(profiler, node, type) : -1;
+}
+
+static void profiler_end(const struct ngl_node *node, int event_id)
+{
+    struct profiler *profiler = node->ctx->profiler;
+    if (profiler)
+        ngli_profiler_end(profiler, event_id);
+}
+
 static void node_release(struct ngl_node *node)
 {
     if (node->state != STATE_READY)
@@ -184,7 +199,10 @@ static void node_release(struct ngl_node *node)
     ngli_assert(node->ctx);
     if (node->class->release) {
         TRACE("RELEASE %s @ %p", node->label, node);
+        const int event_id = profiler_begin(node, PROFILER_EVENT_RELEASE);
         node->class->release(node);
+        profiler_end(node, event_id);
+        node->ctx->stats.cur.nb_releases++;
     }
     node->state = STATE_INITIALIZED;
     node->last_update_time = -1.;
@@ -224,6 +242,8 @@ static void node_uninit(struct ngl_node *node)
         node->class->uninit(node);
     }
     reset_non_params(node);
+    ngli_slab_free(node->ctx->slab, node->init_params, node->class->priv_size);
+    node->init_params = NULL;
     node->state = STATE_UNINITIALIZED;
     node->visit_time = -1.;
 }
@@ -280,9 +300,24 @@ static int node_init(struct ngl_node *node)
     ngli_darray_init(&node->children, sizeof(struct ngl_node *), 0);
 
     ngli_assert(node->ctx);
+
+    /*
+     * init() may derive some parameters (such as a default count); keep the
+     * values originally set by the user for the comparisons with other nodes.
+     */
+    const size_t priv_size = node->class->priv_size;
+    if (priv_size) {
+        node->init_params = ngli_slab_alloc(node->ctx->slab, priv_size);
+        if (!node->init_params)
+            return -1;
+        memcpy(node->init_params, node->priv_data, priv_size);
+    }
+
     if (node->class->init) {
         LOG(VERBOSE, "INIT %s @ %p", node->label, node);
+        const int event_id = profiler_begin(node, PROFILER_EVENT_INIT);
         int ret = node->class->init(node);
+        profiler_end(node, event_id);
         if (ret < 0) {
             LOG(ERROR, "initializing node %s failed: %d", node->label, ret);
             node->state = STATE_INIT_FAILED;
@@ -292,8 +327,11 @@ static int node_init(struct ngl_node *node)
     }
 
     int ret = track_children(node);
-    if (ret < 0)
+    if (ret < 0) {
+        node->state = STATE_INIT_FAILED;
+        node_uninit(node);
         return ret;
+    }
 
     if (node->class->prefetch)
         node->state = STATE_INITIALIZED;
@@ -303,8 +341,26 @@ static int node_init(struct ngl_node *node)
     return 0;
 }
 
+static int node_set_ctx(struct ngl_node *node, struct ngl_ctx *ctx);
+
+static int set_child_ctx(struct ngl_node *node, struct ngl_ctx *ctx, int *nb_nodesp, int max_nodes)
+{
+    if (*nb_nodesp == max_nodes)
+        return 0;
+    int ret = node_set_ctx(node, ctx);
+    if (ret < 0)
+        return ret;
+    (*nb_nodesp)++;
+    return 0;
+}
+
+/*
+ * Set the context of the children in the order of the parameters, stopping
+ * after max_nodes children (or never if max_nodes is negative). The number of
+ * processed children is accumulated in nb_nodesp.
+ */
 static int node_set_children_ctx(uint8_t *base_ptr, const struct node_param *params,
-                                 struct ngl_ctx *ctx)
+                                 struct ngl_ctx *ctx, int *nb_nodesp, int max_nodes)
 {
     if (!params)
         return 0;
@@ -315,7 +371,7 @@ static int node_set_children_ctx(uint8_t *base_ptr, const struct node_param *par
             uint8_t *node_p = base_ptr + par->offset;
             struct ngl_node *node = *(struct ngl_node **)node_p;
             if (node) {
-                int ret = ngli_node_attach_ctx(node, ctx);
+                int ret = set_child_ctx(node, ctx, nb_nodesp, max_nodes);
                 if (ret < 0)
                     return ret;
             }
@@ -325,7 +381,7 @@ static int node_set_children_ctx(uint8_t *base_ptr, const struct node_param *par
             struct ngl_node **elems = *(struct ngl_node ***)elems_p;
             const int nb_elems = *(int *)nb_elems_p;
             for (int j = 0; j < nb_elems; j++) {
-                int ret = ngli_node_attach_ctx(elems[j], ctx);
+                int ret = set_child_ctx(elems[j], ctx, nb_nodesp, max_nodes);
                 if (ret < 0)
                     return ret;
             }
@@ -336,7 +392,7 @@ static int node_set_children_ctx(uint8_t *base_ptr, const struct node_param *par
             const struct hmap_entry *entry = NULL;
             while ((entry = ngli_hmap_next(hmap, entry))) {
                 struct ngl_node *node = entry->data;
-                int ret = ngli_node_attach_ctx(node, ctx);
+                int ret = set_child_ctx(node, ctx, nb_nodesp, max_nodes);
                 if (ret < 0)
                     return ret;
             }
@@ -345,6 +401,20 @@ static int node_set_children_ctx(uint8_t *base_ptr, const struct node_param *par
     return 0;
 }
 
+static int set_all_children_ctx(struct ngl_node *node, struct ngl_ctx *ctx, int *nb_nodesp, int max_nodes)
+{
+    int ret;
+    if ((ret = node_set_children_ctx(node->priv_data, node->class->params, ctx, nb_nodesp, max_nodes)) < 0 ||
+        (ret = node_set_children_ctx((uint8_t *)node, ngli_base_node_params, ctx, nb_nodesp, max_nodes)) < 0)
+        return ret;
+    return 0;
+}
+
+/*
+ * The attach of a graph is all or nothing: if any node fails to initialize,
+ * the children already attached by this call are detached again, so the
+ * context reference counts are left untouched.
+ */
 static int node_set_ctx(struct ngl_node *node, struct ngl_ctx *ctx)
 {
     int ret;
@@ -362,21 +432,29 @@ static int node_set_ctx(struct ngl_node *node, struct ngl_ctx *ctx)
         ngli_assert(node->ctx_refcount >= 0);
     }
 
-    if ((ret = node_set_children_ctx(node->priv_data, node->class->params, ctx)) < 0 ||
-        (ret = node_set_children_ctx((uint8_t *)node, ngli_base_node_params, ctx)) < 0)
-        return ret;
+    int nb_children = 0;
+    ret = set_all_children_ctx(node, ctx, &nb_children, -1);
+    if (ret < 0)
+        goto fail;
 
     if (ctx) {
         node->ctx = ctx;
         ret = node_init(node);
         if (ret < 0) {
             node->ctx = NULL;
-            return ret;
+            goto fail;
         }
         node->ctx_refcount++;
     }
 
     return 0;
+
+fail:
+    if (nb_children) {
+        int nb_detached = 0;
+        set_all_children_ctx(node, NULL, &nb_detached, nb_children);
+    }
+    return ret;
 }
 
 int ngli_node_attach_ctx(struct ngl_node *node, struct ngl_ctx *ctx)
@@ -390,6 +468,22 @@ void ngli_node_detach_ctx(struct ngl_node *node)
     ngli_assert(ret == 0);
 }
 
+static int queue_activitycheck(struct ngl_ctx *ctx, struct ngl_node *node)
+{
+    if (ctx->nb_activitycheck_nodes == ctx->activitycheck_nodes_capacity) {
+        const int capacity = NGLI_MAX(2 * ctx->activitycheck_nodes_capacity, 64);
+        struct ngl_node **nodes = ngli_arena_realloc(ctx->frame_arena, ctx->activitycheck_nodes,
+                                                     ctx->activitycheck_nodes_capacity * sizeof(*nodes),
+                                                     capacity * sizeof(*nodes));
+        if (!nodes)
+            return -1;
+        ctx->activitycheck_nodes = nodes;
+        ctx->activitycheck_nodes_capacity = capacity;
+    }
+    ctx->activitycheck_nodes[ctx->nb_activitycheck_nodes++] = node;
+    return 0;
+}
+
 int ngli_node_visit(struct ngl_node *node, int is_active, double t)
 {
     /*
@@ -438,8 +532,8 @@ int ngli_node_visit(struct ngl_node *node, int is_active, double t)
         }
     }
 
-    if (queue_node && !ngli_darray_push(&node->ctx->activitycheck_nodes, &node))
-        return -1;
+    if (queue_node)
+        return queue_activitycheck(node->ctx, node);
 
     return 0;
 }
@@ -451,25 +545,28 @@ static int node_prefetch(struct ngl_node *node)
 
     if (node->class->prefetch) {
         TRACE("PREFETCH %s @ %p", node->label, node);
+        const int event_id = profiler_begin(node, PROFILER_EVENT_PREFETCH);
         int ret = node->class->prefetch(node);
+        profiler_end(node, event_id);
         if (ret < 0) {
             LOG(ERROR, "prefetching node %s failed: %d", node->label, ret);
             node->visit_time = -1.;
             return ret;
         }
+        node->ctx->stats.cur.nb_prefetches++;
     }
     node->state = STATE_READY;
 
     return 0;
 }
 
-int ngli_node_honor_release_prefetch(struct darray *nodes_array)
+int ngli_node_honor_release_prefetch(struct ngl_node **nodes, int nb_nodes)
 {
-    struct ngl_node **nodes = ngli_darray_data(nodes_array);
-    for (int i = 0; i < ngli_darray_count(nodes_array); i++) {
+    for (int i = 0; i < nb_nodes; i++) {
         struct ngl_node *node = nodes[i];
 
         if (node->is_active) {
+            node->ctx->stats.cur.nb_active_nodes++;
             int ret = node_prefetch(node);
             if (ret < 0)
                 return ret;
@@ -486,7 +583,9 @@ int ngli_node_update(struct ngl_node *node, double t)
     if (node->class->update) {
         if (node->last_update_time != t) {
             TRACE("UPDATE %s @ %p with t=%g", node->label, node, t);
+            const int event_id = profiler_begin(node, PROFILER_EVENT_UPDATE);
             int ret = node->class->update(node, t);
+            profiler_end(node, event_id);
             if (ret < 0)
                 return ret;
             node->last_update_time = t;
@@ -503,7 +602,9 @@ void ngli_node_draw(struct ngl_node *node)
 {
     if (node->class->draw) {
         TRACE("DRAW %s @ %p", node->label, node);
+        const int event_id = profiler_begin(node, PROFILER_EVENT_DRAW);
         node->class->draw(node);
+        profiler_end(node, event_id);
         node->draw_count++;
     }
 }
@@ -523,6 +624,37 @@ const struct node_param *ngli_node_param_find(const struct ngl_node *node, const
     return par;
 }
 
+static void release_mapped_data(struct ngl_node *node, uint8_t *base_ptr,
+                                const struct node_param *par)
+{
+    if (!node->filemap || par->type != PARAM_TYPE_DATA)
+        return;
+    uint8_t **datap = (uint8_t **)(base_ptr + par->offset);
+    if (ngli_filemap_contains(node->filemap, *datap)) {
+        *datap = NULL;
+        *(int *)(base_ptr + par->offset + sizeof(uint8_t *)) = 0;
+    }
+}
+
+int ngli_node_param_set_mapped_data(struct ngl_node *node, const struct node_param *par,
+                                    struct filemap *filemap, uint8_t *data, int size)
+{
+    ngli_assert(par->type == PARAM_TYPE_DATA);
+    if (node->filemap && node->filemap != filemap)
+        return -1;
+
+    uint8_t *base_ptr = node->priv_data;
+    release_mapped_data(node, base_ptr, par);
+    uint8_t **datap = (uint8_t **)(base_ptr + par->offset);
+    ngli_free(*datap);
+    *datap = data;
+    *(int *)(base_ptr + par->offset + sizeof(uint8_t *)) = size;
+
+    if (!node->filemap)
+        node->filemap = ngli_filemap_ref(filemap);
+    return 0;
+}
+
 int ngl_node_param_add(struct ngl_node *node, const char *key,
                        int nb_elems, void *elems)
 {
@@ -565,6 +697,8 @@ int ngl_node_param_set(struct ngl_node *node, const char *key, ...)
         return -1;
     }
 
+    release_mapped_data(node, base_ptr, par);
+
     va_start(ap, key);
     ret = ngli_params_set(base_ptr, par, &ap);
     va_end(ap);
@@ -573,6 +707,10 @@ int ngl_node_param_set(struct ngl_node *node, const char *key, ...)
         return ret;
     }
 
+    if (node->init_params && base_ptr == node->priv_data)
+        memcpy(node->init_params + par->offset, base_ptr + par->offset,
+               ngli_params_specs[par->type].size);
+
     if (node->ctx && par->update_func)
         ret = par->update_func(node);
 
@@ -596,6 +734,12 @@ void ngl_node_unrefp(struct ngl_node **nodep)
     if (delete) {
         LOG(VERBOSE, "DELETE %s @ %p", node->label, node);
         ngli_assert(!node->ctx);
+        if (node->filemap) {
+            const struct node_param *par = node->class->params;
+            while (par && par->key)
+                release_mapped_data(node, node->priv_data, par++);
+            ngli_filemap_unrefp(&node->filemap);
+        }
         ngli_params_free((uint8_t *)node, ngli_base_node_params);
         ngli_params_free(node->priv_data, node->class->params);
         ngli_free_aligned(node);
@@ -43,11 +43,14 @@
 #include "animation.h"
 #include "glincludes.h"
 #include "glcontext.h"
+#include "filemap.h"
 #include "glstate.h"
 #include "hmap.h"
 #include "image.h"
 #include "nodegl.h"
 #include "params.h"
+#include "program.h"
+#include "stats.h"
 #include "darray.h"
 #include "buffer.h"
 #include "format.h"
@@ -55,6 +58,7 @@
 #include "texture.h"
 
 struct node_class;
+struct shared_resource;
 
 typedef int (*cmd_func_type)(struct ngl_ctx *s, void *arg);
 
@@ -71,10 +75,18 @@ struct ngl_ctx {
     struct glstate glstate;
     struct ngl_node *scene;
     struct ngl_config config;
-    int timer_active;
+    struct profiler *profiler;
+    struct stats stats;
     struct darray modelview_matrix_stack;
     struct darray projection_matrix_stack;
-    struct darray activitycheck_nodes;
+    struct ngl_node **activitycheck_nodes; // visited nodes of the frame, in the frame arena
+    int nb_activitycheck_nodes;
+    int activitycheck_nodes_capacity;
+    struct arena *frame_arena; // transient allocations, reset at every frame
+    struct slab *slab;         // allocations bound to the lifetime of the attached nodes
+    struct hmap *shared_resources; // shared_resource, indexed by content key
+    struct hmap *shared_programs;  // shared_program, indexed by sources hash
+    int nb_frames_since_attach;
 #if defined(HAVE_VAAPI_X11)
     Display *x11_display;
     VADisplay va_display;
@@ -124,6 +136,10 @@ struct ngl_node {
 
     char *label;
 
+    struct filemap *filemap; /* mapping the data params may point into */
+
+    uint8_t *init_params;    /* private data as it was before init() */
+
     void *priv_data;
 };
 
@@ -221,15 +237,25 @@ struct geometry_priv {
     int npoints;
 
     /* geometry params */
+    struct ngl_node *geometry_vertices;
+    struct ngl_node *geometry_uvcoords;
+    struct ngl_node *geometry_normals;
+    struct ngl_node *geometry_indices;
+    GLenum topology;
+    int optimize;
+
+    /* buffers to draw: the geometry params or their optimized version */
     struct ngl_node *vertices_buffer;
     struct ngl_node *uvcoords_buffer;
     struct ngl_node *normals_buffer;
     struct ngl_node *indices_buffer;
 
-    GLenum topology;
+    float aabb_min[3];      // axis-aligned bounding box of the vertices
+    float aabb_max[3];
 };
 
 struct ngl_node *ngli_node_geometry_generate_buffer(struct ngl_ctx *ctx, int type, int count, int size, void *data);
+int ngli_node_geometry_update_aabb(struct ngl_node *node);
 
 struct buffer_priv {
     int count;              // number of elements
@@ -246,18 +272,29 @@ struct buffer_priv {
     int nb_animkf;
     struct animation anim;
 
-    int fd;
+    struct filemap *filemap;    // mapping of <filename>, only alive while the data is referenced
+    int data_refcount;
     int dynamic;
 
     struct buffer buffer;
     int buffer_refcount;
     double buffer_last_upload_time;
+
+    int shareable;                      // whether the GL buffer can be shared with identical buffers
+    struct shared_resource *shared;     // GL buffer shared with other nodes, if any
 };
 
 int ngli_node_buffer_ref(struct ngl_node *node);
 void ngli_node_buffer_unref(struct ngl_node *node);
 int ngli_node_buffer_upload(struct ngl_node *node);
 
+/*
+ * The data of the buffers read from a file is only mapped in memory while it
+ * is referenced: users of the CPU data must hold a reference on it.
+ */
+int ngli_node_buffer_ref_data(struct ngl_node *node);
+void ngli_node_buffer_unref_data(struct ngl_node *node);
+
 struct uniform_priv {
     double scalar;
     float vector[4];
@@ -289,17 +326,47 @@ struct rtt_priv {
     struct texture fbo_ms_depth;
 };
 
+/*
+ * GL program and probed program information, shared by all the Program (or
+ * ComputeProgram) nodes of a context with identical sources.
+ */
+struct shared_program {
+    char key[32];                   // empty if the program is not registered
+    int refcount;
+    char *vertex;
+    char *fragment;
+    char *compute;
+
+    struct program_build build;     // submitted build, pending until the first reference
+    int pending;
+
+    GLuint program_id;
+    struct hmap *active_uniforms;
+    struct hmap *active_attributes;
+    struct hmap *active_buffer_blocks;
+
+    const struct pipeline *last_pipeline; // last pipeline which uploaded its uniforms
+};
+
 struct program_priv {
     const char *vertex;
     const char *fragment;
     const char *compute;
 
+    /* Fields of the shared program, for convenience */
     GLuint program_id;
     struct hmap *active_uniforms;
     struct hmap *active_attributes;
     struct hmap *active_buffer_blocks;
+
+    struct shared_program *shared;
 };
 
+int ngli_node_program_ref(struct ngl_node *node);
+void ngli_node_program_unref(struct ngl_node *node);
+int ngli_node_program_precompile(struct ngl_ctx *ctx, struct ngl_node *scene);
+void ngli_node_program_release_unused(struct ngl_ctx *ctx);
+
 struct texture_priv {
     struct texture_params params;
     struct ngl_node *data_src;
@@ -310,6 +377,9 @@ struct texture_priv {
 
     const struct hwmap_class *hwupload_map_class;
     void *hwupload_priv_data;
+
+    int shareable;                      // whether the GL texture can be shared with identical textures
+    struct shared_resource *shared;     // GL texture shared with other nodes, if any
 };
 
 struct uniformprograminfo {
@@ -356,22 +426,57 @@ struct nodeprograminfopair {
     void *program_info;
 };
 
+typedef void (*pipeline_uniform_upload_func)(const struct glcontext *gl, GLint location,
+                                             int count, const void *data);
+
+/*
+ * Uniform resolved at pipeline init: the per-draw upload reads the value
+ * directly from the node private data and calls the upload function selected
+ * for the node/uniform types, without any lookup. Values of at most
+ * sizeof(last_value) bytes are cached so unchanged uniforms are not uploaded
+ * again, as long as no other pipeline shares the program.
+ */
+struct pipeline_uniform {
+    struct ngl_node *buffer;    // buffer node holding the data, if any
+    GLint location;
+    int count;
+    const void *data;
+    int data_size; // 0 if the value is not cached (always uploaded)
+    pipeline_uniform_upload_func upload;
+    int uploaded;
+    float last_value[16];
+};
+
+struct pipeline_texture {
+    const struct textureprograminfo *info;
+    const struct image *image;
+};
+
+struct pipeline_buffer {
+    struct ngl_node *node;
+    const struct buffer *buffer;
+    GLenum type;
+    GLuint binding;
+};
+
 struct pipeline {
     struct ngl_node *program;
 
     struct hmap *textures;
     struct textureprograminfo *textureprograminfos;
     int nb_textureprograminfos;
-    struct darray texture_pairs; // nodeprograminfopair (texture, textureprograminfo)
+    struct darray texture_bindings; // pipeline_texture
 
     uint64_t used_texture_units;
     int disabled_texture_unit[2]; /* 2D, OES */
 
     struct hmap *uniforms;
-    struct darray uniform_pairs; // nodeprograminfopair (uniform, uniformprograminfo)
+    struct darray uniform_bindings; // pipeline_uniform
 
     struct hmap *buffers;
-    struct darray buffer_pairs; // nodeprograminfopair (buffer, uniformprograminfo)
+    struct darray buffer_bindings; // pipeline_buffer
+
+    struct darray update_nodes; // ngl_node * (textures and uniforms)
 };
 
 struct render_priv {
@@ -398,9 +503,34 @@ struct render_priv {
     GLuint vao_id;
     GLenum indices_type;
 
+    struct buffer indirect_buffer;      // multi-draw indirect commands, if any
+    int nb_indirect_draws;
+
+    int culling;                        // whether the geometry bounds can be tested against the frustum
+
+    char *instance_culling_attribute;
+    int frustum_culling;
+    struct gpuculling *gpuculling;      // compute pass culling the instances, if any
+    GLuint culled_command_id;           // indirect draw command written by the culling pass
+
     void (*draw)(struct glcontext *gl, struct render_priv *render);
 };
 
+struct render_indirect_draw {
+    int count;              // number of vertices (or indices) to draw
+    int nb_instances;
+    int first;              // first vertex (or index)
+    int base_vertex;        // value added to the indices, indexed geometries only
+    int base_instance;      // first element of the instance attributes
+};
+
+/*
+ * Replace the draw of the Render node with a multi-draw indirect submitting
+ * the given draws, all sharing the geometry buffers of the node.
+ */
+int ngli_node_render_set_indirect_draws(struct ngl_node *node,
+                                        const struct render_indirect_draw *draws, int nb_draws);
+
 struct compute_priv {
     int nb_group_x;
     int nb_group_y;
@@ -621,7 +751,7 @@ struct node_class {
 void ngli_node_print_specs(void);
 
 int ngli_node_visit(struct ngl_node *node, int is_active, double t);
-int ngli_node_honor_release_prefetch(struct darray *nodes_array);
+int ngli_node_honor_release_prefetch(struct ngl_node **nodes, int nb_nodes);
 int ngli_node_update(struct ngl_node *node, double t);
 int ngli_prepare_draw(struct ngl_ctx *s, double t);
 void ngli_node_draw(struct ngl_node *node);
@@ -635,4 +765,12 @@ struct ngl_node *ngli_node_create_noconstructor(int type);
 const struct node_param *ngli_node_param_find(const struct ngl_node *node, const char *key,
                                               uint8_t **base_ptrp);
 
+/*
+ * Make a data param point directly into a file mapping instead of holding a
+ * copy. The node keeps a reference on the mapping; a node can only reference
+ * one mapping.
+ */
+int ngli_node_param_set_mapped_data(struct ngl_node *node, const struct node_param *par,
+                                    struct filemap *filemap, uint8_t *data, int size);
+
 #endif
@@ -46,6 +46,7 @@
     action(NGL_NODE_BUFFERIVEC2,            ngli_bufferivec2_class)             \
     action(NGL_NODE_BUFFERIVEC3,            ngli_bufferivec3_class)             \
     action(NGL_NODE_BUFFERIVEC4,            ngli_bufferivec4_class)             \
+    action(NGL_NODE_BUFFERINT2101010REV,    ngli_bufferint2101010rev_class)     \
     action(NGL_NODE_BUFFERSHORT,            ngli_buffershort_class)             \
     action(NGL_NODE_BUFFERSVEC2,            ngli_buffersvec2_class)             \
     action(NGL_NODE_BUFFERSVEC3,            ngli_buffersvec3_class)             \
@@ -62,6 +63,10 @@
     action(NGL_NODE_BUFFERUSVEC2,           ngli_bufferusvec2_class)            \
     action(NGL_NODE_BUFFERUSVEC3,           ngli_bufferusvec3_class)            \
     action(NGL_NODE_BUFFERUSVEC4,           ngli_bufferusvec4_class)            \
+    action(NGL_NODE_BUFFERHALF,             ngli_bufferhalf_class)              \
+    action(NGL_NODE_BUFFERHVEC2,            ngli_bufferhvec2_class)             \
+    action(NGL_NODE_BUFFERHVEC3,            ngli_bufferhvec3_class)             \
+    action(NGL_NODE_BUFFERHVEC4,            ngli_bufferhvec4_class)             \
     action(NGL_NODE_BUFFERFLOAT,            ngli_bufferfloat_class)             \
     action(NGL_NODE_BUFFERVEC2,             ngli_buffervec2_class)              \
     action(NGL_NODE_BUFFERVEC3,             ngli_buffervec3_class)              \
@@ -0,0 +1,553 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "darray.h"
+#include "hmap.h"
+#include "log.h"
+#include "memory.h"
+#include "nodes.h"
+#include "params.h"
+#include "patch.h"
+#include "utils.h"
+
+extern const struct node_param ngli_base_node_params[];
+extern const struct param_specs ngli_params_specs[];
+
+/* Marks a label shared by several nodes of the current scene */
+static const char ambiguous_label;
+
+/* Live changes to apply on a kept node */
+struct patch_update {
+    struct ngl_node *node;      /* kept node of the current scene */
+    struct ngl_node *new;       /* matched node of the new scene holding the values */
+    int label_changed;
+    char *label;                /* new label, allocated ahead so the apply can not fail on it */
+};
+
+struct patch {
+    struct ngl_node *scene;     /* merged scene root */
+    struct patch_stats stats;
+    struct darray new_nodes;    /* references on the visited new nodes and their copies */
+    struct darray updates;      /* patch_update */
+};
+
+struct patcher {
+    struct hmap *resolved;      /* new node address -> node to use instead */
+    struct hmap *claimed;       /* current node address -> matched new node */
+    struct hmap *labels;        /* label -> current node */
+    struct patch *patch;
+};
+
+static void get_node_key(char *key, size_t size, const struct ngl_node *node)
+{
+    (void)snprintf(key, size, "%p", node);
+}
+
+static int has_default_label(const struct ngl_node *node)
+{
+    return !node->label || ngli_is_default_label(node->class->name, node->label);
+}
+
+static int index_labels(struct patcher *p, struct hmap *visited, struct ngl_node *node);
+
+static int index_children_labels(struct patcher *p, struct hmap *visited, struct ngl_node *node)
+{
+    uint8_t *base_ptr = node->priv_data;
+    const struct node_param *par = node->class->params;
+
+    while (par && par->key) {
+        int ret = 0;
+        switch (par->type) {
+            case PARAM_TYPE_NODE: {
+                struct ngl_node *child = *(struct ngl_node **)(base_ptr + par->offset);
+                if (child)
+                    ret = index_labels(p, visited, child);
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **elems = *(struct ngl_node ***)(base_ptr + par->offset);
+                const int nb_elems = *(int *)(base_ptr + par->offset + sizeof(struct ngl_node **));
+                for (int i = 0; i < nb_elems && ret >= 0; i++)
+                    ret = index_labels(p, visited, elems[i]);
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(base_ptr + par->offset);
+                if (!hmap)
+                    break;
+                const struct hmap_entry *entry = NULL;
+                while (ret >= 0 && (entry = ngli_hmap_next(hmap, entry)))
+                    ret = index_labels(p, visited, entry->data);
+                break;
+            }
+        }
+        if (ret < 0)
+            return ret;
+        par++;
+    }
+    return 0;
+}
+
+static int index_labels(struct patcher *p, struct hmap *visited, struct ngl_node *node)
+{
+    char key[32];
+    get_node_key(key, sizeof(key), node);
+    if (ngli_hmap_get(visited, key))
+        return 0;
+    int ret = ngli_hmap_set(visited, key, node);
+    if (ret < 0)
+        return ret;
+
+    if (!has_default_label(node)) {
+        void *data = ngli_hmap_get(p->labels, node->label) ? (void *)&ambiguous_label : node;
+        ret = ngli_hmap_set(p->labels, node->label, data);
+        if (ret < 0)
+            return ret;
+    }
+
+    return index_children_labels(p, visited, node);
+}
+
+static int can_match(const struct patcher *p, const struct ngl_node *cur, const struct ngl_node *new)
+{
+    if (!cur || cur->class != new->class)
+        return 0;
+    char key[32];
+    get_node_key(key, sizeof(key), cur);
+    const struct ngl_node *claimant = ngli_hmap_get(p->claimed, key);
+    return !claimant || claimant == new;
+}
+
+static int param_equal(const uint8_t *cur_base, const uint8_t *new_base, const struct node_param *par)
+{
+    const uint8_t *cur_p = cur_base + par->offset;
+    const uint8_t *new_p = new_base + par->offset;
+
+    switch (par->type) {
+        case PARAM_TYPE_STR: {
+            const char *cur_s = *(const char **)cur_p;
+            const char *new_s = *(const char **)new_p;
+            return cur_s == new_s || (cur_s && new_s && !strcmp(cur_s, new_s));
+        }
+        case PARAM_TYPE_DATA:
+        case PARAM_TYPE_DBLLIST: {
+            const uint8_t *cur_data = *(const uint8_t **)cur_p;
+            const uint8_t *new_data = *(const uint8_t **)new_p;
+            const int cur_nb = *(const int *)(cur_p + sizeof(uint8_t *));
+            const int new_nb = *(const int *)(new_p + sizeof(uint8_t *));
+            const size_t elem_size = par->type == PARAM_TYPE_DATA ? 1 : sizeof(double);
+            return cur_nb == new_nb && (!cur_nb || cur_data == new_data ||
+                                        !memcmp(cur_data, new_data, cur_nb * elem_size));
+        }
+        default:
+            return !memcmp(cur_p, new_p, ngli_params_specs[par->type].size);
+    }
+}
+
+/* Parameter values of the current node as they were set by the user */
+static const uint8_t *get_params_base(const struct ngl_node *node)
+{
+    return node->init_params ? node->init_params : node->priv_data;
+}
+
+static int is_node_param(const struct node_param *par)
+{
+    return par->type == PARAM_TYPE_NODE     ||
+           par->type == PARAM_TYPE_NODELIST ||
+           par->type == PARAM_TYPE_NODEDICT;
+}
+
+/* Only the values stored inline in the node can be copied in place */
+static int is_live_changeable(const struct node_param *par)
+{
+    return (par->flags & PARAM_FLAG_ALLOW_LIVE_CHANGE) &&
+           par->type != PARAM_TYPE_STR  &&
+           par->type != PARAM_TYPE_DATA &&
+           par->type != PARAM_TYPE_DBLLIST;
+}
+
+/*
+ * Check if the values of the current node can be made identical to the new
+ * ones without re-initializing it. The label is not used by the rendering so
+ * it can always be changed.
+ */
+static int values_compatible(const struct ngl_node *cur, const struct ngl_node *new, int *changedp)
+{
+    const uint8_t *cur_base = get_params_base(cur);
+    const struct node_param *par = cur->class->params;
+    while (par && par->key) {
+        if (!is_node_param(par) && !param_equal(cur_base, new->priv_data, par)) {
+            if (!is_live_changeable(par))
+                return 0;
+            *changedp = 1;
+        }
+        par++;
+    }
+    if (!param_equal((const uint8_t *)cur, (const uint8_t *)new, &ngli_base_node_params[0]))
+        *changedp = 1;
+    return 1;
+}
+
+static int record_update(struct patcher *p, struct ngl_node *cur, struct ngl_node *new)
+{
+    struct patch_update update = {.node = cur, .new = new};
+    const struct node_param *label_par = &ngli_base_node_params[0];
+    if (!param_equal((const uint8_t *)cur, (const uint8_t *)new, label_par)) {
+        update.label_changed = 1;
+        if (new->label && !(update.label = ngli_strdup(new->label)))
+            return -1;
+    }
+    if (!ngli_darray_push(&p->patch->updates, &update)) {
+        ngli_free(update.label);
+        return -1;
+    }
+    return 0;
+}
+
+static int apply_update(struct patch_update *update)
+{
+    struct ngl_node *cur = update->node;
+    const struct ngl_node *new = update->new;
+    const struct node_param *par = cur->class->params;
+    int ret = 0;
+    while (par && par->key) {
+        if (!is_node_param(par) && !param_equal(get_params_base(cur), new->priv_data, par)) {
+            const size_t size = ngli_params_specs[par->type].size;
+            const uint8_t *value = (const uint8_t *)new->priv_data + par->offset;
+            memcpy((uint8_t *)cur->priv_data + par->offset, value, size);
+            if (cur->init_params)
+                memcpy(cur->init_params + par->offset, value, size);
+            if (cur->ctx && par->update_func) {
+                int update_ret = par->update_func(cur);
+                if (update_ret < 0)
+                    ret = update_ret;
+            }
+        }
+        par++;
+    }
+    if (update->label_changed) {
+        ngli_free(cur->label);
+        cur->label = update->label;
+        update->label = NULL;
+        update->label_changed = 0;
+    }
+    return ret;
+}
+
+static struct ngl_node *resolve(struct patcher *p, struct ngl_node *cur, struct ngl_node *new);
+
+/*
+ * Resolve the children of the new node against the children of the current
+ * node. keepp is reset if any child of the current node can not be kept, and
+ * modifiedp is set if any child of the new node resolves to another node.
+ */
+static int resolve_children(struct patcher *p, struct ngl_node *cur, struct ngl_node *new,
+                            int *keepp, int *modifiedp)
+{
+    uint8_t *cur_base = cur ? cur->priv_data : NULL;
+    uint8_t *new_base = new->priv_data;
+    const struct node_param *par = new->class->params;
+
+    while (par && par->key) {
+        switch (par->type) {
+            case PARAM_TYPE_NODE: {
+                struct ngl_node *new_child = *(struct ngl_node **)(new_base + par->offset);
+                struct ngl_node *cur_child = cur ? *(struct ngl_node **)(cur_base + par->offset) : NULL;
+                if (!new_child) {
+                    if (cur_child)
+                        *keepp = 0;
+                    break;
+                }
+                struct ngl_node *child = resolve(p, cur_child, new_child);
+                if (!child)
+                    return -1;
+                if (child != new_child)
+                    *modifiedp = 1;
+                if (child != cur_child)
+                    *keepp = 0;
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **elems = *(struct ngl_node ***)(new_base + par->offset);
+                const int nb_elems = *(int *)(new_base + par->offset + sizeof(struct ngl_node **));
+                struct ngl_node **cur_elems = NULL;
+                int cur_nb_elems = 0;
+                if (cur) {
+                    cur_elems = *(struct ngl_node ***)(cur_base + par->offset);
+                    cur_nb_elems = *(int *)(cur_base + par->offset + sizeof(struct ngl_node **));
+                }
+                if (nb_elems != cur_nb_elems)
+                    *keepp = 0;
+                for (int i = 0; i < nb_elems; i++) {
+                    struct ngl_node *cur_child = i < cur_nb_elems ? cur_elems[i] : NULL;
+                    struct ngl_node *child = resolve(p, cur_child, elems[i]);
+                    if (!child)
+                        return -1;
+                    if (child != elems[i])
+                        *modifiedp = 1;
+                    if (child != cur_child)
+                        *keepp = 0;
+                }
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(new_base + par->offset);
+                struct hmap *cur_hmap = cur ? *(struct hmap **)(cur_base + par->offset) : NULL;
+                const int nb_nodes = hmap ? ngli_hmap_count(hmap) : 0;
+                const int cur_nb_nodes = cur_hmap ? ngli_hmap_count(cur_hmap) : 0;
+                if (nb_nodes != cur_nb_nodes)
+                    *keepp = 0;
+                if (!hmap)
+                    break;
+                const struct hmap_entry *entry = NULL;
+                while ((entry = ngli_hmap_next(hmap, entry))) {
+                    struct ngl_node *cur_child = cur_hmap ? ngli_hmap_get(cur_hmap, entry->key) : NULL;
+                    struct ngl_node *child = resolve(p, cur_child, entry->data);
+                    if (!child)
+                        return -1;
+                    if (child != entry->data)
+                        *modifiedp = 1;
+                    if (child != cur_child)
+                        *keepp = 0;
+                }
+                break;
+            }
+        }
+        par++;
+    }
+    return 0;
+}
+
+static struct ngl_node *get_resolved(const struct patcher *p, struct ngl_node *new)
+{
+    char key[32];
+    get_node_key(key, sizeof(key), new);
+    return ngli_hmap_get(p->resolved, key);
+}
+
+static int copy_param(const struct patcher *p, uint8_t *dst_base, const uint8_t *src_base,
+                      const struct node_param *par)
+{
+    const uint8_t *srcp = src_base + par->offset;
+
+    switch (par->type) {
+        case PARAM_TYPE_STR:
+            return ngli_params_vset(dst_base, par, *(const char **)srcp);
+        case PARAM_TYPE_DATA:
+            return ngli_params_vset(dst_base, par, *(const int *)(srcp + sizeof(uint8_t *)),
+                                    *(uint8_t **)srcp);
+        case PARAM_TYPE_DBLLIST:
+            return ngli_params_add(dst_base, par, *(const int *)(srcp + sizeof(double *)),
+                                   *(double **)srcp);
+        case PARAM_TYPE_NODE: {
+            struct ngl_node *child = *(struct ngl_node **)srcp;
+            return child ? ngli_params_vset(dst_base, par, get_resolved(p, child)) : 0;
+        }
+        case PARAM_TYPE_NODELIST: {
+            struct ngl_node **elems = *(struct ngl_node ***)srcp;
+            const int nb_elems = *(const int *)(srcp + sizeof(struct ngl_node **));
+            for (int i = 0; i < nb_elems; i++) {
+                struct ngl_node *child = get_resolved(p, elems[i]);
+                int ret = ngli_params_add(dst_base, par, 1, &child);
+                if (ret < 0)
+                    return ret;
+            }
+            return 0;
+        }
+        case PARAM_TYPE_NODEDICT: {
+            struct hmap *hmap = *(struct hmap **)srcp;
+            if (!hmap)
+                return 0;
+            const struct hmap_entry *entry = NULL;
+            while ((entry = ngli_hmap_next(hmap, entry))) {
+                int ret = ngli_params_vset(dst_base, par, entry->key, get_resolved(p, entry->data));
+                if (ret < 0)
+                    return ret;
+            }
+            return 0;
+        }
+        default:
+            memcpy(dst_base + par->offset, srcp, ngli_params_specs[par->type].size);
+            return 0;
+    }
+}
+
+/*
+ * Create a copy of the new node referencing the resolved children, so that
+ * the new scene given by the user is never modified.
+ */
+static struct ngl_node *copy_node(struct patcher *p, const struct ngl_node *new)
+{
+    struct ngl_node *node = ngli_node_create_noconstructor(new->class->id);
+    if (!node)
+        return NULL;
+
+    if (!ngli_darray_push(&p->patch->new_nodes, &node)) {
+        ngl_node_unrefp(&node);
+        return NULL;
+    }
+
+    if (copy_param(p, (uint8_t *)node, (const uint8_t *)new, &ngli_base_node_params[0]) < 0)
+        return NULL;
+
+    const struct node_param *par = new->class->params;
+    while (par && par->key) {
+        if (copy_param(p, node->priv_data, new->priv_data, par) < 0)
+            return NULL;
+        par++;
+    }
+    return node;
+}
+
+static struct ngl_node *resolve(struct patcher *p, struct ngl_node *cur, struct ngl_node *new)
+{
+    char key[32];
+    get_node_key(key, sizeof(key), new);
+    struct ngl_node *resolved = ngli_hmap_get(p->resolved, key);
+    if (resolved)
+        return resolved;
+
+    /* Keep the visited nodes alive so their addresses stay unique */
+    if (!ngli_darray_push(&p->patch->new_nodes, &new))
+        return NULL;
+    ngl_node_ref(new);
+
+    if (!has_default_label(new)) {
+        struct ngl_node *labeled = ngli_hmap_get(p->labels, new->label);
+        if (labeled != (void *)&ambiguous_label && can_match(p, labeled, new))
+            cur = labeled;
+    }
+    if (!can_match(p, cur, new))
+        cur = NULL;
+
+    if (cur) {
+        char cur_key[32];
+        get_node_key(cur_key, sizeof(cur_key), cur);
+        if (ngli_hmap_set(p->claimed, cur_key, new) < 0)
+            return NULL;
+    }
+
+    int keep = !!cur;
+    int modified = 0;
+    if (resolve_children(p, cur, new, &keep, &modified) < 0)
+        return NULL;
+
+    int changed = 0;
+    if (keep)
+        keep = values_compatible(cur, new, &changed);
+
+    if (keep) {
+        if (changed) {
+            if (record_update(p, cur, new) < 0)
+                return NULL;
+            p->patch->stats.nb_updated++;
+        }
+        p->patch->stats.nb_kept++;
+        resolved = cur;
+    } else {
+        p->patch->stats.nb_created++;
+        resolved = modified ? copy_node(p, new) : new;
+        if (!resolved)
+            return NULL;
+    }
+
+    if (ngli_hmap_set(p->resolved, key, resolved) < 0)
+        return NULL;
+    return resolved;
+}
+
+struct patch *ngli_patch_create(struct ngl_node *cur_scene, struct ngl_node *new_scene)
+{
+    struct patch *s = ngli_calloc(1, sizeof(*s));
+    if (!s)
+        return NULL;
+    ngli_darray_init(&s->new_nodes, sizeof(struct ngl_node *), 0);
+    ngli_darray_init(&s->updates, sizeof(struct patch_update), 0);
+
+    struct hmap *visited = ngli_hmap_create();
+    struct patcher p = {
+        .resolved = ngli_hmap_create(),
+        .claimed  = ngli_hmap_create(),
+        .labels   = ngli_hmap_create(),
+        .patch    = s,
+    };
+    if (!visited || !p.resolved || !p.claimed || !p.labels)
+        goto end;
+
+    if (index_labels(&p, visited, cur_scene) < 0)
+        goto end;
+
+    s->scene = resolve(&p, cur_scene, new_scene);
+    if (s->scene)
+        ngl_node_ref(s->scene);
+
+end:
+    ngli_hmap_freep(&visited);
+    ngli_hmap_freep(&p.resolved);
+    ngli_hmap_freep(&p.claimed);
+    ngli_hmap_freep(&p.labels);
+    if (!s->scene)
+        ngli_patch_freep(&s);
+    return s;
+}
+
+struct ngl_node *ngli_patch_get_scene(const struct patch *s)
+{
+    return s->scene;
+}
+
+const struct patch_stats *ngli_patch_get_stats(const struct patch *s)
+{
+    return &s->stats;
+}
+
+int ngli_patch_apply(struct patch *s)
+{
+    int ret = 0;
+    struct patch_update *updates = ngli_darray_data(&s->updates);
+    for (int i = 0; i < ngli_darray_count(&s->updates); i++) {
+        int update_ret = apply_update(&updates[i]);
+        if (update_ret < 0)
+            ret = update_ret;
+    }
+    return ret;
+}
+
+void ngli_patch_freep(struct patch **sp)
+{
+    struct patch *s = *sp;
+    if (!s)
+        return;
+    ngl_node_unrefp(&s->scene);
+    struct patch_update *updates = ngli_darray_data(&s->updates);
+    for (int i = 0; i < ngli_darray_count(&s->updates); i++)
+        ngli_free(updates[i].label);
+    ngli_darray_reset(&s->updates);
+    struct ngl_node **new_nodes = ngli_darray_data(&s->new_nodes);
+    for (int i = 0; i < ngli_darray_count(&s->new_nodes); i++)
+        ngl_node_unrefp(&new_nodes[i]);
+    ngli_darray_reset(&s->new_nodes);
+    ngli_free(s);
+    *sp = NULL;
+}
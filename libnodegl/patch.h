@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PATCH_H
+#define PATCH_H
+
+struct ngl_node;
+
+struct patch_stats {
+    int nb_kept;        // nodes of the current scene reused as is
+    int nb_updated;     // reused nodes with live changed parameters
+    int nb_created;     // nodes of the new scene which need to be initialized
+};
+
+struct patch;
+
+/*
+ * Merge the new scene into the current one: every node of the new scene is
+ * matched with a node of the current scene (through the same parameter of
+ * the matched parent, or through a unique non-default label). A matched node
+ * is kept if all its parameters are identical, or only differ by parameters
+ * which can be live changed, and if all its children are kept as well.
+ * Otherwise the node of the new scene is used, or a copy of it referencing
+ * the kept nodes if any of its children has been replaced.
+ *
+ * Neither scene is modified: the live changes of the kept nodes are only
+ * recorded, and applied with ngli_patch_apply() once the merged scene has
+ * been successfully attached.
+ */
+struct patch *ngli_patch_create(struct ngl_node *cur_scene, struct ngl_node *new_scene);
+
+/*
+ * Return the merged scene root, which is the current scene if the whole graph
+ * has been kept. The reference is owned by the patch.
+ */
+struct ngl_node *ngli_patch_get_scene(const struct patch *s);
+
+const struct patch_stats *ngli_patch_get_stats(const struct patch *s);
+
+/* Apply the recorded live changes to the kept nodes */
+int ngli_patch_apply(struct patch *s);
+
+void ngli_patch_freep(struct patch **sp);
+
+#endif
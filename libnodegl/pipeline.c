@@ -71,7 +71,7 @@ static const struct {
     [1] = {"OES", GL_TEXTURE_EXTERNAL_OES},
 };
 
-static int get_disabled_texture_unit(const struct glcontext *gl,
+static int get_disabled_texture_unit(struct glcontext *gl,
                                      struct pipeline *s,
                                      uint64_t *used_texture_units,
                                      int type_index)
@@ -88,15 +88,15 @@ static int get_disabled_texture_unit(const struct glcontext *gl,
           tex_unit, tex_specs[type_index].name);
     s->disabled_texture_unit[type_index] = tex_unit;
 
-    ngli_glActiveTexture(gl, GL_TEXTURE0 + tex_unit);
-    ngli_glBindTexture(gl, GL_TEXTURE_2D, 0);
+    ngli_glstate_active_texture(gl, GL_TEXTURE0 + tex_unit);
+    ngli_glstate_bind_texture(gl, GL_TEXTURE_2D, 0);
     if (gl->features & NGLI_FEATURE_OES_EGL_EXTERNAL_IMAGE)
-        ngli_glBindTexture(gl, GL_TEXTURE_EXTERNAL_OES, 0);
+        ngli_glstate_bind_texture(gl, GL_TEXTURE_EXTERNAL_OES, 0);
 
     return tex_unit;
 }
 
-static int bind_texture_plane(const struct glcontext *gl,
+static int bind_texture_plane(struct glcontext *gl,
                               const struct texture *plane,
                               uint64_t *used_texture_units,
                               int location)
@@ -104,13 +104,13 @@ static int bind_texture_plane(const struct glcontext *gl,
     int texture_index = acquire_next_available_texture_unit(used_texture_units);
     if (texture_index < 0)
         return -1;
-    ngli_glActiveTexture(gl, GL_TEXTURE0 + texture_index);
-    ngli_glBindTexture(gl, plane->target, plane->id);
+    ngli_glstate_active_texture(gl, GL_TEXTURE0 + texture_index);
+    ngli_glstate_bind_texture(gl, plane->target, plane->id);
     ngli_glUniform1i(gl, location, texture_index);
     return 0;
 }
 
-static int update_sampler(const struct glcontext *gl,
+static int update_sampler(struct glcontext *gl,
                           struct pipeline *s,
                           const struct image *image,
                           const struct textureprograminfo *info,
@@ -192,135 +192,183 @@ static int update_images_and_samplers(struct ngl_node *node)
     struct glcontext *gl = ctx->glcontext;
     struct pipeline *s = get_pipeline(node);
 
-    if (s->textures) {
-        uint64_t used_texture_units = s->used_texture_units;
+    const struct darray *texture_bindings = &s->texture_bindings;
+    const int nb_textures = ngli_darray_count(texture_bindings);
+    if (!nb_textures)
+        return 0;
 
-        for (int i = 0; i < NGLI_ARRAY_NB(s->disabled_texture_unit); i++)
-            s->disabled_texture_unit[i] = -1;
+    uint64_t used_texture_units = s->used_texture_units;
 
-        const struct darray *texture_pairs = &s->texture_pairs;
-        const struct nodeprograminfopair *pairs = ngli_darray_data(texture_pairs);
-        for (int i = 0; i < ngli_darray_count(texture_pairs); i++) {
-            const struct nodeprograminfopair *pair = &pairs[i];
-            const struct textureprograminfo *info = pair->program_info;
-            const struct texture_priv *texture = pair->node->priv_data;
-            const struct image *image = &texture->image;
+    for (int i = 0; i < NGLI_ARRAY_NB(s->disabled_texture_unit); i++)
+        s->disabled_texture_unit[i] = -1;
 
-            int sampling_mode;
-            int ret = update_sampler(gl, s, image, info, &used_texture_units, &sampling_mode);
-            if (ret < 0)
-                return ret;
+    const struct pipeline_texture *textures = ngli_darray_data(texture_bindings);
+    for (int i = 0; i < nb_textures; i++) {
+        const struct textureprograminfo *info = textures[i].info;
+        const struct image *image = textures[i].image;
 
-            if (info->sampling_mode_location >= 0)
-                ngli_glUniform1i(gl, info->sampling_mode_location, sampling_mode);
+        int sampling_mode;
+        int ret = update_sampler(gl, s, image, info, &used_texture_units, &sampling_mode);
+        if (ret < 0)
+            return ret;
 
-            if (info->coord_matrix_location >= 0)
-                ngli_glUniformMatrix4fv(gl, info->coord_matrix_location, 1, GL_FALSE, image->coordinates_matrix);
+        if (info->sampling_mode_location >= 0)
+            ngli_glUniform1i(gl, info->sampling_mode_location, sampling_mode);
 
-            if (info->dimensions_location >= 0) {
-                float dimensions[3] = {0};
-                if (image->layout != NGLI_IMAGE_LAYOUT_NONE) {
-                    const struct texture_params *params = &image->planes[0]->params;
-                    dimensions[0] = params->width;
-                    dimensions[1] = params->height;
-                    dimensions[2] = params->depth;
-                }
-                if (info->dimensions_type == GL_FLOAT_VEC2)
-                    ngli_glUniform2fv(gl, info->dimensions_location, 1, dimensions);
-                else if (info->dimensions_type == GL_FLOAT_VEC3)
-                    ngli_glUniform3fv(gl, info->dimensions_location, 1, dimensions);
-            }
+        if (info->coord_matrix_location >= 0)
+            ngli_glUniformMatrix4fv(gl, info->coord_matrix_location, 1, GL_FALSE, image->coordinates_matrix);
 
-            if (info->ts_location >= 0)
-                ngli_glUniform1f(gl, info->ts_location, image->ts);
+        if (info->dimensions_location >= 0) {
+            float dimensions[3] = {0};
+            if (image->layout != NGLI_IMAGE_LAYOUT_NONE) {
+                const struct texture_params *params = &image->planes[0]->params;
+                dimensions[0] = params->width;
+                dimensions[1] = params->height;
+                dimensions[2] = params->depth;
+            }
+            if (info->dimensions_type == GL_FLOAT_VEC2)
+                ngli_glUniform2fv(gl, info->dimensions_location, 1, dimensions);
+            else if (info->dimensions_type == GL_FLOAT_VEC3)
+                ngli_glUniform3fv(gl, info->dimensions_location, 1, dimensions);
         }
+
+        if (info->ts_location >= 0)
+            ngli_glUniform1f(gl, info->ts_location, image->ts);
     }
 
     return 0;
 }
 
-static int update_uniforms(struct ngl_node *node)
+static void upload_float_from_double(const struct glcontext *gl, GLint location, int count, const void *data)
 {
-    struct ngl_ctx *ctx = node->ctx;
-    struct glcontext *gl = ctx->glcontext;
-    struct pipeline *s = get_pipeline(node);
+    ngli_glUniform1f(gl, location, *(const double *)data);
+}
 
-    const struct darray *uniform_pairs = &s->uniform_pairs;
-    const struct nodeprograminfopair *pairs = ngli_darray_data(uniform_pairs);
-    for (int i = 0; i < ngli_darray_count(uniform_pairs); i++) {
-        const struct nodeprograminfopair *pair = &pairs[i];
-        const struct uniformprograminfo *info = pair->program_info;
-        const GLint uid = info->location;
-        if (uid < 0)
-            continue;
-        const struct ngl_node *unode = pair->node;
+static void upload_float(const struct glcontext *gl, GLint location, int count, const void *data)
+{
+    ngli_glUniform1fv(gl, location, count, data);
+}
+
+static void upload_vec2(const struct glcontext *gl, GLint location, int count, const void *data)
+{
+    ngli_glUniform2fv(gl, location, count, data);
+}
+
+static void upload_vec3(const struct glcontext *gl, GLint location, int count, const void *data)
+{
+    ngli_glUniform3fv(gl, location, count, data);
+}
+
+static void upload_vec4(const struct glcontext *gl, GLint location, int count, const void *data)
+{
+    ngli_glUniform4fv(gl, location, count, data);
+}
+
+static void upload_int(const struct glcontext *gl, GLint location, int count, const void *data)
+{
+    ngli_glUniform1i(gl, location, *(const int *)data);
+}
+
+static void upload_mat4(const struct glcontext *gl, GLint location, int count, const void *data)
+{
+    ngli_glUniformMatrix4fv(gl, location, count, GL_FALSE, data);
+}
+
+static int init_uniform(struct pipeline_uniform *uniform,
+                        struct ngl_node *unode,
+                        const struct uniformprograminfo *info,
+                        const char *name)
+{
+    uniform->location = info->location;
+    uniform->count = 1;
+
+    switch (unode->class->id) {
+    case NGL_NODE_UNIFORMFLOAT:
+    case NGL_NODE_UNIFORMVEC2:
+    case NGL_NODE_UNIFORMVEC3:
+    case NGL_NODE_UNIFORMVEC4:
+    case NGL_NODE_UNIFORMINT:
+    case NGL_NODE_UNIFORMQUAT:
+    case NGL_NODE_UNIFORMMAT4: {
+        const struct uniform_priv *u = unode->priv_data;
         switch (unode->class->id) {
-        case NGL_NODE_UNIFORMFLOAT: {
-            const struct uniform_priv *u = unode->priv_data;
-            ngli_glUniform1f(gl, uid, u->scalar);
-            break;
-        }
-        case NGL_NODE_UNIFORMVEC2: {
-            const struct uniform_priv *u = unode->priv_data;
-            ngli_glUniform2fv(gl, uid, 1, u->vector);
-            break;
-        }
-        case NGL_NODE_UNIFORMVEC3: {
-            const struct uniform_priv *u = unode->priv_data;
-            ngli_glUniform3fv(gl, uid, 1, u->vector);
-            break;
-        }
-        case NGL_NODE_UNIFORMVEC4: {
-            const struct uniform_priv *u = unode->priv_data;
-            ngli_glUniform4fv(gl, uid, 1, u->vector);
-            break;
-        }
-        case NGL_NODE_UNIFORMINT: {
-            const struct uniform_priv *u = unode->priv_data;
-            ngli_glUniform1i(gl, uid, u->ival);
-            break;
-        }
-        case NGL_NODE_UNIFORMQUAT: {
-            const struct uniform_priv *u = unode->priv_data;
-            if (info->type == GL_FLOAT_MAT4)
-                ngli_glUniformMatrix4fv(gl, uid, 1, GL_FALSE, u->matrix);
-            else if (info->type == GL_FLOAT_VEC4)
-                ngli_glUniform4fv(gl, uid, 1, u->vector);
-            else
-                LOG(ERROR,
-                    "quaternion uniform '%s' must be declared as vec4 or mat4 in the shader",
-                    pair->name);
-            break;
-        }
-        case NGL_NODE_UNIFORMMAT4: {
-            const struct uniform_priv *u = unode->priv_data;
-            ngli_glUniformMatrix4fv(gl, uid, 1, GL_FALSE, u->matrix);
-            break;
-        }
-        case NGL_NODE_BUFFERFLOAT: {
-            const struct buffer_priv *buffer = unode->priv_data;
-            ngli_glUniform1fv(gl, uid, buffer->count, (const GLfloat *)buffer->data);
-            break;
-        }
-        case NGL_NODE_BUFFERVEC2: {
-            const struct buffer_priv *buffer = unode->priv_data;
-            ngli_glUniform2fv(gl, uid, buffer->count, (const GLfloat *)buffer->data);
-            break;
-        }
-        case NGL_NODE_BUFFERVEC3: {
-            const struct buffer_priv *buffer = unode->priv_data;
-            ngli_glUniform3fv(gl, uid, buffer->count, (const GLfloat *)buffer->data);
+        case NGL_NODE_UNIFORMFLOAT: uniform->upload = upload_float_from_double; uniform->data = &u->scalar; uniform->data_size = sizeof(u->scalar);    break;
+        case NGL_NODE_UNIFORMVEC2:  uniform->upload = upload_vec2;              uniform->data = u->vector;  uniform->data_size = 2 * sizeof(*u->vector); break;
+        case NGL_NODE_UNIFORMVEC3:  uniform->upload = upload_vec3;              uniform->data = u->vector;  uniform->data_size = 3 * sizeof(*u->vector); break;
+        case NGL_NODE_UNIFORMVEC4:  uniform->upload = upload_vec4;              uniform->data = u->vector;  uniform->data_size = 4 * sizeof(*u->vector); break;
+        case NGL_NODE_UNIFORMINT:   uniform->upload = upload_int;               uniform->data = &u->ival;   uniform->data_size = sizeof(u->ival);      break;
+        case NGL_NODE_UNIFORMMAT4:  uniform->upload = upload_mat4;              uniform->data = u->matrix;  uniform->data_size = sizeof(u->matrix);    break;
+        case NGL_NODE_UNIFORMQUAT:
+            if (info->type == GL_FLOAT_MAT4) {
+                uniform->upload = upload_mat4;
+                uniform->data = u->matrix;
+                uniform->data_size = sizeof(u->matrix);
+            } else if (info->type == GL_FLOAT_VEC4) {
+                uniform->upload = upload_vec4;
+                uniform->data = u->vector;
+                uniform->data_size = 4 * sizeof(*u->vector);
+            } else {
+                LOG(ERROR, "quaternion uniform '%s' must be declared as vec4 or mat4 in the shader", name);
+                return 0;
+            }
             break;
         }
-        case NGL_NODE_BUFFERVEC4: {
-            const struct buffer_priv *buffer = unode->priv_data;
-            ngli_glUniform4fv(gl, uid, buffer->count, (const GLfloat *)buffer->data);
-            break;
+        break;
+    }
+    case NGL_NODE_BUFFERFLOAT:
+    case NGL_NODE_BUFFERVEC2:
+    case NGL_NODE_BUFFERVEC3:
+    case NGL_NODE_BUFFERVEC4: {
+        const struct buffer_priv *buffer = unode->priv_data;
+        int ret = ngli_node_buffer_ref_data(unode);
+        if (ret < 0)
+            return ret;
+        uniform->buffer = unode;
+        switch (unode->class->id) {
+        case NGL_NODE_BUFFERFLOAT: uniform->upload = upload_float; break;
+        case NGL_NODE_BUFFERVEC2:  uniform->upload = upload_vec2;  break;
+        case NGL_NODE_BUFFERVEC3:  uniform->upload = upload_vec3;  break;
+        case NGL_NODE_BUFFERVEC4:  uniform->upload = upload_vec4;  break;
         }
-        default:
-            LOG(ERROR, "unsupported uniform of type %s", unode->class->name);
-            break;
+        uniform->count = buffer->count;
+        uniform->data = buffer->data;
+        break;
+    }
+    default:
+        LOG(ERROR, "unsupported uniform of type %s", unode->class->name);
+        return 0;
+    }
+
+    ngli_assert(uniform->data_size <= sizeof(uniform->last_value));
+    return 1;
+}
+
+static int update_uniforms(struct ngl_node *node)
+{
+    struct ngl_ctx *ctx = node->ctx;
+    struct glcontext *gl = ctx->glcontext;
+    struct pipeline *s = get_pipeline(node);
+    struct program_priv *program = s->program->priv_data;
+
+    /*
+     * The cached values are only meaningful if this pipeline was the last one
+     * to upload its uniforms into the program.
+     */
+    const int force_upload = program->shared->last_pipeline != s;
+    program->shared->last_pipeline = s;
+
+    struct darray *uniform_bindings = &s->uniform_bindings;
+    struct pipeline_uniform *uniforms = ngli_darray_data(uniform_bindings);
+    for (int i = 0; i < ngli_darray_count(uniform_bindings); i++) {
+        struct pipeline_uniform *uniform = &uniforms[i];
+        if (uniform->data_size) {
+            if (!force_upload && uniform->uploaded &&
+                !memcmp(uniform->last_value, uniform->data, uniform->data_size))
+                continue;
+            memcpy(uniform->last_value, uniform->data, uniform->data_size);
+            uniform->uploaded = 1;
         }
+        uniform->upload(gl, uniform->location, uniform->count, uniform->data);
     }
 
     return 0;
@@ -332,15 +380,11 @@ static int update_buffers(struct ngl_node *node)
     struct glcontext *gl = ctx->glcontext;
     struct pipeline *s = get_pipeline(node);
 
-    const struct darray *buffer_pairs = &s->buffer_pairs;
-    const struct nodeprograminfopair *pairs = ngli_darray_data(buffer_pairs);
-    for (int i = 0; i < ngli_darray_count(buffer_pairs); i++) {
-        const struct nodeprograminfopair *pair = &pairs[i];
-        const struct ngl_node *bnode = pair->node;
-        const struct buffer_priv *buffer = bnode->priv_data;
-        const struct bufferprograminfo *info = pair->program_info;
-
-        ngli_glBindBufferBase(gl, info->type, info->binding, buffer->buffer.id);
+    const struct darray *buffer_bindings = &s->buffer_bindings;
+    const struct pipeline_buffer *buffers = ngli_darray_data(buffer_bindings);
+    for (int i = 0; i < ngli_darray_count(buffer_bindings); i++) {
+        const struct pipeline_buffer *buffer = &buffers[i];
+        ngli_glBindBufferBase(gl, buffer->type, buffer->binding, buffer->buffer->id);
     }
 
     return 0;
@@ -419,13 +463,18 @@ int ngli_pipeline_init(struct ngl_node *node)
     struct pipeline *s = get_pipeline(node);
     struct program_priv *program = s->program->priv_data;
 
-    ngli_darray_init(&s->texture_pairs, sizeof(struct nodeprograminfopair), 0);
-    ngli_darray_init(&s->uniform_pairs, sizeof(struct nodeprograminfopair), 0);
-    ngli_darray_init(&s->buffer_pairs, sizeof(struct nodeprograminfopair), 0);
+    ngli_darray_init(&s->texture_bindings, sizeof(struct pipeline_texture), 0);
+    ngli_darray_init(&s->uniform_bindings, sizeof(struct pipeline_uniform), 0);
+    ngli_darray_init(&s->buffer_bindings, sizeof(struct pipeline_buffer), 0);
+    ngli_darray_init(&s->update_nodes, sizeof(struct ngl_node *), 0);
 
     if (s->uniforms) {
         const struct hmap_entry *entry = NULL;
         while ((entry = ngli_hmap_next(s->uniforms, entry))) {
+            struct ngl_node *unode = entry->data;
+            if (!ngli_darray_push(&s->update_nodes, &unode))
+                return -1;
+
             const struct uniformprograminfo *active_uniform =
                 ngli_hmap_get(program->active_uniforms, entry->key);
             if (!active_uniform) {
@@ -434,13 +483,20 @@ int ngli_pipeline_init(struct ngl_node *node)
                 continue;
             }
 
-            struct nodeprograminfopair pair = {
-                .node = entry->data,
-                .program_info = (void *)active_uniform,
-            };
-            snprintf(pair.name, sizeof(pair.name), "%s", entry->key);
-            if (!ngli_darray_push(&s->uniform_pairs, &pair))
+            if (active_uniform->location < 0)
+                continue;
+
+            struct pipeline_uniform uniform = {0};
+            int ret = init_uniform(&uniform, unode, active_uniform, entry->key);
+            if (ret < 0)
+                return ret;
+            if (!ret)
+                continue;
+            if (!ngli_darray_push(&s->uniform_bindings, &uniform)) {
+                if (uniform.buffer)
+                    ngli_node_buffer_unref_data(uniform.buffer);
                 return -1;
+            }
         }
     }
 
@@ -500,12 +556,12 @@ int ngli_pipeline_init(struct ngl_node *node)
 #endif
             s->nb_textureprograminfos++;
 
-            struct nodeprograminfopair pair = {
-                .node = tnode,
-                .program_info = (void *)info,
+            struct pipeline_texture pipeline_texture = {
+                .info = info,
+                .image = &texture->image,
             };
-            snprintf(pair.name, sizeof(pair.name), "%s", key);
-            if (!ngli_darray_push(&s->texture_pairs, &pair))
+            if (!ngli_darray_push(&s->texture_bindings, &pipeline_texture) ||
+                !ngli_darray_push(&s->update_nodes, &tnode))
                 return -1;
         }
     }
@@ -538,12 +594,13 @@ int ngli_pipeline_init(struct ngl_node *node)
             if (ret < 0)
                 return ret;
 
-            struct nodeprograminfopair pair = {
+            struct pipeline_buffer pipeline_buffer = {
                 .node = bnode,
-                .program_info = (void *)info,
+                .buffer = &buffer->buffer,
+                .type = info->type,
+                .binding = info->binding,
             };
-            snprintf(pair.name, sizeof(pair.name), "%s", entry->key);
-            if (!ngli_darray_push(&s->buffer_pairs, &pair)) {
+            if (!ngli_darray_push(&s->buffer_bindings, &pipeline_buffer)) {
                 ngli_node_buffer_unref(bnode);
                 return -1;
             }
@@ -556,19 +613,28 @@ int ngli_pipeline_init(struct ngl_node *node)
 void ngli_pipeline_uninit(struct ngl_node *node)
 {
     struct pipeline *s = get_pipeline(node);
+    struct program_priv *program = s->program->priv_data;
 
-    ngli_free(s->textureprograminfos);
+    if (program->shared && program->shared->last_pipeline == s)
+        program->shared->last_pipeline = NULL;
 
-    ngli_darray_reset(&s->texture_pairs);
-    ngli_darray_reset(&s->uniform_pairs);
+    ngli_free(s->textureprograminfos);
 
-    struct darray *buffer_pairs = &s->buffer_pairs;
-    struct nodeprograminfopair *pairs = ngli_darray_data(buffer_pairs);
-    for (int i = 0; i < ngli_darray_count(buffer_pairs); i++) {
-        struct nodeprograminfopair *pair = &pairs[i];
-        ngli_node_buffer_unref(pair->node);
-    }
-    ngli_darray_reset(&s->buffer_pairs);
+    ngli_darray_reset(&s->texture_bindings);
+
+    struct darray *uniform_bindings = &s->uniform_bindings;
+    struct pipeline_uniform *uniforms = ngli_darray_data(uniform_bindings);
+    for (int i = 0; i < ngli_darray_count(uniform_bindings); i++)
+        if (uniforms[i].buffer)
+            ngli_node_buffer_unref_data(uniforms[i].buffer);
+    ngli_darray_reset(&s->uniform_bindings);
+    ngli_darray_reset(&s->update_nodes);
+
+    struct darray *buffer_bindings = &s->buffer_bindings;
+    struct pipeline_buffer *buffers = ngli_darray_data(buffer_bindings);
+    for (int i = 0; i < ngli_darray_count(buffer_bindings); i++)
+        ngli_node_buffer_unref(buffers[i].node);
+    ngli_darray_reset(&s->buffer_bindings);
 }
 
 int ngli_pipeline_update(struct ngl_node *node, double t)
@@ -577,29 +643,19 @@ int ngli_pipeline_update(struct ngl_node *node, double t)
     struct glcontext *gl = ctx->glcontext;
     struct pipeline *s = get_pipeline(node);
 
-    if (s->textures) {
-        const struct hmap_entry *entry = NULL;
-        while ((entry = ngli_hmap_next(s->textures, entry))) {
-            int ret = ngli_node_update(entry->data, t);
-            if (ret < 0)
-                return ret;
-        }
-    }
-
-    if (s->uniforms) {
-        const struct hmap_entry *entry = NULL;
-        while ((entry = ngli_hmap_next(s->uniforms, entry))) {
-            int ret = ngli_node_update(entry->data, t);
-            if (ret < 0)
-                return ret;
-        }
+    const struct darray *update_nodes = &s->update_nodes;
+    struct ngl_node **nodes = ngli_darray_data(update_nodes);
+    for (int i = 0; i < ngli_darray_count(update_nodes); i++) {
+        int ret = ngli_node_update(nodes[i], t);
+        if (ret < 0)
+            return ret;
     }
 
-    if (s->buffers &&
-        gl->features & NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT) {
-        const struct hmap_entry *entry = NULL;
-        while ((entry = ngli_hmap_next(s->buffers, entry))) {
-            struct ngl_node *bnode = (struct ngl_node *)entry->data;
+    if (gl->features & NGLI_FEATURE_SHADER_STORAGE_BUFFER_OBJECT) {
+        const struct darray *buffer_bindings = &s->buffer_bindings;
+        const struct pipeline_buffer *buffers = ngli_darray_data(buffer_bindings);
+        for (int i = 0; i < ngli_darray_count(buffer_bindings); i++) {
+            struct ngl_node *bnode = buffers[i].node;
             int ret = ngli_node_update(bnode, t);
             if (ret < 0)
                 return ret;
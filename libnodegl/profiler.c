@@ -0,0 +1,484 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <errno.h>
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "bstr.h"
+#include "darray.h"
+#include "glincludes.h"
+#include "glcontext.h"
+#include "hmap.h"
+#include "log.h"
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "profiler.h"
+#include "utils.h"
+
+static const char * const event_names[] = {
+    [PROFILER_EVENT_INIT]     = "init",
+    [PROFILER_EVENT_PREFETCH] = "prefetch",
+    [PROFILER_EVENT_UPDATE]   = "update",
+    [PROFILER_EVENT_DRAW]     = "draw",
+    [PROFILER_EVENT_RELEASE]  = "release",
+};
+
+NGLI_STATIC_ASSERT(event_names, NGLI_ARRAY_NB(event_names) == NB_PROFILER_EVENTS);
+
+struct profiler_stats {
+    char *label;
+    int count[NB_PROFILER_EVENTS];
+    int64_t cpu_times[NB_PROFILER_EVENTS];
+    int64_t gpu_time;
+};
+
+struct profiler_event {
+    struct profiler_stats *stats;
+    enum profiler_event_type type;
+    int64_t cpu_start;
+    int64_t cpu_end;
+    int query_id;
+};
+
+struct event_batch {
+    struct darray events;
+    struct darray queries;
+    int nb_queries_used;
+};
+
+/* GPU timing of an event whose queries were not available yet when its batch
+ * was flushed; the queries are owned by the entry until they are resolved */
+struct pending_event {
+    struct profiler_stats *stats;
+    int64_t cpu_start;
+    GLuint queries[2];
+};
+
+struct profiler {
+    int fd;
+    int write_error;
+    struct bstr *buf;
+    int nb_written;
+    struct hmap *stats;
+    struct event_batch batches[2];
+    int cur_batch;
+    struct darray pending_events;   // pending_event
+    int64_t gpu_origin;             // GPU timestamp aligned with cpu_origin, -1 if unset
+    int64_t cpu_origin;
+
+    struct glcontext *gl;
+    int timer_queries;              // whether the GPU timings are available
+    void (*glGenQueries)(const struct glcontext *gl, GLsizei n, GLuint * ids);
+    void (*glDeleteQueries)(const struct glcontext *gl, GLsizei n, const GLuint * ids);
+    void (*glQueryCounter)(const struct glcontext *gl, GLuint id, GLenum target);
+    void (*glGetQueryObjectui64v)(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 *params);
+};
+
+static void free_stats(void *user_arg, void *data)
+{
+    struct profiler_stats *stats = data;
+    ngli_free(stats->label);
+    ngli_free(stats);
+}
+
+static void write_trace(struct profiler *p, const char *buf, size_t size)
+{
+    while (size && !p->write_error) {
+        const ssize_t n = write(p->fd, buf, size);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0) {
+            LOG(ERROR, "unable to write the profiling trace, it will be incomplete");
+            p->write_error = 1;
+            break;
+        }
+        buf += n;
+        size -= n;
+    }
+}
+
+struct profiler *ngli_profiler_create(const char *filename)
+{
+    struct profiler *p = ngli_calloc(1, sizeof(*p));
+    if (!p)
+        return NULL;
+
+    p->fd = open(filename, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+    if (p->fd == -1) {
+        LOG(ERROR, "unable to open \"%s\" for writing", filename);
+        ngli_free(p);
+        return NULL;
+    }
+
+    for (int i = 0; i < NGLI_ARRAY_NB(p->batches); i++) {
+        ngli_darray_init(&p->batches[i].events, sizeof(struct profiler_event), 0);
+        ngli_darray_init(&p->batches[i].queries, sizeof(GLuint), 0);
+    }
+    ngli_darray_init(&p->pending_events, sizeof(struct pending_event), 0);
+
+    p->buf = ngli_bstr_create();
+    p->stats = ngli_hmap_create();
+    if (!p->buf || !p->stats) {
+        ngli_profiler_freep(&p);
+        return NULL;
+    }
+    ngli_hmap_set_free(p->stats, free_stats, NULL);
+
+    static const char header[] = "{\"traceEvents\":[\n";
+    write_trace(p, header, sizeof(header) - 1);
+
+    LOG(INFO, "profiling to %s", filename);
+    return p;
+}
+
+static void print_event(struct profiler *p, const char *label, const char *cat,
+                        int tid, int64_t ts, int64_t dur)
+{
+    ngli_bstr_print(p->buf, "%s{\"name\":\"", p->nb_written++ ? ",\n" : "");
+    for (const char *c = label; *c; c++) {
+        if (*c == '"' || *c == '\\')
+            ngli_bstr_print(p->buf, "\\%c", *c);
+        else if ((unsigned char)*c < 0x20)
+            ngli_bstr_print(p->buf, "\\u%04x", *c);
+        else
+            ngli_bstr_print(p->buf, "%c", *c);
+    }
+    ngli_bstr_print(p->buf, "\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":0,\"tid\":%d,"
+                    "\"ts\":%" PRId64 ",\"dur\":%" PRId64 "}", cat, tid, ts, dur);
+}
+
+/*
+ * Return 1 and the GPU start/end timestamps if the queries are available (or
+ * if wait is set, in which case the results are waited for), 0 otherwise.
+ */
+static int get_gpu_times(struct profiler *p, const GLuint *queries, int wait,
+                         GLuint64 *startp, GLuint64 *endp)
+{
+    if (!wait) {
+        GLuint64 available = 0;
+        p->glGetQueryObjectui64v(p->gl, queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            return 0;
+    }
+    p->glGetQueryObjectui64v(p->gl, queries[0], GL_QUERY_RESULT, startp);
+    p->glGetQueryObjectui64v(p->gl, queries[1], GL_QUERY_RESULT, endp);
+    return 1;
+}
+
+static void print_gpu_event(struct profiler *p, struct profiler_stats *stats, int64_t cpu_start,
+                            GLuint64 gpu_start, GLuint64 gpu_end)
+{
+    /* GPU timestamps use their own time base: align them with the CPU clock
+     * using the first GPU event resolved in the flush */
+    if (p->gpu_origin < 0) {
+        p->gpu_origin = gpu_start;
+        p->cpu_origin = cpu_start;
+    }
+
+    const int64_t gpu_dur = gpu_end - gpu_start;
+    stats->gpu_time += gpu_dur;
+    print_event(p, stats->label, "gpu", 1,
+                p->cpu_origin + ((int64_t)gpu_start - p->gpu_origin) / 1000, gpu_dur / 1000);
+}
+
+static void flush_pending_events(struct profiler *p, int wait)
+{
+    struct pending_event *pending = ngli_darray_data(&p->pending_events);
+    int nb_pending = 0;
+    for (int i = 0; i < ngli_darray_count(&p->pending_events); i++) {
+        struct pending_event *pev = &pending[i];
+        GLuint64 gpu_start = 0, gpu_end = 0;
+        if (get_gpu_times(p, pev->queries, wait, &gpu_start, &gpu_end)) {
+            print_gpu_event(p, pev->stats, pev->cpu_start, gpu_start, gpu_end);
+            p->glDeleteQueries(p->gl, 2, pev->queries);
+        } else {
+            pending[nb_pending++] = *pev;
+        }
+    }
+    p->pending_events.count = nb_pending;
+}
+
+/*
+ * Defer the GPU timing of an event to a later flush: its queries are moved
+ * out of the batch, which gets new ones in place.
+ */
+static int defer_event(struct profiler *p, struct event_batch *batch, const struct profiler_event *ev)
+{
+    GLuint *queries = ngli_darray_data(&batch->queries);
+    struct pending_event pev = {
+        .stats     = ev->stats,
+        .cpu_start = ev->cpu_start,
+        .queries   = {queries[ev->query_id], queries[ev->query_id + 1]},
+    };
+    if (!ngli_darray_push(&p->pending_events, &pev))
+        return -1;
+    p->glGenQueries(p->gl, 2, &queries[ev->query_id]);
+    return 0;
+}
+
+static void flush_batch(struct profiler *p, struct event_batch *batch, int wait)
+{
+    const GLuint *queries = ngli_darray_data(&batch->queries);
+    const struct profiler_event *events = ngli_darray_data(&batch->events);
+    const int nb_events = ngli_darray_count(&batch->events);
+
+    p->gpu_origin = -1;
+
+    for (int i = 0; i < nb_events; i++) {
+        const struct profiler_event *ev = &events[i];
+        struct profiler_stats *stats = ev->stats;
+        const int64_t cpu_dur = ev->cpu_end - ev->cpu_start;
+
+        stats->count[ev->type]++;
+        stats->cpu_times[ev->type] += cpu_dur;
+        print_event(p, stats->label, event_names[ev->type], 0, ev->cpu_start, cpu_dur);
+
+        if (ev->query_id < 0)
+            continue;
+
+        /* The GPU may lag behind: the events not completed yet are resolved
+         * at a later flush instead of stalling the pipeline */
+        GLuint64 gpu_start = 0, gpu_end = 0;
+        if (get_gpu_times(p, &queries[ev->query_id], wait, &gpu_start, &gpu_end) ||
+            (defer_event(p, batch, ev) < 0 && get_gpu_times(p, &queries[ev->query_id], 1, &gpu_start, &gpu_end)))
+            print_gpu_event(p, stats, ev->cpu_start, gpu_start, gpu_end);
+    }
+
+    if (p->timer_queries)
+        flush_pending_events(p, wait);
+
+    const int len = ngli_bstr_len(p->buf);
+    if (len)
+        write_trace(p, ngli_bstr_strptr(p->buf), len);
+    ngli_bstr_clear(p->buf);
+
+    batch->events.count = 0;
+    batch->nb_queries_used = 0;
+}
+
+static void flush_all(struct profiler *p)
+{
+    const int nb_batches = NGLI_ARRAY_NB(p->batches);
+    for (int i = 1; i <= nb_batches; i++)
+        flush_batch(p, &p->batches[(p->cur_batch + i) % nb_batches], 1);
+}
+
+int ngli_profiler_set_glcontext(struct profiler *p, struct glcontext *gl)
+{
+    flush_all(p);
+
+    for (int i = 0; i < NGLI_ARRAY_NB(p->batches); i++) {
+        struct darray *queries = &p->batches[i].queries;
+        if (p->gl && ngli_darray_count(queries))
+            p->glDeleteQueries(p->gl, ngli_darray_count(queries), ngli_darray_data(queries));
+        queries->count = 0;
+    }
+
+    p->gl = gl;
+    p->timer_queries = 0;
+    if (!gl)
+        return 0;
+
+    if (gl->features & NGLI_FEATURE_TIMER_QUERY) {
+        p->glGenQueries          = ngli_glGenQueries;
+        p->glDeleteQueries       = ngli_glDeleteQueries;
+        p->glQueryCounter        = ngli_glQueryCounter;
+        p->glGetQueryObjectui64v = ngli_glGetQueryObjectui64v;
+        p->timer_queries         = 1;
+    } else if (gl->features & NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY) {
+        p->glGenQueries          = ngli_glGenQueriesEXT;
+        p->glDeleteQueries       = ngli_glDeleteQueriesEXT;
+        p->glQueryCounter        = ngli_glQueryCounterEXT;
+        p->glGetQueryObjectui64v = ngli_glGetQueryObjectui64vEXT;
+        p->timer_queries         = 1;
+    } else {
+        LOG(WARNING, "GPU timings will not be available in the profiling trace");
+    }
+
+    return 0;
+}
+
+static struct profiler_stats *get_stats(struct profiler *p, const char *label)
+{
+    struct profiler_stats *stats = ngli_hmap_get(p->stats, label);
+    if (stats)
+        return stats;
+
+    stats = ngli_calloc(1, sizeof(*stats));
+    if (!stats)
+        return NULL;
+    stats->label = ngli_strdup(label);
+    if (!stats->label || ngli_hmap_set(p->stats, label, stats) < 0) {
+        free_stats(NULL, stats);
+        return NULL;
+    }
+    return stats;
+}
+
+static int get_queries(struct profiler *p, struct event_batch *batch)
+{
+    struct darray *queries = &batch->queries;
+    while (ngli_darray_count(queries) < batch->nb_queries_used + 2) {
+        GLuint query = 0;
+        p->glGenQueries(p->gl, 1, &query);
+        if (!ngli_darray_push(queries, &query))
+            return -1;
+    }
+    const int query_id = batch->nb_queries_used;
+    batch->nb_queries_used += 2;
+    return query_id;
+}
+
+static int has_gpu_work(const struct ngl_node *node, enum profiler_event_type type)
+{
+    if (type != PROFILER_EVENT_DRAW)
+        return 0;
+    const int id = node->class->id;
+    return id == NGL_NODE_RENDER || id == NGL_NODE_COMPUTE || id == NGL_NODE_RENDERTOTEXTURE;
+}
+
+int ngli_profiler_begin(struct profiler *p, const struct ngl_node *node,
+                        enum profiler_event_type type)
+{
+    struct event_batch *batch = &p->batches[p->cur_batch];
+
+    struct profiler_event ev = {
+        .stats    = get_stats(p, node->label),
+        .type     = type,
+        .query_id = -1,
+    };
+    if (!ev.stats)
+        return -1;
+
+    if (p->timer_queries && has_gpu_work(node, type)) {
+        ev.query_id = get_queries(p, batch);
+        if (ev.query_id < 0)
+            return -1;
+        const GLuint *queries = ngli_darray_data(&batch->queries);
+        p->glQueryCounter(p->gl, queries[ev.query_id], GL_TIMESTAMP);
+    }
+
+    ev.cpu_start = ngli_gettime();
+    if (!ngli_darray_push(&batch->events, &ev))
+        return -1;
+    return ngli_darray_count(&batch->events) - 1;
+}
+
+void ngli_profiler_end(struct profiler *p, int event_id)
+{
+    if (event_id < 0)
+        return;
+
+    struct event_batch *batch = &p->batches[p->cur_batch];
+    struct profiler_event *ev = ngli_darray_get(&batch->events, event_id);
+    ev->cpu_end = ngli_gettime();
+
+    if (ev->query_id >= 0) {
+        const GLuint *queries = ngli_darray_data(&batch->queries);
+        p->glQueryCounter(p->gl, queries[ev->query_id + 1], GL_TIMESTAMP);
+    }
+}
+
+void ngli_profiler_frame_end(struct profiler *p)
+{
+    p->cur_batch = (p->cur_batch + 1) % NGLI_ARRAY_NB(p->batches);
+    flush_batch(p, &p->batches[p->cur_batch], 0);
+}
+
+static int cmp_stats(const void *a, const void *b)
+{
+    const struct profiler_stats *s0 = *(const struct profiler_stats **)a;
+    const struct profiler_stats *s1 = *(const struct profiler_stats **)b;
+    int64_t t0 = 0, t1 = 0;
+    for (int i = 0; i < NB_PROFILER_EVENTS; i++) {
+        t0 += s0->cpu_times[i];
+        t1 += s1->cpu_times[i];
+    }
+    return t0 < t1 ? 1 : t0 > t1 ? -1 : 0;
+}
+
+#define MAX_SUMMARY_ENTRIES 20
+
+static void log_summary(struct profiler *p)
+{
+    const int nb_stats = ngli_hmap_count(p->stats);
+    if (!nb_stats)
+        return;
+
+    const struct profiler_stats **stats = ngli_calloc(nb_stats, sizeof(*stats));
+    if (!stats)
+        return;
+
+    int n = 0;
+    const struct hmap_entry *entry = NULL;
+    while ((entry = ngli_hmap_next(p->stats, entry)))
+        stats[n++] = entry->data;
+    qsort(stats, nb_stats, sizeof(*stats), cmp_stats);
+
+    LOG(INFO, "%-24s %12s %12s %12s %12s %12s %12s",
+        "label (usec)", "init", "prefetch", "update", "draw", "release", "gpu draw");
+    for (int i = 0; i < NGLI_MIN(nb_stats, MAX_SUMMARY_ENTRIES); i++) {
+        const struct profiler_stats *s = stats[i];
+        LOG(INFO, "%-24.24s %12" PRId64 " %12" PRId64 " %12" PRId64 " %12" PRId64 " %12" PRId64 " %12" PRId64,
+            s->label,
+            s->cpu_times[PROFILER_EVENT_INIT],
+            s->cpu_times[PROFILER_EVENT_PREFETCH],
+            s->cpu_times[PROFILER_EVENT_UPDATE],
+            s->cpu_times[PROFILER_EVENT_DRAW],
+            s->cpu_times[PROFILER_EVENT_RELEASE],
+            s->gpu_time / 1000);
+    }
+    if (nb_stats > MAX_SUMMARY_ENTRIES)
+        LOG(INFO, "(%d more labels in the trace)", nb_stats - MAX_SUMMARY_ENTRIES);
+
+    ngli_free(stats);
+}
+
+void ngli_profiler_freep(struct profiler **pp)
+{
+    struct profiler *p = *pp;
+    if (!p)
+        return;
+
+    if (p->buf && p->stats) {
+        ngli_profiler_set_glcontext(p, NULL);
+        log_summary(p);
+        static const char footer[] = "\n]}\n";
+        write_trace(p, footer, sizeof(footer) - 1);
+    }
+    close(p->fd);
+
+    for (int i = 0; i < NGLI_ARRAY_NB(p->batches); i++) {
+        ngli_darray_reset(&p->batches[i].events);
+        ngli_darray_reset(&p->batches[i].queries);
+    }
+    ngli_darray_reset(&p->pending_events);
+    ngli_bstr_freep(&p->buf);
+    ngli_hmap_freep(&p->stats);
+    ngli_free(p);
+    *pp = NULL;
+}
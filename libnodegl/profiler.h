@@ -0,0 +1,67 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "glcontext.h"
+
+struct ngl_node;
+
+enum profiler_event_type {
+    PROFILER_EVENT_INIT,
+    PROFILER_EVENT_PREFETCH,
+    PROFILER_EVENT_UPDATE,
+    PROFILER_EVENT_DRAW,
+    PROFILER_EVENT_RELEASE,
+    NB_PROFILER_EVENTS
+};
+
+struct profiler;
+
+/*
+ * Create a profiler writing a Chrome trace_event JSON file (which can be
+ * loaded in chrome://tracing) to the specified filename. A summary of the
+ * timings aggregated per node label is logged when the profiler is destroyed.
+ */
+struct profiler *ngli_profiler_create(const char *filename);
+
+/*
+ * Set the GL context used for the GPU timestamp queries. All the pending
+ * events are flushed before switching context; gl can be NULL to release the
+ * GL resources before the current context is destroyed.
+ */
+int ngli_profiler_set_glcontext(struct profiler *p, struct glcontext *gl);
+
+int ngli_profiler_begin(struct profiler *p, const struct ngl_node *node,
+                        enum profiler_event_type type);
+void ngli_profiler_end(struct profiler *p, int event_id);
+
+/*
+ * Mark the end of a frame: the events of the previous frame are written to
+ * the trace, which leaves one frame to the GPU to make the timestamps
+ * available.
+ */
+void ngli_profiler_frame_end(struct profiler *p);
+
+void ngli_profiler_freep(struct profiler **pp);
+
+#endif
@@ -27,45 +27,98 @@
 #include "memory.h"
 #include "nodes.h"
 #include "program.h"
+#include "programcache.h"
 
-GLuint ngli_program_load(struct glcontext *gl, const char *vertex, const char *fragment)
+void ngli_program_build_submit(struct glcontext *gl, struct program_build *build,
+                                const char *vertex, const char *fragment, const char *compute)
 {
-    GLuint program = ngli_glCreateProgram(gl);
-    GLuint vertex_shader = ngli_glCreateShader(gl, GL_VERTEX_SHADER);
-    GLuint fragment_shader = ngli_glCreateShader(gl, GL_FRAGMENT_SHADER);
+    memset(build, 0, sizeof(*build));
+
+    static const GLenum graphics_types[] = {GL_VERTEX_SHADER, GL_FRAGMENT_SHADER};
+    static const GLenum compute_types[]  = {GL_COMPUTE_SHADER};
+    const GLenum *types = compute ? compute_types : graphics_types;
+    build->nb_shaders = compute ? 1 : 2;
+    build->sources[0] = compute ? compute : vertex;
+    build->sources[1] = compute ? NULL : fragment;
+
+    struct programcache *cache = gl->programcache;
+    if (cache) {
+        build->program = ngli_programcache_load(cache, build->sources, build->nb_shaders);
+        if (build->program) {
+            build->cached = 1;
+            return;
+        }
+    }
 
-    ngli_glShaderSource(gl, vertex_shader, 1, &vertex, NULL);
-    ngli_glCompileShader(gl, vertex_shader);
-    if (ngli_program_check_status(gl, vertex_shader, GL_COMPILE_STATUS) < 0)
-        goto fail;
+    build->program = ngli_glCreateProgram(gl);
+    if (cache)
+        ngli_glProgramParameteri(gl, build->program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+    /* The compilation and link statuses are only checked when the program is
+     * needed, which gives the driver a chance to process the build in the
+     * background meanwhile */
+    for (int i = 0; i < build->nb_shaders; i++) {
+        build->shaders[i] = ngli_glCreateShader(gl, types[i]);
+        ngli_glShaderSource(gl, build->shaders[i], 1, &build->sources[i], NULL);
+        ngli_glCompileShader(gl, build->shaders[i]);
+        ngli_glAttachShader(gl, build->program, build->shaders[i]);
+    }
+    ngli_glLinkProgram(gl, build->program);
+}
 
-    ngli_glShaderSource(gl, fragment_shader, 1, &fragment, NULL);
-    ngli_glCompileShader(gl, fragment_shader);
-    if (ngli_program_check_status(gl, fragment_shader, GL_COMPILE_STATUS) < 0)
-        goto fail;
+GLuint ngli_program_build_finish(struct glcontext *gl, struct program_build *build)
+{
+    if (build->cached) {
+        GLuint program = build->program;
+        memset(build, 0, sizeof(*build));
+        return program;
+    }
 
-    ngli_glAttachShader(gl, program, vertex_shader);
-    ngli_glAttachShader(gl, program, fragment_shader);
-    ngli_glLinkProgram(gl, program);
-    if (ngli_program_check_status(gl, program, GL_LINK_STATUS) < 0)
+    for (int i = 0; i < build->nb_shaders; i++)
+        if (ngli_program_check_status(gl, build->shaders[i], GL_COMPILE_STATUS) < 0)
+            goto fail;
+
+    if (ngli_program_check_status(gl, build->program, GL_LINK_STATUS) < 0)
         goto fail;
 
-    ngli_glDeleteShader(gl, vertex_shader);
-    ngli_glDeleteShader(gl, fragment_shader);
+    struct programcache *cache = gl->programcache;
+    if (cache)
+        ngli_programcache_store(cache, build->sources, build->nb_shaders, build->program);
 
+    GLuint program = build->program;
+    build->program = 0;
+    ngli_program_build_reset(gl, build);
     return program;
 
 fail:
-    if (vertex_shader)
-        ngli_glDeleteShader(gl, vertex_shader);
-    if (fragment_shader)
-        ngli_glDeleteShader(gl, fragment_shader);
-    if (program)
-        ngli_glDeleteProgram(gl, program);
-
+    ngli_program_build_reset(gl, build);
     return 0;
 }
 
+void ngli_program_build_reset(struct glcontext *gl, struct program_build *build)
+{
+    for (int i = 0; i < build->nb_shaders; i++)
+        if (build->shaders[i])
+            ngli_glDeleteShader(gl, build->shaders[i]);
+    if (build->program)
+        ngli_glstate_delete_program(gl, build->program);
+    memset(build, 0, sizeof(*build));
+}
+
+GLuint ngli_program_load(struct glcontext *gl, const char *vertex, const char *fragment)
+{
+    struct program_build build;
+    ngli_program_build_submit(gl, &build, vertex, fragment, NULL);
+    return ngli_program_build_finish(gl, &build);
+}
+
+GLuint ngli_program_load_compute(struct glcontext *gl, const char *compute)
+{
+    struct program_build build;
+    ngli_program_build_submit(gl, &build, NULL, NULL, compute);
+    return ngli_program_build_finish(gl, &build);
+}
+
 int ngli_program_check_status(const struct glcontext *gl, GLuint id, GLenum status)
 {
     char *info_log = NULL;
@@ -25,7 +25,28 @@
 #include "hmap.h"
 #include "glcontext.h"
 
+/*
+ * Program build in two steps: ngli_program_build_submit() only submits the
+ * compilation and link of the shaders, which the driver may process in the
+ * background (typically with GL_KHR_parallel_shader_compile), and
+ * ngli_program_build_finish() waits for the result, returning the program or
+ * 0 on error. ngli_program_build_reset() cancels a submitted build.
+ */
+struct program_build {
+    GLuint program;
+    GLuint shaders[2];
+    const char *sources[2];
+    int nb_shaders;
+    int cached;             // program loaded from the program binaries cache
+};
+
+void ngli_program_build_submit(struct glcontext *gl, struct program_build *build,
+                                const char *vertex, const char *fragment, const char *compute);
+GLuint ngli_program_build_finish(struct glcontext *gl, struct program_build *build);
+void ngli_program_build_reset(struct glcontext *gl, struct program_build *build);
+
 GLuint ngli_program_load(struct glcontext *gl, const char *vertex, const char *fragment);
+GLuint ngli_program_load_compute(struct glcontext *gl, const char *compute);
 int ngli_program_check_status(const struct glcontext *gl, GLuint id, GLenum status);
 struct hmap *ngli_program_probe_uniforms(const char *node_label, struct glcontext *gl, GLuint pid);
 struct hmap *ngli_program_probe_attributes(const char *node_label, struct glcontext *gl, GLuint pid);
@@ -0,0 +1,298 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef TARGET_MINGW_W64
+#define _POSIX_C_SOURCE 200809L // mkstemp(), fdopen()
+#endif
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef TARGET_MINGW_W64
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include "bstr.h"
+#include "glcontext.h"
+#include "log.h"
+#include "memory.h"
+#include "programcache.h"
+#include "utils.h"
+
+#define PROGRAMCACHE_MAGIC   "NGLP"
+#define PROGRAMCACHE_VERSION 2
+
+/*
+ * An entry is the header, followed by the sources the program was linked
+ * from, and the program binary. The sources are compared on load so a hash
+ * collision on the key can never feed the driver with the wrong binary.
+ */
+struct entry_header {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t sources_size;
+    uint32_t binary_format;
+    uint32_t binary_size;
+};
+
+static uint64_t get_context_hash(struct glcontext *gl)
+{
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return 0;
+
+    ngli_bstr_print(b, "%s\n%s\n%s\n%s\nbackend=%d version=%d features=0x%x",
+                    (const char *)ngli_glGetString(gl, GL_VENDOR),
+                    (const char *)ngli_glGetString(gl, GL_RENDERER),
+                    (const char *)ngli_glGetString(gl, GL_VERSION),
+                    (const char *)ngli_glGetString(gl, GL_SHADING_LANGUAGE_VERSION),
+                    gl->backend, gl->version, gl->features);
+    const uint64_t hash = ngli_hash64(ngli_bstr_strptr(b), ngli_bstr_len(b));
+    ngli_bstr_freep(&b);
+    return hash;
+}
+
+struct programcache *ngli_programcache_create(struct glcontext *gl, const char *path)
+{
+    struct programcache *cache = ngli_calloc(1, sizeof(*cache));
+    if (!cache)
+        return NULL;
+
+    cache->gl = gl;
+    cache->path = ngli_strdup(path);
+    if (!cache->path) {
+        ngli_free(cache);
+        return NULL;
+    }
+    cache->context_hash = get_context_hash(gl);
+
+    LOG(INFO, "program binaries cached in %s", path);
+    return cache;
+}
+
+static uint64_t get_key(const struct programcache *cache, const char **sources, int nb_sources)
+{
+    uint64_t key = cache->context_hash ^ nb_sources;
+    for (int i = 0; i < nb_sources; i++)
+        key = key * 0x9e3779b97f4a7c15 ^ ngli_hash64(sources[i], strlen(sources[i]));
+    return key;
+}
+
+/* Concatenation of the sources, each prefixed by its length */
+static struct bstr *get_sources(const char **sources, int nb_sources)
+{
+    struct bstr *b = ngli_bstr_create();
+    if (!b)
+        return NULL;
+    for (int i = 0; i < nb_sources; i++)
+        ngli_bstr_print(b, "%zu:%s", strlen(sources[i]), sources[i]);
+    return b;
+}
+
+static char *get_entry_filename(const struct programcache *cache, uint64_t key)
+{
+    return ngli_asprintf("%s/%016" PRIx64 ".bin", cache->path, key);
+}
+
+static void *read_entry(const char *filename, uint64_t key, struct bstr *sources,
+                        struct entry_header *hdr)
+{
+    FILE *fp = fopen(filename, "rb");
+    if (!fp)
+        return NULL;
+
+    void *binary = NULL;
+    char *entry_sources = NULL;
+    const int sources_size = ngli_bstr_len(sources);
+    if (fread(hdr, sizeof(*hdr), 1, fp) != 1 ||
+        memcmp(hdr->magic, PROGRAMCACHE_MAGIC, sizeof(hdr->magic)) ||
+        hdr->version != PROGRAMCACHE_VERSION || hdr->key != key ||
+        hdr->sources_size != sources_size || !hdr->binary_size)
+        goto end;
+
+    entry_sources = ngli_malloc(sources_size);
+    if (!entry_sources)
+        goto end;
+    if (fread(entry_sources, sources_size, 1, fp) != 1 ||
+        memcmp(entry_sources, ngli_bstr_strptr(sources), sources_size)) {
+        LOG(DEBUG, "program cache entry %s does not match the sources", filename);
+        goto end;
+    }
+
+    binary = ngli_malloc(hdr->binary_size);
+    if (!binary)
+        goto end;
+
+    if (fread(binary, hdr->binary_size, 1, fp) != 1) {
+        ngli_free(binary);
+        binary = NULL;
+    }
+
+end:
+    ngli_free(entry_sources);
+    fclose(fp);
+    return binary;
+}
+
+static GLuint load_entry(struct programcache *cache, uint64_t key, struct bstr *sources)
+{
+    struct glcontext *gl = cache->gl;
+
+    char *filename = get_entry_filename(cache, key);
+    if (!filename)
+        return 0;
+
+    struct entry_header hdr;
+    void *binary = read_entry(filename, key, sources, &hdr);
+    ngli_free(filename);
+    if (!binary)
+        return 0;
+
+    GLuint program = ngli_glCreateProgram(gl);
+    ngli_glProgramBinary(gl, program, hdr.binary_format, binary, hdr.binary_size);
+    ngli_free(binary);
+
+    /* The binary may be rejected, typically after a driver update which did
+     * not change the version strings */
+    GLint status = GL_FALSE;
+    ngli_glGetProgramiv(gl, program, GL_LINK_STATUS, &status);
+    if (status != GL_TRUE) {
+        LOG(DEBUG, "program binary %016" PRIx64 " rejected by the driver", key);
+        ngli_glstate_delete_program(gl, program);
+        return 0;
+    }
+
+    return program;
+}
+
+GLuint ngli_programcache_load(struct programcache *cache, const char **sources, int nb_sources)
+{
+    struct bstr *b = get_sources(sources, nb_sources);
+    if (!b)
+        return 0;
+    const uint64_t key = get_key(cache, sources, nb_sources);
+    GLuint program = load_entry(cache, key, b);
+    ngli_bstr_freep(&b);
+    if (program)
+        cache->nb_hits++;
+    else
+        cache->nb_misses++;
+    return program;
+}
+
+/*
+ * Create a temporary file with a unique name in the cache directory, so that
+ * concurrent writers of the same entry never write to the same file
+ */
+static FILE *create_tmp_file(const struct programcache *cache, uint64_t key, char **filenamep)
+{
+#ifndef TARGET_MINGW_W64
+    char *filename = ngli_asprintf("%s/%016" PRIx64 ".XXXXXX", cache->path, key);
+    if (!filename)
+        return NULL;
+    const int fd = mkstemp(filename);
+    FILE *fp = fd >= 0 ? fdopen(fd, "wb") : NULL;
+    if (!fp && fd >= 0) {
+        close(fd);
+        remove(filename);
+    }
+#else
+    char *filename = ngli_asprintf("%s/%016" PRIx64 ".%d.tmp", cache->path, key, _getpid());
+    if (!filename)
+        return NULL;
+    FILE *fp = fopen(filename, "wb");
+#endif
+    if (!fp) {
+        LOG(WARNING, "could not create program cache entry %s", filename);
+        ngli_free(filename);
+        return NULL;
+    }
+    *filenamep = filename;
+    return fp;
+}
+
+void ngli_programcache_store(struct programcache *cache, const char **sources, int nb_sources, GLuint program)
+{
+    struct glcontext *gl = cache->gl;
+
+    GLint size = 0;
+    ngli_glGetProgramiv(gl, program, GL_PROGRAM_BINARY_LENGTH, &size);
+    if (size <= 0)
+        return;
+
+    char *filename = NULL;
+    char *tmp_filename = NULL;
+    struct bstr *b = get_sources(sources, nb_sources);
+    void *binary = ngli_malloc(size);
+    if (!b || !binary)
+        goto end;
+
+    struct entry_header hdr = {
+        .magic        = PROGRAMCACHE_MAGIC,
+        .version      = PROGRAMCACHE_VERSION,
+        .key          = get_key(cache, sources, nb_sources),
+        .sources_size = ngli_bstr_len(b),
+    };
+    GLenum binary_format = 0;
+    GLsizei binary_size = 0;
+    ngli_glGetProgramBinary(gl, program, size, &binary_size, &binary_format, binary);
+    hdr.binary_format = binary_format;
+    hdr.binary_size = binary_size;
+
+    filename = get_entry_filename(cache, hdr.key);
+    if (!filename || !binary_size)
+        goto end;
+
+    /* The entry is written in a temporary file first so that concurrent
+     * readers never see a partial entry */
+    FILE *fp = create_tmp_file(cache, hdr.key, &tmp_filename);
+    if (!fp)
+        goto end;
+    const int written = fwrite(&hdr, sizeof(hdr), 1, fp) == 1 &&
+                        fwrite(ngli_bstr_strptr(b), hdr.sources_size, 1, fp) == 1 &&
+                        fwrite(binary, binary_size, 1, fp) == 1;
+    if (fclose(fp) || !written || rename(tmp_filename, filename)) {
+        LOG(WARNING, "could not write program cache entry %s", filename);
+        remove(tmp_filename);
+    }
+
+end:
+    ngli_free(tmp_filename);
+    ngli_free(filename);
+    ngli_free(binary);
+    ngli_bstr_freep(&b);
+}
+
+void ngli_programcache_freep(struct programcache **cachep)
+{
+    struct programcache *cache = *cachep;
+    if (!cache)
+        return;
+    LOG(DEBUG, "program cache: %d hits, %d misses", cache->nb_hits, cache->nb_misses);
+    ngli_free(cache->path);
+    ngli_free(cache);
+    *cachep = NULL;
+}
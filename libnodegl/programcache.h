@@ -0,0 +1,63 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef PROGRAMCACHE_H
+#define PROGRAMCACHE_H
+
+#include <stdint.h>
+
+#include "glincludes.h"
+
+struct glcontext;
+
+/*
+ * On-disk cache of the linked program binaries (NGL_PROGRAM_CACHE_DIR
+ * environment variable). The entries are keyed by a hash of the shader
+ * sources and of the GL implementation (vendor, renderer, versions), so a
+ * driver update naturally invalidates them. A binary rejected by the driver
+ * is considered a miss: the program is compiled again and the entry
+ * replaced.
+ */
+struct programcache {
+    struct glcontext *gl;
+    char *path;
+    uint64_t context_hash;
+    int nb_hits;
+    int nb_misses;
+};
+
+struct programcache *ngli_programcache_create(struct glcontext *gl, const char *path);
+
+/*
+ * Return a program created from the cached binary matching the sources, or 0
+ * if there is none (or if the driver rejects it).
+ */
+GLuint ngli_programcache_load(struct programcache *cache, const char **sources, int nb_sources);
+
+/*
+ * Store the binary of a program freshly linked from the sources. The program
+ * must have been created with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+ */
+void ngli_programcache_store(struct programcache *cache, const char **sources, int nb_sources, GLuint program);
+
+void ngli_programcache_freep(struct programcache **cachep);
+
+#endif
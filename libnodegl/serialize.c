@@ -28,6 +28,7 @@
 #include "memory.h"
 #include "nodes.h"
 #include "nodegl.h"
+#include "serialize_binary.h"
 #include "utils.h"
 
 extern const struct node_param ngli_base_node_params[];
@@ -278,22 +279,17 @@ static void serialize_options(struct hmap *nlist,
     }
 }
 
-static int serialize(struct hmap *nlist,
-                     struct bstr *b,
-                     const struct ngl_node *node);
+typedef int (*serialize_func_type)(void *arg, const struct ngl_node *node);
 
-static int serialize_children(struct hmap *nlist,
-                               struct bstr *b,
-                               const struct ngl_node *node,
-                               uint8_t *priv,
-                               const struct node_param *p)
+static int serialize_children(serialize_func_type serialize_func, void *arg,
+                              uint8_t *priv, const struct node_param *p)
 {
     while (p && p->key) {
         switch (p->type) {
             case PARAM_TYPE_NODE: {
                 const struct ngl_node *child = *(struct ngl_node **)(priv + p->offset);
                 if (child) {
-                    int ret = serialize(nlist, b, child);
+                    int ret = serialize_func(arg, child);
                     if (ret < 0)
                         return ret;
                 }
@@ -304,7 +300,7 @@ static int serialize_children(struct hmap *nlist,
                 const int nb_children = *(int *)(priv + p->offset + sizeof(struct ngl_node **));
 
                 for (int i = 0; i < nb_children; i++) {
-                    int ret = serialize(nlist, b, children[i]);
+                    int ret = serialize_func(arg, children[i]);
                     if (ret < 0)
                         return ret;
                 }
@@ -316,7 +312,7 @@ static int serialize_children(struct hmap *nlist,
                     break;
                 const struct hmap_entry *entry = NULL;
                 while ((entry = ngli_hmap_next(hmap, entry))) {
-                    int ret = serialize(nlist, b, entry->data);
+                    int ret = serialize_func(arg, entry->data);
                     if (ret < 0)
                         return ret;
                 }
@@ -328,17 +324,32 @@ static int serialize_children(struct hmap *nlist,
     return 0;
 }
 
-static int serialize(struct hmap *nlist,
-                     struct bstr *b,
-                     const struct ngl_node *node)
+static int serialize_all_children(serialize_func_type serialize_func, void *arg,
+                                  const struct ngl_node *node)
 {
+    int ret;
+    if ((ret = serialize_children(serialize_func, arg, (uint8_t *)node, ngli_base_node_params)) < 0 ||
+        (ret = serialize_children(serialize_func, arg, node->priv_data, node->class->params)) < 0)
+        return ret;
+    return 0;
+}
+
+struct text_serializer {
+    struct hmap *nlist;
+    struct bstr *b;
+};
+
+static int serialize(void *arg, const struct ngl_node *node)
+{
+    struct text_serializer *s = arg;
+    struct hmap *nlist = s->nlist;
+    struct bstr *b = s->b;
+
     if (get_node_id(nlist, node))
         return 0;
 
-    int ret;
-
-    if ((ret = serialize_children(nlist, b, node, (uint8_t *)node, ngli_base_node_params)) < 0 ||
-        (ret = serialize_children(nlist, b, node, node->priv_data, node->class->params)) < 0)
+    int ret = serialize_all_children(serialize, s, node);
+    if (ret < 0)
         return ret;
 
     const uint32_t tag = node->class->id;
@@ -365,7 +376,8 @@ char *ngl_node_serialize(const struct ngl_node *node)
     ngli_hmap_set_free(nlist, free_func, NULL);
     ngli_bstr_print(b, "# Node.GL v%d.%d.%d\n",
                     NODEGL_VERSION_MAJOR, NODEGL_VERSION_MINOR, NODEGL_VERSION_MICRO);
-    if (serialize(nlist, b, node) < 0)
+    struct text_serializer serializer = {.nlist = nlist, .b = b};
+    if (serialize(&serializer, node) < 0)
         goto end;
     s = ngli_bstr_strdup(b);
 
@@ -374,3 +386,323 @@ end:
     ngli_bstr_freep(&b);
     return s;
 }
+
+struct bytes {
+    uint8_t *data;
+    size_t size;
+    size_t cap;
+};
+
+static int64_t bytes_append(struct bytes *b, const void *data, size_t size, size_t align)
+{
+    const size_t offset = NGLI_ALIGN(b->size, align);
+    const size_t new_size = offset + size;
+    if (new_size > b->cap) {
+        size_t cap = b->cap ? b->cap * 2 : 4096;
+        while (cap < new_size)
+            cap *= 2;
+        uint8_t *new_data = ngli_realloc(b->data, cap);
+        if (!new_data)
+            return -1;
+        b->data = new_data;
+        b->cap = cap;
+    }
+    memset(b->data + b->size, 0, offset - b->size);
+    memcpy(b->data + offset, data, size);
+    b->size = new_size;
+    return offset;
+}
+
+struct binary_serializer {
+    struct hmap *nlist;     /* node address -> node index + 1 */
+    struct hmap *strings;   /* string -> string offset + 1 */
+    struct darray nodes;
+    struct darray params;
+    struct bytes strtab;
+    struct bytes blobs;
+};
+
+static uint32_t get_node_index(const struct hmap *nlist, const struct ngl_node *node)
+{
+    char key[32];
+    (void)snprintf(key, sizeof(key), "%p", node);
+    return (uint32_t)((uintptr_t)ngli_hmap_get(nlist, key) - 1);
+}
+
+static int64_t add_string(struct binary_serializer *s, const char *str)
+{
+    const uintptr_t id = (uintptr_t)ngli_hmap_get(s->strings, str);
+    if (id)
+        return id - 1;
+    const int64_t offset = bytes_append(&s->strtab, str, strlen(str) + 1, 1);
+    if (offset < 0)
+        return offset;
+    int ret = ngli_hmap_set(s->strings, str, (void *)(uintptr_t)(offset + 1));
+    if (ret < 0)
+        return ret;
+    return offset;
+}
+
+static int add_param(struct binary_serializer *s, const struct node_param *p,
+                     uint32_t count, uint64_t value)
+{
+    const int64_t key = add_string(s, p->key);
+    if (key < 0)
+        return key;
+    const struct nglb_param param = {
+        .key   = key,
+        .type  = p->type,
+        .count = count,
+        .value = value,
+    };
+    return ngli_darray_push(&s->params, &param) ? 0 : -1;
+}
+
+static int add_param_str(struct binary_serializer *s, const struct node_param *p,
+                         const char *str)
+{
+    const int64_t offset = add_string(s, str);
+    if (offset < 0)
+        return offset;
+    return add_param(s, p, 0, offset);
+}
+
+static int add_param_blob(struct binary_serializer *s, const struct node_param *p,
+                          const void *data, size_t size, uint32_t count)
+{
+    const int64_t offset = bytes_append(&s->blobs, data, size, NGLI_ALIGN_VAL);
+    if (offset < 0)
+        return offset;
+    return add_param(s, p, count, offset);
+}
+
+static int serialize_binary_options(struct binary_serializer *s,
+                                    const struct ngl_node *node,
+                                    uint8_t *priv,
+                                    const struct node_param *p)
+{
+    while (p && p->key) {
+        const int constructor = p->flags & PARAM_FLAG_CONSTRUCTOR;
+        int ret = 0;
+        switch (p->type) {
+            case PARAM_TYPE_SELECT: {
+                const int v = *(int *)(priv + p->offset);
+                if (!constructor && v == p->def_value.i64)
+                    break;
+                const char *str = ngli_params_get_select_str(p->choices->consts, v);
+                ngli_assert(str);
+                ret = add_param_str(s, p, str);
+                break;
+            }
+            case PARAM_TYPE_FLAGS: {
+                const int v = *(int *)(priv + p->offset);
+                if (!constructor && v == p->def_value.i64)
+                    break;
+                char *str = ngli_params_get_flags_str(p->choices->consts, v);
+                if (!str)
+                    return -1;
+                ret = add_param_str(s, p, str);
+                ngli_free(str);
+                break;
+            }
+            case PARAM_TYPE_BOOL:
+            case PARAM_TYPE_INT: {
+                const int v = *(int *)(priv + p->offset);
+                if (constructor || v != p->def_value.i64)
+                    ret = add_param(s, p, 0, (int64_t)v);
+                break;
+            }
+            case PARAM_TYPE_I64: {
+                const int64_t v = *(int64_t *)(priv + p->offset);
+                if (constructor || v != p->def_value.i64)
+                    ret = add_param(s, p, 0, v);
+                break;
+            }
+            case PARAM_TYPE_DBL: {
+                const double v = *(double *)(priv + p->offset);
+                if (constructor || v != p->def_value.dbl) {
+                    uint64_t bits;
+                    memcpy(&bits, &v, sizeof(bits));
+                    ret = add_param(s, p, 0, bits);
+                }
+                break;
+            }
+            case PARAM_TYPE_RATIONAL: {
+                const int *r = (int *)(priv + p->offset);
+                if (constructor || memcmp(r, p->def_value.r, sizeof(p->def_value.r)))
+                    ret = add_param(s, p, 0, (uint32_t)r[0] | (uint64_t)(uint32_t)r[1] << 32);
+                break;
+            }
+            case PARAM_TYPE_STR: {
+                const char *str = *(char **)(priv + p->offset);
+                if (!str || (p->def_value.str && !strcmp(str, p->def_value.str)))
+                    break;
+                if (!strcmp(p->key, "label") &&
+                    ngli_is_default_label(node->class->name, str))
+                    break;
+                ret = add_param_str(s, p, str);
+                break;
+            }
+            case PARAM_TYPE_DATA: {
+                const uint8_t *data = *(uint8_t **)(priv + p->offset);
+                const int size = *(int *)(priv + p->offset + sizeof(uint8_t *));
+                if (data && size)
+                    ret = add_param_blob(s, p, data, size, size);
+                break;
+            }
+            case PARAM_TYPE_VEC2:
+            case PARAM_TYPE_VEC3:
+            case PARAM_TYPE_VEC4: {
+                const float *v = (float *)(priv + p->offset);
+                const int n = p->type - PARAM_TYPE_VEC2 + 2;
+                if (constructor || memcmp(v, p->def_value.vec, n * sizeof(*v)))
+                    ret = add_param_blob(s, p, v, n * sizeof(*v), n);
+                break;
+            }
+            case PARAM_TYPE_MAT4: {
+                const float *m = (float *)(priv + p->offset);
+                if (constructor || memcmp(m, p->def_value.mat, 16 * sizeof(*m)))
+                    ret = add_param_blob(s, p, m, 16 * sizeof(*m), 16);
+                break;
+            }
+            case PARAM_TYPE_NODE: {
+                const struct ngl_node *child = *(struct ngl_node **)(priv + p->offset);
+                if (child)
+                    ret = add_param(s, p, 0, get_node_index(s->nlist, child));
+                break;
+            }
+            case PARAM_TYPE_NODELIST: {
+                struct ngl_node **nodes = *(struct ngl_node ***)(priv + p->offset);
+                const int nb_nodes = *(int *)(priv + p->offset + sizeof(struct ngl_node **));
+                if (!nb_nodes)
+                    break;
+                uint32_t *ids = ngli_malloc(nb_nodes * sizeof(*ids));
+                if (!ids)
+                    return -1;
+                for (int i = 0; i < nb_nodes; i++)
+                    ids[i] = get_node_index(s->nlist, nodes[i]);
+                ret = add_param_blob(s, p, ids, nb_nodes * sizeof(*ids), nb_nodes);
+                ngli_free(ids);
+                break;
+            }
+            case PARAM_TYPE_DBLLIST: {
+                const double *elems = *(double **)(priv + p->offset);
+                const int nb_elems = *(int *)(priv + p->offset + sizeof(double *));
+                if (nb_elems)
+                    ret = add_param_blob(s, p, elems, nb_elems * sizeof(*elems), nb_elems);
+                break;
+            }
+            case PARAM_TYPE_NODEDICT: {
+                struct hmap *hmap = *(struct hmap **)(priv + p->offset);
+                const int nb_nodes = hmap ? ngli_hmap_count(hmap) : 0;
+                if (!nb_nodes)
+                    break;
+                uint32_t *pairs = ngli_malloc(nb_nodes * 2 * sizeof(*pairs));
+                if (!pairs)
+                    return -1;
+                int i = 0;
+                const struct hmap_entry *entry = NULL;
+                while ((entry = ngli_hmap_next(hmap, entry))) {
+                    const int64_t key = add_string(s, entry->key);
+                    if (key < 0) {
+                        ngli_free(pairs);
+                        return key;
+                    }
+                    pairs[i++] = key;
+                    pairs[i++] = get_node_index(s->nlist, entry->data);
+                }
+                ret = add_param_blob(s, p, pairs, nb_nodes * 2 * sizeof(*pairs), nb_nodes);
+                ngli_free(pairs);
+                break;
+            }
+            default:
+                LOG(ERROR, "cannot serialize %s: unsupported parameter type", p->key);
+        }
+        if (ret < 0)
+            return ret;
+        p++;
+    }
+    return 0;
+}
+
+static int serialize_binary(void *arg, const struct ngl_node *node)
+{
+    struct binary_serializer *s = arg;
+
+    char key[32];
+    (void)snprintf(key, sizeof(key), "%p", node);
+    if (ngli_hmap_get(s->nlist, key))
+        return 0;
+
+    int ret = serialize_all_children(serialize_binary, s, node);
+    if (ret < 0)
+        return ret;
+
+    const int nb_params = ngli_darray_count(&s->params);
+    if ((ret = serialize_binary_options(s, node, node->priv_data, node->class->params)) < 0 ||
+        (ret = serialize_binary_options(s, node, (uint8_t *)node, ngli_base_node_params)) < 0)
+        return ret;
+
+    const struct nglb_node nglb_node = {
+        .type      = node->class->id,
+        .nb_params = ngli_darray_count(&s->params) - nb_params,
+    };
+    const uintptr_t id = ngli_darray_count(&s->nodes) + 1;
+    if (!ngli_darray_push(&s->nodes, &nglb_node))
+        return -1;
+    return ngli_hmap_set(s->nlist, key, (void *)id);
+}
+
+void *ngl_node_serialize_binary(const struct ngl_node *node, size_t *sizep)
+{
+    uint8_t *buf = NULL;
+    struct binary_serializer s = {
+        .nlist   = ngli_hmap_create(),
+        .strings = ngli_hmap_create(),
+    };
+    ngli_darray_init(&s.nodes, sizeof(struct nglb_node), 0);
+    ngli_darray_init(&s.params, sizeof(struct nglb_param), 0);
+    if (!s.nlist || !s.strings)
+        goto end;
+
+    if (serialize_binary(&s, node) < 0)
+        goto end;
+
+    struct nglb_header header = {
+        .magic          = NGLB_MAGIC,
+        .byte_order     = NGLB_BYTE_ORDER,
+        .version        = NGLB_VERSION,
+        .nodegl_version = NODEGL_VERSION_INT,
+        .nb_nodes       = ngli_darray_count(&s.nodes),
+        .nb_params      = ngli_darray_count(&s.params),
+        .strings_size   = s.strtab.size,
+        .blobs_size     = s.blobs.size,
+    };
+    struct nglb_layout layout;
+    ngli_nglb_get_layout(&header, &layout);
+    header.size = layout.size;
+
+    buf = ngli_calloc(1, layout.size);
+    if (!buf)
+        goto end;
+    memcpy(buf, &header, sizeof(header));
+    memcpy(buf + layout.nodes_offset, ngli_darray_data(&s.nodes),
+           header.nb_nodes * sizeof(struct nglb_node));
+    if (header.nb_params)
+        memcpy(buf + layout.params_offset, ngli_darray_data(&s.params),
+               header.nb_params * sizeof(struct nglb_param));
+    if (s.strtab.size)
+        memcpy(buf + layout.strings_offset, s.strtab.data, s.strtab.size);
+    if (s.blobs.size)
+        memcpy(buf + layout.blobs_offset, s.blobs.data, s.blobs.size);
+    *sizep = layout.size;
+
+end:
+    ngli_hmap_freep(&s.nlist);
+    ngli_hmap_freep(&s.strings);
+    ngli_darray_reset(&s.nodes);
+    ngli_darray_reset(&s.params);
+    ngli_free(s.strtab.data);
+    ngli_free(s.blobs.data);
+    return buf;
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef SERIALIZE_BINARY_H
+#define SERIALIZE_BINARY_H
+
+#include <stdint.h>
+
+#include "utils.h"
+
+/*
+ * Binary scene layout (native endianness, every section aligned on
+ * NGLI_ALIGN_VAL):
+ *
+ *   header
+ *   nodes[nb_nodes]    children always come before their parents, the root
+ *                      is the last node
+ *   params[nb_params]  the params of each node, in the node order
+ *   strings            NUL terminated, referenced by offset
+ *   blobs              raw arrays (data, floats, doubles, node indexes),
+ *                      each one aligned on NGLI_ALIGN_VAL
+ *
+ * The blobs are laid out so that a mapped file can be used in place.
+ */
+
+#define NGLB_MAGIC      "NGLB"
+#define NGLB_BYTE_ORDER 0x01020304
+#define NGLB_VERSION    1
+
+struct nglb_header {
+    char magic[4];
+    uint32_t byte_order;
+    uint32_t version;
+    uint32_t nodegl_version;
+    uint32_t nb_nodes;
+    uint32_t nb_params;
+    uint32_t strings_size;
+    uint32_t reserved;
+    uint64_t blobs_size;
+    uint64_t size;
+};
+
+struct nglb_node {
+    uint32_t type;
+    uint32_t nb_params;
+};
+
+/*
+ * The value is interpreted according to the param type:
+ * - bool, int, i64: the integer itself
+ * - dbl: the bits of the double
+ * - rational: numerator in the low 32 bits, denominator in the high ones
+ * - str, select, flags: string offset
+ * - node: node index
+ * - vec*, mat4: blob offset of count floats
+ * - data: blob offset of count bytes
+ * - dbllist: blob offset of count doubles
+ * - nodelist: blob offset of count uint32 node indexes
+ * - nodedict: blob offset of count {string offset, node index} uint32 pairs
+ */
+struct nglb_param {
+    uint32_t key;
+    uint32_t type;
+    uint32_t count;
+    uint32_t reserved;
+    uint64_t value;
+};
+
+struct nglb_layout {
+    uint64_t nodes_offset;
+    uint64_t params_offset;
+    uint64_t strings_offset;
+    uint64_t blobs_offset;
+    uint64_t size;
+};
+
+static inline void ngli_nglb_get_layout(const struct nglb_header *h, struct nglb_layout *l)
+{
+    l->nodes_offset   = NGLI_ALIGN(sizeof(*h), NGLI_ALIGN_VAL);
+    l->params_offset  = NGLI_ALIGN(l->nodes_offset + (uint64_t)h->nb_nodes * sizeof(struct nglb_node), NGLI_ALIGN_VAL);
+    l->strings_offset = NGLI_ALIGN(l->params_offset + (uint64_t)h->nb_params * sizeof(struct nglb_param), NGLI_ALIGN_VAL);
+    l->blobs_offset   = NGLI_ALIGN(l->strings_offset + h->strings_size, NGLI_ALIGN_VAL);
+    l->size           = l->blobs_offset + h->blobs_size;
+}
+
+#endif
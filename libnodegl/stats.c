@@ -0,0 +1,145 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "glcontext.h"
+#include "glincludes.h"
+#include "stats.h"
+
+static void noop(const struct glcontext *gl, ...)
+{
+}
+
+void ngli_stats_init(struct stats *s, struct glcontext *gl)
+{
+    memset(s, 0, sizeof(*s));
+    s->gl = gl;
+    s->last.draw_gpu_time = -1;
+    s->last_uploaded_bytes = gl->uploaded_bytes;
+
+    if (gl->features & NGLI_FEATURE_TIMER_QUERY) {
+        s->glGenQueries          = ngli_glGenQueries;
+        s->glDeleteQueries       = ngli_glDeleteQueries;
+        s->glQueryCounter        = ngli_glQueryCounter;
+        s->glGetQueryObjectui64v = ngli_glGetQueryObjectui64v;
+    } else if (gl->features & NGLI_FEATURE_EXT_DISJOINT_TIMER_QUERY) {
+        s->glGenQueries          = ngli_glGenQueriesEXT;
+        s->glDeleteQueries       = ngli_glDeleteQueriesEXT;
+        s->glQueryCounter        = ngli_glQueryCounterEXT;
+        s->glGetQueryObjectui64v = ngli_glGetQueryObjectui64vEXT;
+    } else {
+        s->glGenQueries          = (void *)noop;
+        s->glDeleteQueries       = (void *)noop;
+        s->glQueryCounter        = (void *)noop;
+        s->glGetQueryObjectui64v = (void *)noop;
+    }
+
+    for (int i = 0; i < NB_STATS_QUERY_FRAMES; i++)
+        s->glGenQueries(gl, 2, s->queries[i]);
+}
+
+void ngli_stats_draw_start(struct stats *s)
+{
+    if (!s->gl)
+        return;
+
+    /* The GPU is too far behind: drop the oldest measure instead of waiting
+     * for it */
+    if (s->nb_pending_queries == NB_STATS_QUERY_FRAMES) {
+        s->query_read_pos = (s->query_read_pos + 1) % NB_STATS_QUERY_FRAMES;
+        s->nb_pending_queries--;
+    }
+
+    s->glQueryCounter(s->gl, s->queries[s->query_write_pos][0], GL_TIMESTAMP);
+}
+
+void ngli_stats_draw_end(struct stats *s)
+{
+    if (!s->gl)
+        return;
+
+    s->glQueryCounter(s->gl, s->queries[s->query_write_pos][1], GL_TIMESTAMP);
+    s->query_write_pos = (s->query_write_pos + 1) % NB_STATS_QUERY_FRAMES;
+    s->nb_pending_queries++;
+}
+
+static void collect_gpu_time(struct stats *s)
+{
+    while (s->nb_pending_queries) {
+        const GLuint *queries = s->queries[s->query_read_pos];
+
+        GLuint64 available = 0;
+        s->glGetQueryObjectui64v(s->gl, queries[1], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available)
+            break;
+
+        GLuint64 start = 0, end = 0;
+        s->glGetQueryObjectui64v(s->gl, queries[0], GL_QUERY_RESULT, &start);
+        s->glGetQueryObjectui64v(s->gl, queries[1], GL_QUERY_RESULT, &end);
+        s->cur.draw_gpu_time = (end - start) / 1000;
+
+        s->query_read_pos = (s->query_read_pos + 1) % NB_STATS_QUERY_FRAMES;
+        s->nb_pending_queries--;
+    }
+}
+
+void ngli_stats_frame_end(struct stats *s)
+{
+    if (!s->gl)
+        return;
+
+    struct glcontext *gl = s->gl;
+
+    /* GPU timings are only available a few frames later: keep the last known
+     * value until a new one is available */
+    s->cur.draw_gpu_time = s->last.draw_gpu_time;
+    collect_gpu_time(s);
+
+    s->cur.uploaded_bytes  = gl->uploaded_bytes - s->last_uploaded_bytes;
+    s->cur.buffers_memory  = gl->buffers_memory;
+    s->cur.textures_memory = gl->textures_memory;
+    s->last_uploaded_bytes = gl->uploaded_bytes;
+
+    if (gl->glstats) {
+        s->cur.nb_gl_calls        = gl->glstats->nb_total_calls;
+        s->cur.nb_redundant_binds = ngli_glstats_get_nb_redundant_binds(gl->glstats);
+        ngli_glstats_frame_end(gl->glstats);
+    }
+
+    if (gl->programcache) {
+        s->cur.nb_program_cache_hits   = gl->programcache->nb_hits;
+        s->cur.nb_program_cache_misses = gl->programcache->nb_misses;
+    }
+
+    s->last = s->cur;
+    memset(&s->cur, 0, sizeof(s->cur));
+}
+
+void ngli_stats_reset(struct stats *s)
+{
+    if (!s->gl)
+        return;
+
+    for (int i = 0; i < NB_STATS_QUERY_FRAMES; i++)
+        s->glDeleteQueries(s->gl, 2, s->queries[i]);
+    memset(s, 0, sizeof(*s));
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include "glcontext.h"
+#include "nodegl.h"
+
+#define NB_STATS_QUERY_FRAMES 4
+
+struct stats {
+    struct ngl_stats cur;  /* frame being drawn, incremented by the nodes */
+    struct ngl_stats last; /* last completed frame, returned to the user */
+    int64_t last_uploaded_bytes;
+
+    struct glcontext *gl;
+    GLuint queries[NB_STATS_QUERY_FRAMES][2];
+    int query_read_pos;
+    int query_write_pos;
+    int nb_pending_queries;
+    void (*glGenQueries)(const struct glcontext *gl, GLsizei n, GLuint * ids);
+    void (*glDeleteQueries)(const struct glcontext *gl, GLsizei n, const GLuint * ids);
+    void (*glQueryCounter)(const struct glcontext *gl, GLuint id, GLenum target);
+    void (*glGetQueryObjectui64v)(const struct glcontext *gl, GLuint id, GLenum pname, GLuint64 *params);
+};
+
+void ngli_stats_init(struct stats *s, struct glcontext *gl);
+void ngli_stats_draw_start(struct stats *s);
+void ngli_stats_draw_end(struct stats *s);
+void ngli_stats_frame_end(struct stats *s);
+void ngli_stats_reset(struct stats *s);
+
+#endif
@@ -19,6 +19,8 @@
  * under the License.
  */
 
+#include <inttypes.h>
+#include <stdio.h>
 #include <string.h>
 
 #define HMAP_SIZE_NBIT 1
@@ -41,6 +43,151 @@ static void free_func(void *arg, void *data)
     ngli_free(data);
 }
 
+static char *make_key(int i)
+{
+    char buf[32];
+    snprintf(buf, sizeof(buf), "key_%08x", i * 2654435761U);
+    return ngli_strdup(buf);
+}
+
+static void check_order(void)
+{
+    static const char * const keys[] = {"zzz", "aaa", "mmm", "bbb", "yyy"};
+    struct hmap *hm = ngli_hmap_create();
+    ngli_assert(hm);
+
+    /* Iteration follows insertion order, including after a deletion */
+    for (int i = 0; i < NGLI_ARRAY_NB(keys); i++)
+        ngli_assert(ngli_hmap_set(hm, keys[i], (void *)keys[i]) == 0);
+    ngli_assert(ngli_hmap_set(hm, "mmm", NULL) == 1);
+    ngli_assert(ngli_hmap_set(hm, "mmm", "mmm") == 0);
+
+    static const char * const expected[] = {"zzz", "aaa", "bbb", "yyy", "mmm"};
+    const struct hmap_entry *e = NULL;
+    for (int i = 0; i < NGLI_ARRAY_NB(expected); i++) {
+        e = ngli_hmap_next(hm, e);
+        ngli_assert(e && !strcmp(e->key, expected[i]));
+    }
+    ngli_assert(!ngli_hmap_next(hm, e));
+
+    ngli_hmap_freep(&hm);
+}
+
+static void check_interned_keys(void)
+{
+    static const char key[] = "interned";
+    struct hmap *hm = ngli_hmap_create();
+    ngli_assert(hm);
+    ngli_hmap_set_interned_keys(hm, 1);
+
+    ngli_assert(ngli_hmap_set(hm, key, "value") == 0);
+    const struct hmap_entry *e = ngli_hmap_next(hm, NULL);
+    ngli_assert(e && e->key == key);
+    ngli_assert(!strcmp(ngli_hmap_get(hm, "interned"), "value"));
+
+    ngli_hmap_freep(&hm);
+}
+
+static void check_stress(int nb_keys, char **keys)
+{
+    struct hmap *hm = ngli_hmap_create();
+    ngli_assert(hm);
+
+    /* Interleave insertions and deletions to exercise the compaction and
+     * the backward shift deletion of the probe sequences */
+    for (int i = 0; i < nb_keys; i++) {
+        ngli_assert(ngli_hmap_set(hm, keys[i], keys[i]) == 0);
+        if (i % 3 == 2)
+            ngli_assert(ngli_hmap_set(hm, keys[i - 1], NULL) == 1);
+    }
+
+    for (int i = 0; i < nb_keys; i++) {
+        const char *data = ngli_hmap_get(hm, keys[i]);
+        if (i % 3 == 1)
+            ngli_assert(!data);
+        else
+            ngli_assert(data == keys[i]);
+    }
+    ngli_assert(ngli_hmap_count(hm) == nb_keys - nb_keys / 3);
+
+    ngli_hmap_freep(&hm);
+}
+
+static void run_benchmark(int nb_keys, char **keys)
+{
+    /* Repeat the operations on small maps to get meaningful timings */
+    const int nb_rounds = NGLI_MAX(100000 / nb_keys, 1);
+    const int nb_lookups = nb_keys * 4;
+    const int nb_iterations = 4;
+    int64_t insert_time = 0, get_time = 0, iterate_time = 0, delete_time = 0;
+
+    for (int r = 0; r < nb_rounds; r++) {
+        struct hmap *hm = ngli_hmap_create();
+        ngli_assert(hm);
+
+        const int64_t t0 = ngli_gettime();
+        for (int i = 0; i < nb_keys; i++)
+            ngli_assert(ngli_hmap_set(hm, keys[i], keys[i]) >= 0);
+
+        const int64_t t1 = ngli_gettime();
+        for (int i = 0; i < nb_lookups; i++)
+            ngli_assert(ngli_hmap_get(hm, keys[i % nb_keys]));
+
+        const int64_t t2 = ngli_gettime();
+        for (int i = 0; i < nb_iterations; i++) {
+            int n = 0;
+            const struct hmap_entry *e = NULL;
+            while ((e = ngli_hmap_next(hm, e)))
+                n++;
+            ngli_assert(n == nb_keys);
+        }
+
+        const int64_t t3 = ngli_gettime();
+        for (int i = 0; i < nb_keys; i++)
+            ngli_assert(ngli_hmap_set(hm, keys[i], NULL) == 1);
+
+        const int64_t t4 = ngli_gettime();
+        ngli_hmap_freep(&hm);
+
+        insert_time  += t1 - t0;
+        get_time     += t2 - t1;
+        iterate_time += t3 - t2;
+        delete_time  += t4 - t3;
+    }
+
+    const double nb_ops = (double)nb_rounds * nb_keys;
+    printf("%6d entries: insert %6.1fns get %6.1fns iterate %6.1fns delete %6.1fns\n",
+           nb_keys,
+           insert_time  * 1000. / nb_ops,
+           get_time     * 1000. / (nb_ops * nb_lookups / nb_keys),
+           iterate_time * 1000. / (nb_ops * nb_iterations),
+           delete_time  * 1000. / nb_ops);
+}
+
+static void run_tests(void)
+{
+    static const int nb_keys_list[] = {10, 100, 1000, 10000, 100000};
+    const int max_keys = nb_keys_list[NGLI_ARRAY_NB(nb_keys_list) - 1];
+
+    char **keys = ngli_calloc(max_keys, sizeof(*keys));
+    ngli_assert(keys);
+    for (int i = 0; i < max_keys; i++) {
+        keys[i] = make_key(i);
+        ngli_assert(keys[i]);
+    }
+
+    check_order();
+    check_interned_keys();
+    check_stress(max_keys, keys);
+
+    for (int i = 0; i < NGLI_ARRAY_NB(nb_keys_list); i++)
+        run_benchmark(nb_keys_list[i], keys);
+
+    for (int i = 0; i < max_keys; i++)
+        ngli_free(keys[i]);
+    ngli_free(keys);
+}
+
 int main(void)
 {
     static const struct {
@@ -90,5 +237,7 @@ int main(void)
         ngli_hmap_freep(&hm);
     }
 
+    run_tests();
+
     return 0;
 }
@@ -0,0 +1,219 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <string.h>
+
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "params.h"
+#include "patch.h"
+#include "utils.h"
+
+static void *get_param(const struct ngl_node *node, const char *key)
+{
+    const struct node_param *par = ngli_params_find(node->class->params, key);
+    ngli_assert(par);
+    return (uint8_t *)node->priv_data + par->offset;
+}
+
+static struct ngl_node *get_child(const struct ngl_node *node, int index)
+{
+    struct ngl_node **children = *(struct ngl_node ***)get_param(node, "children");
+    return children[index];
+}
+
+static int get_nb_children(const struct ngl_node *node)
+{
+    return *(int *)((uint8_t *)get_param(node, "children") + sizeof(struct ngl_node **));
+}
+
+static struct ngl_node *create_group(struct ngl_node **children, int nb_children)
+{
+    struct ngl_node *group = ngl_node_create(NGL_NODE_GROUP);
+    ngli_assert(group);
+    int ret = ngl_node_param_add(group, "children", nb_children, children);
+    ngli_assert(ret >= 0);
+    for (int i = 0; i < nb_children; i++)
+        ngl_node_unrefp(&children[i]);
+    return group;
+}
+
+static struct ngl_node *create_uniform(double value)
+{
+    struct ngl_node *uniform = ngl_node_create(NGL_NODE_UNIFORMFLOAT);
+    ngli_assert(uniform);
+    int ret = ngl_node_param_set(uniform, "value", value);
+    ngli_assert(ret >= 0);
+    return uniform;
+}
+
+static double get_uniform_value(const struct ngl_node *node)
+{
+    return *(double *)get_param(node, "value");
+}
+
+/* A live changeable parameter keeps the node, and is only updated on apply */
+static void test_param_change(void)
+{
+    struct ngl_node *cur_children[] = {create_uniform(1.0)};
+    struct ngl_node *cur = create_group(cur_children, 1);
+    struct ngl_node *new_children[] = {create_uniform(2.0)};
+    struct ngl_node *new = create_group(new_children, 1);
+    struct ngl_node *uniform = get_child(cur, 0);
+    int ret = ngl_node_param_set(get_child(new, 0), "label", "value");
+    ngli_assert(ret >= 0);
+
+    struct patch *patch = ngli_patch_create(cur, new);
+    ngli_assert(patch);
+    const struct patch_stats *stats = ngli_patch_get_stats(patch);
+    ngli_assert(ngli_patch_get_scene(patch) == cur);
+    ngli_assert(stats->nb_kept == 2 && stats->nb_updated == 1 && stats->nb_created == 0);
+
+    ngli_assert(get_uniform_value(uniform) == 1.0);
+    ngli_assert(strcmp(uniform->label, "value"));
+    ret = ngli_patch_apply(patch);
+    ngli_assert(ret == 0);
+    ngli_assert(get_uniform_value(uniform) == 2.0);
+    ngli_assert(!strcmp(uniform->label, "value"));
+
+    ngli_patch_freep(&patch);
+    ngl_node_unrefp(&new);
+    ngl_node_unrefp(&cur);
+}
+
+/* A different set of children replaces the parent but keeps the children in common */
+static void test_children_change(void)
+{
+    struct ngl_node *cur_children[] = {create_uniform(1.0), create_uniform(2.0)};
+    struct ngl_node *cur = create_group(cur_children, 2);
+
+    struct ngl_node *added_children[] = {create_uniform(1.0), create_uniform(2.0), create_uniform(3.0)};
+    struct ngl_node *added = create_group(added_children, 3);
+    for (int i = 0; i < 3; i++)
+        added_children[i] = get_child(added, i);
+    struct patch *patch = ngli_patch_create(cur, added);
+    ngli_assert(patch);
+    const struct patch_stats *stats = ngli_patch_get_stats(patch);
+    struct ngl_node *scene = ngli_patch_get_scene(patch);
+    ngli_assert(scene != added && scene != cur);
+    ngli_assert(stats->nb_kept == 2 && stats->nb_created == 2);
+    ngli_assert(get_nb_children(scene) == 3);
+    ngli_assert(get_child(scene, 0) == get_child(cur, 0));
+    ngli_assert(get_child(scene, 1) == get_child(cur, 1));
+    ngli_assert(get_child(scene, 2) == get_child(added, 2));
+    /* The new scene is left untouched */
+    for (int i = 0; i < 3; i++)
+        ngli_assert(get_child(added, i) == added_children[i]);
+    ngli_patch_freep(&patch);
+    ngl_node_unrefp(&added);
+
+    struct ngl_node *removed_children[] = {create_uniform(1.0)};
+    struct ngl_node *removed = create_group(removed_children, 1);
+    removed_children[0] = get_child(removed, 0);
+    patch = ngli_patch_create(cur, removed);
+    ngli_assert(patch);
+    stats = ngli_patch_get_stats(patch);
+    scene = ngli_patch_get_scene(patch);
+    ngli_assert(scene != removed && scene != cur);
+    ngli_assert(stats->nb_kept == 1 && stats->nb_created == 1);
+    ngli_assert(get_nb_children(scene) == 1);
+    ngli_assert(get_child(scene, 0) == get_child(cur, 0));
+    ngli_assert(get_child(removed, 0) == removed_children[0]);
+    ngli_patch_freep(&patch);
+    ngl_node_unrefp(&removed);
+
+    ngl_node_unrefp(&cur);
+}
+
+static struct ngl_node *create_filter(double value, double start_time, double max_idle_time)
+{
+    struct ngl_node *uniform = create_uniform(value);
+    struct ngl_node *filter = ngl_node_create(NGL_NODE_TIMERANGEFILTER, uniform);
+    ngli_assert(filter);
+    ngl_node_unrefp(&uniform);
+    struct ngl_node *range = ngl_node_create(NGL_NODE_TIMERANGEMODECONT, start_time);
+    ngli_assert(range);
+    int ret = ngl_node_param_add(filter, "ranges", 1, &range);
+    ngli_assert(ret >= 0);
+    ngl_node_unrefp(&range);
+    ret = ngl_node_param_set(filter, "max_idle_time", max_idle_time);
+    ngli_assert(ret >= 0);
+    return filter;
+}
+
+static struct ngl_node *get_child_range(const struct ngl_node *node)
+{
+    struct ngl_node **ranges = *(struct ngl_node ***)get_param(node, "ranges");
+    return ranges[0];
+}
+
+/*
+ * A failing attach of the merged scene leaves the current scene untouched:
+ * the shared nodes keep their reference count, the nodes attached before the
+ * failure are detached, and the live changes are not applied.
+ */
+static void test_attach_failure(void)
+{
+    struct ngl_ctx ctx = {0};
+    ctx.slab = ngli_slab_create();
+    ngli_assert(ctx.slab);
+
+    struct ngl_node *cur = create_filter(1.0, 0.0, 4.0);
+    int ret = ngli_node_attach_ctx(cur, &ctx);
+    ngli_assert(ret == 0);
+    struct ngl_node *uniform = *(struct ngl_node **)get_param(cur, "child");
+    ngli_assert(uniform->ctx_refcount == 1);
+
+    /* The max idle time can not be live changed and is invalid, so the new
+     * filter is created and fails to initialize after its new range has been
+     * attached */
+    struct ngl_node *new = create_filter(2.0, 1.0, 0.5);
+    struct patch *patch = ngli_patch_create(cur, new);
+    ngli_assert(patch);
+    struct ngl_node *scene = ngli_patch_get_scene(patch);
+    ngli_assert(scene != new && scene != cur);
+    ngli_assert(*(struct ngl_node **)get_param(scene, "child") == uniform);
+    struct ngl_node *range = get_child_range(scene);
+
+    ret = ngli_node_attach_ctx(scene, &ctx);
+    ngli_assert(ret < 0);
+    ngli_assert(!scene->ctx && scene->ctx_refcount == 0);
+    ngli_assert(!range->ctx && range->ctx_refcount == 0);
+    ngli_assert(uniform->ctx == &ctx && uniform->ctx_refcount == 1);
+    ngli_assert(get_uniform_value(uniform) == 1.0);
+    ngli_patch_freep(&patch);
+    ngl_node_unrefp(&new);
+
+    ngli_assert(uniform->ctx_refcount == 1);
+    ngli_node_detach_ctx(cur);
+    ngli_assert(!uniform->ctx && uniform->ctx_refcount == 0);
+    ngl_node_unrefp(&cur);
+    ngli_slab_freep(&ctx.slab);
+}
+
+int main(void)
+{
+    test_param_change();
+    test_children_change();
+    test_attach_failure();
+    return 0;
+}
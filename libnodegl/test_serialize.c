@@ -0,0 +1,313 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#define _POSIX_C_SOURCE 200809L // mkstemp()
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "memory.h"
+#include "nodegl.h"
+#include "serialize_binary.h"
+#include "utils.h"
+
+static struct ngl_node *create_scene(void)
+{
+    static const float vertices[] = {
+        -1.0f, -1.0f, 0.0f,
+         1.0f, -1.0f, 0.0f,
+         0.0f,  1.0f, 0.0f,
+         0.5f,  0.5f, 0.5f,
+    };
+    static const uint32_t indices[] = {0, 1, 2, 1, 3, 2};
+    static const float eye[3] = {0.0f, 0.0f, 2.0f};
+    static const float perspective[2] = {45.0f, 1.0f};
+    static const double easing_args[] = {0.5, 2.0};
+
+    struct ngl_node *vbuf = ngl_node_create(NGL_NODE_BUFFERVEC3);
+    struct ngl_node *ibuf = ngl_node_create(NGL_NODE_BUFFERUINT);
+    ngli_assert(vbuf && ibuf);
+    ngli_assert(ngl_node_param_set(vbuf, "data", (int)sizeof(vertices), vertices) >= 0);
+    ngli_assert(ngl_node_param_set(ibuf, "data", (int)sizeof(indices), indices) >= 0);
+
+    struct ngl_node *geometry = ngl_node_create(NGL_NODE_GEOMETRY, vbuf);
+    ngli_assert(geometry);
+    ngli_assert(ngl_node_param_set(geometry, "indices", ibuf) >= 0);
+    ngli_assert(ngl_node_param_set(geometry, "topology", "triangles") >= 0);
+    ngli_assert(ngl_node_param_set(geometry, "optimize", 1) >= 0);
+
+    struct ngl_node *kfs[] = {
+        ngl_node_create(NGL_NODE_ANIMKEYFRAMEFLOAT, 0.0, 0.0),
+        ngl_node_create(NGL_NODE_ANIMKEYFRAMEFLOAT, 1.5, 0.75),
+    };
+    ngli_assert(kfs[0] && kfs[1]);
+    ngli_assert(ngl_node_param_set(kfs[1], "easing", "exp_in") >= 0);
+    ngli_assert(ngl_node_param_add(kfs[1], "easing_args", NGLI_ARRAY_NB(easing_args), (void *)easing_args) >= 0);
+    struct ngl_node *anim = ngl_node_create(NGL_NODE_ANIMATEDFLOAT);
+    ngli_assert(anim);
+    ngli_assert(ngl_node_param_add(anim, "keyframes", NGLI_ARRAY_NB(kfs), kfs) >= 0);
+
+    struct ngl_node *uniform = ngl_node_create(NGL_NODE_UNIFORMFLOAT);
+    ngli_assert(uniform);
+    ngli_assert(ngl_node_param_set(uniform, "value", 0.5) >= 0);
+    ngli_assert(ngl_node_param_set(uniform, "anim", anim) >= 0);
+
+    struct ngl_node *render = ngl_node_create(NGL_NODE_RENDER, geometry);
+    ngli_assert(render);
+    ngli_assert(ngl_node_param_set(render, "uniforms", "time", uniform) >= 0);
+    ngli_assert(ngl_node_param_set(render, "frustum_culling", 0) >= 0);
+
+    struct ngl_node *camera = ngl_node_create(NGL_NODE_CAMERA, render);
+    ngli_assert(camera);
+    ngli_assert(ngl_node_param_set(camera, "eye", eye) >= 0);
+    ngli_assert(ngl_node_param_set(camera, "perspective", perspective) >= 0);
+
+    struct ngl_node *hud = ngl_node_create(NGL_NODE_HUD, camera);
+    ngli_assert(hud);
+    ngli_assert(ngl_node_param_set(hud, "refresh_rate", 1, 30) >= 0);
+    ngli_assert(ngl_node_param_set(hud, "export_filename", "hud.csv") >= 0);
+
+    /* The animation is referenced twice to exercise the node references */
+    struct ngl_node *children[] = {hud, anim};
+    struct ngl_node *scene = ngl_node_create(NGL_NODE_GROUP);
+    ngli_assert(scene);
+    ngli_assert(ngl_node_param_add(scene, "children", NGLI_ARRAY_NB(children), children) >= 0);
+
+    ngl_node_unrefp(&vbuf);
+    ngl_node_unrefp(&ibuf);
+    ngl_node_unrefp(&geometry);
+    ngl_node_unrefp(&kfs[0]);
+    ngl_node_unrefp(&kfs[1]);
+    ngl_node_unrefp(&anim);
+    ngl_node_unrefp(&uniform);
+    ngl_node_unrefp(&render);
+    ngl_node_unrefp(&camera);
+    ngl_node_unrefp(&hud);
+    return scene;
+}
+
+/* The scene is compared through its text serialization */
+static void check_scene(struct ngl_node *scene, const char *ref)
+{
+    ngli_assert(scene);
+    char *str = ngl_node_serialize(scene);
+    ngli_assert(str && !strcmp(str, ref));
+    free(str);
+    ngl_node_unrefp(&scene);
+}
+
+static void test_text_roundtrip(const char *ref)
+{
+    check_scene(ngl_node_deserialize(ref), ref);
+    check_scene(ngl_node_deserialize_data(ref, strlen(ref)), ref);
+}
+
+static void test_binary_roundtrip(struct ngl_node *scene, const char *ref)
+{
+    size_t size;
+    uint8_t *data = ngl_node_serialize_binary(scene, &size);
+    ngli_assert(data && size > sizeof(struct nglb_header));
+    check_scene(ngl_node_deserialize_data(data, size), ref);
+
+    /* The blobs must be usable in place whatever the input alignment */
+    uint8_t *unaligned = malloc(size + 1);
+    ngli_assert(unaligned);
+    memcpy(unaligned + 1, data, size);
+    check_scene(ngl_node_deserialize_data(unaligned + 1, size), ref);
+    free(unaligned);
+
+    char filename[] = "/tmp/test_serialize_XXXXXX";
+    int fd = mkstemp(filename);
+    ngli_assert(fd >= 0);
+    ngli_assert(write(fd, data, size) == size);
+    close(fd);
+    check_scene(ngl_node_deserialize_file(filename), ref);
+    unlink(filename);
+
+    free(data);
+}
+
+static void test_binary_truncated(struct ngl_node *scene)
+{
+    size_t size;
+    uint8_t *data = ngl_node_serialize_binary(scene, &size);
+    ngli_assert(data);
+
+    /* The data is copied so that any read past the size is caught by the
+     * memory checkers */
+    for (size_t i = 0; i < size; i++) {
+        uint8_t *truncated = malloc(i ? i : 1);
+        ngli_assert(truncated);
+        memcpy(truncated, data, i);
+        struct ngl_node *node = ngl_node_deserialize_data(truncated, i);
+        ngli_assert(!node);
+        free(truncated);
+    }
+
+    free(data);
+}
+
+static void test_binary_corrupted(struct ngl_node *scene)
+{
+    size_t size;
+    uint8_t *data = ngl_node_serialize_binary(scene, &size);
+    ngli_assert(data);
+    uint8_t *corrupted = malloc(size);
+    ngli_assert(corrupted);
+
+    /* Sections sizes inconsistent with the header size (growing by less than
+     * the alignment could be absorbed by the padding) */
+    static const size_t header_fields[] = {
+        offsetof(struct nglb_header, nb_nodes),
+        offsetof(struct nglb_header, nb_params),
+        offsetof(struct nglb_header, strings_size),
+    };
+    for (int i = 0; i < NGLI_ARRAY_NB(header_fields); i++) {
+        memcpy(corrupted, data, size);
+        uint32_t v;
+        memcpy(&v, corrupted + header_fields[i], sizeof(v));
+        v += NGLI_ALIGN_VAL;
+        memcpy(corrupted + header_fields[i], &v, sizeof(v));
+        ngli_assert(!ngl_node_deserialize_data(corrupted, size));
+        v = UINT32_MAX;
+        memcpy(corrupted + header_fields[i], &v, sizeof(v));
+        ngli_assert(!ngl_node_deserialize_data(corrupted, size));
+    }
+
+    /* A header size larger than the actual data */
+    memcpy(corrupted, data, size);
+    uint64_t header_size = size + NGLI_ALIGN_VAL;
+    memcpy(corrupted + offsetof(struct nglb_header, size), &header_size, sizeof(header_size));
+    ngli_assert(!ngl_node_deserialize_data(corrupted, size));
+
+    /* A blobs size wrapping the total size around to the header one */
+    memcpy(corrupted, data, size);
+    struct nglb_layout layout;
+    ngli_nglb_get_layout((const struct nglb_header *)data, &layout);
+    header_size = layout.blobs_offset - NGLI_ALIGN_VAL;
+    const uint64_t blobs_size = header_size - layout.blobs_offset;
+    memcpy(corrupted + offsetof(struct nglb_header, size), &header_size, sizeof(header_size));
+    memcpy(corrupted + offsetof(struct nglb_header, blobs_size), &blobs_size, sizeof(blobs_size));
+    ngli_assert(!ngl_node_deserialize_data(corrupted, size));
+
+    /*
+     * Every byte of the records is altered: the scene may still be valid
+     * (with different values), but it must never be loaded from outside the
+     * data.
+     */
+    const size_t records_size = size - ((const struct nglb_header *)data)->blobs_size;
+    for (size_t i = sizeof(struct nglb_header); i < records_size; i++) {
+        memcpy(corrupted, data, size);
+        corrupted[i] ^= 0xff;
+        struct ngl_node *node = ngl_node_deserialize_data(corrupted, size);
+        ngl_node_unrefp(&node);
+    }
+
+    free(corrupted);
+    free(data);
+}
+
+static void test_text_corrupted(const char *ref)
+{
+    const size_t len = strlen(ref);
+    char *str = malloc(len + 1);
+    ngli_assert(str);
+
+    /* An unknown type for the first node */
+    memcpy(str, ref, len + 1);
+    char *line = strchr(str, '\n');
+    ngli_assert(line);
+    memcpy(line + 1, "Xxxx", 4);
+    ngli_assert(!ngl_node_deserialize(str));
+
+    /* Lines split or merged at every position */
+    for (size_t i = 0; i < len; i++) {
+        memcpy(str, ref, len + 1);
+        str[i] = str[i] == '\n' ? ' ' : '\n';
+        struct ngl_node *node = ngl_node_deserialize(str);
+        ngl_node_unrefp(&node);
+    }
+
+    free(str);
+}
+
+static struct ngl_node *deserialize_stream(const uint8_t *data, size_t size, size_t chunk_size)
+{
+    struct ngl_deserializer *d = ngl_deserializer_create();
+    ngli_assert(d);
+    for (size_t pos = 0; pos < size; pos += chunk_size) {
+        const size_t n = NGLI_MIN(chunk_size, size - pos);
+        ngli_assert(ngl_deserializer_feed(d, (const char *)data + pos, n) >= 0);
+    }
+    struct ngl_node *node = ngl_deserializer_end(d);
+    ngl_deserializer_freep(&d);
+    return node;
+}
+
+static void test_stream(struct ngl_node *scene, const char *ref)
+{
+    size_t size;
+    uint8_t *data = ngl_node_serialize_binary(scene, &size);
+    ngli_assert(data);
+
+    static const size_t chunk_sizes[] = {1, 2, 3, 7, 64, 4096};
+    for (int i = 0; i < NGLI_ARRAY_NB(chunk_sizes); i++) {
+        check_scene(deserialize_stream((const uint8_t *)ref, strlen(ref), chunk_sizes[i]), ref);
+        check_scene(deserialize_stream(data, size, chunk_sizes[i]), ref);
+    }
+
+    /* A binary stream ending early */
+    ngli_assert(!deserialize_stream(data, size - 1, 1));
+
+    /* Nothing can be fed once the scene has been returned */
+    struct ngl_deserializer *d = ngl_deserializer_create();
+    ngli_assert(d);
+    ngli_assert(ngl_deserializer_feed(d, ref, strlen(ref)) >= 0);
+    struct ngl_node *node = ngl_deserializer_end(d);
+    check_scene(node, ref);
+    ngli_assert(ngl_deserializer_feed(d, ref, 1) < 0);
+    ngli_assert(!ngl_deserializer_end(d));
+    ngl_deserializer_freep(&d);
+    ngli_assert(!d);
+
+    free(data);
+}
+
+int main(void)
+{
+    struct ngl_node *scene = create_scene();
+    char *ref = ngl_node_serialize(scene);
+    ngli_assert(ref);
+
+    test_text_roundtrip(ref);
+    test_binary_roundtrip(scene, ref);
+    test_binary_truncated(scene);
+    test_binary_corrupted(scene);
+    test_text_corrupted(ref);
+    test_stream(scene, ref);
+
+    free(ref);
+    ngl_node_unrefp(&scene);
+    return 0;
+}
@@ -0,0 +1,283 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory.h"
+#include "nodegl.h"
+#include "nodes.h"
+#include "utils.h"
+#include "vertexcache.h"
+
+#define CACHE_SIZE 16
+
+/* Triangle list of a w x h grid of quads, with the triangles shuffled */
+static uint32_t *create_grid(int w, int h, int *nb_indicesp)
+{
+    const int nb_triangles = w * h * 2;
+    uint32_t *indices = ngli_calloc(nb_triangles * 3, sizeof(*indices));
+    ngli_assert(indices);
+
+    uint32_t *p = indices;
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            const uint32_t v = y * (w + 1) + x;
+            const uint32_t quad[] = {v, v + 1, v + w + 1, v + 1, v + w + 2, v + w + 1};
+            memcpy(p, quad, sizeof(quad));
+            p += NGLI_ARRAY_NB(quad);
+        }
+    }
+
+    uint32_t seed = 0x12345678;
+    for (int i = nb_triangles - 1; i > 0; i--) {
+        seed = seed * 1664525 + 1013904223;
+        const int j = (seed >> 8) % (i + 1);
+        uint32_t tmp[3];
+        memcpy(tmp, &indices[i * 3], sizeof(tmp));
+        memcpy(&indices[i * 3], &indices[j * 3], sizeof(tmp));
+        memcpy(&indices[j * 3], tmp, sizeof(tmp));
+    }
+
+    *nb_indicesp = nb_triangles * 3;
+    return indices;
+}
+
+static int cmp_triangle(const void *a, const void *b)
+{
+    return memcmp(a, b, 3 * sizeof(uint32_t));
+}
+
+static void sort_triangles(uint32_t *indices, int nb_indices)
+{
+    qsort(indices, nb_indices / 3, 3 * sizeof(*indices), cmp_triangle);
+}
+
+/* Average number of vertex shader invocations per triangle with a FIFO cache */
+static double get_acmr(const uint32_t *indices, int nb_indices, int nb_vertices)
+{
+    int *cache_time = ngli_calloc(nb_vertices, sizeof(*cache_time));
+    ngli_assert(cache_time);
+    int time = CACHE_SIZE + 1;
+    int nb_misses = 0;
+    for (int i = 0; i < nb_indices; i++) {
+        const uint32_t v = indices[i];
+        if (time - cache_time[v] > CACHE_SIZE) {
+            cache_time[v] = time++;
+            nb_misses++;
+        }
+    }
+    ngli_free(cache_time);
+    return nb_misses / (nb_indices / 3.0);
+}
+
+static void test_optimize(void)
+{
+    const int w = 32, h = 32;
+    const int nb_vertices = (w + 1) * (h + 1);
+    int nb_indices;
+    uint32_t *indices = create_grid(w, h, &nb_indices);
+    uint32_t *optimized = ngli_calloc(nb_indices, sizeof(*optimized));
+    ngli_assert(optimized);
+
+    int ret = ngli_vertexcache_optimize(optimized, indices, nb_indices, nb_vertices, CACHE_SIZE);
+    ngli_assert(ret == 0);
+
+    /* Nearly every access of a shuffled grid misses the cache (3 vertices
+     * per triangle), an optimized one gets close to the ideal 0.5 */
+    const double acmr = get_acmr(indices, nb_indices, nb_vertices);
+    const double optimized_acmr = get_acmr(optimized, nb_indices, nb_vertices);
+    ngli_assert(acmr > 2.5);
+    ngli_assert(optimized_acmr < 0.8);
+
+    /* The triangles are only reordered, with their winding kept */
+    uint32_t *ref = ngli_calloc(nb_indices, sizeof(*ref));
+    ngli_assert(ref);
+    memcpy(ref, indices, nb_indices * sizeof(*ref));
+    sort_triangles(ref, nb_indices);
+    sort_triangles(optimized, nb_indices);
+    ngli_assert(!memcmp(ref, optimized, nb_indices * sizeof(*ref)));
+
+    ngli_free(ref);
+    ngli_free(optimized);
+    ngli_free(indices);
+}
+
+static void test_remap(void)
+{
+    const int w = 8, h = 8;
+    /* The last vertices are not referenced by any triangle */
+    const int nb_vertices = (w + 1) * (h + 1) + 3;
+    int nb_indices;
+    uint32_t *indices = create_grid(w, h, &nb_indices);
+    uint32_t *remapped = ngli_calloc(nb_indices, sizeof(*remapped));
+    uint32_t *remap = ngli_calloc(nb_vertices, sizeof(*remap));
+    uint8_t *used = ngli_calloc(nb_vertices, sizeof(*used));
+    ngli_assert(remapped && remap && used);
+
+    memcpy(remapped, indices, nb_indices * sizeof(*remapped));
+    ngli_vertexcache_remap(remap, remapped, nb_indices, nb_vertices);
+
+    /* remap is a permutation consistent with the rewritten indices */
+    for (int v = 0; v < nb_vertices; v++) {
+        ngli_assert(remap[v] < nb_vertices && !used[remap[v]]);
+        used[remap[v]] = 1;
+    }
+    for (int i = 0; i < nb_indices; i++)
+        ngli_assert(remapped[i] == remap[indices[i]]);
+
+    /* The vertices are numbered by order of first use, unused ones last */
+    uint32_t next = 0;
+    for (int i = 0; i < nb_indices; i++) {
+        ngli_assert(remapped[i] <= next);
+        if (remapped[i] == next)
+            next++;
+    }
+    ngli_assert(next == nb_vertices - 3);
+    for (int v = nb_vertices - 3; v < nb_vertices; v++)
+        ngli_assert(remap[v] >= next);
+
+    ngli_free(used);
+    ngli_free(remap);
+    ngli_free(remapped);
+    ngli_free(indices);
+}
+
+static struct ngl_node *create_geometry(int w, int h, int optimize)
+{
+    const int nb_vertices = (w + 1) * (h + 1);
+    float *vertices = ngli_calloc(nb_vertices, 3 * sizeof(*vertices));
+    ngli_assert(vertices);
+    for (int i = 0; i < nb_vertices; i++) {
+        vertices[i * 3 + 0] = i % (w + 1);
+        vertices[i * 3 + 1] = i / (w + 1);
+    }
+    int nb_indices;
+    uint32_t *indices = create_grid(w, h, &nb_indices);
+
+    struct ngl_node *vbuf = ngl_node_create(NGL_NODE_BUFFERVEC3);
+    struct ngl_node *ibuf = ngl_node_create(NGL_NODE_BUFFERUINT);
+    ngli_assert(vbuf && ibuf);
+    int ret = ngl_node_param_set(vbuf, "data", nb_vertices * 3 * (int)sizeof(*vertices), vertices);
+    ngli_assert(ret >= 0);
+    ret = ngl_node_param_set(ibuf, "data", nb_indices * (int)sizeof(*indices), indices);
+    ngli_assert(ret >= 0);
+
+    struct ngl_node *geometry = ngl_node_create(NGL_NODE_GEOMETRY, vbuf);
+    ngli_assert(geometry);
+    ret = ngl_node_param_set(geometry, "indices", ibuf);
+    ngli_assert(ret >= 0);
+    ret = ngl_node_param_set(geometry, "optimize", optimize);
+    ngli_assert(ret >= 0);
+
+    ngl_node_unrefp(&vbuf);
+    ngl_node_unrefp(&ibuf);
+    ngli_free(vertices);
+    ngli_free(indices);
+    return geometry;
+}
+
+static int cmp_triangle_pos(const void *a, const void *b)
+{
+    return memcmp(a, b, 9 * sizeof(float));
+}
+
+/* Read back the positions of the vertices of the triangles, in a stable order */
+static float *get_triangles(const struct geometry_priv *s)
+{
+    const struct buffer_priv *vertices = s->vertices_buffer->priv_data;
+    const struct buffer_priv *indices = s->indices_buffer->priv_data;
+    float *triangles = ngli_calloc(indices->count, 3 * sizeof(*triangles));
+    ngli_assert(triangles);
+    for (int i = 0; i < indices->count; i++) {
+        uint32_t index;
+        switch (indices->data_stride) {
+        case 2: index = ((const uint16_t *)indices->data)[i]; break;
+        case 4: index = ((const uint32_t *)indices->data)[i]; break;
+        default: ngli_assert(0);
+        }
+        ngli_assert(index < vertices->count);
+        memcpy(&triangles[i * 3], vertices->data + index * vertices->data_stride, 3 * sizeof(*triangles));
+    }
+    qsort(triangles, indices->count / 3, 9 * sizeof(*triangles), cmp_triangle_pos);
+    return triangles;
+}
+
+static void check_geometry(int w, int h, int index_type)
+{
+    struct ngl_ctx ctx = {0};
+    ctx.slab = ngli_slab_create();
+    ngli_assert(ctx.slab);
+
+    struct ngl_node *ref = create_geometry(w, h, 0);
+    int ret = ngli_node_attach_ctx(ref, &ctx);
+    ngli_assert(ret == 0);
+    struct geometry_priv *ref_priv = ref->priv_data;
+    float *ref_triangles = get_triangles(ref_priv);
+
+    struct ngl_node *geometry = create_geometry(w, h, 1);
+    ret = ngli_node_attach_ctx(geometry, &ctx);
+    ngli_assert(ret == 0);
+    struct geometry_priv *s = geometry->priv_data;
+    ngli_assert(s->indices_buffer->class->id == index_type);
+    ngli_assert(s->indices_buffer != s->geometry_indices);
+    const struct buffer_priv *indices = s->indices_buffer->priv_data;
+    const struct buffer_priv *ref_indices = ref_priv->indices_buffer->priv_data;
+    ngli_assert(indices->count == ref_indices->count);
+
+    /* The optimized geometry draws the same triangles */
+    float *triangles = get_triangles(s);
+    ngli_assert(!memcmp(triangles, ref_triangles, indices->count * 3 * sizeof(*triangles)));
+
+    /* The optimized buffers do not leak into the user parameters */
+    char *serialized = ngl_node_serialize(geometry);
+    ngli_assert(serialized);
+    ngli_node_detach_ctx(geometry);
+    char *serialized_detached = ngl_node_serialize(geometry);
+    ngli_assert(serialized_detached);
+    ngli_assert(!strcmp(serialized, serialized_detached));
+    free(serialized_detached);
+    free(serialized);
+
+    ngli_free(triangles);
+    ngli_free(ref_triangles);
+    ngli_node_detach_ctx(ref);
+    ngl_node_unrefp(&geometry);
+    ngl_node_unrefp(&ref);
+    ngli_slab_freep(&ctx.slab);
+}
+
+static void test_geometry(void)
+{
+    /* 16-bit indices as long as every vertex can be addressed with them */
+    check_geometry(15, 15, NGL_NODE_BUFFERUSHORT);
+    check_geometry(255, 255, NGL_NODE_BUFFERUSHORT);
+    check_geometry(256, 255, NGL_NODE_BUFFERUINT);
+}
+
+int main(void)
+{
+    test_optimize();
+    test_remap();
+    test_geometry();
+    return 0;
+}
@@ -132,6 +132,18 @@ static void renderbuffer_set_storage(struct texture *s)
         ngli_glRenderbufferStorage(gl, GL_RENDERBUFFER, s->format, params->width, params->height);
 }
 
+static int64_t texture_get_memory_size(const struct texture *s)
+{
+    const struct texture_params *params = &s->params;
+    if (s->external_storage)
+        return 0;
+    return (int64_t)params->width
+         * params->height
+         * (params->dimensions == 3 ? params->depth : 1)
+         * NGLI_MAX(params->samples, 1)
+         * ngli_format_get_bytes_per_pixel(params->format);
+}
+
 static int texture_init_fields(struct texture *s)
 {
     struct glcontext *gl = s->gl;
@@ -199,7 +211,7 @@ int ngli_texture_init(struct texture *s,
         renderbuffer_set_storage(s);
     } else {
         ngli_glGenTextures(gl, 1, &s->id);
-        ngli_glBindTexture(gl, s->target, s->id);
+        ngli_glstate_bind_texture(gl, s->target, s->id);
         ngli_glTexParameteri(gl, s->target, GL_TEXTURE_MIN_FILTER, params->min_filter);
         ngli_glTexParameteri(gl, s->target, GL_TEXTURE_MAG_FILTER, params->mag_filter);
         ngli_glTexParameteri(gl, s->target, GL_TEXTURE_WRAP_S, params->wrap_s);
@@ -223,6 +235,9 @@ int ngli_texture_init(struct texture *s,
         }
     }
 
+    s->memory_size = texture_get_memory_size(s);
+    gl->textures_memory += s->memory_size;
+
     return 0;
 }
 
@@ -250,6 +265,8 @@ void ngli_texture_set_id(struct texture *s, GLuint id)
     /* only wrapped textures can update their id with this function */
     ngli_assert(s->wrapped);
 
+    if (s->id != id && s->target != GL_RENDERBUFFER)
+        ngli_glstate_forget_texture(s->gl, s->id);
     s->id = id;
 }
 
@@ -289,13 +306,14 @@ int ngli_texture_upload(struct texture *s, const uint8_t *data)
      * buffers) cannot update their content with this function */
     ngli_assert(!s->external_storage && !(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
 
-    ngli_glBindTexture(gl, s->target, s->id);
+    ngli_glstate_bind_texture(gl, s->target, s->id);
     if (data) {
         texture_set_sub_image(s, data);
+        gl->uploaded_bytes += texture_get_memory_size(s);
         if (ngli_texture_has_mipmap(s))
             ngli_glGenerateMipmap(gl, s->target);
     }
-    ngli_glBindTexture(gl, s->target, 0);
+    ngli_glstate_bind_texture(gl, s->target, 0);
 
     return 0;
 }
@@ -307,7 +325,7 @@ int ngli_texture_generate_mipmap(struct texture *s)
 
     ngli_assert(!(params->usage & NGLI_TEXTURE_USAGE_ATTACHMENT_ONLY));
 
-    ngli_glBindTexture(gl, s->target, s->id);
+    ngli_glstate_bind_texture(gl, s->target, s->id);
     ngli_glGenerateMipmap(gl, s->target);
     return 0;
 }
@@ -318,11 +336,18 @@ void ngli_texture_reset(struct texture *s)
     if (!gl)
         return;
 
+    gl->textures_memory -= s->memory_size;
+    s->memory_size = 0;
+
     if (!s->wrapped) {
         if (s->target == GL_RENDERBUFFER)
             ngli_glDeleteRenderbuffers(gl, 1, &s->id);
         else
-            ngli_glDeleteTextures(gl, 1, &s->id);
+            ngli_glstate_delete_texture(gl, s->id);
+    } else if (s->target != GL_RENDERBUFFER) {
+        /* the lifetime of wrapped textures is managed outside of the
+         * library, their name may be reused by a future texture */
+        ngli_glstate_forget_texture(gl, s->id);
     }
 
     memset(s, 0, sizeof(*s));
@@ -72,6 +72,8 @@ struct texture {
     GLint format;
     GLint internal_format;
     GLenum format_type;
+
+    int64_t memory_size;    // bytes accounted in the context textures memory
 };
 
 int ngli_texture_init(struct texture *s,
@@ -96,6 +96,25 @@ uint32_t ngli_crc32(const char *s)
     return ~crc;
 }
 
+uint64_t ngli_hash64(const void *data, size_t size)
+{
+    const uint8_t *p = data;
+    uint64_t hash = 0xcbf29ce484222325 ^ size;
+    while (size >= sizeof(uint64_t)) {
+        uint64_t v;
+        memcpy(&v, p, sizeof(v));
+        hash = (hash ^ v) * 0x9e3779b97f4a7c15;
+        hash ^= hash >> 32;
+        p += sizeof(v);
+        size -= sizeof(v);
+    }
+    while (size--) {
+        hash = (hash ^ *p++) * 0x100000001b3;
+    }
+    hash ^= hash >> 29;
+    return hash;
+}
+
 void ngli_thread_set_name(const char *name)
 {
 #if defined(__APPLE__)
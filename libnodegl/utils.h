@@ -97,6 +97,7 @@ char *ngli_strdup(const char *s);
 int64_t ngli_gettime(void);
 char *ngli_asprintf(const char *fmt, ...) ngli_printf_format(1, 2);
 uint32_t ngli_crc32(const char *s);
+uint64_t ngli_hash64(const void *data, size_t size);
 void ngli_thread_set_name(const char *name);
 
 #endif /* UTILS_H */
@@ -0,0 +1,183 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "memory.h"
+#include "vertexcache.h"
+
+struct tipsify {
+    const uint32_t *indices;
+    int nb_vertices;
+    int cache_size;
+    int *adjacency_offsets;     // offset of the triangles of each vertex in adjacency
+    int *adjacency;             // triangles using each vertex
+    int *live_triangles;        // number of triangles not emitted yet using each vertex
+    int *cache_time;            // time at which each vertex last entered the cache
+    uint8_t *emitted;
+    int *dead_end;              // stack of recently used vertices
+    int nb_dead_end;
+    int cursor;                 // next vertex to consider once the stack is exhausted
+};
+
+static int build_adjacency(struct tipsify *s, int nb_indices)
+{
+    s->adjacency_offsets = ngli_calloc(s->nb_vertices + 1, sizeof(*s->adjacency_offsets));
+    s->adjacency = ngli_calloc(nb_indices, sizeof(*s->adjacency));
+    s->live_triangles = ngli_calloc(s->nb_vertices, sizeof(*s->live_triangles));
+    if (!s->adjacency_offsets || !s->adjacency || !s->live_triangles)
+        return -1;
+
+    for (int i = 0; i < nb_indices; i++)
+        s->live_triangles[s->indices[i]]++;
+
+    for (int v = 0; v < s->nb_vertices; v++)
+        s->adjacency_offsets[v + 1] = s->adjacency_offsets[v] + s->live_triangles[v];
+
+    int *fill = ngli_calloc(s->nb_vertices, sizeof(*fill));
+    if (!fill)
+        return -1;
+    for (int i = 0; i < nb_indices; i++) {
+        const uint32_t v = s->indices[i];
+        s->adjacency[s->adjacency_offsets[v] + fill[v]++] = i / 3;
+    }
+    ngli_free(fill);
+    return 0;
+}
+
+static int skip_dead_end(struct tipsify *s)
+{
+    while (s->nb_dead_end > 0) {
+        const int v = s->dead_end[--s->nb_dead_end];
+        if (s->live_triangles[v] > 0)
+            return v;
+    }
+    while (s->cursor < s->nb_vertices) {
+        const int v = s->cursor++;
+        if (s->live_triangles[v] > 0)
+            return v;
+    }
+    return -1;
+}
+
+/*
+ * Among the vertices of the triangles just emitted, pick the one still in
+ * the cache (even after its remaining triangles are emitted) which entered
+ * it the earliest.
+ */
+static int get_next_vertex(struct tipsify *s, const int *candidates, int nb_candidates, int time)
+{
+    int best = -1;
+    int best_priority = -1;
+    for (int i = 0; i < nb_candidates; i++) {
+        const int v = candidates[i];
+        if (s->live_triangles[v] <= 0)
+            continue;
+        int priority = 0;
+        if (time - s->cache_time[v] + 2 * s->live_triangles[v] <= s->cache_size)
+            priority = time - s->cache_time[v];
+        if (priority > best_priority) {
+            best = v;
+            best_priority = priority;
+        }
+    }
+    return best >= 0 ? best : skip_dead_end(s);
+}
+
+int ngli_vertexcache_optimize(uint32_t *dst, const uint32_t *indices, int nb_indices,
+                              int nb_vertices, int cache_size)
+{
+    struct tipsify s = {
+        .indices     = indices,
+        .nb_vertices = nb_vertices,
+        .cache_size  = cache_size,
+    };
+
+    int ret = -1;
+    int *candidates = NULL;
+    if (build_adjacency(&s, nb_indices) < 0)
+        goto end;
+
+    s.cache_time = ngli_calloc(nb_vertices, sizeof(*s.cache_time));
+    s.emitted = ngli_calloc(nb_indices / 3, sizeof(*s.emitted));
+    s.dead_end = ngli_calloc(nb_indices, sizeof(*s.dead_end));
+    if (!s.cache_time || !s.emitted || !s.dead_end)
+        goto end;
+
+    int max_triangles = 0;
+    for (int v = 0; v < nb_vertices; v++)
+        max_triangles = s.live_triangles[v] > max_triangles ? s.live_triangles[v] : max_triangles;
+    candidates = ngli_calloc(max_triangles * 3, sizeof(*candidates));
+    if (max_triangles && !candidates)
+        goto end;
+
+    int time = cache_size + 1;
+    int nb_dst = 0;
+    int fan = nb_indices ? 0 : -1;
+    while (fan >= 0) {
+        int nb_candidates = 0;
+        for (int i = s.adjacency_offsets[fan]; i < s.adjacency_offsets[fan + 1]; i++) {
+            const int triangle = s.adjacency[i];
+            if (s.emitted[triangle])
+                continue;
+            for (int j = 0; j < 3; j++) {
+                const uint32_t v = indices[triangle * 3 + j];
+                dst[nb_dst++] = v;
+                s.dead_end[s.nb_dead_end++] = v;
+                candidates[nb_candidates++] = v;
+                s.live_triangles[v]--;
+                if (time - s.cache_time[v] > cache_size)
+                    s.cache_time[v] = time++;
+            }
+            s.emitted[triangle] = 1;
+        }
+        fan = get_next_vertex(&s, candidates, nb_candidates, time);
+    }
+    ret = 0;
+
+end:
+    ngli_free(candidates);
+    ngli_free(s.adjacency_offsets);
+    ngli_free(s.adjacency);
+    ngli_free(s.live_triangles);
+    ngli_free(s.cache_time);
+    ngli_free(s.emitted);
+    ngli_free(s.dead_end);
+    return ret;
+}
+
+void ngli_vertexcache_remap(uint32_t *remap, uint32_t *indices, int nb_indices, int nb_vertices)
+{
+    memset(remap, 0xff, nb_vertices * sizeof(*remap));
+
+    uint32_t next = 0;
+    for (int i = 0; i < nb_indices; i++) {
+        const uint32_t v = indices[i];
+        if (remap[v] == UINT32_MAX)
+            remap[v] = next++;
+        indices[i] = remap[v];
+    }
+
+    for (int v = 0; v < nb_vertices; v++)
+        if (remap[v] == UINT32_MAX)
+            remap[v] = next++;
+}
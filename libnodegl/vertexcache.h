@@ -0,0 +1,44 @@
+/*
+ * Copyright 2018 GoPro Inc.
+ *
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * "License"); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+#ifndef VERTEXCACHE_H
+#define VERTEXCACHE_H
+
+#include <stdint.h>
+
+/*
+ * Reorder the triangles of a triangle list for the locality of the
+ * post-transform vertex cache, using the Tipsify algorithm (Sander et al.,
+ * "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw", 2007).
+ * The indices must be lower than nb_vertices. dst and indices can not
+ * overlap.
+ */
+int ngli_vertexcache_optimize(uint32_t *dst, const uint32_t *indices, int nb_indices,
+                              int nb_vertices, int cache_size);
+
+/*
+ * Reorder the vertices by order of first use for the locality of the vertex
+ * fetches. The indices are rewritten in place, and remap[v] receives the new
+ * position of the vertex v. The unused vertices are moved at the end.
+ */
+void ngli_vertexcache_remap(uint32_t *remap, uint32_t *indices, int nb_indices, int nb_vertices);
+
+#endif
@@ -34,32 +34,29 @@
 
 static struct ngl_node *get_scene(const char *filename)
 {
-    struct ngl_node *scene = NULL;
-    char *buf = NULL;
-    struct stat st;
-
-    int fd = open(filename, O_RDONLY);
-    if (fd == -1) {
-        fprintf(stderr, "unable to open %s\n", filename);
-        goto end;
-    }
-
-    if (fstat(fd, &st) == -1)
-        goto end;
-
-    buf = malloc(st.st_size + 1);
-    if (!buf)
-        goto end;
+    if (strcmp(filename, "-"))
+        return ngl_node_deserialize_file(filename);
 
-    int n = read(fd, buf, st.st_size);
-    buf[n] = 0;
+    /* The scene is built progressively while it is read */
+    struct ngl_deserializer *d = ngl_deserializer_create();
+    if (!d)
+        return NULL;
 
-    scene = ngl_node_deserialize(buf);
+    struct ngl_node *scene = NULL;
+    char buf[4096];
+    for (;;) {
+        const ssize_t n = read(STDIN_FILENO, buf, sizeof(buf));
+        if (n < 0)
+            goto end;
+        if (!n)
+            break;
+        if (ngl_deserializer_feed(d, buf, n) < 0)
+            goto end;
+    }
+    scene = ngl_deserializer_end(d);
 
 end:
-    if (fd != -1)
-        close(fd);
-    free(buf);
+    ngl_deserializer_freep(&d);
     return scene;
 }
 
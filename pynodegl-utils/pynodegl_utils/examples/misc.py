@@ -206,6 +206,38 @@ def cropboard(cfg, dim=15):
     return render
 
 
+@scene(dim={'type': 'range', 'range': [1, 50]},
+       order_independent={'type': 'bool'})
+def sprites(cfg, dim=20, order_independent=True):
+    '''Many sprites interleaving programs and textures, drawn by an order independent Group'''
+    m0 = cfg.medias[0]
+    cfg.duration = m0.duration
+    cfg.aspect_ratio = (m0.width, m0.height)
+
+    video_tex = ngl.Texture2D(data_src=ngl.Media(m0.filename))
+    checker_tex = ngl.Texture2D(width=2, height=2,
+                                data_src=ngl.BufferUBVec4(data=array.array('B', [255, 255, 255, 255, 0, 0, 0, 255,
+                                                                                 0, 0, 0, 255, 255, 255, 255, 255])))
+    textures = (video_tex, checker_tex)
+
+    tint_prog = ngl.Program(fragment=cfg.get_frag('tex-tint'))
+    programs = (ngl.Program(), tint_prog)
+
+    qw = qh = 2. / dim
+    group = ngl.Group(order_independent=order_independent)
+    for y in range(dim):
+        for x in range(dim):
+            i = y * dim + x
+            q = ngl.Quad((x*qw - 1., y*qh - 1., 0), (qw, 0, 0), (0, qh, 0))
+            render = ngl.Render(q, programs[i % 2])
+            render.update_textures(tex0=textures[i // 2 % 2])
+            if programs[i % 2] == tint_prog:
+                render.update_uniforms(blend_color=ngl.UniformVec3(value=(1, .5, 0)),
+                                       mix_factor=ngl.UniformFloat(value=.5))
+            group.add_children(render)
+    return group
+
+
 @scene(freq_precision={'type': 'range', 'range': [1, 10]},
        overlay={'type': 'range', 'unit_base': 100})
 def audiotex(cfg, freq_precision=7, overlay=0.6):
@@ -243,7 +243,7 @@ class Player(QtCore.QThread):
         if self._backend != cfg['backend']:
             self._backend = cfg['backend']
             self._viewer = ngl.Viewer()
-        self._viewer.set_scene_from_string(self._scene)
+        self._viewer.patch_scene_from_string(self._scene)
         self._configure_viewer()
         self._clock.configure(self._framerate, self._duration)
         self.onSceneMetadata.emit({'framerate': self._framerate, 'duration': self._duration})
@@ -1,6 +1,7 @@
 from libc.stdlib cimport calloc
 from libc.string cimport memset
 from libc.stdint cimport uint8_t
+from libc.stdint cimport int64_t
 from libc.stdint cimport uintptr_t
 
 cdef extern from "nodegl.h":
@@ -55,11 +56,35 @@ cdef extern from "nodegl.h":
         int  set_surface_pts
         float clear_color[4]
         uint8_t *capture_buffer
+        int  dedup_resources
+        int  auto_instancing
+        int  disable_culling
 
     ngl_ctx *ngl_create()
     int ngl_configure(ngl_ctx *s, ngl_config *config)
     int ngl_set_scene(ngl_ctx *s, ngl_node *scene)
+    int ngl_patch_scene(ngl_ctx *s, ngl_node *scene)
     int ngl_draw(ngl_ctx *s, double t) nogil
+
+    cdef struct ngl_stats:
+        int64_t update_cpu_time
+        int64_t draw_cpu_time
+        int64_t draw_gpu_time
+        int nb_draw_calls
+        int nb_culled_draws
+        int nb_dispatches
+        int nb_active_nodes
+        int nb_prefetches
+        int nb_releases
+        int64_t uploaded_bytes
+        int64_t buffers_memory
+        int64_t textures_memory
+        int nb_gl_calls
+        int nb_redundant_binds
+        int nb_program_cache_hits
+        int nb_program_cache_misses
+
+    int ngl_get_stats(ngl_ctx *s, ngl_stats *stats)
     char *ngl_dot(ngl_ctx *s, double t) nogil
     void ngl_freep(ngl_ctx **ss)
 
@@ -167,6 +192,9 @@ cdef class Viewer:
         clear_color = kwargs.get('clear_color', (0.0, 0.0, 0.0, 1.0))
         for i in range(4):
             config.clear_color[i] = clear_color[i]
+        config.dedup_resources = kwargs.get('dedup_resources', 0)
+        config.auto_instancing = kwargs.get('auto_instancing', 0)
+        config.disable_culling = kwargs.get('disable_culling', 0)
         capture_buffer = kwargs.get('capture_buffer')
         if capture_buffer is not None:
             config.capture_buffer = capture_buffer
@@ -181,10 +209,25 @@ cdef class Viewer:
         ngl_node_unrefp(&scene)
         return ret
 
+    def patch_scene(self, _Node scene):
+        return ngl_patch_scene(self.ctx, NULL if scene is None else scene.ctx)
+
+    def patch_scene_from_string(self, s):
+        cdef ngl_node *scene = ngl_node_deserialize(s);
+        ret = ngl_patch_scene(self.ctx, scene)
+        ngl_node_unrefp(&scene)
+        return ret
+
     def draw(self, double t):
         with nogil:
             ngl_draw(self.ctx, t)
 
+    def get_stats(self):
+        cdef ngl_stats stats
+        if ngl_get_stats(self.ctx, &stats) < 0:
+            return None
+        return stats
+
     def dot(self, double t):
         cdef char *s;
         with nogil: